@@ -43,3 +43,4 @@ class InstinctCppRecipe(ConanFile):
         self.requires("cli11/2.4.1")
         # test deps
         self.test_requires("gtest/1.14.0")
+        self.test_requires("benchmark/1.8.3")
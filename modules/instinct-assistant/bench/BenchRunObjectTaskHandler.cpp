@@ -0,0 +1,205 @@
+#include <benchmark/benchmark.h>
+#include <cmrc/cmrc.hpp>
+#include <httplib.h>
+
+#include "LLMTestGlobals.hpp"
+#include "assistant/v2/data_mapper/VectorStoreDataMapper.hpp"
+#include "assistant/v2/data_mapper/VectorStoreFileBatchDataMapper.hpp"
+#include "assistant/v2/data_mapper/VectorStoreFileDataMapper.hpp"
+#include "assistant/v2/service/impl/AssistantServiceImpl.hpp"
+#include "assistant/v2/service/impl/FileServiceImpl.hpp"
+#include "assistant/v2/service/impl/MessageServiceImpl.hpp"
+#include "assistant/v2/service/impl/RunServiceImpl.hpp"
+#include "assistant/v2/service/impl/ThreadServiceImpl.hpp"
+#include "assistant/v2/service/impl/VectorStoreServiceImpl.hpp"
+#include "assistant/v2/task_handler/RunObjectTaskHandler.hpp"
+#include "assistant/v2/tool/SimpleRetrieverOperator.hpp"
+#include "database/DBUtils.hpp"
+#include "database/duckdb/DuckDBConnectionPool.hpp"
+#include "database/duckdb/DuckDBDataTemplate.hpp"
+#include "object_store/FileSystemObjectStore.hpp"
+#include "store/VectorStoreMetadataDataMapper.hpp"
+#include "store/duckdb/DuckDBVectorStoreOperator.hpp"
+#include "tools/SystemUtils.hpp"
+
+CMRC_DECLARE(instinct::assistant);
+
+namespace INSTINCT_ASSISTANT_NS::v2::bench {
+    using namespace INSTINCT_DATA_NS;
+
+    /**
+     * Loopback server answering every chat completion request immediately with a final answer, so that runs finish without calling any tool.
+     */
+    class MockChatCompletionServer {
+        httplib::Server server_;
+        std::thread server_thread_;
+        int port_ = 0;
+
+    public:
+        MockChatCompletionServer() {
+            server_.Post(DEFAULT_OPENAI_CHAT_COMPLETION_ENDPOINT, [](const httplib::Request&, httplib::Response& resp) {
+                resp.set_content(R"({"id":"chatcmpl-mock","object":"chat.completion","created":1718000000,"model":"gpt-3.5-turbo","choices":[{"index":0,"message":{"role":"assistant","content":"Double sovereign is a gold coin."},"finish_reason":"stop"}],"usage":{"prompt_tokens":10,"completion_tokens":8,"total_tokens":18}})", HTTP_CONTENT_TYPES.at(kJSON));
+            });
+            port_ = server_.bind_to_any_port("127.0.0.1");
+            server_thread_ = std::thread([&] { server_.listen_after_bind(); });
+            server_.wait_until_ready();
+        }
+
+        ~MockChatCompletionServer() {
+            server_.stop();
+            server_thread_.join();
+        }
+
+        [[nodiscard]] int GetPort() const {
+            return port_;
+        }
+    };
+
+    /**
+     * Services backed by a temporary database, and an assistant with file search over a VectorStore whose only file is marked as completed, so no ingestion is needed. They are created once and shared by all benchmark runs.
+     */
+    struct RunObjectFixture {
+        MockChatCompletionServer server;
+        DuckDBPtr duck_db;
+        DuckDBConnectionPoolPtr connection_pool;
+        RunServicePtr run_service;
+        MessageServicePtr message_service;
+        AssistantServicePtr assistant_service;
+        ThreadServicePtr thread_service;
+        FileServicePtr file_service;
+        RetrieverOperatorPtr retriever_operator;
+        VectorStoreServicePtr vector_store_service;
+        CitationAnnotatingChainPtr citation_annotating_chain;
+        LLMProviderOptions llm_provider_options;
+        std::string assistant_id;
+
+        static RunObjectFixture& GetInstance() {
+            static RunObjectFixture fixture;
+            return fixture;
+        }
+
+        std::shared_ptr<RunObjectTaskHandler> CreateTaskHandler(const InstanceCachePtr& instance_cache) const {
+            return std::make_shared<RunObjectTaskHandler>(
+                run_service,
+                message_service,
+                assistant_service,
+                retriever_operator,
+                vector_store_service,
+                thread_service,
+                citation_annotating_chain,
+                llm_provider_options,
+                AgentExecutorOptions {.agent_executor_name = "openai_tool"},
+                instance_cache
+            );
+        }
+
+        void Run(const std::shared_ptr<RunObjectTaskHandler>& handler) const {
+            CreateThreadAndRunRequest create_thread_and_run_request;
+            create_thread_and_run_request.set_assistant_id(assistant_id);
+            auto* msg = create_thread_and_run_request.mutable_thread()->add_messages();
+            msg->set_role(user);
+            msg->set_content("What makes coins of double sovereign special?");
+            const auto run_object = run_service->CreateThreadAndRun(create_thread_and_run_request);
+            handler->Handle({
+                .task_id = run_object->id(),
+                .category = RunObjectTaskHandler::CATEGORY,
+                .payload = ProtobufUtils::Serialize(run_object.value())
+            });
+            GetRunRequest get_run_request;
+            get_run_request.set_thread_id(run_object->thread_id());
+            get_run_request.set_run_id(run_object->id());
+            assert_true(run_service->RetrieveRun(get_run_request)->status() == RunObject_RunObjectStatus_completed, "should have run completed");
+        }
+
+    private:
+        RunObjectFixture():
+            duck_db(std::make_shared<DuckDB>(std::filesystem::temp_directory_path() / fmt::format("assistant_bench_{}.db", ChronoUtils::GetCurrentTimeMillis()))),
+            connection_pool(CreateDuckDBConnectionPool(duck_db)) {
+            const auto embedded_fs = cmrc::instinct::assistant::get_filesystem();
+            const auto sql_file = embedded_fs.open("db_migration/001/up.sql");
+            assert_query_ok(DBUtils::ExecuteSQL(std::string {sql_file.begin(), sql_file.end()}, connection_pool));
+
+            const auto thread_data_mapper = CreateDuckDBDataMapper<ThreadObject, std::string>(connection_pool);
+            const auto message_data_mapper = CreateDuckDBDataMapper<MessageObject, std::string>(connection_pool);
+            const auto run_data_mapper = CreateDuckDBDataMapper<RunObject, std::string>(connection_pool);
+            const auto run_step_data_mapper = CreateDuckDBDataMapper<RunStepObject, std::string>(connection_pool);
+            run_service = std::make_shared<RunServiceImpl>(thread_data_mapper, run_data_mapper, run_step_data_mapper, message_data_mapper, nullptr);
+            message_service = std::make_shared<MessageServiceImpl>(message_data_mapper);
+            assistant_service = std::make_shared<AssistantServiceImpl>(CreateDuckDBDataMapper<AssistantObject, std::string>(connection_pool));
+            thread_service = std::make_shared<ThreadServiceImpl>(thread_data_mapper, message_data_mapper, run_data_mapper, run_step_data_mapper);
+            file_service = std::make_shared<FileServiceImpl>(CreateDuckDBDataMapper<FileObject, std::string>(connection_pool), std::make_shared<FileSystemObjectStore>(std::filesystem::temp_directory_path() / "assistant_bench"));
+
+            // retrievers and toolkits are shared by all handlers, and instance caches are passed to handlers directly
+            const auto vector_store_operator = CreateDuckDBStoreOperator(
+                duck_db,
+                std::make_shared<HashedEmbeddings>(),
+                std::make_shared<VectorStoreMetadataDataMapper>(CreateDuckDBDataMapper<VectorStoreInstanceMetadata, std::string>(connection_pool)));
+            retriever_operator = CreateSimpleRetrieverOperator(vector_store_operator, duck_db, {.table_name = "bench_docs"});
+            vector_store_service = std::make_shared<VectorStoreServiceImpl>(
+                std::make_shared<VectorStoreFileDataMapper>(CreateDuckDBDataMapper<VectorStoreFileObject, std::string>(connection_pool)),
+                std::make_shared<VectorStoreDataMapper>(CreateDuckDBDataMapper<VectorStoreObject, std::string>(connection_pool)),
+                std::make_shared<VectorStoreFileBatchDataMapper>(CreateDuckDBDataMapper<VectorStoreFileBatchObject, std::string>(connection_pool)),
+                nullptr,
+                retriever_operator,
+                nullptr
+            );
+
+            llm_provider_options.provider = ModelProvider::kOPENAI;
+            llm_provider_options.endpoint = {.protocol = kHTTP, .host = "127.0.0.1", .port = server.GetPort()};
+            llm_provider_options.api_key = "mock-key";
+            citation_annotating_chain = CreateCitationAnnotatingChain(CreateOpenAIChatModel({.api_key = "mock-key", .endpoint = llm_provider_options.endpoint}));
+
+            CreateVectorStoreRequest create_vector_store_request;
+            create_vector_store_request.set_name("bench-vs");
+            const auto vector_store_object = vector_store_service->CreateVectorStore(create_vector_store_request);
+            UploadFileRequest upload_file_request;
+            upload_file_request.set_filename("Double sovereign.txt");
+            upload_file_request.set_purpose(FileObjectPurpose::assistants);
+            std::fstream fstream {std::filesystem::current_path() / "_assets" / "Double sovereign.txt", std::ios::binary | std::ios::in};
+            const auto file_object = file_service->UploadFile(upload_file_request, fstream);
+            fstream.close();
+            CreateVectorStoreFileRequest create_vector_store_file_request;
+            create_vector_store_file_request.set_file_id(file_object->id());
+            create_vector_store_file_request.set_vector_store_id(vector_store_object->id());
+            assert_true(vector_store_service->CreateVectorStoreFile(create_vector_store_file_request), "should have vector store file created");
+            ModifyVectorStoreFileRequest modify_vector_store_file_request;
+            modify_vector_store_file_request.set_file_id(file_object->id());
+            modify_vector_store_file_request.set_vector_store_id(vector_store_object->id());
+            modify_vector_store_file_request.set_status(completed);
+            modify_vector_store_file_request.set_summary("History of double sovereign coins.");
+            assert_true(vector_store_service->ModifyVectorStoreFile(modify_vector_store_file_request), "should have vector store file modified");
+
+            AssistantObject create_assistant_request;
+            create_assistant_request.add_tools()->set_type(file_search);
+            create_assistant_request.mutable_tool_resources()->mutable_file_search()->add_vector_store_ids(vector_store_object->id());
+            create_assistant_request.set_model("gpt-3.5-turbo");
+            assistant_id = assistant_service->CreateAssistant(create_assistant_request)->id();
+        }
+    };
+
+    /**
+     * Runs/sec of handling back-to-back runs of an assistant with file search. Without cache, every run rebuilds ranking model, toolkit and chat model. With cache, they are built by first run only. Args: cached (0 to disable instance cache, 1 to use default one).
+     */
+    static void BM_RunObjectTaskHandler_BackToBackRuns(benchmark::State& state) {
+        const auto& fixture = RunObjectFixture::GetInstance();
+        const auto instance_cache = state.range(0)
+            ? CreateInstanceCache()
+            : CreateInstanceCache({.max_ranking_models = 0, .max_tokenizers = 0, .max_retrievers = 0, .max_toolkits = 0, .max_idle_chat_models = 0});
+        const auto handler = fixture.CreateTaskHandler(instance_cache);
+        for (auto _: state) {
+            fixture.Run(handler);
+        }
+        const auto stats = instance_cache->GetStats();
+        state.SetItemsProcessed(state.iterations());
+        state.counters["toolkit_hits"] = static_cast<double>(stats.toolkits.hit_count);
+        state.counters["rss_mb"] = static_cast<double>(SystemUtils::GetResidentSetSize() / 1024 / 1024);
+    }
+
+    BENCHMARK(BM_RunObjectTaskHandler_BackToBackRuns)
+        ->ArgNames({"cached"})
+        ->Arg(0)
+        ->Arg(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
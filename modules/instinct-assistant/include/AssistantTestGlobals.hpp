@@ -104,13 +104,14 @@ namespace INSTINCT_ASSISTANT_NS {
             return std::make_shared<MessageServiceImpl>(message_data_mapper);
         }
 
-        VectorStoreServicePtr CreateVectorStoreService(const TaskSchedulerPtr<std::string>& task_scheduler = nullptr, const RetrieverOperatorPtr& retriever_operator = nullptr) {
+        VectorStoreServicePtr CreateVectorStoreService(const TaskSchedulerPtr<std::string>& task_scheduler = nullptr, const RetrieverOperatorPtr& retriever_operator = nullptr, const InstanceCachePtr& instance_cache = nullptr) {
             return std::make_shared<VectorStoreServiceImpl>(
                 vector_store_file_data_mapper,
                 vector_store_data_mapper,
                 vector_store_file_batch_data_mapper,
                 task_scheduler,
-                retriever_operator
+                retriever_operator,
+                instance_cache
                 );
         }
 
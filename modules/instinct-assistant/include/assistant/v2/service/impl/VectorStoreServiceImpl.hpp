@@ -21,6 +21,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
         VectorStoreFileBatchDataMapperPtr vector_store_file_batch_data_mapper_;
         CommonTaskSchedulerPtr task_scheduler_;
         RetrieverOperatorPtr retriever_operator_;
+        InstanceCachePtr instance_cache_;
 
     public:
         VectorStoreServiceImpl(
@@ -28,12 +29,14 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             VectorStoreDataMapperPtr vector_store_data_mapper,
             VectorStoreFileBatchDataMapperPtr vector_store_file_batch_data_mapper,
             CommonTaskSchedulerPtr task_scheduler,
-            RetrieverOperatorPtr retriever_operator)
+            RetrieverOperatorPtr retriever_operator,
+            InstanceCachePtr instance_cache = nullptr)
             : vector_store_file_data_mapper_(std::move(vector_store_file_data_mapper)),
               vector_store_data_mapper_(std::move(vector_store_data_mapper)),
               vector_store_file_batch_data_mapper_(std::move(vector_store_file_batch_data_mapper)),
               task_scheduler_(std::move(task_scheduler)),
-              retriever_operator_(std::move(retriever_operator)) {
+              retriever_operator_(std::move(retriever_operator)),
+              instance_cache_(std::move(instance_cache)) {
         }
 
         ListVectorStoresResponse ListVectorStores(const ListVectorStoresRequest &req) override {
@@ -92,6 +95,10 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
         std::optional<VectorStoreObject> ModifyVectorStore(const ModifyVectorStoreRequest &req) override {
             trace_span span {"ModifyVectorStore"};
             assert_true(vector_store_data_mapper_->UpdateVectorStore(req) == 1, "should have vector object updated");
+            InvalidateCachedInstances_(req.vector_store_id());
+            if (retriever_operator_) {
+                retriever_operator_->InvalidateRetriever(req.vector_store_id());
+            }
             GetVectorStoreRequest get_vector_store_request;
             get_vector_store_request.set_vector_store_id(req.vector_store_id());
             return GetVectorStore(get_vector_store_request);
@@ -113,6 +120,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
                 const auto deleted_count = vector_store_file_data_mapper_->DeleteVectorStoreFiles(req.vector_store_id());
                 LOG_DEBUG("Cascade delete {} files in VectorStore {}", deleted_count, req.vector_store_id());
                 assert_true(vector_store_data_mapper_->DeleteVectorStore(req) == 1, "should have VectorStore deleted");
+                InvalidateCachedInstances_(req.vector_store_id());
                 if (retriever_operator_) {
                     response.set_deleted(retriever_operator_->CleanupRetriever(vector_store_object->id()));
                 } else {
@@ -135,6 +143,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             assert_not_blank(req.file_id(), "should provide file_id");
             assert_not_blank(req.vector_store_id(), "should provide vector_store_id");
             assert_true(vector_store_file_data_mapper_->InsertVectorStoreFile(req), "should have vector store file created");
+            InvalidateCachedInstances_(req.vector_store_id());
             GetVectorStoreFileRequest get_request;
             get_request.set_vector_store_id(req.vector_store_id());
             get_request.set_file_id(req.file_id());
@@ -165,6 +174,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             response.set_id(req.file_id());
             response.set_object("vector_store.file.deleted");
             response.set_deleted(count == 1);
+            InvalidateCachedInstances_(req.vector_store_id());
             if (retriever_operator_) {
                 const auto vector_store_object = vector_store_data_mapper_->GetVectorStore(req.vector_store_id());
                 const auto retriever = retriever_operator_->GetStatefulRetriever(vector_store_object->id());
@@ -183,6 +193,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             assert_not_blank(req.vector_store_id(), "should provide vector_store_id");
             assert_true(vector_store_file_data_mapper_->GetVectorStoreFile(req.vector_store_id(), req.file_id()), "should have found VectorStoreFileObject before update");
             assert_true(vector_store_file_data_mapper_->UpdateVectorStoreFile(req) == 1, "should have VectorStoreFile updated");
+            InvalidateCachedInstances_(req.vector_store_id());
             return vector_store_file_data_mapper_->GetVectorStoreFile(req.vector_store_id(), req.file_id());
         }
 
@@ -195,6 +206,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             assert_true(pk, "should have VectorStoreFileBatch inserted");
             // create files
             vector_store_file_data_mapper_->InsertManyVectorStoreFiles(req.vector_store_id(), req.file_ids(), pk.value());
+            InvalidateCachedInstances_(req.vector_store_id());
             // trigger file object jobs
             if (task_scheduler_) {
                 for(const auto files = vector_store_file_data_mapper_->ListVectorStoreFiles(req.vector_store_id(), req.file_ids()); const auto& file: files) {
@@ -245,6 +257,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
 
             // update vector file objects
             assert_true(vector_store_file_data_mapper_->CancelVectorStoreFiles(req.vector_store_id(), req.batch_id()) > 0, "should have vector store files updated");
+            InvalidateCachedInstances_(req.vector_store_id());
 
             // return latest vector store file batch
             // return
@@ -285,6 +298,17 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             assert_gte(req.limit(), 1, "limit should be a positive number");
             return vector_store_file_batch_data_mapper_->ListPendingFileBatchObjects(req);
         }
+
+    private:
+        /**
+         * Evict cached retrievers and toolkits, as they may hold stale file list or indices of given VectorStore
+         * @param vector_store_id
+         */
+        void InvalidateCachedInstances_(const std::string& vector_store_id) const {
+            if (instance_cache_) {
+                instance_cache_->InvalidateVectorStore(vector_store_id);
+            }
+        }
     };
 }
 
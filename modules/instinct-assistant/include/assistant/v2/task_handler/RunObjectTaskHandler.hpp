@@ -13,6 +13,7 @@
 #include "task_scheduler/ThreadPoolTaskScheduler.hpp"
 #include "agent/patterns/openai_tool/OpenAIToolAgentExecutor.hpp"
 #include "assistant/v2/service/IVectorStoreService.hpp"
+#include "assistant/v2/tool/InstanceCache.hpp"
 #include "assistant/v2/toolkit/SummaryGuidedFileSearch.hpp"
 #include "chain/CitationAnnotatingChain.hpp"
 #include "toolkit/LocalToolkit.hpp"
@@ -46,6 +47,8 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
 
     /**
      * Task handler for run objects using `OpenAIToolAgentExecutor`.
+     *
+     * Ranking models, retrievers, toolkits and chat models are reused across runs through `InstanceCache`.
      */
     class RunObjectTaskHandler final: public CommonTaskScheduler::ITaskHandler {
         RunServicePtr run_service_;
@@ -57,6 +60,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
         VectorStoreServicePtr vector_store_service_;
         ThreadServicePtr thread_service_;
         CitationAnnotatingChainPtr citation_annotating_chain_;
+        InstanceCachePtr instance_cache_;
 
     public:
         static inline std::string CATEGORY = "run_object";
@@ -69,7 +73,8 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             ThreadServicePtr thread_service,
             CitationAnnotatingChainPtr citation_annotating_chain,
             LLMProviderOptions llm_provider_options,
-            AgentExecutorOptions agent_executor_options)
+            AgentExecutorOptions agent_executor_options,
+            InstanceCachePtr instance_cache = nullptr)
             : run_service_(std::move(run_service)),
               message_service_(std::move(message_service)),
               assistant_service_(std::move(assistant_service)),
@@ -78,7 +83,9 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
               retriever_operator_(std::move(retriever_operator)),
               vector_store_service_(std::move(vector_store_service)),
               thread_service_(std::move(thread_service)),
-              citation_annotating_chain_(std::move(citation_annotating_chain)) {
+              citation_annotating_chain_(std::move(citation_annotating_chain)),
+              // toolkits hold file lists of VectorStores, so they are not cached unless the cache is shared with VectorStoreService for invalidation
+              instance_cache_(instance_cache ? std::move(instance_cache) : CreateInstanceCache({.max_toolkits = 0})) {
         }
 
         bool Accept(const ITaskScheduler<std::string>::Task &task) override {
@@ -127,7 +134,9 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
                 return;
             }
 
-            const auto executor = BuildAgentExecutor_(run_object, assistant_obj.value(), local_toolkit);
+            // chat model is leased exclusively until this run is finished
+            const auto chat_model_lease = LeaseChatModel_(run_object, assistant_obj.value());
+            const auto executor = BuildAgentExecutor_(run_object, assistant_obj.value(), chat_model_lease->Get(), local_toolkit);
             if(!executor) {
                 LOG_ERROR("Failed to create agent executor with run object: {}", run_object.ShortDebugString());
                 return;
@@ -295,16 +304,13 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
         }
 
         /**
-         * Just return `OpenAIToolAgentExecutor`
+         * Borrow a chat model configured with model options from user objects. Chat models with identical provider and overrides are reused across runs.
          * @param run_object
          * @param assistant_obj
-         * @param local_toolkit
          * @return
          */
-        [[nodiscard]] AgentExecutorPtr BuildAgentExecutor_(const RunObject& run_object, const AssistantObject& assistant_obj, const FunctionToolkitPtr& local_toolkit) const {
-
+        [[nodiscard]] std::unique_ptr<InstanceCache::ChatModelLease> LeaseChatModel_(const RunObject& run_object, const AssistantObject& assistant_obj) const {
             // load model options from user objects
-            const auto chat_model = LLMObjectFactory::CreateChatModel(llm_provider_options_);
             ModelOverrides model_overrides;
             if (StringUtils::IsNotBlankString(run_object.model())) {
                 model_overrides.model_name = run_object.model();
@@ -322,7 +328,32 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
                 model_overrides.top_p = assistant_obj.top_p();
             }
             model_overrides.stop_words =  {"<END_OF_PLAN>", "<END_OF_RESPONSE>"};
-            chat_model->Configure(model_overrides);
+
+            const auto key = fmt::format(
+                "{}|{}:{}|{}|{}|{}",
+                static_cast<int>(llm_provider_options_.provider),
+                llm_provider_options_.endpoint.host,
+                llm_provider_options_.endpoint.port,
+                model_overrides.model_name.value_or(""),
+                model_overrides.temperature ? std::to_string(model_overrides.temperature.value()) : "",
+                model_overrides.top_p ? std::to_string(model_overrides.top_p.value()) : ""
+            );
+            return instance_cache_->LeaseChatModel(key, [&]() {
+                const auto chat_model = LLMObjectFactory::CreateChatModel(llm_provider_options_);
+                chat_model->Configure(model_overrides);
+                return chat_model;
+            });
+        }
+
+        /**
+         * Just return `OpenAIToolAgentExecutor`
+         * @param run_object
+         * @param assistant_obj
+         * @param chat_model
+         * @param local_toolkit
+         * @return
+         */
+        [[nodiscard]] AgentExecutorPtr BuildAgentExecutor_(const RunObject& run_object, const AssistantObject& assistant_obj, const ChatModelPtr& chat_model, const FunctionToolkitPtr& local_toolkit) const {
 
             // load instructions from user objects
             auto agent_options = agent_executor_options_;
@@ -353,7 +384,6 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
                 const AssistantObject& assistant_object,
                 const ThreadObject& thread_object
             ) const {
-            std::vector<FunctionToolPtr> tools;
             // if file_search is not enabled by assistant, let's exit
             if(details::has_file_search(assistant_object)) {
                 assert_true(assistant_object.tool_resources().file_search().vector_store_ids_size()>0, "should have at least one VectorStore");
@@ -365,18 +395,22 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
                 if (thread_object.tool_resources().has_file_search() && thread_object.tool_resources().file_search().vector_store_ids_size()>0) {
                     vs_id_list.push_back(thread_object.tool_resources().file_search().vector_store_ids(0));
                 }
-                // find files
-                const auto related_files = vector_store_service_->ListAllVectorStoreObjectFiles(vs_id_list);
-                const auto retriever = retriever_operator_->GetStatelessRetriever(vs_id_list);
-                const auto file_search_tool = CreateSummaryGuidedFileSearch(
-                    CreateLocalRankingModel(ModelType::BGE_M3_RERANKER),
-                    retriever,
-                    related_files
-                    );
-                tools.push_back(file_search_tool);
+                // toolkit is cached until files in these VectorStores are changed
+                return instance_cache_->GetToolkit(vs_id_list, [&]() {
+                    // find files
+                    const auto related_files = vector_store_service_->ListAllVectorStoreObjectFiles(vs_id_list);
+                    const auto retriever = retriever_operator_->GetStatelessRetriever(vs_id_list);
+                    const auto file_search_tool = CreateSummaryGuidedFileSearch(
+                        instance_cache_->GetRankingModel("bge-m3-reranker", [] {
+                            return CreateLocalRankingModel(ModelType::BGE_M3_RERANKER);
+                        }),
+                        retriever,
+                        related_files
+                        );
+                    return CreateLocalToolkit(std::vector {file_search_tool});
+                });
             }
-
-            return tools.empty() ? nullptr : CreateLocalToolkit(tools);
+            return nullptr;
         }
 
         /**
@@ -0,0 +1,256 @@
+#ifndef INSTINCT_INSTANCECACHE_HPP
+#define INSTINCT_INSTANCECACHE_HPP
+
+#include <set>
+
+#include "AssistantGlobals.hpp"
+#include "chat_model/BaseChatModel.hpp"
+#include "ranker/BaseRankingModel.hpp"
+#include "retrieval/BaseRetriever.hpp"
+#include "tokenizer/Tokenizer.hpp"
+#include "toolkit/BaseFunctionToolkit.hpp"
+#include "tools/LRUCache.hpp"
+
+namespace INSTINCT_ASSISTANT_NS::v2 {
+    using namespace INSTINCT_RETRIEVAL_NS;
+
+    struct InstanceCacheOptions {
+        /**
+         * Max count of ranking models, keyed by model type. A local ranking model may hold more than 1GB of memory, so it should be small.
+         */
+        size_t max_ranking_models = 2;
+
+        /**
+         * Max count of tokenizers, keyed by name
+         */
+        size_t max_tokenizers = 4;
+
+        /**
+         * Max count of retrievers, keyed by ids of VectorStore objects they search
+         */
+        size_t max_retrievers = 64;
+
+        /**
+         * Max count of built-in toolkits, keyed by ids of VectorStore objects they search
+         */
+        size_t max_toolkits = 64;
+
+        /**
+         * Max count of idle chat model clients. Chat models are stateful, so each of them is leased to a single run at a time.
+         */
+        size_t max_idle_chat_models = 16;
+    };
+
+    /**
+     * Cached object with ids of VectorStore objects it searches, so that it's invalidated only when one of them is modified
+     */
+    template<typename T>
+    struct VectorStoreBoundInstance {
+        std::set<std::string> vector_store_ids;
+        T instance;
+    };
+
+    struct InstanceCacheStats {
+        CacheStats ranking_models;
+        CacheStats tokenizers;
+        CacheStats retrievers;
+        CacheStats toolkits;
+        CacheStats chat_models;
+    };
+
+    /**
+     * Shared cache of expensive objects needed by runs, so that back-to-back runs don't have to rebuild models, retrievers and toolkits from scratch.
+     *
+     * 1. Ranking models and tokenizers are immutable and thread-safe, so they are shared by all runs.
+     * 2. Retrievers and toolkits are keyed by ids of VectorStore objects, and entries referencing a VectorStore are evicted by `InvalidateVectorStore` whenever it's modified.
+     * 3. Chat models are configured and bound with tools per run, so they are leased exclusively and returned to an idle list keyed by model configuration.
+     */
+    class InstanceCache final {
+        InstanceCacheOptions options_;
+        LRUCache<std::string, RankingModelPtr> ranking_models_;
+        LRUCache<std::string, TokenizerPtr> tokenizers_;
+        LRUCache<std::string, VectorStoreBoundInstance<RetrieverPtr>> retrievers_;
+        LRUCache<std::string, VectorStoreBoundInstance<FunctionToolkitPtr>> toolkits_;
+
+        // creation of each kind of objects is serialized, so that concurrent runs won't build same object twice
+        std::mutex ranking_models_mutex_;
+        std::mutex tokenizers_mutex_;
+        std::mutex retrievers_mutex_;
+        std::mutex toolkits_mutex_;
+
+        // bumped on each invalidation, so that objects built with stale data are not put into cache
+        std::atomic<uint64_t> generation_ = 0;
+
+        std::mutex chat_models_mutex_;
+        std::unordered_map<std::string, std::vector<ChatModelPtr>> idle_chat_models_;
+        size_t idle_chat_model_count_ = 0;
+        std::atomic<uint64_t> chat_model_hit_count_ = 0;
+        std::atomic<uint64_t> chat_model_miss_count_ = 0;
+
+    public:
+        /**
+         * RAII chat model borrowed from cache, which is returned to idle list on destruction
+         */
+        class ChatModelLease {
+            InstanceCache* cache_;
+            std::string key_;
+            ChatModelPtr chat_model_;
+        public:
+            ChatModelLease(InstanceCache* cache, std::string key, ChatModelPtr chat_model)
+                : cache_(cache), key_(std::move(key)), chat_model_(std::move(chat_model)) {
+            }
+
+            ~ChatModelLease() {
+                if (chat_model_) {
+                    cache_->ReleaseChatModel_(key_, std::move(chat_model_));
+                }
+            }
+
+            ChatModelLease(const ChatModelLease&)=delete;
+            ChatModelLease& operator=(const ChatModelLease&)=delete;
+
+            [[nodiscard]] const ChatModelPtr& Get() const {
+                return chat_model_;
+            }
+        };
+
+        explicit InstanceCache(const InstanceCacheOptions& options = {}):
+            options_(options),
+            ranking_models_(options.max_ranking_models),
+            tokenizers_(options.max_tokenizers),
+            retrievers_(options.max_retrievers),
+            toolkits_(options.max_toolkits) {
+        }
+
+        InstanceCache(const InstanceCache&)=delete;
+        InstanceCache& operator=(const InstanceCache&)=delete;
+
+        RankingModelPtr GetRankingModel(const std::string& key, const std::function<RankingModelPtr()>& factory) {
+            return GetOrCreate_(ranking_models_, ranking_models_mutex_, key, factory);
+        }
+
+        TokenizerPtr GetTokenizer(const std::string& key, const std::function<TokenizerPtr()>& factory) {
+            return GetOrCreate_(tokenizers_, tokenizers_mutex_, key, factory);
+        }
+
+        RetrieverPtr GetRetriever(const std::vector<std::string>& vector_store_ids, const std::function<RetrieverPtr()>& factory) {
+            return GetOrCreateForVectorStores_(retrievers_, retrievers_mutex_, vector_store_ids, factory);
+        }
+
+        FunctionToolkitPtr GetToolkit(const std::vector<std::string>& vector_store_ids, const std::function<FunctionToolkitPtr()>& factory) {
+            return GetOrCreateForVectorStores_(toolkits_, toolkits_mutex_, vector_store_ids, factory);
+        }
+
+        /**
+         * Borrow an idle chat model with given configuration key, or create a new one using `factory`.
+         * @param key identity of model configuration, including provider, endpoint and model overrides
+         * @param factory function to create and configure a chat model
+         * @return
+         */
+        std::unique_ptr<ChatModelLease> LeaseChatModel(const std::string& key, const std::function<ChatModelPtr()>& factory) {
+            {
+                std::lock_guard guard {chat_models_mutex_};
+                if (const auto itr = idle_chat_models_.find(key); itr != idle_chat_models_.end() && !itr->second.empty()) {
+                    auto chat_model = std::move(itr->second.back());
+                    itr->second.pop_back();
+                    --idle_chat_model_count_;
+                    ++chat_model_hit_count_;
+                    return std::make_unique<ChatModelLease>(this, key, std::move(chat_model));
+                }
+            }
+            ++chat_model_miss_count_;
+            return std::make_unique<ChatModelLease>(this, key, factory());
+        }
+
+        /**
+         * Evict retrievers and toolkits that search given VectorStore. This should be called whenever a VectorStore or its files are modified.
+         * @param vector_store_id
+         */
+        void InvalidateVectorStore(const std::string& vector_store_id) {
+            ++generation_;
+            const auto references = [&](const std::string&, const auto& entry) {
+                return entry.vector_store_ids.contains(vector_store_id);
+            };
+            const auto count = retrievers_.RemoveIf(references) + toolkits_.RemoveIf(references);
+            LOG_DEBUG("Invalidated {} cached instances for VectorStore {}", count, vector_store_id);
+        }
+
+        void Clear() {
+            ++generation_;
+            ranking_models_.Clear();
+            tokenizers_.Clear();
+            retrievers_.Clear();
+            toolkits_.Clear();
+            std::lock_guard guard {chat_models_mutex_};
+            idle_chat_models_.clear();
+            idle_chat_model_count_ = 0;
+        }
+
+        [[nodiscard]] InstanceCacheStats GetStats() const {
+            return {
+                .ranking_models = ranking_models_.GetStats(),
+                .tokenizers = tokenizers_.GetStats(),
+                .retrievers = retrievers_.GetStats(),
+                .toolkits = toolkits_.GetStats(),
+                .chat_models = {.hit_count = chat_model_hit_count_, .miss_count = chat_model_miss_count_}
+            };
+        }
+
+    private:
+        template<typename T>
+        std::shared_ptr<T> GetOrCreate_(LRUCache<std::string, std::shared_ptr<T>>& cache, std::mutex& mutex, const std::string& key, const std::function<std::shared_ptr<T>()>& factory) {
+            if (auto cached = cache.Get(key)) {
+                return cached.value();
+            }
+            std::lock_guard guard {mutex};
+            // check again as it may be created by another thread while waiting
+            if (auto cached = cache.Get(key)) {
+                return cached.value();
+            }
+            const auto generation = generation_.load();
+            auto instance = factory();
+            if (instance && generation == generation_.load()) {
+                cache.Put(key, instance);
+            }
+            return instance;
+        }
+
+        template<typename T>
+        std::shared_ptr<T> GetOrCreateForVectorStores_(LRUCache<std::string, VectorStoreBoundInstance<std::shared_ptr<T>>>& cache, std::mutex& mutex, const std::vector<std::string>& vector_store_ids, const std::function<std::shared_ptr<T>()>& factory) {
+            // ids are deduplicated and sorted, so that same set of VectorStore objects always has the same key
+            std::set<std::string> id_set {vector_store_ids.begin(), vector_store_ids.end()};
+            const auto key = StringUtils::JoinWith(id_set, ",");
+            if (auto cached = cache.Get(key)) {
+                return cached->instance;
+            }
+            std::lock_guard guard {mutex};
+            if (auto cached = cache.Get(key)) {
+                return cached->instance;
+            }
+            const auto generation = generation_.load();
+            auto instance = factory();
+            if (instance && generation == generation_.load()) {
+                cache.Put(key, {.vector_store_ids = std::move(id_set), .instance = instance});
+            }
+            return instance;
+        }
+
+        void ReleaseChatModel_(const std::string& key, ChatModelPtr chat_model) {
+            std::lock_guard guard {chat_models_mutex_};
+            if (idle_chat_model_count_ >= options_.max_idle_chat_models) {
+                return;
+            }
+            idle_chat_models_[key].push_back(std::move(chat_model));
+            ++idle_chat_model_count_;
+        }
+    };
+
+    using InstanceCachePtr = std::shared_ptr<InstanceCache>;
+
+    static InstanceCachePtr CreateInstanceCache(const InstanceCacheOptions& options = {}) {
+        return std::make_shared<InstanceCache>(options);
+    }
+
+}
+
+#endif //INSTINCT_INSTANCECACHE_HPP
@@ -8,6 +8,7 @@
 #include <document/RecursiveCharacterTextSplitter.hpp>
 
 #include "AssistantGlobals.hpp"
+#include "assistant/v2/tool/InstanceCache.hpp"
 #include "ranker/LocalRankingModel.hpp"
 #include "retrieval/BaseRetriever.hpp"
 #include "retrieval/ChunkedMultiVectorRetriever.hpp"
@@ -50,6 +51,12 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
          */
         virtual bool CleanupRetriever(const std::string& vector_store_object_id) = 0;
 
+        /**
+         * Drop cached retrievers and vector store instance of given VectorStoreObject, which should be called after it's altered
+         * @param vector_store_object_id
+         */
+        virtual void InvalidateRetriever(const std::string& vector_store_object_id) = 0;
+
         /**
          * Get readonly retriever for online search
          * @param vector_store_object_ids a list of VectorStoreObject that restricts the search space of returned retriever
@@ -74,20 +81,24 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
      *
      * 1. It uses shared doc store for all retrievers. This could be improved in the future when scalability is vital.
      * 2. It uses MultiPathRetriever with local ranker and CreateChunkedMultiVectorRetriever as its child retrievers.
+     * 3. Ranking model, tokenizer and stateless retrievers are shared through InstanceCache, and cached retrievers are evicted when VectorStore is cleaned up.
      *
      */
     class SimpleRetrieverOperator final: public IRetrieverOperator {
         VectorStoreOperatorPtr vector_store_operator_;
         DocStorePtr doc_store_;
         RetrieverOperatorOptions options_;
+        InstanceCachePtr instance_cache_;
     public:
         SimpleRetrieverOperator(
             VectorStoreOperatorPtr vector_store_operator,
             DocStorePtr doc_store,
-            const RetrieverOperatorOptions& options = {})
+            const RetrieverOperatorOptions& options = {},
+            InstanceCachePtr instance_cache = nullptr)
             : vector_store_operator_(std::move(vector_store_operator)),
               doc_store_(std::move(doc_store)),
-              options_(options) {
+              options_(options),
+              instance_cache_(instance_cache ? std::move(instance_cache) : CreateInstanceCache()) {
             // validate schema in doc store
             for(const auto& field_name: {METADATA_SCHEMA_PARENT_DOC_ID_KEY, VECTOR_STORE_ID_KEY}) {
                 assert_true(
@@ -113,6 +124,7 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
         }
 
         bool CleanupRetriever(const std::string& vector_store_object_id) override {
+            InvalidateRetriever(vector_store_object_id);
             SearchQuery search_query;
             search_query.mutable_term()->set_name(VECTOR_STORE_ID_KEY);
             search_query.mutable_term()->mutable_term()->set_string_value(vector_store_object_id);
@@ -125,23 +137,32 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
             return false;
         }
 
+        void InvalidateRetriever(const std::string& vector_store_object_id) override {
+            instance_cache_->InvalidateVectorStore(vector_store_object_id);
+            vector_store_operator_->InvalidateInstance(vector_store_object_id);
+        }
+
         RetrieverPtr GetStatelessRetriever(const std::vector<std::string>& vector_store_object_ids) override {
             assert_true(!vector_store_object_ids.empty());
-            const auto ranking_model = CreateLocalRankingModel(BGE_M3_RERANKER);
-            std::vector<RetrieverPtr> child_retrievers;
-            for(const auto& vector_store_object_id: vector_store_object_ids) {
-                const auto vector_store = vector_store_operator_->LoadInstance(vector_store_object_id);
-                const auto child_retriever = GetStatefulRetriever(vector_store_object_id);
-                child_retrievers.push_back(child_retriever);
-            }
-            return CreateMultiPathRetriever(ranking_model, child_retrievers);
+            return instance_cache_->GetRetriever(vector_store_object_ids, [&]() -> RetrieverPtr {
+                const auto ranking_model = instance_cache_->GetRankingModel("bge-m3-reranker", [] {
+                    return CreateLocalRankingModel(BGE_M3_RERANKER);
+                });
+                std::vector<RetrieverPtr> child_retrievers;
+                for(const auto& vector_store_object_id: vector_store_object_ids) {
+                    child_retrievers.push_back(GetStatefulRetriever(vector_store_object_id));
+                }
+                return CreateMultiPathRetriever(ranking_model, child_retrievers);
+            });
         }
 
         StatefulRetrieverPtr GetStatefulRetriever(const std::string& vector_store_object_id) override {
             assert_not_blank(vector_store_object_id, "should have non-blank vector_store_object_id");
             const auto vector_store = vector_store_operator_->LoadInstance(vector_store_object_id);
             assert_true(vector_store, fmt::format("should have found vector store by id {}", vector_store_object_id));
-            const auto tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer();
+            const auto tokenizer = instance_cache_->GetTokenizer("cl100k_base", [] {
+                return TiktokenTokenizer::MakeGPT4Tokenizer();
+            });
             const auto child_spliter = CreateRecursiveCharacterTextSplitter(tokenizer, {
                 .chunk_size = options_.child_chunk_size,
                 .chunk_overlap = options_.child_chunk_overlap
@@ -168,9 +189,10 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
     static RetrieverOperatorPtr CreateSimpleRetrieverOperator(
         const VectorStoreOperatorPtr& vector_store_operator,
         const DocStorePtr& doc_store,
-        const RetrieverOperatorOptions& options = {}
+        const RetrieverOperatorOptions& options = {},
+        const InstanceCachePtr& instance_cache = nullptr
         ) {
-        return std::make_shared<SimpleRetrieverOperator>(vector_store_operator, doc_store, options);
+        return std::make_shared<SimpleRetrieverOperator>(vector_store_operator, doc_store, options, instance_cache);
     }
 
     /**
@@ -191,16 +213,18 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
      * @param duck_db
      * @param options
      * @param operator_options
+     * @param instance_cache cache shared with other components. A private one is created if it's null.
      * @return
      */
     static RetrieverOperatorPtr CreateSimpleRetrieverOperator(
         const VectorStoreOperatorPtr& vector_store_operator,
         const DuckDBPtr& duck_db,
         const DuckDBStoreOptions& options = {},
-        const RetrieverOperatorOptions& operator_options = {}
+        const RetrieverOperatorOptions& operator_options = {},
+        const InstanceCachePtr& instance_cache = nullptr
         ) {
         const auto doc_store = CreateDuckDBDocStore(duck_db, options, CreatePresetMetadataSchemaForRetrieverOperator());
-        return std::make_shared<SimpleRetrieverOperator>(vector_store_operator, doc_store, operator_options);
+        return std::make_shared<SimpleRetrieverOperator>(vector_store_operator, doc_store, operator_options, instance_cache);
     }
 
 
@@ -60,12 +60,13 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
         SearchToolResponse DoExecute(const SearchToolRequest &input) override {
             // file-id to score
             std::vector<PSF> file_scores;
+            std::vector<std::string> summaries;
             for(const auto& file: vector_store_file_objects_) {
-                auto score = ranking_model_->Invoke({
-                    .query = input.query(),
-                    .doc = file.summary()
-                });
-                file_scores.emplace_back(file.file_id(), score);
+                summaries.push_back(file.summary());
+            }
+            const auto scores = ranking_model_->GetRankingScores(input.query(), summaries);
+            for(size_t i=0; i<vector_store_file_objects_.size(); ++i) {
+                file_scores.emplace_back(vector_store_file_objects_[i].file_id(), scores[i]);
             }
 
             // sort by score and select top N file_id
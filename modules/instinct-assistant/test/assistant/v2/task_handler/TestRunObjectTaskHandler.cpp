@@ -3,6 +3,7 @@
 //
 #include <gtest/gtest.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <httplib.h>
 
 #include "AssistantTestGlobals.hpp"
 #include "LLMTestGlobals.hpp"
@@ -498,4 +499,108 @@ namespace INSTINCT_ASSISTANT_NS::v2 {
 
     }
 
+    TEST_F(TestRunObjectTaskHandler, ReuseCachedInstancesAcrossRuns) {
+        static constexpr int RUN_COUNT = 3;
+
+        // mock LLM server answering every chat completion request immediately
+        httplib::Server server;
+        std::atomic<int> completion_count = 0;
+        server.Post(DEFAULT_OPENAI_CHAT_COMPLETION_ENDPOINT, [&](const httplib::Request&, httplib::Response& resp) {
+            ++completion_count;
+            resp.set_content(R"({"id":"chatcmpl-mock","object":"chat.completion","created":1718000000,"model":"gpt-3.5-turbo","choices":[{"index":0,"message":{"role":"assistant","content":"Double sovereign is a gold coin."},"finish_reason":"stop"}],"usage":{"prompt_tokens":10,"completion_tokens":8,"total_tokens":18}})", HTTP_CONTENT_TYPES.at(kJSON));
+        });
+        const auto port = server.bind_to_any_port("127.0.0.1");
+        std::thread server_thread {[&] { server.listen_after_bind(); }};
+        server.wait_until_ready();
+
+        // services sharing one instance cache
+        const auto instance_cache = CreateInstanceCache();
+        const auto retriever_operator = CreateSimpleRetrieverOperator(vector_store_operator_, duck_db_, {.table_name = "bench_docs_" + ChronoUtils::GetCurrentTimestampString()}, {}, instance_cache);
+        const auto vector_store_service = CreateVectorStoreService(nullptr, retriever_operator, instance_cache);
+
+        // vs with a file that is marked as completed, so no ingestion is needed
+        CreateVectorStoreRequest create_vector_store_request;
+        create_vector_store_request.set_name("bench-vs");
+        const auto vector_store_object = vector_store_service->CreateVectorStore(create_vector_store_request);
+        UploadFileRequest upload_file_request;
+        upload_file_request.set_filename("Double sovereign.txt");
+        upload_file_request.set_purpose(FileObjectPurpose::assistants);
+        std::fstream fstream {asset_dir_ / "Double sovereign.txt", std::ios::binary | std::ios::in};
+        const auto file_object = file_service_->UploadFile(upload_file_request, fstream);
+        fstream.close();
+        CreateVectorStoreFileRequest create_vector_store_file_request;
+        create_vector_store_file_request.set_file_id(file_object->id());
+        create_vector_store_file_request.set_vector_store_id(vector_store_object->id());
+        ASSERT_TRUE(vector_store_service->CreateVectorStoreFile(create_vector_store_file_request));
+        ModifyVectorStoreFileRequest modify_vector_store_file_request;
+        modify_vector_store_file_request.set_file_id(file_object->id());
+        modify_vector_store_file_request.set_vector_store_id(vector_store_object->id());
+        modify_vector_store_file_request.set_status(completed);
+        modify_vector_store_file_request.set_summary("History of double sovereign coins.");
+        ASSERT_TRUE(vector_store_service->ModifyVectorStoreFile(modify_vector_store_file_request));
+
+        AssistantObject create_assistant_request;
+        create_assistant_request.add_tools()->set_type(file_search);
+        create_assistant_request.mutable_tool_resources()->mutable_file_search()->add_vector_store_ids(vector_store_object->id());
+        create_assistant_request.set_model("gpt-3.5-turbo");
+        const auto assistant_object = assistant_service_->CreateAssistant(create_assistant_request);
+
+        LLMProviderOptions llm_provider_options;
+        llm_provider_options.provider = ModelProvider::kOPENAI;
+        llm_provider_options.endpoint = {.protocol = kHTTP, .host = "127.0.0.1", .port = port};
+        llm_provider_options.api_key = "mock-key";
+        const auto create_handler = [&](const InstanceCachePtr& cache) {
+            return std::make_shared<RunObjectTaskHandler>(
+                run_service_,
+                message_service_,
+                assistant_service_,
+                retriever_operator,
+                vector_store_service,
+                thread_service_,
+                citation_annotating_chain,
+                llm_provider_options,
+                AgentExecutorOptions {.agent_executor_name = "openai_tool"},
+                cache
+            );
+        };
+
+        const auto run = [&](const std::shared_ptr<RunObjectTaskHandler>& handler, const int n) {
+            for (int i = 0; i < n; ++i) {
+                CreateThreadAndRunRequest create_thread_and_run_request;
+                create_thread_and_run_request.set_assistant_id(assistant_object->id());
+                auto* msg = create_thread_and_run_request.mutable_thread()->add_messages();
+                msg->set_role(user);
+                msg->set_content("What makes coins of double sovereign special?");
+                const auto run_object = run_service_->CreateThreadAndRun(create_thread_and_run_request);
+                handler->Handle({
+                    .task_id = run_object->id(),
+                    .category = RunObjectTaskHandler::CATEGORY,
+                    .payload = ProtobufUtils::Serialize(run_object.value())
+                });
+                GetRunRequest get_run_request;
+                get_run_request.set_thread_id(run_object->thread_id());
+                get_run_request.set_run_id(run_object->id());
+                ASSERT_EQ(run_service_->RetrieveRun(get_run_request)->status(), RunObject_RunObjectStatus_completed);
+            }
+        };
+
+        // models and toolkits are built by first run only
+        run(create_handler(instance_cache), RUN_COUNT);
+        auto stats = instance_cache->GetStats();
+        ASSERT_EQ(stats.toolkits.hit_count, RUN_COUNT - 1);
+        ASSERT_EQ(stats.chat_models.hit_count, RUN_COUNT - 1);
+        ASSERT_EQ(stats.chat_models.miss_count, 1);
+
+        // toolkit is rebuilt after files in VectorStore are modified
+        modify_vector_store_file_request.set_summary("Gold coins issued in the United Kingdom.");
+        ASSERT_TRUE(vector_store_service->ModifyVectorStoreFile(modify_vector_store_file_request));
+        run(create_handler(instance_cache), 1);
+        stats = instance_cache->GetStats();
+        ASSERT_EQ(stats.toolkits.hit_count, RUN_COUNT - 1);
+        ASSERT_EQ(completion_count, RUN_COUNT + 1);
+
+        server.stop();
+        server_thread.join();
+    }
+
 }
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "assistant/v2/tool/InstanceCache.hpp"
+#include "toolkit/LocalToolkit.hpp"
+
+namespace INSTINCT_ASSISTANT_NS::v2 {
+
+    TEST(InstanceCacheTest, KeyedBySetOfVectorStoreIds) {
+        const auto cache = CreateInstanceCache();
+        int created = 0;
+        const auto factory = [&] {
+            ++created;
+            return CreateLocalToolkit();
+        };
+        const auto toolkit = cache->GetToolkit({"vs-2", "vs-1"}, factory);
+        ASSERT_EQ(cache->GetToolkit({"vs-1", "vs-2"}, factory), toolkit);
+        ASSERT_EQ(cache->GetToolkit({"vs-2", "vs-1", "vs-2"}, factory), toolkit);
+        ASSERT_EQ(created, 1);
+        ASSERT_NE(cache->GetToolkit({"vs-1"}, factory), toolkit);
+        ASSERT_EQ(created, 2);
+    }
+
+    TEST(InstanceCacheTest, InvalidateByExactVectorStoreId) {
+        const auto cache = CreateInstanceCache();
+        int created = 0;
+        const auto factory = [&] {
+            ++created;
+            return CreateLocalToolkit();
+        };
+        // ids that are substrings of each other, or contain separator of cache keys
+        cache->GetToolkit({"vs-1"}, factory);
+        cache->GetToolkit({"vs-10"}, factory);
+        cache->GetToolkit({"vs-1,vs-2"}, factory);
+        cache->GetToolkit({"vs-1", "vs-3"}, factory);
+        ASSERT_EQ(created, 4);
+
+        cache->InvalidateVectorStore("vs-2");
+        cache->GetToolkit({"vs-1"}, factory);
+        cache->GetToolkit({"vs-10"}, factory);
+        cache->GetToolkit({"vs-1,vs-2"}, factory);
+        cache->GetToolkit({"vs-1", "vs-3"}, factory);
+        ASSERT_EQ(created, 4);
+
+        cache->InvalidateVectorStore("vs-1");
+        cache->GetToolkit({"vs-10"}, factory);
+        cache->GetToolkit({"vs-1,vs-2"}, factory);
+        ASSERT_EQ(created, 4);
+        cache->GetToolkit({"vs-1"}, factory);
+        cache->GetToolkit({"vs-1", "vs-3"}, factory);
+        ASSERT_EQ(created, 6);
+    }
+
+}
@@ -0,0 +1,171 @@
+#include <benchmark/benchmark.h>
+#include <httplib.h>
+
+#include "tools/Assertions.hpp"
+#include "tools/http/CURLHttpClient.hpp"
+#include "tools/http/CURLMultiHttpClient.hpp"
+
+namespace INSTINCT_CORE_NS::bench {
+
+    static constexpr int HTTP_BENCH_STREAM_LINES = 20;
+    static constexpr int HTTP_BENCH_REQUEST_PER_THREAD = 250;
+
+    enum HttpClientBenchMode {
+        // `curl_easy_init` per request without any connection shared
+        kFreshHandles,
+        // easy handles and connections are reused
+        kPooledHandles,
+        // transfers are multiplexed in event loop of `CURLMultiHttpClient`
+        kMultiHandle
+    };
+
+    /**
+     * Loopback server with a `/ping` endpoint and a `/stream` endpoint of SSE lines. Connections are kept alive during whole benchmark.
+     */
+    class LoopbackHttpServer {
+        httplib::Server server_;
+        std::thread server_thread_;
+        int port_ = 0;
+
+    public:
+        LoopbackHttpServer() {
+            server_.set_keep_alive_max_count(1000000);
+            server_.new_task_queue = [] { return new httplib::ThreadPool(64); };
+            server_.Get("/ping", [](const httplib::Request&, httplib::Response& resp) {
+                resp.set_content("pong", HTTP_CONTENT_TYPES.at(kPlainText));
+            });
+            server_.Get("/stream", [](const httplib::Request&, httplib::Response& resp) {
+                resp.set_chunked_content_provider(HTTP_CONTENT_TYPES.at(kEventStream), [](const size_t offset, httplib::DataSink& sink) {
+                    for (int i = 0; i < HTTP_BENCH_STREAM_LINES; ++i) {
+                        const auto line = fmt::format("data: {}\n\n", i);
+                        sink.write(line.data(), line.size());
+                    }
+                    sink.done();
+                    return true;
+                });
+            });
+            port_ = server_.bind_to_any_port("127.0.0.1");
+            server_thread_ = std::thread([&] { server_.listen_after_bind(); });
+            server_.wait_until_ready();
+        }
+
+        ~LoopbackHttpServer() {
+            server_.stop();
+            server_thread_.join();
+        }
+
+        [[nodiscard]] HttpRequest CreateRequest(const std::string& path) const {
+            return HttpUtils::CreateRequest(fmt::format("GET http://127.0.0.1:{}{}", port_, path));
+        }
+    };
+
+    static LoopbackHttpServer& get_loopback_http_server() {
+        static LoopbackHttpServer server;
+        return server;
+    }
+
+    /**
+     * Requests/sec of blocking `Execute` calls issued sequentially by each of `threads` threads. Counter `connections_per_request` tells how many connections are established for a request. Args: mode (0 for fresh handles, 1 for pooled handles, 2 for multi handle), threads.
+     */
+    static void BM_HttpClient_Execute(benchmark::State& state) {
+        const auto mode = static_cast<HttpClientBenchMode>(state.range(0));
+        const auto thread_count = static_cast<int>(state.range(1));
+        const auto request = get_loopback_http_server().CreateRequest("/ping");
+        std::function<HttpClientStats()> get_stats;
+        HttpClientPtr client;
+        if (mode == kMultiHandle) {
+            const auto multi_client = std::make_shared<CURLMultiHttpClient>(CURLMultiHttpClientOptions {.max_host_connections = 16});
+            get_stats = [multi_client] { return multi_client->GetStats(); };
+            client = multi_client;
+        } else {
+            const auto easy_client = mode == kFreshHandles
+                ? std::make_shared<CURLHttpClient>(CURLHandlePoolOptions {.max_idle_handles_per_host = 0, .share_connections = false})
+                : std::make_shared<CURLHttpClient>();
+            get_stats = [easy_client] { return easy_client->GetStats(); };
+            client = easy_client;
+        }
+
+        for (auto _: state) {
+            std::vector<std::thread> threads;
+            std::atomic<int> ok = 0;
+            for (int i = 0; i < thread_count; ++i) {
+                threads.emplace_back([&] {
+                    for (int j = 0; j < HTTP_BENCH_REQUEST_PER_THREAD; ++j) {
+                        ok += client->Execute(request).status_code == 200;
+                    }
+                });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+            assert_true(ok == thread_count * HTTP_BENCH_REQUEST_PER_THREAD, "should have all requests succeeded");
+        }
+        const auto stats = get_stats();
+        state.SetItemsProcessed(state.iterations() * thread_count * HTTP_BENCH_REQUEST_PER_THREAD);
+        state.counters["connections_per_request"] = static_cast<double>(stats.connection_count) / static_cast<double>(std::max<uint64_t>(1, stats.request_count));
+    }
+
+    BENCHMARK(BM_HttpClient_Execute)
+        ->ArgNames({"mode", "threads"})
+        ->ArgsProduct({{kFreshHandles, kPooledHandles, kMultiHandle}, {1, 4, 16}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Requests/sec of submitting `batch_size` requests at once with `ExecuteBatch` of `CURLMultiHttpClient`, which doesn't occupy a thread per request. Args: batch_size.
+     */
+    static void BM_CURLMultiHttpClient_ExecuteBatch(benchmark::State& state) {
+        const auto batch_size = static_cast<size_t>(state.range(0));
+        CURLMultiHttpClient client {{.max_host_connections = 16}};
+        ThreadPool unused_pool {1};
+        const std::vector calls(batch_size, get_loopback_http_server().CreateRequest("/ping"));
+        for (auto _: state) {
+            for (auto& f: client.ExecuteBatch(calls, unused_pool)) {
+                assert_true(f.get().status_code == 200, "should have request succeeded");
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch_size));
+        state.counters["connections"] = static_cast<double>(client.GetStats().connection_count);
+    }
+
+    BENCHMARK(BM_CURLMultiHttpClient_ExecuteBatch)
+        ->ArgNames({"batch_size"})
+        ->Arg(100)
+        ->Arg(1000)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Streams/sec of `streams` concurrent SSE streams multiplexed in the event loop of `CURLMultiHttpClient`, each of which is consumed by its own subscriber thread. Args: streams.
+     */
+    static void BM_CURLMultiHttpClient_StreamChunk(benchmark::State& state) {
+        const auto stream_count = static_cast<int>(state.range(0));
+        const auto client = std::make_shared<CURLMultiHttpClient>(CURLMultiHttpClientOptions {.max_host_connections = 16, .max_buffered_chunks = 4});
+        const auto request = get_loopback_http_server().CreateRequest("/stream");
+        for (auto _: state) {
+            std::vector<std::thread> threads;
+            std::atomic<int> lines = 0;
+            for (int i = 0; i < stream_count; ++i) {
+                threads.emplace_back([&] {
+                    client->StreamChunk(request, {.line_breaker = "\n\n"})
+                        .subscribe([&](const auto& chunk) {
+                            lines += chunk.starts_with("data: ");
+                        });
+                });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+            assert_true(lines == stream_count * HTTP_BENCH_STREAM_LINES, "should have all lines received");
+        }
+        state.SetItemsProcessed(state.iterations() * stream_count);
+    }
+
+    BENCHMARK(BM_CURLMultiHttpClient_StreamChunk)
+        ->ArgNames({"streams"})
+        ->Arg(8)
+        ->Arg(32)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
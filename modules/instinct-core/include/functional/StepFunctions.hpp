@@ -52,6 +52,21 @@ namespace INSTINCT_CORE_NS {
             }
             return continuous_input;
         }
+
+        /**
+         * Each step consumes chunks emitted by its predecessor, so that chunks of a streaming step (e.g. a chat model) flow through following steps one by one. Non-streaming steps emit exactly one output for each input.
+         * @param input
+         * @return
+         */
+        AsyncIterator<JSONContextPtr> Stream(const JSONContextPtr &input) override {
+            AsyncIterator<JSONContextPtr> stream = rpp::source::just(input);
+            for (const auto &step: steps_) {
+                stream = stream | rpp::operators::flat_map([step](const JSONContextPtr &ctx) {
+                    return step->Stream(ctx);
+                });
+            }
+            return stream;
+        }
 //
 //        [[nodiscard]] std::vector<std::string> GetInputKeys() const override {
 //            return steps_.front()->GetInputKeys();
@@ -0,0 +1,140 @@
+#ifndef INSTINCT_LRUCACHE_HPP
+#define INSTINCT_LRUCACHE_HPP
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include "CoreGlobals.hpp"
+
+namespace INSTINCT_CORE_NS {
+
+    struct CacheStats {
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+    };
+
+    /**
+     * Thread-safe LRU cache with bounded count of entries. Least recently used entry is evicted when capacity is reached. A cache with zero capacity stores nothing.
+     * @tparam Key
+     * @tparam Value should be copyable, as values are copied out of cache on lookup
+     * @tparam Hash
+     */
+    template<typename Key, typename Value, typename Hash = std::hash<Key>>
+    class LRUCache final {
+        using Entry = std::pair<Key, Value>;
+        size_t capacity_;
+        // most recently used entry is at front
+        std::list<Entry> entries_;
+        std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+        mutable std::mutex mutex_;
+        std::atomic<uint64_t> hit_count_ = 0;
+        std::atomic<uint64_t> miss_count_ = 0;
+
+    public:
+        explicit LRUCache(const size_t capacity): capacity_(capacity) {
+            index_.reserve(capacity);
+        }
+
+        LRUCache(const LRUCache&)=delete;
+        LRUCache& operator=(const LRUCache&)=delete;
+
+        std::optional<Value> Get(const Key& key) {
+            if (capacity_ == 0) {
+                return std::nullopt;
+            }
+            std::lock_guard guard {mutex_};
+            const auto itr = index_.find(key);
+            if (itr == index_.end()) {
+                ++miss_count_;
+                return std::nullopt;
+            }
+            ++hit_count_;
+            entries_.splice(entries_.begin(), entries_, itr->second);
+            return itr->second->second;
+        }
+
+        /**
+         * Insert or replace entry of given key
+         * @return value that is replaced or evicted by this call, so that caller can release it outside of its own locks
+         */
+        std::optional<Value> Put(const Key& key, Value value) {
+            if (capacity_ == 0) {
+                return std::nullopt;
+            }
+            std::lock_guard guard {mutex_};
+            std::optional<Value> displaced;
+            if (const auto itr = index_.find(key); itr != index_.end()) {
+                displaced = std::exchange(itr->second->second, std::move(value));
+                entries_.splice(entries_.begin(), entries_, itr->second);
+                return displaced;
+            }
+            if (entries_.size() >= capacity_) {
+                displaced = std::move(entries_.back().second);
+                index_.erase(entries_.back().first);
+                entries_.pop_back();
+            }
+            entries_.emplace_front(key, std::move(value));
+            index_.emplace(key, entries_.begin());
+            return displaced;
+        }
+
+        bool Remove(const Key& key) {
+            std::lock_guard guard {mutex_};
+            const auto itr = index_.find(key);
+            if (itr == index_.end()) {
+                return false;
+            }
+            entries_.erase(itr->second);
+            index_.erase(itr);
+            return true;
+        }
+
+        /**
+         * Remove all entries satisfying given predicate
+         * @tparam Predicate callable with signature of `bool(const Key&, const Value&)`
+         * @param predicate
+         * @return count of removed entries
+         */
+        template<typename Predicate>
+        size_t RemoveIf(Predicate&& predicate) {
+            std::lock_guard guard {mutex_};
+            size_t count = 0;
+            for (auto itr = entries_.begin(); itr != entries_.end();) {
+                if (predicate(itr->first, itr->second)) {
+                    index_.erase(itr->first);
+                    itr = entries_.erase(itr);
+                    ++count;
+                } else {
+                    ++itr;
+                }
+            }
+            return count;
+        }
+
+        void Clear() {
+            std::lock_guard guard {mutex_};
+            entries_.clear();
+            index_.clear();
+        }
+
+        [[nodiscard]] size_t Size() const {
+            std::lock_guard guard {mutex_};
+            return entries_.size();
+        }
+
+        [[nodiscard]] size_t GetCapacity() const {
+            return capacity_;
+        }
+
+        [[nodiscard]] CacheStats GetStats() const {
+            return {.hit_count = hit_count_, .miss_count = miss_count_};
+        }
+    };
+
+}
+
+#endif //INSTINCT_LRUCACHE_HPP
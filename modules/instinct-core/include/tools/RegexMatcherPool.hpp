@@ -0,0 +1,90 @@
+#ifndef INSTINCT_REGEXMATCHERPOOL_HPP
+#define INSTINCT_REGEXMATCHERPOOL_HPP
+
+#include <mutex>
+#include <unicode/regex.h>
+
+#include "CoreGlobals.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_CORE_NS {
+    using namespace U_ICU_NAMESPACE;
+
+    /**
+     * A regex pattern compiled only once, with a pool of `RegexMatcher` created from it. A `RegexMatcher` is stateful and cannot be shared across threads, so each concurrent caller leases its own matcher, and it's returned to the pool for later reuse.
+     */
+    class RegexMatcherPool final {
+        std::unique_ptr<RegexPattern> pattern_;
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<RegexMatcher>> idle_matchers_;
+
+    public:
+        /**
+         * RAII matcher borrowed from pool. Matcher may still hold input of previous user, so it should always be `reset` with new input before use.
+         */
+        class Lease {
+            RegexMatcherPool* pool_;
+            std::unique_ptr<RegexMatcher> matcher_;
+        public:
+            explicit Lease(RegexMatcherPool* pool): pool_(pool), matcher_(pool->Acquire_()) {}
+
+            ~Lease() {
+                pool_->Release_(std::move(matcher_));
+            }
+
+            Lease(const Lease&)=delete;
+            Lease& operator=(const Lease&)=delete;
+
+            RegexMatcher& operator*() const {
+                return *matcher_;
+            }
+
+            RegexMatcher* operator->() const {
+                return matcher_.get();
+            }
+        };
+
+        explicit RegexMatcherPool(const UnicodeString& regex_string, const uint32_t flags = 0) {
+            UErrorCode status = U_ZERO_ERROR;
+            pattern_.reset(RegexPattern::compile(regex_string, flags, status));
+            assert_icu_status(status, "Failed to compile regex with pattern string: " + regex_string);
+        }
+
+        RegexMatcherPool(const RegexMatcherPool&)=delete;
+        RegexMatcherPool& operator=(const RegexMatcherPool&)=delete;
+
+        Lease Acquire() {
+            return Lease {this};
+        }
+
+        [[nodiscard]] UnicodeString GetPatternString() const {
+            return pattern_->pattern();
+        }
+
+    private:
+        std::unique_ptr<RegexMatcher> Acquire_() {
+            {
+                std::lock_guard guard {mutex_};
+                if (!idle_matchers_.empty()) {
+                    auto matcher = std::move(idle_matchers_.back());
+                    idle_matchers_.pop_back();
+                    return matcher;
+                }
+            }
+            UErrorCode status = U_ZERO_ERROR;
+            std::unique_ptr<RegexMatcher> matcher {pattern_->matcher(status)};
+            assert_icu_status(status, std::string {"Failed to create RegexMatcher"});
+            return matcher;
+        }
+
+        void Release_(std::unique_ptr<RegexMatcher> matcher) {
+            std::lock_guard guard {mutex_};
+            idle_matchers_.push_back(std::move(matcher));
+        }
+    };
+
+    using RegexMatcherPoolPtr = std::shared_ptr<RegexMatcherPool>;
+
+}
+
+#endif //INSTINCT_REGEXMATCHERPOOL_HPP
@@ -5,6 +5,11 @@
 #ifndef SYSTEMUTILS_HPP
 #define SYSTEMUTILS_HPP
 
+#include <fstream>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 #include "CoreGlobals.hpp"
 
 namespace INSTINCT_CORE_NS {
@@ -50,6 +55,21 @@ namespace INSTINCT_CORE_NS {
             return GetEnv("HOME");
 #endif
         }
+
+        /**
+         * Get resident set size of current process
+         * @return size in bytes, or zero if it's not supported on current platform
+         */
+        static size_t GetResidentSetSize() {
+#ifdef __linux__
+            std::ifstream statm {"/proc/self/statm"};
+            size_t total_pages = 0, resident_pages = 0;
+            if (statm >> total_pages >> resident_pages) {
+                return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            }
+#endif
+            return 0;
+        }
     };
 }
 
@@ -0,0 +1,191 @@
+#ifndef INSTINCT_CURLHANDLEPOOL_HPP
+#define INSTINCT_CURLHANDLEPOOL_HPP
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <ranges>
+#include <curl/curl.h>
+
+#include "CoreGlobals.hpp"
+#include "IHttpClient.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_CORE_NS {
+
+    namespace details {
+        static void initialize_curl() {
+            // function-local static initialization is thread-safe
+            static const bool CURL_INITIALIZED = [] {
+                return curl_global_init(CURL_GLOBAL_ALL) == CURLE_OK;
+            }();
+            assert_true(CURL_INITIALIZED, "failed to initialize libcurl");
+        }
+    }
+
+    struct CURLHandlePoolOptions {
+        /**
+         * Max count of idle easy handles kept for each host. Handles returned beyond this limit are cleaned up.
+         */
+        size_t max_idle_handles_per_host = 16;
+
+        /**
+         * Share DNS cache among handles
+         */
+        bool share_dns = true;
+
+        /**
+         * Share connection cache among handles. Should be disabled if handles are driven by a multi handle, which has its own connection cache.
+         */
+        bool share_connections = true;
+
+        /**
+         * Share TLS session cache among handles
+         */
+        bool share_ssl_sessions = true;
+    };
+
+    /**
+     * Counters of finished transfers
+     */
+    struct HttpClientStats {
+        uint64_t request_count = 0;
+        /**
+         * count of new connections established, including those for redirects
+         */
+        uint64_t connection_count = 0;
+    };
+
+    /**
+     * Pool of CURL easy handles grouped by host. Reusing a handle keeps its live connections, and all handles are attached to a `CURLSH` so that DNS cache, connections and TLS sessions are shared across hosts and threads.
+     */
+    class CURLHandlePool final {
+        CURLHandlePoolOptions options_;
+        CURLSH* share_ = nullptr;
+        // one lock for each kind of shared data
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::vector<CURL*>> idle_handles_;
+        std::atomic<uint64_t> request_count_ = 0;
+        std::atomic<uint64_t> connection_count_ = 0;
+
+    public:
+        /**
+         * RAII handle borrowed from pool
+         */
+        class Lease {
+            CURLHandlePool* pool_;
+            std::string key_;
+            CURL* handle_;
+        public:
+            Lease(CURLHandlePool* pool, const Endpoint& endpoint): pool_(pool), key_(GetKey(endpoint)), handle_(pool->Acquire(key_)) {}
+
+            ~Lease() {
+                pool_->Release(key_, handle_);
+            }
+
+            Lease(const Lease&)=delete;
+            Lease& operator=(const Lease&)=delete;
+
+            [[nodiscard]] CURL* Get() const {
+                return handle_;
+            }
+        };
+
+        explicit CURLHandlePool(const CURLHandlePoolOptions& options = {}): options_(options) {
+            details::initialize_curl();
+            share_ = curl_share_init();
+            assert_true(share_, "failed to create CURLSH");
+            curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, LockShare_);
+            curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, UnlockShare_);
+            curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+            if (options_.share_dns) {
+                curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            }
+            if (options_.share_connections) {
+                curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+            }
+            if (options_.share_ssl_sessions) {
+                curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            }
+        }
+
+        ~CURLHandlePool() {
+            // easy handles should be cleaned before the share object they are attached to
+            for (const auto& handles: idle_handles_ | std::views::values) {
+                for (const auto& handle: handles) {
+                    curl_easy_cleanup(handle);
+                }
+            }
+            curl_share_cleanup(share_);
+        }
+
+        CURLHandlePool(const CURLHandlePool&)=delete;
+        CURLHandlePool& operator=(const CURLHandlePool&)=delete;
+
+        static std::string GetKey(const Endpoint& endpoint) {
+            return fmt::format("{}://{}:{}", endpoint.protocol, endpoint.host, endpoint.port);
+        }
+
+        /**
+         * Get an idle handle for given host, or create a new one. Returned handle has default options except `CURLOPT_SHARE`.
+         * @param key
+         * @return
+         */
+        CURL* Acquire(const std::string& key) {
+            {
+                std::lock_guard guard {mutex_};
+                if (const auto itr = idle_handles_.find(key); itr != idle_handles_.end() && !itr->second.empty()) {
+                    CURL* handle = itr->second.back();
+                    itr->second.pop_back();
+                    return handle;
+                }
+            }
+            CURL* handle = curl_easy_init();
+            assert_true(handle, "failed to create CURL easy handle");
+            curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+            return handle;
+        }
+
+        /**
+         * Return handle to pool. Statistics of last transfer are collected before options are reset.
+         * @param key
+         * @param handle
+         */
+        void Release(const std::string& key, CURL* handle) {
+            long connects = 0;
+            if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK) {
+                connection_count_ += connects;
+            }
+            ++request_count_;
+
+            // `curl_easy_reset` keeps live connections and caches
+            curl_easy_reset(handle);
+            curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+            {
+                std::lock_guard guard {mutex_};
+                if (auto& handles = idle_handles_[key]; handles.size() < options_.max_idle_handles_per_host) {
+                    handles.push_back(handle);
+                    return;
+                }
+            }
+            curl_easy_cleanup(handle);
+        }
+
+        [[nodiscard]] HttpClientStats GetStats() const {
+            return {.request_count = request_count_, .connection_count = connection_count_};
+        }
+
+    private:
+        static void LockShare_(CURL*, const curl_lock_data data, curl_lock_access, void* user_data) {
+            static_cast<CURLHandlePool*>(user_data)->share_locks_.at(data).lock();
+        }
+
+        static void UnlockShare_(CURL*, const curl_lock_data data, void* user_data) {
+            static_cast<CURLHandlePool*>(user_data)->share_locks_.at(data).unlock();
+        }
+    };
+
+}
+
+#endif //INSTINCT_CURLHANDLEPOOL_HPP
@@ -15,6 +15,7 @@
 #include "IHttpClient.hpp"
 #include "HttpUtils.hpp"
 #include "HttpClientException.hpp"
+#include "CURLHandlePool.hpp"
 #include "tools/SystemUtils.hpp"
 
 namespace INSTINCT_CORE_NS {
@@ -26,14 +27,6 @@ namespace INSTINCT_CORE_NS {
             std::thread::hardware_concurrency())
         );
 
-        static void initialize_curl() {
-            static bool CURL_INITIALIZED = false;
-            if(!CURL_INITIALIZED) {
-                curl_global_init(CURL_GLOBAL_ALL);
-                CURL_INITIALIZED = true;
-            }
-        }
-
         static size_t curl_write_callback(char *ptr, size_t size, size_t nmemb,
                                           HttpResponse *http_response) {
             http_response->body += {ptr, size*nmemb};
@@ -72,12 +65,23 @@ namespace INSTINCT_CORE_NS {
             curl_easy_setopt(hnd, CURLOPT_SSL_VERIFYPEER, 0L);
         }
 
+        static void read_curl_response_headers(CURL *hnd, HttpHeaders& headers) {
+            struct curl_header *h;
+            struct curl_header *prev = nullptr;
+            do {
+                h = curl_easy_nextheader(hnd, CURLH_HEADER, -1, prev);
+                if(h) {
+                    headers[h->name] = h->value;
+                }
+                prev = h;
+            } while(h);
+        }
+
         static CURLcode make_curl_request(
+            CURL *hnd,
             const HttpRequest &request,
             HttpResponse& response
         ) {
-            initialize_curl();
-            CURL *hnd = curl_easy_init();
             curl_slist *header_slist = nullptr;
 
             configure_curl_request(request, hnd, &header_slist);
@@ -90,22 +94,10 @@ namespace INSTINCT_CORE_NS {
             if(ret==0) {
                 // get response code
                 curl_easy_getinfo(hnd, CURLINFO_RESPONSE_CODE, &response.status_code);
-                { // dump headers to response
-                    struct curl_header *h;
-                    struct curl_header *prev = nullptr;
-                    do {
-                        h = curl_easy_nextheader(hnd, CURLH_HEADER, -1, prev);
-                        if(h) {
-//                            printf(" %s: %s (%u)\n", h->name, h->value, (int)h->amount);
-                            response.headers[h->name] = h->value;
-                        }
-
-                        prev = h;
-                    } while(h);
-                }
+                // dump headers to response
+                read_curl_response_headers(hnd, response.headers);
             }
 
-            curl_easy_cleanup(hnd);
             curl_slist_free_all(header_slist);
             return ret;
         }
@@ -121,6 +113,10 @@ namespace INSTINCT_CORE_NS {
         template<typename OB>
         requires rpp::constraint::observer_of_type<OB, std::string>
         static size_t curl_write_callback_with_observer(char *ptr, size_t size, size_t nmemb, StreamBuffer<OB> *buf) {
+            if (buf->ob.is_disposed()) {
+                // subscriber is gone, so abort the transfer by returning a different size
+                return 0;
+            }
             const std::string original_chunk = {ptr, size * nmemb};
             buf->data += original_chunk;
             while(true) {
@@ -136,10 +132,8 @@ namespace INSTINCT_CORE_NS {
 
         template<typename OB>
         requires rpp::constraint::observer_of_type<OB, std::string>
-        static CURLcode observe_curl_request(const HttpRequest &request, OB&& observer, const StreamChunkOptions& options) {
-            initialize_curl();
+        static CURLcode observe_curl_request(CURL *hnd, const HttpRequest &request, OB&& observer, const StreamChunkOptions& options) {
             curl_slist *header_slist = nullptr;
-            CURL *hnd = curl_easy_init();
 
             configure_curl_request(request, hnd, &header_slist);
             using OB_TYPE = std::decay_t<OB>;
@@ -161,7 +155,6 @@ namespace INSTINCT_CORE_NS {
                     observer.on_completed();
                 }
             }
-            curl_easy_cleanup(hnd);
             curl_slist_free_all(header_slist);
             return ret;
         }
@@ -174,9 +167,7 @@ namespace INSTINCT_CORE_NS {
         }
 
 
-        static CURLcode make_curl_request_with_callback(const HttpRequest& request, HttpStreamResponse& response, const HttpResponseCallback& callback) {
-            initialize_curl();
-            CURL *hnd = curl_easy_init();
+        static CURLcode make_curl_request_with_callback(CURL *hnd, const HttpRequest& request, HttpStreamResponse& response, const HttpResponseCallback& callback) {
             curl_slist *header_slist = nullptr;
 
             configure_curl_request(request, hnd, &header_slist);
@@ -189,22 +180,10 @@ namespace INSTINCT_CORE_NS {
             if(ret==0) {
                 // get response code
                 curl_easy_getinfo(hnd, CURLINFO_RESPONSE_CODE, &response.status_code);
-                { // dump headers to response
-                    struct curl_header *h;
-                    struct curl_header *prev = nullptr;
-                    do {
-                        h = curl_easy_nextheader(hnd, CURLH_HEADER, -1, prev);
-                        if(h) {
-                            //                            printf(" %s: %s (%u)\n", h->name, h->value, (int)h->amount);
-                            response.headers[h->name] = h->value;
-                        }
-
-                        prev = h;
-                    } while(h);
-                }
+                // dump headers to response
+                read_curl_response_headers(hnd, response.headers);
             }
 
-            curl_easy_cleanup(hnd);
             curl_slist_free_all(header_slist);
             return ret;
         }
@@ -213,17 +192,25 @@ namespace INSTINCT_CORE_NS {
 
 
 
+    /**
+     * Blocking HTTP client. Easy handles are pooled by host, so that connections, DNS results and TLS sessions are reused across requests.
+     */
     class CURLHttpClient final: public IHttpClient {
+        std::shared_ptr<CURLHandlePool> handle_pool_;
 
     public:
+        explicit CURLHttpClient(const CURLHandlePoolOptions& options = {}): handle_pool_(std::make_shared<CURLHandlePool>(options)) {}
 
-
+        [[nodiscard]] HttpClientStats GetStats() const {
+            return handle_pool_->GetStats();
+        }
 
         HttpResponse Execute(const HttpRequest &call) override {
             HttpResponse http_response;
             auto url = HttpUtils::CreateUrlString(call);
             LOG_DEBUG("REQ: {} {}", call.method, url);
-            if (const auto code = details::make_curl_request(call, http_response); code != 0) {
+            const CURLHandlePool::Lease handle {handle_pool_.get(), call.endpoint};
+            if (const auto code = details::make_curl_request(handle.Get(), call, http_response); code != 0) {
                 throw HttpClientException(0, "curl request failed with return code " + std::string(curl_easy_strerror(code)));
             }
 
@@ -243,10 +230,11 @@ namespace INSTINCT_CORE_NS {
             // TODO maybe stop copying `call` by using smart pointer
             auto url = HttpUtils::CreateUrlString(call);
             LOG_DEBUG("REQ: {} {}", call.method, url);
-            return rpp::source::create<std::string>([&, call, options](auto&& observer) {
+            return rpp::source::create<std::string>([&, call, options, handle_pool = handle_pool_](auto&& observer) {
                 using OB_TYPE = decltype(observer);
-                auto code = details::observe_curl_request<OB_TYPE>(call, std::forward<OB_TYPE>(observer), options);
-                if (code!=0) {
+                const CURLHandlePool::Lease handle {handle_pool.get(), call.endpoint};
+                auto code = details::observe_curl_request<OB_TYPE>(handle.Get(), call, std::forward<OB_TYPE>(observer), options);
+                if (code!=0 && !observer.is_disposed()) {
                     observer.on_error(std::make_exception_ptr(InstinctException("curl request failed with reason: " + std::string(curl_easy_strerror(code)))));
                 }
             }) | rpp::ops::tap({}, {}, [&,call]() {
@@ -270,7 +258,8 @@ namespace INSTINCT_CORE_NS {
                 0
             };
             auto url = HttpUtils::CreateUrlString(call);
-            if (const auto code = details::make_curl_request_with_callback(call, http_stream_response, callback); code != 0) {
+            const CURLHandlePool::Lease handle {handle_pool_.get(), call.endpoint};
+            if (const auto code = details::make_curl_request_with_callback(handle.Get(), call, http_stream_response, callback); code != 0) {
                 throw HttpClientException(-1, "curl request failed with return code " + std::string(curl_easy_strerror(code)));
             }
             LOG_DEBUG("RESP: {} {}, status_code={}", call.method, url, http_stream_response.status_code);
@@ -278,8 +267,8 @@ namespace INSTINCT_CORE_NS {
         }
     };
 
-    static HttpClientPtr CreateCURLHttpClient() {
-        return std::make_shared<CURLHttpClient>();
+    static HttpClientPtr CreateCURLHttpClient(const CURLHandlePoolOptions& options = {}) {
+        return std::make_shared<CURLHttpClient>(options);
     }
 }
 
@@ -0,0 +1,452 @@
+#ifndef INSTINCT_CURLMULTIHTTPCLIENT_HPP
+#define INSTINCT_CURLMULTIHTTPCLIENT_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <ranges>
+#include <thread>
+#include <curl/curl.h>
+
+#include "CURLHttpClient.hpp"
+
+namespace INSTINCT_CORE_NS {
+
+    struct CURLMultiHttpClientOptions {
+        /**
+         * Max count of connections to a single host. Zero means unlimited, and transfers beyond this limit are queued by libcurl.
+         */
+        long max_host_connections = 0;
+
+        /**
+         * Max count of connections in total. Zero means unlimited.
+         */
+        long max_total_connections = 0;
+
+        /**
+         * Size of connection cache. Zero means libcurl's default.
+         */
+        long max_cached_connections = 0;
+
+        /**
+         * Max count of unconsumed chunks buffered for a streaming response. Transfer is paused when its consumer falls behind.
+         */
+        size_t max_buffered_chunks = 64;
+
+        /**
+         * Options for easy handles. Connection cache is owned by the multi handle, so `share_connections` is ignored.
+         */
+        CURLHandlePoolOptions handle_pool = {};
+    };
+
+    namespace details {
+        /**
+         * Chunks of a streaming response, produced by the event loop and consumed by the subscriber thread.
+         */
+        class CURLStreamChannel final {
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            std::deque<std::string> chunks_;
+            size_t capacity_;
+            bool done_ = false;
+            std::exception_ptr error_;
+            std::atomic<bool> cancelled_ = false;
+
+        public:
+            HttpStreamResponse response;
+
+            explicit CURLStreamChannel(const size_t capacity): capacity_(capacity) {}
+
+            /**
+             * Called in event loop
+             * @return false if buffer is full
+             */
+            bool TryPush(std::string chunk) {
+                {
+                    std::lock_guard guard {mutex_};
+                    if (chunks_.size() >= capacity_) return false;
+                    chunks_.push_back(std::move(chunk));
+                }
+                cv_.notify_one();
+                return true;
+            }
+
+            [[nodiscard]] bool HasRoom() {
+                std::lock_guard guard {mutex_};
+                return chunks_.size() < capacity_;
+            }
+
+            /**
+             * Called in event loop when transfer is finished
+             */
+            void Finish(std::exception_ptr error = nullptr) {
+                {
+                    std::lock_guard guard {mutex_};
+                    done_ = true;
+                    error_ = std::move(error);
+                }
+                cv_.notify_one();
+            }
+
+            /**
+             * Wait for next chunk.
+             * @return false if transfer is finished and all chunks are consumed
+             */
+            bool Pop(std::string& chunk) {
+                std::unique_lock lock {mutex_};
+                cv_.wait(lock, [&] { return !chunks_.empty() || done_; });
+                if (chunks_.empty()) return false;
+                chunk = std::move(chunks_.front());
+                chunks_.pop_front();
+                return true;
+            }
+
+            void RethrowIfFailed() {
+                std::lock_guard guard {mutex_};
+                if (error_) std::rethrow_exception(error_);
+            }
+
+            void Cancel() {
+                cancelled_ = true;
+            }
+
+            [[nodiscard]] bool IsCancelled() const {
+                return cancelled_;
+            }
+        };
+    }
+
+    /**
+     * HTTP client driven by a single event loop thread using `curl_multi` interface. All transfers, including SSE streams, are multiplexed in that thread, so that hundreds of concurrent requests won't occupy as many threads. Connections are cached by the multi handle and reused across requests.
+     *
+     * Callers of `Execute`, `ExecuteWithCallback` and subscribers of `StreamChunk` still block until their own transfers complete, and callbacks and observers are run in caller threads rather than the event loop.
+     */
+    class CURLMultiHttpClient final: public IHttpClient {
+        struct Transfer_ {
+            HttpRequest request;
+            CURL* handle = nullptr;
+            std::string handle_key;
+            curl_slist* header_slist = nullptr;
+            HttpResponse response;
+            // set for buffered transfers
+            std::promise<HttpResponse> promise;
+            // set for streaming transfers
+            std::shared_ptr<details::CURLStreamChannel> channel;
+            bool paused = false;
+        };
+        using TransferPtr = std::shared_ptr<Transfer_>;
+
+        /**
+         * State shared between the client and its pending streams. Observables returned by `StreamChunk` hold this rather than the client, so that subscribing after the client is destroyed fails with an exception instead of touching a dangling pointer.
+         */
+        struct SubmissionQueue_ {
+            CURLM* multi;
+            size_t max_buffered_chunks;
+            std::mutex mutex;
+            std::vector<TransferPtr> incoming;
+            bool stopping = false;
+
+            SubmissionQueue_(CURLM* multi, const size_t max_buffered_chunks): multi(multi), max_buffered_chunks(max_buffered_chunks) {}
+
+            SubmissionQueue_(const SubmissionQueue_&) = delete;
+
+            ~SubmissionQueue_() {
+                curl_multi_cleanup(multi);
+            }
+
+            void Enqueue(const TransferPtr& transfer) {
+                {
+                    std::lock_guard guard {mutex};
+                    if (stopping) throw HttpClientException(0, "http client is shutting down");
+                    incoming.push_back(transfer);
+                }
+                // multi handle is alive as long as this queue is
+                curl_multi_wakeup(multi);
+            }
+
+            std::shared_ptr<details::CURLStreamChannel> SubmitStream(const HttpRequest& call) {
+                auto transfer = std::make_shared<Transfer_>();
+                transfer->request = call;
+                transfer->channel = std::make_shared<details::CURLStreamChannel>(max_buffered_chunks);
+                auto channel = transfer->channel;
+                Enqueue(transfer);
+                return channel;
+            }
+        };
+
+        CURLMultiHttpClientOptions options_;
+        CURLHandlePool handle_pool_;
+        CURLM* multi_;
+        std::shared_ptr<SubmissionQueue_> queue_;
+        // only accessed in event loop
+        std::unordered_map<CURL*, TransferPtr> active_;
+        std::thread event_loop_;
+
+    public:
+        explicit CURLMultiHttpClient(const CURLMultiHttpClientOptions& options = {}):
+            options_(options),
+            handle_pool_({
+                .max_idle_handles_per_host = options.handle_pool.max_idle_handles_per_host,
+                .share_dns = options.handle_pool.share_dns,
+                .share_connections = false,
+                .share_ssl_sessions = options.handle_pool.share_ssl_sessions
+            }),
+            multi_(curl_multi_init()) {
+            assert_true(multi_, "failed to create CURLM");
+            queue_ = std::make_shared<SubmissionQueue_>(multi_, options_.max_buffered_chunks);
+            if (options_.max_host_connections > 0) {
+                curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, options_.max_host_connections);
+            }
+            if (options_.max_total_connections > 0) {
+                curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, options_.max_total_connections);
+            }
+            if (options_.max_cached_connections > 0) {
+                curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, options_.max_cached_connections);
+            }
+            event_loop_ = std::thread([this] { RunEventLoop_(); });
+        }
+
+        ~CURLMultiHttpClient() override {
+            {
+                std::lock_guard guard {queue_->mutex};
+                queue_->stopping = true;
+            }
+            curl_multi_wakeup(multi_);
+            event_loop_.join();
+        }
+
+        [[nodiscard]] HttpClientStats GetStats() const {
+            return handle_pool_.GetStats();
+        }
+
+        HttpResponse Execute(const HttpRequest &call) override {
+            const auto url = HttpUtils::CreateUrlString(call);
+            LOG_DEBUG("REQ: {} {}", call.method, url);
+            auto http_response = Submit_(call).get();
+            LOG_DEBUG("RESP: {} {}, status_code={}, body_length={}", call.method, url, http_response.status_code, http_response.body.size());
+            return http_response;
+        }
+
+        /**
+         * All requests are submitted to event loop at once, and given thread pool is not used.
+         * @param calls
+         * @param pool
+         * @return
+         */
+        Futures<HttpResponse> ExecuteBatch(const std::vector<HttpRequest> &calls, ThreadPool &pool) override {
+            Futures<HttpResponse> futures;
+            futures.reserve(calls.size());
+            for (const auto& call: calls) {
+                futures.push_back(Submit_(call));
+            }
+            return futures;
+        }
+
+        HttpStreamResponse ExecuteWithCallback(const HttpRequest &call, const HttpResponseCallback &callback) override {
+            const auto url = HttpUtils::CreateUrlString(call);
+            const auto channel = queue_->SubmitStream(call);
+            std::string chunk;
+            while (channel->Pop(chunk)) {
+                if (!channel->IsCancelled() && !callback(chunk)) {
+                    // drain remaining chunks until event loop aborts the transfer
+                    channel->Cancel();
+                }
+            }
+            channel->RethrowIfFailed();
+            LOG_DEBUG("RESP: {} {}, status_code={}", call.method, url, channel->response.status_code);
+            return channel->response;
+        }
+
+        AsyncIterator<std::string> StreamChunk(const HttpRequest &call, const StreamChunkOptions &options) override {
+            assert_true(!options.line_breaker.empty(), "should assign line-breaker");
+            HttpUtils::AssertHttpRequest(call);
+            LOG_DEBUG("REQ: {} {}", call.method, HttpUtils::CreateUrlString(call));
+            return rpp::source::create<std::string>([queue = queue_, call, options](auto&& observer) {
+                std::shared_ptr<details::CURLStreamChannel> channel;
+                try {
+                    channel = queue->SubmitStream(call);
+                } catch (...) {
+                    observer.on_error(std::current_exception());
+                    return;
+                }
+                std::string chunk, data;
+                while (channel->Pop(chunk)) {
+                    if (channel->IsCancelled()) continue;
+                    if (observer.is_disposed()) {
+                        channel->Cancel();
+                        continue;
+                    }
+                    data += chunk;
+                    size_t start = 0;
+                    for (auto idx = data.find(options.line_breaker); idx != std::string::npos; idx = data.find(options.line_breaker, start)) {
+                        observer.on_next(data.substr(start, idx - start));
+                        start = idx + options.line_breaker.size();
+                    }
+                    data.erase(0, start);
+                }
+                if (channel->IsCancelled()) return;
+                try {
+                    channel->RethrowIfFailed();
+                } catch (...) {
+                    observer.on_error(std::current_exception());
+                    return;
+                }
+                // emit remaining data in case the server returns malformed response
+                if (StringUtils::IsNotBlankString(data)) {
+                    observer.on_next(data);
+                }
+                if (channel->response.status_code >= 400) {
+                    observer.on_error(std::make_exception_ptr(HttpClientException(channel->response.status_code, "Failed to get chunked response")));
+                } else {
+                    observer.on_completed();
+                }
+            });
+        }
+
+    private:
+        std::future<HttpResponse> Submit_(const HttpRequest& call) {
+            auto transfer = std::make_shared<Transfer_>();
+            transfer->request = call;
+            auto future = transfer->promise.get_future();
+            queue_->Enqueue(transfer);
+            return future;
+        }
+
+        static size_t WriteCallback_(char *ptr, size_t size, size_t nmemb, Transfer_ *transfer) {
+            size *= nmemb;
+            if (!transfer->channel) {
+                transfer->response.body.append(ptr, size);
+                return size;
+            }
+            if (transfer->channel->IsCancelled()) {
+                // returning a different size aborts the transfer
+                return 0;
+            }
+            if (!transfer->channel->TryPush({ptr, size})) {
+                // same data will be delivered again after transfer is resumed
+                transfer->paused = true;
+                return CURL_WRITEFUNC_PAUSE;
+            }
+            return size;
+        }
+
+        void Start_(const TransferPtr& transfer) {
+            try {
+                transfer->handle_key = CURLHandlePool::GetKey(transfer->request.endpoint);
+                transfer->handle = handle_pool_.Acquire(transfer->handle_key);
+            } catch (...) {
+                Fail_(transfer, std::current_exception());
+                return;
+            }
+            details::configure_curl_request(transfer->request, transfer->handle, &transfer->header_slist);
+            curl_easy_setopt(transfer->handle, CURLOPT_WRITEFUNCTION, WriteCallback_);
+            curl_easy_setopt(transfer->handle, CURLOPT_WRITEDATA, transfer.get());
+            curl_multi_add_handle(multi_, transfer->handle);
+            active_.emplace(transfer->handle, transfer);
+        }
+
+        void Complete_(const TransferPtr& transfer, const CURLcode code) {
+            curl_multi_remove_handle(multi_, transfer->handle);
+            long response_code = 0;
+            HttpHeaders headers;
+            if (code == CURLE_OK) {
+                curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &response_code);
+                details::read_curl_response_headers(transfer->handle, headers);
+            }
+            // handle is returned before waking up caller, so that statistics are up to date
+            curl_slist_free_all(transfer->header_slist);
+            handle_pool_.Release(transfer->handle_key, transfer->handle);
+
+            const auto status_code = static_cast<unsigned int>(response_code);
+            if (code == CURLE_OK) {
+                if (transfer->channel) {
+                    transfer->channel->response = {.headers = std::move(headers), .status_code = status_code};
+                    transfer->channel->Finish();
+                } else {
+                    transfer->response.status_code = status_code;
+                    transfer->response.headers = std::move(headers);
+                    transfer->promise.set_value(std::move(transfer->response));
+                }
+            } else if (transfer->channel && transfer->channel->IsCancelled()) {
+                // aborted by consumer
+                transfer->channel->Finish();
+            } else {
+                Fail_(transfer, std::make_exception_ptr(HttpClientException(0, "curl request failed with return code " + std::string(curl_easy_strerror(code)))));
+            }
+        }
+
+        static void Fail_(const TransferPtr& transfer, const std::exception_ptr& error) {
+            if (transfer->channel) {
+                transfer->channel->Finish(error);
+            } else {
+                transfer->promise.set_exception(error);
+            }
+        }
+
+        void RunEventLoop_() {
+            std::vector<TransferPtr> incoming;
+            while (true) {
+                {
+                    std::lock_guard guard {queue_->mutex};
+                    if (queue_->stopping) break;
+                    incoming.swap(queue_->incoming);
+                }
+                for (const auto& transfer: incoming) {
+                    Start_(transfer);
+                }
+                incoming.clear();
+
+                int running = 0;
+                if (const auto code = curl_multi_perform(multi_, &running); code != CURLM_OK) {
+                    LOG_ERROR("curl_multi_perform failed: {}", curl_multi_strerror(code));
+                }
+
+                int queued = 0;
+                while (const CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+                    if (msg->msg != CURLMSG_DONE) continue;
+                    const auto itr = active_.find(msg->easy_handle);
+                    if (itr == active_.end()) continue;
+                    const auto transfer = itr->second;
+                    active_.erase(itr);
+                    Complete_(transfer, msg->data.result);
+                }
+
+                // resume paused transfers whose consumers have caught up
+                bool has_paused = false;
+                for (const auto& [handle, transfer]: active_) {
+                    if (!transfer->paused) continue;
+                    if (transfer->channel->HasRoom() || transfer->channel->IsCancelled()) {
+                        transfer->paused = false;
+                        // this may call write callback, and pause the transfer again
+                        curl_easy_pause(handle, CURLPAUSE_CONT);
+                    }
+                    has_paused |= transfer->paused;
+                }
+
+                // poll more frequently if any consumer is lagging behind
+                curl_multi_poll(multi_, nullptr, 0, has_paused ? 10 : 1000, nullptr);
+            }
+
+            // abort all remaining transfers
+            const auto error = std::make_exception_ptr(HttpClientException(0, "http client is shutting down"));
+            for (const auto& transfer: active_ | std::views::values) {
+                curl_multi_remove_handle(multi_, transfer->handle);
+                curl_slist_free_all(transfer->header_slist);
+                handle_pool_.Release(transfer->handle_key, transfer->handle);
+                Fail_(transfer, error);
+            }
+            active_.clear();
+            std::lock_guard guard {queue_->mutex};
+            for (const auto& transfer: queue_->incoming) {
+                Fail_(transfer, error);
+            }
+            queue_->incoming.clear();
+        }
+    };
+
+    static HttpClientPtr CreateCURLMultiHttpClient(const CURLMultiHttpClientOptions& options = {}) {
+        return std::make_shared<CURLMultiHttpClient>(options);
+    }
+}
+
+#endif //INSTINCT_CURLMULTIHTTPCLIENT_HPP
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "tools/LRUCache.hpp"
+
+namespace INSTINCT_CORE_NS {
+
+    TEST(TestLRUCache, EvictLeastRecentlyUsed) {
+        LRUCache<std::string, std::vector<int>> cache {2};
+        ASSERT_FALSE(cache.Put("a", {1}));
+        ASSERT_FALSE(cache.Put("b", {2}));
+        // touch `a` so that `b` becomes least recently used
+        ASSERT_EQ(cache.Get("a"), std::vector {1});
+        // evicted value is handed back to caller
+        ASSERT_EQ(cache.Put("c", {3}), std::vector {2});
+        ASSERT_EQ(cache.Size(), 2);
+        ASSERT_FALSE(cache.Get("b"));
+        ASSERT_EQ(cache.Get("c"), std::vector {3});
+
+        // overwrite existing key
+        ASSERT_EQ(cache.Put("a", {4}), std::vector {1});
+        ASSERT_EQ(cache.Get("a"), std::vector {4});
+        ASSERT_EQ(cache.Size(), 2);
+
+        ASSERT_TRUE(cache.Remove("a"));
+        ASSERT_FALSE(cache.Remove("a"));
+        ASSERT_EQ(cache.Size(), 1);
+
+        const auto stats = cache.GetStats();
+        ASSERT_EQ(stats.hit_count, 3);
+        ASSERT_EQ(stats.miss_count, 1);
+    }
+
+    TEST(TestLRUCache, ZeroCapacity) {
+        LRUCache<int, int> cache {0};
+        cache.Put(1, 1);
+        ASSERT_FALSE(cache.Get(1));
+        ASSERT_EQ(cache.Size(), 0);
+    }
+
+    TEST(TestLRUCache, RemoveIf) {
+        LRUCache<std::string, int> cache {4};
+        cache.Put("vs_1", 1);
+        cache.Put("vs_1,vs_2", 2);
+        cache.Put("vs_2", 3);
+        cache.Put("vs_3", 4);
+        ASSERT_EQ(cache.RemoveIf([](const std::string& key, const int) { return key.find("vs_2") != std::string::npos; }), 2);
+        ASSERT_EQ(cache.Size(), 2);
+        ASSERT_FALSE(cache.Get("vs_2"));
+        ASSERT_EQ(cache.Get("vs_1"), 1);
+        // removed entries are not counted toward capacity
+        cache.Put("vs_4", 5);
+        cache.Put("vs_5", 6);
+        ASSERT_EQ(cache.Get("vs_3"), 4);
+        ASSERT_EQ(cache.RemoveIf([](const std::string&, const int value) { return value > 100; }), 0);
+    }
+
+}
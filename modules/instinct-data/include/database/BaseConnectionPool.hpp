@@ -13,6 +13,9 @@ namespace INSTINCT_DATA_NS {
     struct ConnectionPoolOptions {
         int initial_connection_count = 5;
         std::chrono::minutes max_idle_duration = 60min;
+        /**
+         * Max duration to wait for a connection to be released if pool is exhausted. Zero means waiting without timeout.
+         */
         std::chrono::seconds max_wait_duration_for_acquire = 3s;
     };
 
@@ -57,6 +60,10 @@ namespace INSTINCT_DATA_NS {
         ConnectionPtr TryAcquire() override {
             std::unique_lock lock(mutex_);
             while (pool_.empty()) {
+                if (options_.max_wait_duration_for_acquire.count() == 0) {
+                    condition_.wait(lock);
+                    continue;
+                }
                 if (condition_.wait_for(lock, options_.max_wait_duration_for_acquire) ==
                     std::cv_status::timeout) {
                     // timeout
@@ -68,7 +75,7 @@ namespace INSTINCT_DATA_NS {
 
             if (conn &&
                 this->Check(conn) &&
-                conn->GetLastActiveTime() - std::chrono::system_clock::now() < options_.max_idle_duration) {
+                std::chrono::system_clock::now() - conn->GetLastActiveTime() < options_.max_idle_duration) {
                 conn->UpdateActiveTime();
                 return conn;
             }
@@ -85,6 +92,7 @@ namespace INSTINCT_DATA_NS {
         }
 
         void Release(const ConnectionPtr &connection) override {
+            std::unique_lock lock(mutex_);
             if (!connection || !this->Check(connection) ) {
                 auto c = this->Create();
                 LOG_DEBUG("Discarded previous broken connection. Newly created: {}", c->GetId());
@@ -41,6 +41,8 @@ namespace INSTINCT_DATA_NS {
 
     using DuckDBConnectionPoolPtr = ConnectionPoolPtr<duckdb::Connection, duckdb::unique_ptr<duckdb::MaterializedQueryResult>>;
 
+    using DuckDBConnectionPtr = DuckDBConnectionPool::ConnectionPtr;
+
     static DuckDBConnectionPoolPtr CreateDuckDBConnectionPool(const DuckDBPtr& db, const ConnectionPoolOptions &options = {}) {
         const auto pool =  std::make_shared<DuckDBConnectionPool>(db, options);
         pool->Initialize();
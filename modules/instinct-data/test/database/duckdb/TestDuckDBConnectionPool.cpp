@@ -2,6 +2,7 @@
 // Created by RobinQu on 2024/4/23.
 //
 #include <gtest/gtest.h>
+#include <thread>
 #include "DataGlobals.hpp"
 #include "database/duckdb/DuckDBConnectionPool.hpp"
 
@@ -45,5 +46,18 @@ namespace INSTINCT_DATA_NS {
         ASSERT_TRUE(pool->Acquire());
     }
 
+    TEST_F(DuckDBConnectionPoolTest, TestAcquireWithoutTimeout) {
+        const auto pool = CreateDuckDBConnectionPool(mem_db_, {.initial_connection_count = 1, .max_wait_duration_for_acquire = std::chrono::seconds {0}});
+        const auto c1 = pool->Acquire();
+        std::thread releaser([&] {
+            // longer than default timeout of acquire
+            std::this_thread::sleep_for(std::chrono::seconds {4});
+            pool->Release(c1);
+        });
+        // blocked until connection is released
+        ASSERT_EQ(pool->Acquire(), c1);
+        releaser.join();
+    }
+
 }
 
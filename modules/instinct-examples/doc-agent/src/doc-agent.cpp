@@ -8,6 +8,7 @@
 #include "chain/RAGChain.hpp"
 #include "chat_model/OllamaChat.hpp"
 #include "commons/OllamaCommons.hpp"
+#include "embedding_model/CachedEmbeddingModel.hpp"
 #include "embedding_model/OllamaEmbedding.hpp"
 #include "embedding_model/OpenAIEmbedding.hpp"
 #include "ingestor/SingleFileIngestor.hpp"
@@ -18,6 +19,7 @@
 #include "retrieval/MultiQueryRetriever.hpp"
 #include "retrieval/VectorStoreRetriever.hpp"
 #include "store/duckdb/DuckDBDocStore.hpp"
+#include "store/duckdb/DuckDBEmbeddingCacheStore.hpp"
 #include "store/duckdb/DuckDBVectorStore.hpp"
 #include "endpoint/chat_completion/ChatCompletionController.hpp"
 #include "tools/Assertions.hpp"
@@ -70,6 +72,10 @@ namespace instinct::examples::doc_agent {
         LLMProviderOptions chat_model_provider;
         LLMProviderOptions embedding_provider;
         bool force_rebuild = false;
+        /**
+         * Cache embeddings by content in a table of shared db, which is not replaced by `--force`. So rebuilding with unchanged texts doesn't embed them again.
+         */
+        bool embedding_cache = true;
         RetrieverOptions retriever;
     };
 
@@ -235,6 +241,15 @@ namespace instinct::examples::doc_agent {
         // embedding model
         EmbeddingsPtr embedding_model = CreateEmbeddingModel(options.embedding_provider);
         assert_true(embedding_model, "should have assigned correct embedding model");
+        CachedEmbeddingModelPtr cached_embedding_model;
+        if (options.embedding_cache) {
+            cached_embedding_model = CreateCachedEmbeddingModel(
+                embedding_model,
+                {.model_name = fmt::format("{}:{}", options.embedding_provider.provider_name, options.embedding_provider.model_name)},
+                CreateDuckDBEmbeddingCacheStore(db)
+            );
+            embedding_model = cached_embedding_model;
+        }
 
         // chat model
         const auto chat_model = CreateChatModel(options.chat_model_provider);
@@ -254,8 +269,14 @@ namespace instinct::examples::doc_agent {
 
         // ingest data
         retriever->Ingest(ingestor->Load());
+        // write snapshots of in-memory indexes, so that they are restored instead of rebuilt when serving
+        vectore_store->Persist();
 
         PrintDatabaseSummary("Database is built successfully", doc_store, vectore_store);
+        if (cached_embedding_model) {
+            const auto stats = cached_embedding_model->GetStats();
+            LOG_INFO("Embedding cache: memory_hit_count={}, persistent_hit_count={}, miss_count={}", stats.memory_hit_count, stats.persistent_hit_count, stats.miss_count);
+        }
     }
 
     static void ServeCommand(const ServeCommandOptions& options) {
@@ -474,6 +495,8 @@ int main(int argc, char** argv) {
         "build", "💼 Anaylize a single document and build database of learned context data. Proper values should be offered for Embedding model, Chat model, DocStore, VecStore and Retriever mentioned above.");
     build_command->add_flag("--force", build_command_options.force_rebuild,
                             "A flag to force rebuild of database, which means existing db files will be deleted. Use this option with caution!");
+    build_command->add_flag("!--disable_embedding_cache", build_command_options.embedding_cache,
+                            "A flag to disable embedding cache, which keeps embeddings of ingested texts in shared db so that rebuilding won't embed unchanged texts again.");
     auto ds_ogroup = build_command->add_option_group("Data source");
     ds_ogroup->add_option("-f,--file", build_command_options.filename, "Path to the document you want analyze")
             ->required();
@@ -109,13 +109,16 @@ namespace instinct::examples::mini_assistant {
                 context.vector_store_metadata_data_mapper,
                 CreateVectorStorePresetMetadataSchema()
                 );
+            // models, retrievers and toolkits shared by runs, which are invalidated by VectorStoreService
+            const auto instance_cache = CreateInstanceCache();
             context.retriever_operator = CreateSimpleRetrieverOperator(
                 context.vector_store_operator,
                 duckdb,
                 {.table_name = "vs_document_table"},
-                options_.retriever_operator
+                options_.retriever_operator,
+                instance_cache
             );
-            const auto vector_store_service = std::make_shared<VectorStoreServiceImpl>(context.vector_store_file_data_mapper, context.vector_store_data_mapper, context.vector_store_file_batch_data_mapper, context.task_scheduler, context.retriever_operator);
+            const auto vector_store_service = std::make_shared<VectorStoreServiceImpl>(context.vector_store_file_data_mapper, context.vector_store_data_mapper, context.vector_store_file_batch_data_mapper, context.task_scheduler, context.retriever_operator, instance_cache);
             context.assistant_facade = {
                 .assistant = assistant_service,
                 .file = file_service,
@@ -137,7 +140,8 @@ namespace instinct::examples::mini_assistant {
                 thread_service,
                 citation_annotating_chain,
                 options_.chat_model,
-                options_.agent_executor
+                options_.agent_executor,
+                instance_cache
             );
 
             //  configure task handler for VectorStoreFileObject
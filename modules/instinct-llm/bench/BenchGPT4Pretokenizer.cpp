@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "tokenizer/GPT4Pretokenizer.hpp"
+#include "tokenizer/TiktokenTokenizer.hpp"
+#include "tools/RegexMatcherPool.hpp"
+
+namespace INSTINCT_LLM_NS::bench {
+    using namespace U_ICU_NAMESPACE;
+
+    static constexpr size_t PRETOKENIZER_BENCH_STRING_COUNT = 10000;
+
+    enum PretokenizerBenchMode {
+        // compile ICU pattern for every call
+        kCompilePerCall,
+        // reuse compiled matchers from `RegexMatcherPool`
+        kPooledMatcher,
+        // hand-written `gpt4_pretokenize`
+        kFastPretokenizer
+    };
+
+    /**
+     * Generate `n` short strings of random code points, including letters, numbers, white spaces, punctuations and a few characters that are tricky for regex classes.
+     */
+    static std::vector<UnicodeString> make_short_strings(const size_t n, const unsigned seed = 42) {
+        const std::vector<UChar32> alphabet = {
+            ' ', ' ', ' ', '\t', '\n', '\r', '\v', '\f', 0x85, 0xA0, 0x2028, 0x3000,
+            'a', 'b', 'c', 's', 'S', 'd', 'T', 'l', 'L', 'v', 'e', 'E', 'r', 0x17F, 0xE9, 0x4E2D,
+            '0', '7', 0xBD, 0x216B, 0x661,
+            '!', '\'', '\'', '.', ',', '-', '$', 0x301, 0x1F44B, 0x1D400
+        };
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<size_t> char_dis(0, alphabet.size() - 1), length_dis(0, 48);
+        std::vector<UnicodeString> result;
+        for (size_t i = 0; i < n; ++i) {
+            UnicodeString s;
+            for (size_t j = length_dis(gen); j > 0; --j) {
+                s.append(alphabet[char_dis(gen)]);
+            }
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    /**
+     * Strings/sec of splitting short strings with GPT4 split pattern. Args: mode (0 for compiling pattern per call, 1 for pooled matchers, 2 for fast pretokenizer).
+     */
+    static void BM_GPT4Pretokenizer_Split(benchmark::State& state) {
+        const auto mode = static_cast<PretokenizerBenchMode>(state.range(0));
+        static const auto texts = make_short_strings(PRETOKENIZER_BENCH_STRING_COUNT);
+        static const auto pattern = UnicodeString::fromUTF8(GPT4_SPLIT_PATTERN);
+        RegexMatcherPool pool {pattern};
+        size_t chunk_count = 0;
+        for (auto _: state) {
+            chunk_count = 0;
+            for (const auto& text: texts) {
+                std::vector<UnicodeString> chunks;
+                if (mode == kCompilePerCall) {
+                    details::find_all_with_regex(text, pattern, chunks);
+                } else if (mode == kPooledMatcher) {
+                    const auto matcher = pool.Acquire();
+                    details::find_all_with_regex(text, *matcher, chunks);
+                } else {
+                    details::gpt4_pretokenize(text, chunks);
+                }
+                chunk_count += chunks.size();
+            }
+            benchmark::DoNotOptimize(chunk_count);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+        state.counters["chunks"] = static_cast<double>(chunk_count);
+    }
+
+    BENCHMARK(BM_GPT4Pretokenizer_Split)
+        ->ArgNames({"mode"})
+        ->Arg(kCompilePerCall)
+        ->Arg(kPooledMatcher)
+        ->Arg(kFastPretokenizer)
+        ->Unit(benchmark::kMillisecond);
+
+    /**
+     * Strings/sec of encoding short strings with GPT4 tokenizer, whose chunk cache is disabled so that pretokenization is measured on every run. Args: fast (0 for regex pretokenizer, 1 for fast pretokenizer).
+     */
+    static void BM_GPT4Pretokenizer_TokenizerEncode(benchmark::State& state) {
+        static const auto texts = make_short_strings(PRETOKENIZER_BENCH_STRING_COUNT, 7);
+        const auto tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(CL100K_BASE_TIKTOKEN_PATH, {.chunk_cache_size = 0, .fast_gpt4_pretokenizer = state.range(0) == 1});
+        for (auto _: state) {
+            for (const auto& text: texts) {
+                benchmark::DoNotOptimize(tokenizer->Encode(text, {.allow_special = kAll}));
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * texts.size()));
+    }
+
+    BENCHMARK(BM_GPT4Pretokenizer_TokenizerEncode)
+        ->ArgNames({"fast"})
+        ->Arg(0)
+        ->Arg(1)
+        ->Unit(benchmark::kMillisecond);
+
+}
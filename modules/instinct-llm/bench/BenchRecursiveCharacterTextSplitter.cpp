@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "document/RecursiveCharacterTextSplitter.hpp"
+#include "tokenizer/TiktokenTokenizer.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_LLM_NS::bench {
+    using namespace U_ICU_NAMESPACE;
+
+    static const std::vector<std::string> SPLITTER_BENCH_SENTENCES = {
+        "The llama is a domesticated South American camelid, widely used as a meat and pack animal by Andean cultures since the pre-Columbian era. ",
+        "Llamas are social animals and live with others as a herd. ",
+        "Their wool is soft and contains only a small amount of lanolin. ",
+        "When using a pack, they can carry about 25 to 30% of their body weight for 8 to 13 km (5–8 miles). ",
+        "The ancestors of llamas are thought to have originated from the Great Plains of North America about 40 million years ago. ",
+        "In Aymara mythology, llamas are important beings. ",
+        "骆驼是一种大型哺乳动物，主要生活在沙漠地区。 ",
+        "At age nine, Swift became interested in musical theater and performed in four Berks Youth Theatre Academy productions 👋. "
+    };
+
+    /**
+     * Generate a text of given size in UTF-8 bytes, made of paragraphs of 1 to 12 random sentences.
+     */
+    static UnicodeString make_paragraphs(const size_t min_bytes, const unsigned seed = 42) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<size_t> sentence_dis(0, SPLITTER_BENCH_SENTENCES.size() - 1), paragraph_dis(1, 12);
+        std::string buf;
+        while (buf.size() < min_bytes) {
+            for (size_t i = paragraph_dis(gen); i > 0; --i) {
+                buf += SPLITTER_BENCH_SENTENCES[sentence_dis(gen)];
+            }
+            buf += "\n\n";
+        }
+        return UnicodeString::fromUTF8(buf);
+    }
+
+    /**
+     * Length calculator that counts characters measured by the wrapped one
+     */
+    class CountingLengthCalculator final: public ILengthCalculator {
+        LengthCalculatorPtr delegate_;
+    public:
+        size_t measured_chars = 0;
+
+        explicit CountingLengthCalculator(LengthCalculatorPtr delegate)
+            : delegate_(std::move(delegate)) {
+        }
+
+        size_t GetLength(const UnicodeString &s) override {
+            measured_chars += s.length();
+            return delegate_->GetLength(s);
+        }
+    };
+
+    /**
+     * Bytes/sec of splitting a text of `size_mb` MB into chunks of 512 tokens with 64 overlapping tokens, where length is measured with GPT4 tokenizer. Counter `measured_chars_ratio` tells how many times each character is measured. Args: size_mb.
+     */
+    static void BM_RecursiveCharacterTextSplitter_SplitWithTokenizer(benchmark::State& state) {
+        const auto size_mb = static_cast<size_t>(state.range(0));
+        const auto text = make_paragraphs(size_mb * 1024 * 1024);
+        const auto tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(CL100K_BASE_TIKTOKEN_PATH, {.fast_gpt4_pretokenizer = true});
+        const auto length_calculator = std::make_shared<CountingLengthCalculator>(std::make_shared<TokenizerBasedLengthCalculator>(tokenizer));
+        RecursiveCharacterTextSplitter splitter {length_calculator, {.chunk_size = 512, .chunk_overlap = 64}};
+        size_t chunk_count = 0;
+        for (auto _: state) {
+            chunk_count = splitter.SplitTextWithOffsets(text).size();
+        }
+        assert_true(chunk_count > 0, "should have text split into chunks");
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_mb * 1024 * 1024));
+        state.counters["chunks"] = static_cast<double>(chunk_count);
+        state.counters["measured_chars_ratio"] = static_cast<double>(length_calculator->measured_chars) / static_cast<double>(state.iterations() * text.length());
+    }
+
+    BENCHMARK(BM_RecursiveCharacterTextSplitter_SplitWithTokenizer)
+        ->ArgNames({"size_mb"})
+        ->Arg(1)
+        ->Arg(50)
+        ->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "tokenizer/TiktokenTokenizer.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_LLM_NS::bench {
+    using namespace U_ICU_NAMESPACE;
+
+    static constexpr size_t TOKENIZER_BENCH_CORPUS_BYTES = 1024 * 1024;
+
+    static const auto TOKENIZER_BENCH_SAMPLE_TEXT = R"(The llama (/ˈlɑːmə/; Spanish pronunciation: [ˈʎama] or [ˈʝama]) (Lama glama) is a domesticated South American camelid, widely used as a meat and pack animal by Andean cultures since the pre-Columbian era.
+Llamas are social animals and live with others as a herd. Their wool is soft and contains only a small amount of lanolin.[2] Llamas can learn simple tasks after a few repetitions. When using a pack, they can carry about 25 to 30% of their body weight for 8 to 13 km (5–8 miles).[3]
+At age nine, Swift became interested in musical theater and performed in four Berks Youth Theatre Academy productions.[19] She spent weekends performing at local festivals and events. 你好 世界 👋 Ünïcödé 1234567)";
+
+    /**
+     * Generate a corpus of given size in UTF-8 bytes, by sampling words from sample text with a few whitespace-only words.
+     */
+    static UnicodeString make_corpus(const size_t min_bytes, const unsigned seed = 42) {
+        auto words = StringUtils::ReSplit(TOKENIZER_BENCH_SAMPLE_TEXT);
+        for (const auto& word: {"\n\n", "\t", "    "}) {
+            words.emplace_back(word);
+        }
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<size_t> dis(0, words.size() - 1);
+        std::string corpus;
+        while (corpus.size() < min_bytes) {
+            corpus += words[dis(gen)];
+            corpus += " ";
+        }
+        return UnicodeString::fromUTF8(corpus);
+    }
+
+    /**
+     * Tokenizer with given chunk cache size, and the corpus to encode. Both are created once and shared by all benchmark runs.
+     */
+    struct TiktokenFixture {
+        TokenizerPtr cached_tokenizer;
+        TokenizerPtr uncached_tokenizer;
+        BPETokenRanks mergeable_ranks;
+        UnicodeString corpus;
+
+        static TiktokenFixture& GetInstance() {
+            static TiktokenFixture fixture;
+            return fixture;
+        }
+
+    private:
+        TiktokenFixture():
+            cached_tokenizer(TiktokenTokenizer::MakeGPT4Tokenizer(CL100K_BASE_TIKTOKEN_PATH)),
+            uncached_tokenizer(TiktokenTokenizer::MakeGPT4Tokenizer(CL100K_BASE_TIKTOKEN_PATH, {.chunk_cache_size = 0})),
+            mergeable_ranks(TiktokenBPEFileReader(CL100K_BASE_TIKTOKEN_PATH).Fetch()),
+            corpus(make_corpus(TOKENIZER_BENCH_CORPUS_BYTES)) {
+        }
+    };
+
+    /**
+     * Bytes/sec of the reference BPE implementation, which recomputes pair statistics for every merge. It's the baseline of `BM_TiktokenTokenizer_Encode`.
+     */
+    static void BM_TiktokenTokenizer_EncodeReference(benchmark::State& state) {
+        auto& fixture = TiktokenFixture::GetInstance();
+        static const auto pattern = UnicodeString::fromUTF8(GPT4_SPLIT_PATTERN);
+        auto merges = std::dynamic_pointer_cast<RegexTokenizer>(fixture.uncached_tokenizer)->GetBPERanks();
+        std::vector<UnicodeString> chunks;
+        details::find_all_with_regex(fixture.corpus, pattern, chunks);
+        size_t token_count = 0;
+        for (auto _: state) {
+            token_count = 0;
+            for (const auto& chunk: chunks) {
+                std::vector<int32_t> ids;
+                for (const auto& c: details::conv_to_utf8_string(chunk)) {
+                    ids.push_back(fixture.mergeable_ranks.at(Bytes {c}));
+                }
+                details::bpe_merge_with_pair_stats(ids, merges);
+                token_count += ids.size();
+            }
+            benchmark::DoNotOptimize(token_count);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * TOKENIZER_BENCH_CORPUS_BYTES));
+        state.counters["tokens"] = static_cast<double>(token_count);
+    }
+
+    BENCHMARK(BM_TiktokenTokenizer_EncodeReference)->Unit(benchmark::kMillisecond);
+
+    /**
+     * Bytes/sec of `Encode` with rank heap merging. With chunk cache enabled, every run after the first one hits cache for all chunks. Args: cached (0 to disable chunk cache, 1 to use default cache size).
+     */
+    static void BM_TiktokenTokenizer_Encode(benchmark::State& state) {
+        auto& fixture = TiktokenFixture::GetInstance();
+        const auto& tokenizer = state.range(0) ? fixture.cached_tokenizer : fixture.uncached_tokenizer;
+        size_t token_count = 0;
+        for (auto _: state) {
+            const auto ids = tokenizer->Encode(fixture.corpus, {.allow_special = kNone});
+            token_count = ids.size();
+            benchmark::DoNotOptimize(ids.data());
+        }
+        assert_true(token_count > 0, "should have tokens encoded");
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * TOKENIZER_BENCH_CORPUS_BYTES));
+        state.counters["tokens"] = static_cast<double>(token_count);
+    }
+
+    BENCHMARK(BM_TiktokenTokenizer_Encode)
+        ->ArgNames({"cached"})
+        ->Arg(0)
+        ->Arg(1)
+        ->Unit(benchmark::kMillisecond);
+
+}
@@ -11,6 +11,7 @@
 #include "embedding_model/OpenAIEmbedding.hpp"
 #include "llm/BaseLLM.hpp"
 #include "llm/OpenAILLM.hpp"
+#include "ranker/BaseRankingModel.hpp"
 #include "toolkit/BaseSearchTool.hpp"
 #include "toolkit/LocalToolkit.hpp"
 #include "toolkit/builtin/LLMMath.hpp"
@@ -115,12 +116,14 @@ talking non-sense
     class PesudoEmbeddings final: public IEmbeddingModel {
         std::unordered_map<std::string, Embedding> caches_ = {};
         size_t dim_;
+        std::mutex mutex_;
     public:
         explicit PesudoEmbeddings(const size_t dim = 512)
                 : dim_(dim) {
         }
 
         std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            std::lock_guard guard {mutex_};
             std::vector<Embedding> result;
             for(const auto& text: texts) {
                 if (!caches_.contains(text)) {
@@ -145,6 +148,7 @@ talking non-sense
 
 
         Embedding EmbedQuery(const std::string& text) override {
+            std::lock_guard guard {mutex_};
             if (!caches_.contains(text)) {
                 caches_.emplace(text, make_random_vector(dim_));
             }
@@ -152,6 +156,76 @@ talking non-sense
         }
     };
 
+    /**
+     * Stateless embedding model that derives a unit vector from hash of text, so that same text always gets same embedding across runs and threads. It's useful for benchmarks that should run offline and be reproducible.
+     */
+    class HashedEmbeddings final: public IEmbeddingModel {
+        size_t dim_;
+    public:
+        explicit HashedEmbeddings(const size_t dim = 512)
+                : dim_(dim) {
+        }
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            std::vector<Embedding> result;
+            result.reserve(texts.size());
+            for(const auto& text: texts) {
+                result.push_back(EmbedQuery(text));
+            }
+            return result;
+        }
+
+        size_t GetDimension() override {
+            return dim_;
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            // FNV-1a and raw engine output are used instead of std::hash and distributions, whose results are implementation-defined
+            uint64_t seed = 14695981039346656037ULL;
+            for (const auto c: text) {
+                seed ^= static_cast<unsigned char>(c);
+                seed *= 1099511628211ULL;
+            }
+            std::mt19937_64 gen(seed);
+            Embedding embedding(dim_);
+            float norm = 0;
+            for(auto& v: embedding) {
+                v = static_cast<float>(gen() >> 40) / static_cast<float>(1 << 23) - 1.0f;
+                norm += v * v;
+            }
+            norm = std::sqrt(norm);
+            for(auto& v: embedding) {
+                v /= norm;
+            }
+            return embedding;
+        }
+    };
+
+    /**
+     * Ranking model that scores a document by ratio of query words it contains. It's cheap and deterministic, which is good enough to exercise re-ranking paths offline.
+     */
+    class KeywordRankingModel final: public BaseRankingModel {
+    public:
+        float GetRankingScore(const std::string &query, const std::string &doc) override {
+            std::istringstream words {query};
+            size_t total = 0, hit = 0;
+            for (std::string word; words >> word; ++total) {
+                if (doc.find(word) != std::string::npos) {
+                    ++hit;
+                }
+            }
+            return total == 0 ? 0 : static_cast<float>(hit) / static_cast<float>(total);
+        }
+    };
+
+    static std::shared_ptr<HashedEmbeddings> create_hashed_embedding_model(size_t dim = 512) {
+        return std::make_shared<HashedEmbeddings>(dim);
+    }
+
+    static RankingModelPtr create_keyword_ranking_model() {
+        return std::make_shared<KeywordRankingModel>();
+    }
+
     static ChatModelPtr create_pesudo_chat_model() {
         return std::make_shared<PesudoChatModel>();
     }
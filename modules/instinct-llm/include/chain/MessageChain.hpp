@@ -126,6 +126,19 @@ namespace INSTINCT_LLM_NS {
             auto output = step->Invoke(context);
             return output_parser_->Invoke(output);
         }
+
+        /**
+         * Parse each chunk emitted by underlying step function
+         * @param input
+         * @return
+         */
+        AsyncIterator<Output> Stream(const Input &input) override {
+            auto context = input_parser_->Invoke(input);
+            return GetStepFunction()->Stream(context)
+                | rpp::operators::map([output_parser = output_parser_](const JSONContextPtr& output) {
+                    return output_parser->Invoke(output);
+                });
+        }
     };
 
     template<
@@ -118,7 +118,7 @@ namespace INSTINCT_LLM_NS {
         auto message_list = details::conv_prompt_value_variant_to_message_list(prompt_value);
 
         return model_->StreamGenerate(message_list)
-               | rpp::operators::map([&](const LangaugeModelResult &result) {
+               | rpp::operators::map([input](const LangaugeModelResult &result) {
             input->ProduceMessage(result.generations(0));
             return input;
         });
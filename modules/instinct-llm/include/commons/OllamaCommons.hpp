@@ -26,6 +26,8 @@ namespace INSTINCT_LLM_NS {
 
     static const std::string OLLAMA_EMBEDDING_PATH = "/api/embeddings";
 
+    static const std::string OLLAMA_BATCH_EMBEDDING_PATH = "/api/embed";
+
     static const std::string OLLAMA_DEFAULT_CHAT_MODEL_NAME = "mistral:latest";
 
     static const std::string OLLAMA_DEFAULT_EMBEDDING_MODEL_NAME = "all-minilm:latest";
@@ -53,6 +55,11 @@ namespace INSTINCT_LLM_NS {
          * Define timeout for generating one embedding
          */
         std::chrono::seconds embedding_timeout_factor = 0s;
+
+        /**
+         * Max count of texts sent in one request to `/api/embed`. Zero means batch API is not used, and one request is sent to `/api/embeddings` for each text.
+         */
+        size_t embedding_batch_size = 64;
     };
 
 
@@ -71,16 +71,42 @@ namespace  INSTINCT_LLM_NS {
               length_calculator_(std::move(length_calculator)) {
         }
 
+        std::vector<UnicodeString> SplitText(const UnicodeString& text) override {
+            std::vector<UnicodeString> result;
+            for (auto& chunk: SplitTextWithOffsets(text)) {
+                result.push_back(std::move(chunk.text));
+            }
+            return result;
+        }
+
+        /**
+         * Split text into chunks, and keep track of where they are in original text. Chunks are ordered by their start offsets.
+         * @param text
+         * @return
+         */
+        virtual std::vector<TextChunk> SplitTextWithOffsets(const UnicodeString& text) = 0;
+
         AsyncIterator<Document> SplitDocuments(const AsyncIterator<Document>& docs_itr) override {
             return rpp::source::create<Document>([&,docs_itr](const auto& observer) {
                 docs_itr.subscribe([&](const Document& doc) {
-                    for (const auto & chunk : SplitText(UnicodeString::fromUTF8(doc.text()))) {
+                    const auto text = UnicodeString::fromUTF8(doc.text());
+                    // convert offsets in UTF-16 code units to those in UTF-8 bytes, by counting bytes from last chunk
+                    int32_t last_start = 0;
+                    size_t last_utf8_start = 0;
+                    for (const auto & chunk : SplitTextWithOffsets(text)) {
+                        if (chunk.start < last_start) {
+                            last_start = 0;
+                            last_utf8_start = 0;
+                        }
+                        last_utf8_start += details::count_utf8_bytes(text, last_start, chunk.start);
+                        last_start = chunk.start;
+
                         Document document;
-                        chunk.toUTF8String(*document.mutable_text());
+                        chunk.text.toUTF8String(*document.mutable_text());
                         document.mutable_metadata()->CopyFrom(doc.metadata());
                         auto *start_index_field = document.add_metadata();
                         start_index_field->set_name(METADATA_SCHEMA_CHUNK_START_INDEX_KEY);
-                        start_index_field->set_int_value(static_cast<int32_t>(doc.text().find(document.text())));
+                        start_index_field->set_int_value(static_cast<int32_t>(last_utf8_start));
                         auto *end_index_field = document.add_metadata();
                         end_index_field->set_name(METADATA_SCHEMA_CHUNK_END_INDEX_KEY);
                         end_index_field->set_int_value(static_cast<int32_t>(start_index_field->int_value() + document.text().size()));
@@ -96,55 +122,84 @@ namespace  INSTINCT_LLM_NS {
 
     protected:
         /**
-         * Merge partial splits into new strings which have size less than `chunk_size`.
+         * Compute length of each split only once
+         * @param text original text
+         * @param splits positions of splits in `text`
+         * @param offset offset of `text` in its own parent text
+         * @return
+         */
+        std::vector<details::TextPiece> MeasureSplits_(const UnicodeString& text, const std::vector<std::pair<int32_t, int32_t>>& splits, const int32_t offset) const {
+            std::vector<details::TextPiece> pieces;
+            pieces.reserve(splits.size());
+            for (const auto& [start, end]: splits) {
+                const auto piece_text = text.tempSubStringBetween(start, end);
+                pieces.push_back({piece_text, offset + start, length_calculator_->GetLength(piece_text)});
+            }
+            return pieces;
+        }
+
+        /**
+         * Merge partial splits in `splits[first, last)` into new strings which have size less than `chunk_size`. Lengths of splits are precomputed, and length of a merged string is accumulated from them along with separator in between.
          * @param splits
+         * @param first
+         * @param last
          * @param separator
          * @param docs
          */
-        void MergeSplits_(const std::vector<UnicodeString>& splits, const UnicodeString& separator,
-                          std::vector<UnicodeString>& docs) const {
-            const auto s_len = length_calculator_->GetLength(separator);
-            std::vector<UnicodeString> current_doc;
+        void MergeSplits_(const std::vector<details::TextPiece>& splits, const size_t first, const size_t last, const UnicodeString& separator,
+                          std::vector<TextChunk>& docs) const {
+            const auto s_len = separator.isEmpty() ? 0 : length_calculator_->GetLength(separator);
+            const auto chunk_size = static_cast<size_t>(chunk_size_);
+            const auto chunk_overlap = static_cast<size_t>(chunk_overlap_);
+            // current doc is made of `splits[doc_begin, i)`
+            size_t doc_begin = first;
             size_t total = 0;
-            for (const auto& s: splits) {
-                const auto d_len = length_calculator_->GetLength(s);
-                // if chunk_size is reached, merge partials in `current_doc` a new string and append to `docs`.
-                if (total + d_len + (current_doc.empty() ? 0 : s_len) > chunk_size_) {
-                    if (!current_doc.empty()) {
-                        // std::cout << fmt::format("total={}, chunk_size={}, total + d_len + (current_doc.empty() ? 0 : s_len) = {}", total, chunk_size_, total + d_len + (current_doc.empty() ? 0 : s_len)) << std::endl;
-                        // details::print_splits("current_doc: ", current_doc);
-
-                        if (const auto doc = JoinDocs_(current_doc, separator); doc.length()) {
-                            docs.push_back(doc);
-                        }
-
-                        while (total > chunk_overlap_ || ((total + d_len + (current_doc.empty() ? s_len : 0) > chunk_size_) && total > 0)) {
-                            total -= length_calculator_->GetLength(current_doc.front()) + (current_doc.size() > 1 ? s_len : 0);
-                            current_doc.erase(current_doc.begin());
+            for (size_t i = first; i < last; ++i) {
+                const auto d_len = splits[i].length;
+                // if chunk_size is reached, merge partials in current doc into a new string and append to `docs`.
+                if (total + d_len + (doc_begin < i ? s_len : 0) > chunk_size) {
+                    if (doc_begin < i) {
+                        JoinDocs_(splits, doc_begin, i, separator, docs);
+                        while (total > chunk_overlap || ((total + d_len + (doc_begin == i ? s_len : 0) > chunk_size) && total > 0)) {
+                            total -= splits[doc_begin].length + (i - doc_begin > 1 ? s_len : 0);
+                            ++doc_begin;
                         }
                     }
                 }
-                current_doc.push_back(s);
-                total += d_len + (current_doc.size() > 1 ? s_len: 0);
-            }
-            if (const auto rest = JoinDocs_(current_doc, separator); !rest.isEmpty()) {
-                docs.push_back(rest);
+                total += d_len + (doc_begin < i ? s_len: 0);
             }
+            JoinDocs_(splits, doc_begin, last, separator, docs);
         }
 
-        [[nodiscard]] UnicodeString JoinDocs_(const std::vector<UnicodeString>& docs,
-                                              const UnicodeString& separator) const {
+        /**
+         * Join `splits[first, last)` with separator, and append to `docs` if result is not empty
+         */
+        void JoinDocs_(const std::vector<details::TextPiece>& splits, const size_t first, const size_t last,
+                       const UnicodeString& separator, std::vector<TextChunk>& docs) const {
+            if (first >= last) {
+                return;
+            }
             UnicodeString text;
-            for (int i = 0; i < docs.size(); i++) {
-                text += docs[i];
-                if (i != docs.size()-1) {
+            for (size_t i = first; i < last; i++) {
+                text += splits[i].text;
+                if (i != last-1) {
                     text += separator;
                 }
             }
+            int32_t start = splits[first].start;
             if (strip_whitespace_) {
-                return text.trim();
+                UnicodeString trimmed = text;
+                trimmed.trim();
+                if (trimmed.isEmpty()) {
+                    return;
+                }
+                // trimmed text starts with a non-whitespace character, so its first occurrence is right after leading whitespaces
+                start += text.indexOf(trimmed);
+                text = std::move(trimmed);
+            }
+            if (!text.isEmpty()) {
+                docs.push_back({std::move(text), start});
             }
-            return text;
         }
     };
 }
@@ -6,6 +6,7 @@
 #define CHARACTERTEXTSPLITTER_HPP
 
 #include "BaseTextSplitter.hpp"
+#include "tools/RegexMatcherPool.hpp"
 
 namespace INSTINCT_LLM_NS {
 
@@ -20,14 +21,26 @@ namespace INSTINCT_LLM_NS {
 
     class CharacterTextSplitter final: public BaseTextSplitter {
         UnicodeString separator_;
+        RegexMatcherPoolPtr separator_matchers_;
     public:
-        explicit CharacterTextSplitter(const CharacterTextSplitterOptions& options = {}): BaseTextSplitter(options.chunk_size, options.chunk_overlap, options.keep_separator, options.strip_whitespace, options.length_function), separator_(options.separator) {}
+        explicit CharacterTextSplitter(const CharacterTextSplitterOptions& options = {}): BaseTextSplitter(options.chunk_size, options.chunk_overlap, options.keep_separator, options.strip_whitespace, options.length_function), separator_(options.separator) {
+            if (!separator_.isEmpty()) {
+                separator_matchers_ = std::make_shared<RegexMatcherPool>(details::escape_for_regular_expression(separator_));
+            }
+        }
 
-        std::vector<UnicodeString> SplitText(const UnicodeString& text) override {
-            auto sep = details::escape_for_regular_expression(separator_);
-            std::vector<UnicodeString> splits = details::split_text_with_seperator(text, sep, keep_separator_);
-            std::vector<UnicodeString> results;
-            MergeSplits_(splits, sep, results);
+        std::vector<TextChunk> SplitTextWithOffsets(const UnicodeString& text) override {
+            std::vector<std::pair<int32_t, int32_t>> splits;
+            if (separator_matchers_) {
+                const auto matcher = separator_matchers_->Acquire();
+                splits = details::split_text_with_offsets(text, &*matcher, keep_separator_);
+            } else {
+                splits = details::split_text_with_offsets(text, nullptr, keep_separator_);
+            }
+            const auto pieces = MeasureSplits_(text, splits, 0);
+            std::vector<TextChunk> results;
+            // splits are joined with original separator, rather than the escaped one for regex
+            MergeSplits_(pieces, 0, pieces.size(), keep_separator_ ? "" : separator_, results);
             return results;
         }
 
@@ -14,6 +14,7 @@
 #include "LanguageSplitters.hpp"
 #include "tokenizer/TiktokenTokenizer.hpp"
 #include "tokenizer/Tokenizer.hpp"
+#include "tools/RegexMatcherPool.hpp"
 
 namespace INSTINCT_LLM_NS {
     using namespace U_ICU_NAMESPACE;
@@ -39,6 +40,8 @@ namespace INSTINCT_LLM_NS {
      */
     class RecursiveCharacterTextSplitter final: public BaseTextSplitter {
         std::vector<UnicodeString> separators_;
+        // compiled patterns of non-empty separators
+        std::unordered_map<UnicodeString, RegexMatcherPoolPtr, hash_unicode_string> separator_matchers_;
     public:
 
         explicit RecursiveCharacterTextSplitter(const RecursiveCharacterTextSplitterOptions& options = {}): RecursiveCharacterTextSplitter(std::make_shared<StringLengthCalculator>(), options) {}
@@ -50,63 +53,73 @@ namespace INSTINCT_LLM_NS {
             options.strip_whitespace,
             std::move(length_calculator)),
                                                                                                             separators_(options.separators) {
-
+            for (const auto& sep: separators_) {
+                if (!sep.isEmpty() && !separator_matchers_.contains(sep)) {
+                    separator_matchers_.emplace(sep, std::make_shared<RegexMatcherPool>(details::escape_for_regular_expression(sep)));
+                }
+            }
         }
 
-
-        std::vector<UnicodeString> SplitText(const UnicodeString& text) override {
+        std::vector<TextChunk> SplitTextWithOffsets(const UnicodeString& text) override {
             auto seps = std::vector(separators_);
-            std::vector<UnicodeString> result;
-            SplitText_(text, seps, result);
+            std::vector<TextChunk> result;
+            SplitText_(text, 0, seps, result);
             return result;
         }
 
     private:
-        void SplitText_(const UnicodeString& text, std::vector<UnicodeString>& separators, std::vector<UnicodeString>& final_chunks) { // NOLINT(*-no-recursion)
+        /**
+         * Split text with first separator found in it, and merge splits that are small enough. Splits that are still too long are split recursively with remaining separators.
+         * @param text text to be split
+         * @param offset offset of `text` in original text, so that offsets of chunks are relative to original text
+         * @param separators separators to try, which are consumed during recursion
+         * @param final_chunks result
+         */
+        void SplitText_(const UnicodeString& text, const int32_t offset, std::vector<UnicodeString>& separators, std::vector<TextChunk>& final_chunks) { // NOLINT(*-no-recursion)
             // default to last sep, assuming it's most common case in text
-            UnicodeString separator = details::escape_for_regular_expression(separators.back());
+            UnicodeString separator = separators.back();
             for(auto itr=separators.begin(); itr != separators.end(); ++itr) {
-                auto sep = *itr;
                 // break if it's empty string
-                if(sep == "") {
+                if(itr->isEmpty()) {
                     separator = "";
                     separators.clear();
                     break;
                 }
                 // break if text can be split by sep
-                if(text.indexOf(sep) !=-1) {
-                    separator = details::escape_for_regular_expression(sep);
-                    itr = separators.erase(itr);
+                if(text.indexOf(*itr) !=-1) {
+                    separator = *itr;
+                    separators.erase(itr);
                     break;
                 }
             }
-            const auto splits = details::split_text_with_seperator(text, separator, keep_separator_);
-            std::vector<UnicodeString> good_splits;
-
-            // Tricky part: if `keep_separator` is true, then the splits vector (`good_splits`) already contain separators, so we cannot join splits with seperator again, other there will be duplicated separators between splits.
-            const auto merging_separator = keep_separator_ ? "" : separator;
-            for(auto& s: splits) {
-                if(length_calculator_->GetLength(s) < chunk_size_) {
-                    good_splits.push_back(s);
+
+            std::vector<std::pair<int32_t, int32_t>> splits;
+            if (separator.isEmpty()) {
+                splits = details::split_text_with_offsets(text, nullptr, keep_separator_);
+            } else {
+                const auto matcher = separator_matchers_.at(separator)->Acquire();
+                splits = details::split_text_with_offsets(text, &*matcher, keep_separator_);
+            }
+            const auto pieces = MeasureSplits_(text, splits, offset);
+
+            // Tricky part: if `keep_separator` is true, then the splits already contain separators, so we cannot join splits with seperator again, other there will be duplicated separators between splits.
+            const UnicodeString merging_separator = keep_separator_ ? "" : separator;
+            // good splits are `pieces[good_begin, i)`
+            size_t good_begin = 0;
+            for(size_t i = 0; i < pieces.size(); ++i) {
+                if(pieces[i].length < static_cast<size_t>(chunk_size_)) {
+                    continue;
+                }
+                // merge partials if possible
+                MergeSplits_(pieces, good_begin, i, merging_separator, final_chunks);
+                good_begin = i + 1;
+                if(separators.empty()) {
+                    final_chunks.push_back({pieces[i].text, pieces[i].start});
                 } else {
-                    // merge partials if possible
-                    if(!good_splits.empty()) {
-                        MergeSplits_(good_splits, merging_separator, final_chunks);
-                        good_splits.clear();
-                    }
-                    if(separators.empty()) {
-                        final_chunks.push_back(s);
-                    } else {
-                        SplitText_(s, separators, final_chunks);
-                    }
+                    SplitText_(pieces[i].text, pieces[i].start, separators, final_chunks);
                 }
             }
-
-            if(!good_splits.empty()) {
-                MergeSplits_(good_splits, merging_separator, final_chunks);
-            }
-
-            // details::print_array(final_chunks);
+            MergeSplits_(pieces, good_begin, pieces.size(), merging_separator, final_chunks);
         }
     };
 
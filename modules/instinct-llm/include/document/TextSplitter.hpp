@@ -17,6 +17,17 @@ namespace INSTINCT_LLM_NS {
     using namespace INSTINCT_CORE_NS;
     using namespace U_ICU_NAMESPACE;
 
+    /**
+     * A chunk of text with its position in original text
+     */
+    struct TextChunk {
+        UnicodeString text;
+        /**
+         * offset of first character in original text, counted in UTF-16 code units
+         */
+        int32_t start = 0;
+    };
+
     class TextSplitter {
     public:
         TextSplitter()=default;
@@ -36,6 +47,15 @@ namespace INSTINCT_LLM_NS {
      */
     namespace details {
 
+        /**
+         * A split of text with precomputed length
+         */
+        struct TextPiece {
+            UnicodeString text;
+            int32_t start = 0;
+            size_t length = 0;
+        };
+
         static void print_splits(const std::string& announce, const std::vector<UnicodeString>& splits,
                          std::ostream& stream = std::cout, const bool flush = true) {
             stream << announce;
@@ -117,6 +137,63 @@ namespace INSTINCT_LLM_NS {
             });
             return {parts_view.begin(), parts_view.end()};
         }
+
+        /**
+         * Same as `split_text_with_seperator`, but return positions of non-empty splits in `text` instead of copies of them.
+         * @param text
+         * @param separator_matcher matcher of separator, or nullptr to split into graphemes
+         * @param keep_seperator if true, separator is kept at the beginning of following split
+         * @return pairs of [start, end) in UTF-16 code units
+         */
+        static std::vector<std::pair<int32_t, int32_t>> split_text_with_offsets(const UnicodeString& text, RegexMatcher* separator_matcher, const bool keep_seperator) {
+            std::vector<std::pair<int32_t, int32_t>> result;
+            const auto add_split = [&](const int32_t start, const int32_t end) {
+                if (start < end) {
+                    result.emplace_back(start, end);
+                }
+            };
+            if (!separator_matcher) {
+                UErrorCode status = U_ZERO_ERROR;
+                const std::unique_ptr<BreakIterator> itr {BreakIterator::createCharacterInstance(Locale::getDefault(), status)};
+                if(U_FAILURE(status)) {
+                    throw InstinctException("Failed to createCharacterInstance: " + std::string(u_errorName(status)));
+                }
+                itr->setText(text);
+                int32_t start = itr->first();
+                for(int32_t end = itr->next(); end!=BreakIterator::DONE; start=end, end=itr->next()) {
+                    add_split(start, end);
+                }
+                return result;
+            }
+
+            UErrorCode status = U_ZERO_ERROR;
+            separator_matcher->reset(text);
+            int32_t last = 0;
+            while (separator_matcher->find()) {
+                const int32_t match_start = separator_matcher->start(status);
+                const int32_t match_end = separator_matcher->end(status);
+                if(U_FAILURE(status)) {
+                    throw InstinctException("Failed to match separator");
+                }
+                add_split(last, match_start);
+                last = keep_seperator ? match_start : match_end;
+            }
+            add_split(last, text.length());
+            return result;
+        }
+
+        /**
+         * Count bytes of UTF-8 encoding of text[from, to)
+         */
+        static size_t count_utf8_bytes(const UnicodeString& text, const int32_t from, const int32_t to) {
+            size_t count = 0;
+            for (int32_t i = from; i < to;) {
+                const UChar32 c = text.char32At(i);
+                count += c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+                i += U16_LENGTH(c);
+            }
+            return count;
+        }
     }
 
 }
@@ -0,0 +1,174 @@
+#ifndef CACHEDEMBEDDINGMODEL_HPP
+#define CACHEDEMBEDDINGMODEL_HPP
+
+#include "LLMGlobals.hpp"
+#include "model/IEmbeddingCacheStore.hpp"
+#include "model/IEmbeddingModel.hpp"
+#include "tools/Assertions.hpp"
+#include "tools/HashUtils.hpp"
+#include "tools/LRUCache.hpp"
+
+namespace INSTINCT_LLM_NS {
+    using namespace INSTINCT_CORE_NS;
+
+    struct EmbeddingCacheOptions {
+        /**
+         * Name of embedding model, which is part of cache key. Embeddings of different models should never be mixed.
+         */
+        std::string model_name;
+
+        /**
+         * Max count of embeddings kept in memory. Zero means in-memory tier is disabled.
+         */
+        size_t memory_capacity = 10000;
+    };
+
+    struct EmbeddingCacheStats {
+        uint64_t memory_hit_count = 0;
+        uint64_t persistent_hit_count = 0;
+        uint64_t miss_count = 0;
+    };
+
+    /**
+     * Decorator of embedding model which caches embeddings by content. Keys are SHA-256 of model name, dimension and text, so that unchanged texts are never embedded twice, no matter which document they belong to.
+     *
+     * Lookups go through an in-memory LRU tier first, and then an optional `IEmbeddingCacheStore` tier which survives restarts. Texts missing in both tiers are embedded by the underlying model in a single `EmbedDocuments` call, and results are written back to both tiers. Queries are looked up and kept in the in-memory tier only, as they are rarely repeated across restarts and would bloat the persistent tier. A failed write to persistent tier is logged and doesn't fail embedding.
+     */
+    class CachedEmbeddingModel final: public IEmbeddingModel {
+        EmbeddingsPtr embeddings_;
+        EmbeddingCacheStorePtr cache_store_;
+        EmbeddingCacheOptions options_;
+        LRUCache<std::string, Embedding> memory_cache_;
+        std::atomic<uint64_t> memory_hit_count_ = 0;
+        std::atomic<uint64_t> persistent_hit_count_ = 0;
+        std::atomic<uint64_t> miss_count_ = 0;
+
+    public:
+        CachedEmbeddingModel(EmbeddingsPtr embeddings, EmbeddingCacheStorePtr cache_store, EmbeddingCacheOptions options)
+            : embeddings_(std::move(embeddings)),
+              cache_store_(std::move(cache_store)),
+              options_(std::move(options)),
+              memory_cache_(options_.memory_capacity) {
+            assert_true(embeddings_, "should provide embedding model");
+            assert_true(!StringUtils::IsBlankString(options_.model_name), "model_name should not be blank");
+        }
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            return Embed_(texts, true);
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return Embed_({text}, false).front();
+        }
+
+        std::vector<Embedding> EmbedQueries(const std::vector<std::string>& texts) override {
+            return Embed_(texts, false);
+        }
+
+        size_t GetDimension() override {
+            return embeddings_->GetDimension();
+        }
+
+        /**
+         * Counters of lookups since creation. Repeated texts in one call are counted once.
+         */
+        [[nodiscard]] EmbeddingCacheStats GetStats() const {
+            return {.memory_hit_count = memory_hit_count_, .persistent_hit_count = persistent_hit_count_, .miss_count = miss_count_};
+        }
+
+    private:
+        std::string MakeKey_(const std::string& text) const {
+            return HashUtils::HashForString<SHA256>(fmt::format("{}\n{}\n{}", options_.model_name, embeddings_->GetDimension(), text));
+        }
+
+        /**
+         * Look up embeddings of texts in cache tiers, and embed missing ones in a single call
+         * @param texts
+         * @param use_persistent_tier false to skip persistent tier for both lookup and write-back
+         * @return
+         */
+        std::vector<Embedding> Embed_(const std::vector<std::string>& texts, const bool use_persistent_tier) {
+            const bool persistent = use_persistent_tier && cache_store_;
+            std::vector<std::string> keys;
+            keys.reserve(texts.size());
+            for (const auto& text: texts) {
+                keys.push_back(MakeKey_(text));
+            }
+
+            // distinct keys missing in memory, with index of their first occurrence
+            std::unordered_map<std::string, Embedding> found;
+            std::vector<std::string> missing_keys;
+            std::unordered_map<std::string, size_t> missing_indices;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (found.contains(keys[i]) || missing_indices.contains(keys[i])) {
+                    continue;
+                }
+                if (auto embedding = memory_cache_.Get(keys[i])) {
+                    found.emplace(keys[i], std::move(embedding.value()));
+                    ++memory_hit_count_;
+                } else {
+                    missing_indices.emplace(keys[i], i);
+                    missing_keys.push_back(keys[i]);
+                }
+            }
+
+            if (persistent && !missing_keys.empty()) {
+                for (auto& [key, embedding]: cache_store_->MultiGet(missing_keys)) {
+                    memory_cache_.Put(key, embedding);
+                    missing_indices.erase(key);
+                    found.emplace(key, std::move(embedding));
+                    ++persistent_hit_count_;
+                }
+                std::erase_if(missing_keys, [&](const std::string& key) { return !missing_indices.contains(key); });
+            }
+
+            if (!missing_keys.empty()) {
+                std::vector<std::string> missing_texts;
+                missing_texts.reserve(missing_keys.size());
+                for (const auto& key: missing_keys) {
+                    missing_texts.push_back(texts[missing_indices.at(key)]);
+                }
+                // queries share keys with documents in memory tier, so they are embedded the same way
+                auto embeddings = embeddings_->EmbedDocuments(missing_texts);
+                assert_true(embeddings.size() == missing_texts.size(), "should have one embedding for each text");
+                miss_count_ += missing_keys.size();
+                std::vector<std::pair<std::string, Embedding>> entries;
+                entries.reserve(missing_keys.size());
+                for (size_t i = 0; i < missing_keys.size(); ++i) {
+                    memory_cache_.Put(missing_keys[i], embeddings[i]);
+                    entries.emplace_back(missing_keys[i], std::move(embeddings[i]));
+                }
+                if (persistent) {
+                    try {
+                        cache_store_->MultiPut(entries);
+                    } catch (const std::exception& e) {
+                        LOG_WARN("Failed to write {} embeddings to persistent cache: {}", entries.size(), e.what());
+                    }
+                }
+                for (auto& [key, embedding]: entries) {
+                    found.emplace(key, std::move(embedding));
+                }
+            }
+            LOG_DEBUG("Embed with cache: input.size()={}, embedded={}, persistent={}", texts.size(), missing_keys.size(), persistent);
+
+            std::vector<Embedding> result;
+            result.reserve(texts.size());
+            for (const auto& key: keys) {
+                result.push_back(found.at(key));
+            }
+            return result;
+        }
+    };
+
+    using CachedEmbeddingModelPtr = std::shared_ptr<CachedEmbeddingModel>;
+
+    static CachedEmbeddingModelPtr CreateCachedEmbeddingModel(
+        const EmbeddingsPtr& embeddings,
+        const EmbeddingCacheOptions& options,
+        const EmbeddingCacheStorePtr& cache_store = nullptr
+    ) {
+        return std::make_shared<CachedEmbeddingModel>(embeddings, cache_store, options);
+    }
+}
+
+#endif //CACHEDEMBEDDINGMODEL_HPP
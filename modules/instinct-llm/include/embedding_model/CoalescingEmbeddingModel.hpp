@@ -0,0 +1,183 @@
+#ifndef COALESCINGEMBEDDINGMODEL_HPP
+#define COALESCINGEMBEDDINGMODEL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+
+#include "LLMGlobals.hpp"
+#include "model/IEmbeddingModel.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_LLM_NS {
+    using namespace INSTINCT_CORE_NS;
+
+    struct EmbeddingCoalescingOptions {
+        /**
+         * Max count of texts in one call to underlying model
+         */
+        size_t max_batch_size = 64;
+
+        /**
+         * Max time a text waits for other texts to join its batch. A batch is dispatched once it's full or its oldest text has waited this long.
+         */
+        std::chrono::milliseconds max_delay {5};
+
+        /**
+         * Count of batches that can be in flight at the same time
+         */
+        size_t max_concurrent_batches = 4;
+    };
+
+    struct EmbeddingCoalescingStats {
+        uint64_t text_count = 0;
+        uint64_t batch_count = 0;
+    };
+
+    /**
+     * Decorator of embedding model which coalesces texts of concurrent `EmbedDocuments` and `EmbedQuery` calls from many threads into batches bounded by size and deadline, so that underlying model, e.g. `OllamaEmbedding` with `/api/embed`, is called once per batch rather than once per caller. Results are delivered back to each caller in order of its input.
+     */
+    class CoalescingEmbeddingModel final: public IEmbeddingModel {
+        using Clock = std::chrono::steady_clock;
+
+        struct PendingText {
+            std::string text;
+            std::promise<Embedding> promise;
+            Clock::time_point enqueued_at;
+        };
+
+        EmbeddingsPtr embeddings_;
+        EmbeddingCoalescingOptions options_;
+        std::deque<PendingText> queue_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopped_ = false;
+        std::vector<std::thread> workers_;
+        std::atomic<uint64_t> text_count_ = 0;
+        std::atomic<uint64_t> batch_count_ = 0;
+
+    public:
+        CoalescingEmbeddingModel(EmbeddingsPtr embeddings, const EmbeddingCoalescingOptions& options)
+            : embeddings_(std::move(embeddings)),
+              options_(options) {
+            assert_true(embeddings_, "should provide embedding model");
+            assert_positive(options_.max_batch_size, "max_batch_size should be positive");
+            assert_positive(options_.max_concurrent_batches, "max_concurrent_batches should be positive");
+            for (size_t i = 0; i < options_.max_concurrent_batches; ++i) {
+                workers_.emplace_back([&] { RunWorker_(); });
+            }
+        }
+
+        ~CoalescingEmbeddingModel() override {
+            {
+                std::lock_guard guard {mutex_};
+                stopped_ = true;
+            }
+            cv_.notify_all();
+            for (auto& worker: workers_) {
+                worker.join();
+            }
+        }
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            std::vector<std::future<Embedding>> futures;
+            futures.reserve(texts.size());
+            {
+                std::lock_guard guard {mutex_};
+                assert_true(!stopped_, "should not embed after model is stopped");
+                const auto now = Clock::now();
+                for (const auto& text: texts) {
+                    auto& pending = queue_.emplace_back(text, std::promise<Embedding> {}, now);
+                    futures.push_back(pending.promise.get_future());
+                }
+            }
+            cv_.notify_all();
+
+            std::vector<Embedding> result;
+            result.reserve(texts.size());
+            for (auto& future: futures) {
+                result.push_back(future.get());
+            }
+            return result;
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return EmbedDocuments({text}).front();
+        }
+
+        std::vector<Embedding> EmbedQueries(const std::vector<std::string>& texts) override {
+            return EmbedDocuments(texts);
+        }
+
+        size_t GetDimension() override {
+            return embeddings_->GetDimension();
+        }
+
+        [[nodiscard]] EmbeddingCoalescingStats GetStats() const {
+            return {.text_count = text_count_, .batch_count = batch_count_};
+        }
+
+    private:
+        void RunWorker_() {
+            std::unique_lock lock {mutex_};
+            while (true) {
+                cv_.wait(lock, [&] { return stopped_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    // stopped and drained
+                    return;
+                }
+                // wait for batch to be filled up until deadline of oldest text
+                const auto deadline = queue_.front().enqueued_at + options_.max_delay;
+                cv_.wait_until(lock, deadline, [&] { return stopped_ || queue_.size() >= options_.max_batch_size; });
+                if (queue_.empty()) {
+                    // taken by other workers
+                    continue;
+                }
+
+                std::vector<PendingText> batch;
+                const auto batch_size = std::min(queue_.size(), options_.max_batch_size);
+                batch.reserve(batch_size);
+                for (size_t i = 0; i < batch_size; ++i) {
+                    batch.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+                lock.unlock();
+                // other workers can start next batch
+                cv_.notify_all();
+                Dispatch_(batch);
+                lock.lock();
+            }
+        }
+
+        void Dispatch_(std::vector<PendingText>& batch) {
+            std::vector<std::string> texts;
+            texts.reserve(batch.size());
+            for (const auto& pending: batch) {
+                texts.push_back(pending.text);
+            }
+            LOG_DEBUG("Dispatch coalesced batch: batch.size()={}", batch.size());
+            try {
+                auto embeddings = embeddings_->EmbedDocuments(texts);
+                assert_true(embeddings.size() == batch.size(), "should have one embedding for each text");
+                ++batch_count_;
+                text_count_ += batch.size();
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    batch[i].promise.set_value(std::move(embeddings[i]));
+                }
+            } catch (...) {
+                const auto e = std::current_exception();
+                for (auto& pending: batch) {
+                    pending.promise.set_exception(e);
+                }
+            }
+        }
+    };
+
+    using CoalescingEmbeddingModelPtr = std::shared_ptr<CoalescingEmbeddingModel>;
+
+    static CoalescingEmbeddingModelPtr CreateCoalescingEmbeddingModel(const EmbeddingsPtr& embeddings, const EmbeddingCoalescingOptions& options = {}) {
+        return std::make_shared<CoalescingEmbeddingModel>(embeddings, options);
+    }
+}
+
+#endif //COALESCINGEMBEDDINGMODEL_HPP
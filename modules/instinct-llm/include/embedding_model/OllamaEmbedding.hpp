@@ -19,6 +19,8 @@ namespace INSTINCT_LLM_NS {
         HttpRestClient client_;
         OllamaConfiguration configuration_;
         ThreadPool thread_pool_;
+        // set when server doesn't provide `/api/embed`, e.g. Ollama older than 0.3.0
+        std::atomic<bool> batch_api_unsupported_ = false;
 
     public:
         explicit OllamaEmbedding(const OllamaConfiguration& configuration = {}):
@@ -27,10 +29,89 @@ namespace INSTINCT_LLM_NS {
         }
 
         std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
-            using namespace std::chrono_literals;
-            std::vector<Embedding> result;
             LOG_DEBUG("EmbedDocuments: input.size()={}", texts.size());
+            if (texts.empty()) {
+                return {};
+            }
+            if (configuration_.embedding_batch_size > 0 && !batch_api_unsupported_) {
+                try {
+                    return EmbedDocumentsInBatches_(texts);
+                } catch (const HttpClientException& e) {
+                    // unknown route is answered with plain text, while errors like missing model are answered with JSON containing `error`
+                    if (e.status_code_ != 404 || e.raw_response_.find("\"error\"") != std::string::npos) {
+                        throw;
+                    }
+                    LOG_WARN("{} is not available, fallback to {}", OLLAMA_BATCH_EMBEDDING_PATH, OLLAMA_EMBEDDING_PATH);
+                    batch_api_unsupported_ = true;
+                }
+            }
+            return EmbedDocumentsOneByOne_(texts);
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return EmbedDocuments({text}).front();
+        }
+
+        std::vector<Embedding> EmbedQueries(const std::vector<std::string>& texts) override {
+            return EmbedDocuments(texts);
+        }
+
+        size_t GetDimension() override {
+            // Ollama embedding cannot be configured with dimension
+            // see https://github.com/ollama/ollama/issues/651
+            return configuration_.dimension;
+        }
+
+    private:
+        /**
+         * Send texts in chunks of `embedding_batch_size` to `/api/embed`. Chunks are sent concurrently if `max_parallel` is positive.
+         */
+        std::vector<Embedding> EmbedDocumentsInBatches_(const std::vector<std::string>& texts) {
+            std::vector<OllamaBatchEmbeddingRequest> requests;
+            for (size_t i = 0; i < texts.size(); i += configuration_.embedding_batch_size) {
+                OllamaBatchEmbeddingRequest request;
+                request.set_model(configuration_.model_name);
+                const auto chunk_end = std::min(texts.size(), i + configuration_.embedding_batch_size);
+                for (size_t j = i; j < chunk_end; ++j) {
+                    request.add_input(texts[j]);
+                }
+                requests.push_back(std::move(request));
+            }
+
+            std::vector<OllamaBatchEmbeddingResponse> responses;
+            if (configuration_.max_parallel > 0 && requests.size() > 1) {
+                const auto batch = client_.CreatePostBatch<OllamaBatchEmbeddingRequest, OllamaBatchEmbeddingResponse>();
+                for (const auto& request: requests) {
+                    batch->Add(OLLAMA_BATCH_EMBEDDING_PATH, request);
+                }
+                auto futures = batch->Execute(thread_pool_);
+                WaitWithTimeout_(futures, texts.size());
+                responses = futures.get();
+            } else {
+                for (const auto& request: requests) {
+                    responses.push_back(client_.PostObject<OllamaBatchEmbeddingRequest, OllamaBatchEmbeddingResponse>(
+                        OLLAMA_BATCH_EMBEDDING_PATH, request));
+                }
+            }
+
+            std::vector<Embedding> result;
+            result.reserve(texts.size());
+            for (size_t i = 0; i < responses.size(); ++i) {
+                assert_true(responses[i].embeddings_size() == requests[i].input_size(), "should have one embedding for each input");
+                for (const auto& list_value: responses[i].embeddings()) {
+                    Embedding embedding;
+                    embedding.reserve(list_value.values_size());
+                    for (const auto& value: list_value.values()) {
+                        embedding.push_back(static_cast<float>(value.number_value()));
+                    }
+                    result.push_back(std::move(embedding));
+                }
+            }
+            return result;
+        }
 
+        std::vector<Embedding> EmbedDocumentsOneByOne_(const std::vector<std::string>& texts) {
+            std::vector<Embedding> result;
             if (configuration_.max_parallel > 0) {
                 const auto batch = client_.CreatePostBatch<OllamaEmbeddingRequest, OllamaEmbeddingResponse>();
                 for(const auto& text: texts) {
@@ -41,12 +122,7 @@ namespace INSTINCT_LLM_NS {
                 }
 
                 auto futures = batch->Execute(thread_pool_);
-                if (configuration_.embedding_timeout_factor > 0s) {
-                    // timeout control
-                    if (const auto timeout = configuration_.embedding_timeout_factor * texts.size(); !futures.wait_for(timeout)) {
-                        throw InstinctException(fmt::format("Embedding request timeout after {} seconds duration", timeout.count()));
-                    }
-                }
+                WaitWithTimeout_(futures, texts.size());
                 for(const auto& ollama_resp: futures.get()) {
                     result.emplace_back(ollama_resp.embedding().begin(), ollama_resp.embedding().end());
                 }
@@ -66,21 +142,14 @@ namespace INSTINCT_LLM_NS {
             return result;
         }
 
-        Embedding EmbedQuery(const std::string& text) override {
-            OllamaEmbeddingRequest request;
-                request.set_model(configuration_.model_name);
-                request.set_prompt(text);
-            // TODO handle model options
-                // request.mutable_options()->CopyFrom(configuration_->model_options());
-            const auto response = client_.PostObject<OllamaEmbeddingRequest, OllamaEmbeddingResponse>(
-                OLLAMA_EMBEDDING_PATH, request);
-            return {response.embedding().begin(), response.embedding().end()};
-        }
-
-        size_t GetDimension() override {
-            // Ollama embedding cannot be configured with dimension
-            // see https://github.com/ollama/ollama/issues/651
-            return configuration_.dimension;
+        template<typename T>
+        void WaitWithTimeout_(Futures<T>& futures, const size_t text_count) const {
+            if (configuration_.embedding_timeout_factor > 0s) {
+                // timeout control
+                if (const auto timeout = configuration_.embedding_timeout_factor * text_count; !futures.wait_for(timeout)) {
+                    throw InstinctException(fmt::format("Embedding request timeout after {} seconds duration", timeout.count()));
+                }
+            }
         }
     };
 
@@ -66,6 +66,10 @@ namespace INSTINCT_LLM_NS {
             return embedding;
         }
 
+        std::vector<Embedding> EmbedQueries(const std::vector<std::string>& texts) override {
+            return EmbedDocuments(texts);
+        }
+
         size_t GetDimension() override {
             return configuration_.dimension;
         }
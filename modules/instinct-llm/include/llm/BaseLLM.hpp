@@ -115,7 +115,7 @@ namespace INSTINCT_LLM_NS {
         auto prompt_value = input->RequireMessage<PromptValue>();
         const auto string_prompt = details::conv_prompt_value_variant_to_string(prompt_value);
         return model_->StreamGenerate(string_prompt)
-               | rpp::operators::map([&](const LangaugeModelResult &answer) {
+               | rpp::operators::map([](const LangaugeModelResult &answer) {
             auto ctx = CreateJSONContext();
             ctx->ProduceMessage(answer.generations(0));
             return ctx;
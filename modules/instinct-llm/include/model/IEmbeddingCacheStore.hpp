@@ -0,0 +1,36 @@
+#ifndef IEMBEDDINGCACHESTORE_HPP
+#define IEMBEDDINGCACHESTORE_HPP
+
+#include "LLMGlobals.hpp"
+
+namespace INSTINCT_LLM_NS {
+    using namespace INSTINCT_CORE_NS;
+
+    /**
+     * Persistent storage of embeddings keyed by content hash, which is used as second tier of `CachedEmbeddingModel`.
+     */
+    class IEmbeddingCacheStore {
+    public:
+        IEmbeddingCacheStore()=default;
+        virtual ~IEmbeddingCacheStore()=default;
+        IEmbeddingCacheStore(const IEmbeddingCacheStore&)=delete;
+        IEmbeddingCacheStore(IEmbeddingCacheStore&&)=delete;
+
+        /**
+         * Get embeddings of given keys
+         * @param keys
+         * @return embeddings found. Missing keys are absent in returned map.
+         */
+        virtual std::unordered_map<std::string, Embedding> MultiGet(const std::vector<std::string>& keys) = 0;
+
+        /**
+         * Save embeddings. Existing entries are kept, as embeddings of the same key are expected to be identical.
+         * @param entries
+         */
+        virtual void MultiPut(const std::vector<std::pair<std::string, Embedding>>& entries) = 0;
+    };
+
+    using EmbeddingCacheStorePtr = std::shared_ptr<IEmbeddingCacheStore>;
+}
+
+#endif //IEMBEDDINGCACHESTORE_HPP
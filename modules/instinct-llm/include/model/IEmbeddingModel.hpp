@@ -19,6 +19,21 @@ namespace INSTINCT_LLM_NS {
         IEmbeddingModel(IEmbeddingModel&&)=delete;
         virtual std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) = 0;
         virtual Embedding EmbedQuery(const std::string& text) = 0;
+
+        /**
+         * Embed many queries at once. Default implementation calls `EmbedQuery` for each of them, and models that embed queries the same way as documents should override it with a single batched call.
+         * @param texts
+         * @return embeddings in order of `texts`
+         */
+        virtual std::vector<Embedding> EmbedQueries(const std::vector<std::string>& texts) {
+            std::vector<Embedding> result;
+            result.reserve(texts.size());
+            for (const auto& text: texts) {
+                result.push_back(EmbedQuery(text));
+            }
+            return result;
+        }
+
         virtual size_t GetDimension() = 0;
     };
 
@@ -16,6 +16,22 @@ namespace INSTINCT_LLM_NS {
         IRankingModel(IRankingModel&&)=delete;
 
         virtual float GetRankingScore(const std::string& query, const std::string& doc) = 0;
+
+        /**
+         * Score a batch of documents against the same query.
+         * @param query
+         * @param docs
+         * @return scores in the same order of `docs`
+         */
+        virtual std::vector<float> GetRankingScores(const std::string& query, const std::vector<std::string>& docs) = 0;
+
+        /**
+         * Max count of calls that are actually evaluated at the same time. Callers shouldn't split documents into more blocks than this to score them in parallel, as extra calls only queue up.
+         * @return 1 by default, i.e. calls are serialized
+         */
+        [[nodiscard]] virtual size_t GetMaxConcurrency() const {
+            return 1;
+        }
     };
 
 }
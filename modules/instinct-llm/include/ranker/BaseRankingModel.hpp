@@ -23,6 +23,15 @@ namespace INSTINCT_LLM_NS {
         float Invoke(const QAPair &input) override {
             return this->GetRankingScore(input.query, input.doc);
         }
+
+        std::vector<float> GetRankingScores(const std::string &query, const std::vector<std::string> &docs) override {
+            std::vector<float> scores;
+            scores.reserve(docs.size());
+            for (const auto& doc: docs) {
+                scores.push_back(this->GetRankingScore(query, doc));
+            }
+            return scores;
+        }
     };
 
     using RankingModelPtr = std::shared_ptr<BaseRankingModel>;
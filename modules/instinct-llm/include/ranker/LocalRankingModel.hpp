@@ -5,6 +5,8 @@
 #ifndef LOCALRANKINGMODEL_HPP
 #define LOCALRANKINGMODEL_HPP
 
+#include <condition_variable>
+
 #include "./BaseRankingModel.hpp"
 #include "model.hpp"
 #include "model_factory.hpp"
@@ -13,27 +15,113 @@
 namespace INSTINCT_LLM_NS {
     using namespace  INSTINCT_TRANSFORMER_NS;
 
+    struct LocalRankingModelOptions {
+        /**
+         * Count of model instances. Instances share memory-mapped weights, but each of them holds its own compute buffers, so it's the upper bound of concurrent inferences. Raise it only if callers score in parallel, e.g. `MultiPathRetriever` with a multi-threaded pool, which splits documents into blocks only if there is more than one instance.
+         */
+        size_t instance_count = 1;
+
+        /**
+         * Max count of QA pairs to be evaluated in a single forward pass
+         */
+        size_t max_batch_size = 8;
+
+        /**
+         * Max count of tokens in a single forward pass
+         */
+        int max_batch_tokens = 512;
+
+        /**
+         * Threads used by each inference. Zero means ggml's default.
+         */
+        int num_threads = 0;
+    };
+
     /**
      * This class uses models in `instinct-transformer` module
      */
     class LocalRankingModel final: public BaseRankingModel {
         transformer::tokenizer::TokenizerPtr tokenizer_;
-        ModelPtr model_;
-        std::mutex run_mutex_;
+        LocalRankingModelOptions options_;
+        GenerationConfig generation_config_;
+        std::vector<ModelPtr> idle_models_;
+        std::mutex pool_mutex_;
+        std::condition_variable pool_cv_;
+
+        /**
+         * RAII handle of a model instance borrowed from pool
+         */
+        class ModelLease_ {
+            LocalRankingModel* owner_;
+            ModelPtr model_;
+        public:
+            explicit ModelLease_(LocalRankingModel* owner): owner_(owner) {
+                std::unique_lock lock {owner_->pool_mutex_};
+                owner_->pool_cv_.wait(lock, [&] { return !owner_->idle_models_.empty(); });
+                model_ = std::move(owner_->idle_models_.back());
+                owner_->idle_models_.pop_back();
+            }
+
+            ~ModelLease_() {
+                {
+                    std::lock_guard lock {owner_->pool_mutex_};
+                    owner_->idle_models_.push_back(std::move(model_));
+                }
+                owner_->pool_cv_.notify_one();
+            }
+
+            ModelLease_(const ModelLease_&)=delete;
+            ModelLease_& operator=(const ModelLease_&)=delete;
+
+            BaseModel* operator->() const {
+                return model_.get();
+            }
+        };
+
     public:
-        explicit LocalRankingModel(const ModelType model_type, const FileVaultPtr& file_vault) {
+        explicit LocalRankingModel(const ModelType model_type, const FileVaultPtr& file_vault, const LocalRankingModelOptions& options = {}):
+            options_(options),
+            generation_config_({.num_threads = options.num_threads, .max_batch_tokens = options.max_batch_tokens}) {
+            assert_positive(options_.instance_count, "should have at least one model instance");
+            assert_positive(options_.max_batch_size, "max_batch_size should be positive");
             const auto resource_name = "model_bins/" + to_file_name(model_type);
             const auto entry = file_vault->GetResource(resource_name).get();
-            std::tie(model_, tokenizer_) = ModelFactory::GetInstance().load(entry.local_path);
+            for (size_t i = 0; i < options_.instance_count; ++i) {
+                auto [model, tokenizer] = ModelFactory::GetInstance().load(entry.local_path);
+                idle_models_.push_back(std::move(model));
+                // tokenizer is stateless after loading
+                if (!tokenizer_) tokenizer_ = std::move(tokenizer);
+            }
         }
 
         float GetRankingScore(const std::string &query, const std::string &doc) override {
-            // TODO remove this lock by using multi-instance or batching.
-            std::lock_guard guard {run_mutex_};
-            constexpr GenerationConfig config {};
             std::vector<int> ids;
             this->tokenizer_->encode_qa(query, doc, ids);
-            return this->model_->qa_rank(config, ids);
+            const ModelLease_ model {this};
+            return model->qa_rank(generation_config_, ids);
+        }
+
+        /**
+         * Calls beyond count of model instances wait for an idle instance
+         */
+        [[nodiscard]] size_t GetMaxConcurrency() const override {
+            return options_.instance_count;
+        }
+
+        std::vector<float> GetRankingScores(const std::string &query, const std::vector<std::string> &docs) override {
+            std::vector<float> scores;
+            scores.reserve(docs.size());
+            std::vector<std::vector<int>> batch;
+            for (size_t i = 0; i < docs.size(); i += options_.max_batch_size) {
+                const auto n = std::min(options_.max_batch_size, docs.size() - i);
+                batch.assign(n, {});
+                for (size_t j = 0; j < n; ++j) {
+                    this->tokenizer_->encode_qa(query, docs[i + j], batch[j]);
+                }
+                const ModelLease_ model {this};
+                model->qa_rank_batch(generation_config_, batch, scores);
+            }
+            return scores;
         }
     };
 
@@ -48,9 +136,9 @@ namespace INSTINCT_LLM_NS {
         }
     }
 
-    static RankingModelPtr CreateLocalRankingModel(const ModelType model_type, const FileVaultPtr& file_vault = DEFAULT_FILE_VAULT) {
+    static RankingModelPtr CreateLocalRankingModel(const ModelType model_type, const FileVaultPtr& file_vault = DEFAULT_FILE_VAULT, const LocalRankingModelOptions& options = {}) {
         PreloadRankingModelFiles(file_vault);
-        return std::make_shared<LocalRankingModel>(model_type, file_vault);
+        return std::make_shared<LocalRankingModel>(model_type, file_vault, options);
     }
 
 }
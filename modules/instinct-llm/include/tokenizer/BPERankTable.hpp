@@ -0,0 +1,203 @@
+#ifndef INSTINCT_BPERANKTABLE_HPP
+#define INSTINCT_BPERANKTABLE_HPP
+
+#include <bit>
+#include <queue>
+
+#include "Tokenizer.hpp"
+
+namespace INSTINCT_LLM_NS {
+
+    /**
+     * Read-only hash table of merge ranks for byte pairs, using open addressing with linear probing over a flat array. A pair is packed into a single 64-bit key, so a lookup costs a multiplication and a few cache-friendly probes, instead of hashing into buckets of `tsl::ordered_map`.
+     */
+    class BPERankTable final {
+        static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+        struct Slot {
+            uint64_t key = EMPTY_KEY;
+            int32_t rank = -1;
+        };
+
+        std::vector<Slot> slots_;
+        uint64_t mask_ = 0;
+        size_t size_ = 0;
+
+    public:
+        static constexpr int32_t NOT_FOUND = -1;
+
+        BPERankTable() = default;
+
+        explicit BPERankTable(const BPERanks& bpe_ranks) {
+            // keep load factor under 0.5
+            const size_t capacity = std::bit_ceil(std::max<size_t>(16, bpe_ranks.size() * 2));
+            slots_.resize(capacity);
+            mask_ = capacity - 1;
+            for (const auto& [pair, rank]: bpe_ranks) {
+                Insert_(Pack_(pair.first, pair.second), rank);
+            }
+        }
+
+        /**
+         * Get rank of given pair
+         * @param first
+         * @param second
+         * @return rank of merged token, or `NOT_FOUND` if pair is not mergeable
+         */
+        [[nodiscard]] int32_t Find(const int32_t first, const int32_t second) const {
+            if (size_ == 0) {
+                return NOT_FOUND;
+            }
+            const uint64_t key = Pack_(first, second);
+            for (uint64_t i = Hash_(key) & mask_; ; i = (i + 1) & mask_) {
+                const auto& slot = slots_[i];
+                if (slot.key == key) {
+                    return slot.rank;
+                }
+                if (slot.key == EMPTY_KEY) {
+                    return NOT_FOUND;
+                }
+            }
+        }
+
+        [[nodiscard]] size_t Size() const {
+            return size_;
+        }
+
+    private:
+        static uint64_t Pack_(const int32_t first, const int32_t second) {
+            return static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32 | static_cast<uint32_t>(second);
+        }
+
+        static uint64_t Hash_(uint64_t key) {
+            // finalizer of splitmix64
+            key ^= key >> 30;
+            key *= 0xbf58476d1ce4e5b9ULL;
+            key ^= key >> 27;
+            key *= 0x94d049bb133111ebULL;
+            key ^= key >> 31;
+            return key;
+        }
+
+        void Insert_(const uint64_t key, const int32_t rank) {
+            for (uint64_t i = Hash_(key) & mask_; ; i = (i + 1) & mask_) {
+                auto& slot = slots_[i];
+                if (slot.key == key) {
+                    slot.rank = rank;
+                    return;
+                }
+                if (slot.key == EMPTY_KEY) {
+                    slot.key = key;
+                    slot.rank = rank;
+                    ++size_;
+                    return;
+                }
+            }
+        }
+    };
+
+    namespace details {
+
+        /**
+         * Apply BPE merges to `ids` in place, by merging the pair with lowest rank repeatedly until no pair is mergeable. This is the reference implementation which recomputes all pair statistics in each iteration, so it's O(n^2) in length of `ids`.
+         */
+        static void bpe_merge_with_pair_stats(std::vector<int32_t>& ids, BPERanks& merges) {
+            while (ids.size()>=2) {
+                auto stats = compute_pairs_state(ids);
+                int32_t min_idx = INT32_MAX;
+                auto min_entry = stats.end();
+                for(auto itr=stats.begin();itr!=stats.end();++itr) {
+                    if(merges.contains(itr->first)) {
+                        auto cur_idx = merges[itr->first];
+                        if (cur_idx < min_idx) {
+                            min_idx = cur_idx;
+                            min_entry = itr;
+                        }
+                    }
+                }
+                if (min_entry==stats.end()) {// no mergeable found
+                    break;
+                }
+                auto idx = merges[min_entry->first];
+                merge_u32_ids(ids, min_entry->first, idx);
+            }
+        }
+
+        /**
+         * Apply BPE merges to `ids` in place, which produces exactly the same result as `bpe_merge_with_pair_stats` in O(n log n).
+         *
+         * Symbols are kept in a doubly linked list over an array, and candidate pairs are kept in a min-heap ordered by (rank, position). Heap entries are invalidated lazily: an entry is skipped if either side of the pair has been merged since it was pushed. As rank of a merged token is always greater than ranks of its parts, ties on rank are resolved from left to right, same as the reference implementation.
+         */
+        static void bpe_merge_with_rank_heap(std::vector<int32_t>& ids, const BPERankTable& ranks) {
+            const auto n = static_cast<int32_t>(ids.size());
+            if (n < 2) {
+                return;
+            }
+
+            struct Symbol {
+                int32_t id;
+                int32_t prev;
+                int32_t next;
+            };
+            struct Candidate {
+                int32_t rank;
+                int32_t left;
+                int32_t right;
+                int32_t left_id;
+                int32_t right_id;
+
+                bool operator>(const Candidate& other) const {
+                    return rank != other.rank ? rank > other.rank : left > other.left;
+                }
+            };
+
+            std::vector<Symbol> symbols(n);
+            for (int32_t i = 0; i < n; ++i) {
+                symbols[i] = {ids[i], i - 1, i + 1 < n ? i + 1 : -1};
+            }
+
+            std::vector<Candidate> heap_storage;
+            heap_storage.reserve(n);
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> heap {std::greater<>{}, std::move(heap_storage)};
+            const auto try_push = [&](const int32_t left, const int32_t right) {
+                if (left < 0 || right < 0) {
+                    return;
+                }
+                if (const int32_t rank = ranks.Find(symbols[left].id, symbols[right].id); rank != BPERankTable::NOT_FOUND) {
+                    heap.push({rank, left, right, symbols[left].id, symbols[right].id});
+                }
+            };
+
+            for (int32_t i = 0; i + 1 < n; ++i) {
+                try_push(i, i + 1);
+            }
+
+            while (!heap.empty()) {
+                const auto candidate = heap.top();
+                heap.pop();
+                auto& left = symbols[candidate.left];
+                // stale entry
+                if (left.id != candidate.left_id || left.next != candidate.right || symbols[candidate.right].id != candidate.right_id) {
+                    continue;
+                }
+                auto& right = symbols[candidate.right];
+                left.id = candidate.rank;
+                left.next = right.next;
+                if (right.next >= 0) {
+                    symbols[right.next].prev = candidate.left;
+                }
+                // mark removed
+                right.id = -1;
+                try_push(left.prev, candidate.left);
+                try_push(candidate.left, left.next);
+            }
+
+            ids.clear();
+            for (int32_t i = 0; i >= 0; i = symbols[i].next) {
+                ids.push_back(symbols[i].id);
+            }
+        }
+    }
+}
+
+#endif //INSTINCT_BPERANKTABLE_HPP
@@ -0,0 +1,163 @@
+#ifndef INSTINCT_GPT4PRETOKENIZER_HPP
+#define INSTINCT_GPT4PRETOKENIZER_HPP
+
+#include <unicode/uchar.h>
+#include <unicode/utf16.h>
+
+#include "Tokenizer.hpp"
+
+namespace INSTINCT_LLM_NS {
+
+    /**
+     * Split pattern of `cl100k_base`
+     */
+    static const std::string GPT4_SPLIT_PATTERN = R"""('(?i:[sdmt]|ll|ve|re)|[^\r\n\p{L}\p{N}]?+\p{L}+|\p{N}{1,3}| ?[^\s\p{L}\p{N}]++[\r\n]*|\s*[\r\n]|\s+(?!\S)|\s+)""";
+
+    namespace details {
+
+        static bool is_pretokenizer_letter(const UChar32 c) {
+            return U_GET_GC_MASK(c) & U_GC_L_MASK;
+        }
+
+        static bool is_pretokenizer_number(const UChar32 c) {
+            return U_GET_GC_MASK(c) & U_GC_N_MASK;
+        }
+
+        static bool is_pretokenizer_space(const UChar32 c) {
+            // same as `\s` in ICU regex
+            return u_hasBinaryProperty(c, UCHAR_WHITE_SPACE);
+        }
+
+        static bool is_pretokenizer_newline(const UChar32 c) {
+            return c == '\r' || c == '\n';
+        }
+
+        /**
+         * Find end of the token starting at `start`, as if it's matched by `GPT4_SPLIT_PATTERN`. Each branch below corresponds to an alternative in the pattern, and they are tried in the same order.
+         */
+        static int32_t gpt4_match_token(const char16_t* s, const int32_t n, const int32_t start) {
+            const auto next = [&](int32_t i, UChar32& c) {
+                U16_NEXT(s, i, n, c);
+                return i;
+            };
+            const auto skip_while = [&](int32_t i, auto&& predicate) {
+                while (i < n) {
+                    UChar32 c;
+                    const int32_t j = next(i, c);
+                    if (!predicate(c)) {
+                        break;
+                    }
+                    i = j;
+                }
+                return i;
+            };
+            const auto is_punctuation = [](const UChar32 c) {
+                return !is_pretokenizer_space(c) && !is_pretokenizer_letter(c) && !is_pretokenizer_number(c);
+            };
+
+            UChar32 c;
+            const int32_t i = next(start, c);
+
+            // '(?i:[sdmt]|ll|ve|re)
+            if (c == '\'' && i < n) {
+                UChar32 c1, c2;
+                const int32_t j = next(i, c1);
+                c1 = u_foldCase(c1, U_FOLD_CASE_DEFAULT);
+                if (c1 == 's' || c1 == 'd' || c1 == 'm' || c1 == 't') {
+                    return j;
+                }
+                if (j < n) {
+                    const int32_t k = next(j, c2);
+                    c2 = u_foldCase(c2, U_FOLD_CASE_DEFAULT);
+                    if ((c1 == 'l' && c2 == 'l') || (c1 == 'v' && c2 == 'e') || (c1 == 'r' && c2 == 'e')) {
+                        return k;
+                    }
+                }
+            }
+
+            // [^\r\n\p{L}\p{N}]?+\p{L}+
+            if (is_pretokenizer_letter(c)) {
+                return skip_while(i, is_pretokenizer_letter);
+            }
+            if (!is_pretokenizer_newline(c) && !is_pretokenizer_number(c) && i < n) {
+                UChar32 c1;
+                if (const int32_t j = next(i, c1); is_pretokenizer_letter(c1)) {
+                    return skip_while(j, is_pretokenizer_letter);
+                }
+            }
+
+            // \p{N}{1,3}
+            if (is_pretokenizer_number(c)) {
+                int32_t j = i;
+                for (int count = 1; count < 3 && j < n; ++count) {
+                    UChar32 c1;
+                    const int32_t k = next(j, c1);
+                    if (!is_pretokenizer_number(c1)) {
+                        break;
+                    }
+                    j = k;
+                }
+                return j;
+            }
+
+            // ?[^\s\p{L}\p{N}]++[\r\n]*
+            int32_t punctuation_start = -1;
+            if (is_punctuation(c)) {
+                punctuation_start = start;
+            } else if (c == ' ' && i < n) {
+                UChar32 c1;
+                next(i, c1);
+                if (is_punctuation(c1)) {
+                    punctuation_start = i;
+                }
+            }
+            if (punctuation_start >= 0) {
+                return skip_while(skip_while(punctuation_start, is_punctuation), is_pretokenizer_newline);
+            }
+
+            // c is white space for now
+            int32_t end = start, last_space_start = start, last_newline_end = -1;
+            while (end < n) {
+                UChar32 c1;
+                const int32_t j = next(end, c1);
+                if (!is_pretokenizer_space(c1)) {
+                    break;
+                }
+                if (is_pretokenizer_newline(c1)) {
+                    last_newline_end = j;
+                }
+                last_space_start = end;
+                end = j;
+            }
+            // \s*[\r\n]
+            if (last_newline_end > 0) {
+                return last_newline_end;
+            }
+            // \s+(?!\S)
+            if (end == n) {
+                return end;
+            }
+            if (last_space_start > start) {
+                return last_space_start;
+            }
+            // \s+
+            return end;
+        }
+
+        /**
+         * Hand-written equivalent of `find_all_with_regex(text, GPT4_SPLIT_PATTERN, result)`, which scans code points directly without ICU regex engine.
+         */
+        static void gpt4_pretokenize(const UnicodeString& text, std::vector<UnicodeString>& result) {
+            const char16_t* s = text.getBuffer();
+            const int32_t n = text.length();
+            for (int32_t i = 0; i < n;) {
+                const int32_t end = gpt4_match_token(s, n, i);
+                result.push_back(text.tempSubStringBetween(i, end));
+                i = end;
+            }
+        }
+    }
+
+}
+
+#endif //INSTINCT_GPT4PRETOKENIZER_HPP
@@ -11,42 +11,100 @@
 #include <unordered_set>
 #include <utility>
 
+#include "BPERankTable.hpp"
+#include "GPT4Pretokenizer.hpp"
+#include "tools/LRUCache.hpp"
+#include "tools/RegexMatcherPool.hpp"
 #include "tools/StringUtils.hpp"
 
 
 namespace INSTINCT_LLM_NS {
     using namespace INSTINCT_CORE_NS;
 
+    struct RegexTokenizerOptions {
+        /**
+         * Max count of chunks whose token ids are cached. Set to zero to disable cache.
+         */
+        size_t chunk_cache_size = 16384;
+
+        /**
+         * Chunks longer than this in UTF-8 bytes are not cached, as long chunks are rarely repeated.
+         */
+        size_t max_cached_chunk_length = 64;
+
+        /**
+         * Split text with a hand-written scanner instead of ICU regex engine, if split pattern is `GPT4_SPLIT_PATTERN`. Ignored for other patterns.
+         */
+        bool fast_gpt4_pretokenizer = false;
+    };
 
 
     class RegexTokenizer: public Tokenizer {
+        /**
+         * Compiled pattern for a subset of special tokens, which is allowed by `kSome` in encode options
+         */
+        struct AllowedSpecials_ {
+            StringIDDict specials;
+            RegexMatcherPoolPtr matchers;
+        };
+        using AllowedSpecialsPtr = std::shared_ptr<AllowedSpecials_>;
+        // callers tend to pass the same few subsets of special tokens
+        static constexpr size_t ALLOWED_SPECIALS_CACHE_SIZE = 16;
+
         BPERanks merges_;
+        BPERankTable rank_table_;
+        LRUCache<Bytes, std::vector<int32_t>> chunk_cache_;
+        RegexTokenizerOptions options_;
         Vocab vocab_{};
         UnicodeString regexp_pattern_{};
         StringIDDict special_tokens_{};
         ReversedStringIDDict reversed_special_tokens_{};
+        // compiled patterns are shared by all calls to `Encode`
+        RegexMatcherPoolPtr split_matchers_;
+        RegexMatcherPoolPtr special_matchers_;
+        // keyed by sorted tokens of each subset
+        LRUCache<std::string, AllowedSpecialsPtr> allowed_specials_cache_ {ALLOWED_SPECIALS_CACHE_SIZE};
+        bool fast_pretokenize_ = false;
 
     public:
         RegexTokenizer()=delete;
-        RegexTokenizer(UnicodeString regexp_string, const StringIDDict& special_tokens): regexp_pattern_(std::move(regexp_string)) {
+        RegexTokenizer(UnicodeString regexp_string, const StringIDDict& special_tokens, const RegexTokenizerOptions& options = {}):
+            chunk_cache_(options.chunk_cache_size), options_(options), regexp_pattern_(std::move(regexp_string)) {
+            InitSplitPattern_();
             RegisterSpecials(special_tokens);
         }
-        RegexTokenizer(BPERanks bpe_ranks, Vocab vocab, UnicodeString  regexp_string, const StringIDDict& special_tokens):  merges_(std::move(bpe_ranks)), vocab_(std::move(vocab)), regexp_pattern_(std::move(regexp_string)) {
+        RegexTokenizer(BPERanks bpe_ranks, Vocab vocab, UnicodeString  regexp_string, const StringIDDict& special_tokens, const RegexTokenizerOptions& options = {}):
+            merges_(std::move(bpe_ranks)), rank_table_(merges_), chunk_cache_(options.chunk_cache_size), options_(options), vocab_(std::move(vocab)), regexp_pattern_(std::move(regexp_string)) {
+            InitSplitPattern_();
             // initialize revsered speicial tokens
             RegisterSpecials(special_tokens);
         }
 
+        /**
+         * Register special tokens. This is not thread-safe and should be done before any call to `Encode`.
+         * @param special_tokens
+         */
         void RegisterSpecials(const StringIDDict& special_tokens) {
             for (const auto&[token,id]: special_tokens) {
                 special_tokens_[token] = id;
                 reversed_special_tokens_[id] = token;
             }
+            special_matchers_ = special_tokens_.empty() ? nullptr : CreateSpecialMatchers_(special_tokens_ | std::views::keys);
+            allowed_specials_cache_.Clear();
         }
 
         Vocab& GetVocab() {
             return vocab_;
         }
 
+        [[nodiscard]] const BPERanks& GetBPERanks() const {
+            return merges_;
+        }
+
+        [[nodiscard]] CacheStats GetChunkCacheStats() const {
+            return chunk_cache_.GetStats();
+        }
+
         UnicodeString Decode(const std::vector<int32_t>& ids) override {
             return UnicodeString::fromUTF8(Decode_(ids));
         }
@@ -56,48 +114,34 @@ namespace INSTINCT_LLM_NS {
         }
 
         std::vector<int32_t> Encode(const UnicodeString& text, const TokenizerEncodeOptions& options) override {
-            StringIDDict specials;
             switch (options.allow_special) {
                 case kAll:
-                    specials = special_tokens_;
-                break;
+                    if (special_matchers_) {
+                        return EncodeWithSpecials_(text, *special_matchers_, special_tokens_);
+                    }
+                    break;
                 case kNone:
                     break;
                 case kNoneRaise:
-                    for(const auto& token: special_tokens_ | std::views::keys) {
-                        if(text.indexOf(token) > -1) {
+                    if (special_matchers_) {
+                        const auto matcher = special_matchers_->Acquire();
+                        matcher->reset(text);
+                        if (matcher->find()) {
                             throw InstinctException("special token not allowed in text");
                         }
                     }
-                break;
-                case kSome:
-                    for(const auto& token: options.specials) {
-                        specials.emplace(token, special_tokens_[token]);
+                    break;
+                case kSome: {
+                    if (options.specials.empty()) {
+                        break;
                     }
+                    const auto allowed = GetAllowedSpecials_(options.specials);
+                    return EncodeWithSpecials_(text, *allowed->matchers, allowed->specials);
+                }
                 case kUnspecified:
                     throw InstinctException("allowd_special unspecified");
             }
-            if(specials.empty()) {
-                return EncodeOrdinary_(text);
-            }
-            const auto pattern_string = "(" + details::join_with_seperator(
-                "|",
-                specials | std::views::keys | std::views::transform([](const auto& s) {return details::escape_for_regular_expression(s);})
-                ) + ")";
-
-
-            std::vector<UnicodeString> chunks;
-            U32StringUtils::SplitWithRegex(text, pattern_string, chunks);
-            std::vector<int32_t> result;
-            for(const auto& chunk: chunks) {
-                if(specials.contains(chunk)) {
-                    result.push_back(specials[chunk]);
-                } else {
-                    auto chunk_result = EncodeOrdinary_(chunk);
-                    result.insert(result.end(), chunk_result.begin(), chunk_result.end());
-                }
-            }
-            return result;
+            return EncodeOrdinary_(text);
         }
 
         void Train(const UnicodeString& text, int vocab_size) override {
@@ -112,7 +156,7 @@ namespace INSTINCT_LLM_NS {
             // });
             // auto ids = std::vector{ids_view.begin(), ids_view.end()};
             std::vector<UnicodeString> splits;
-            details::find_all_with_regex(text, regexp_pattern_, splits);
+            Split_(text, splits);
 
             std::vector<std::vector<int32_t>> ids;
             for(const auto& chunk: splits) {
@@ -146,7 +190,9 @@ namespace INSTINCT_LLM_NS {
                 vocab[idx] = vocab[pair.first] + vocab[pair.second];
             }
             this->merges_ = std::move(merges);
+            this->rank_table_ = BPERankTable {this->merges_};
             this->vocab_ = std::move(vocab);
+            this->chunk_cache_.Clear();
         }
 
 
@@ -171,7 +217,7 @@ namespace INSTINCT_LLM_NS {
             std::vector<int32_t> result;
 
             std::vector<UnicodeString> text_chunks;
-            details::find_all_with_regex(text, regexp_pattern_, text_chunks);
+            Split_(text, text_chunks);
 
             for(const auto& chunk: text_chunks) {
                 Bytes buf;
@@ -182,34 +228,106 @@ namespace INSTINCT_LLM_NS {
             return result;
         }
 
+        void InitSplitPattern_() {
+            fast_pretokenize_ = options_.fast_gpt4_pretokenizer && regexp_pattern_ == UnicodeString::fromUTF8(GPT4_SPLIT_PATTERN);
+            split_matchers_ = std::make_shared<RegexMatcherPool>(regexp_pattern_);
+        }
+
+        void Split_(const UnicodeString& text, std::vector<UnicodeString>& chunks) const {
+            if (fast_pretokenize_) {
+                details::gpt4_pretokenize(text, chunks);
+                return;
+            }
+            const auto matcher = split_matchers_->Acquire();
+            details::find_all_with_regex(text, *matcher, chunks);
+        }
+
+        static RegexMatcherPoolPtr CreateSpecialMatchers_(const std::ranges::input_range auto& tokens) {
+            const auto pattern_string = "(" + details::join_with_seperator(
+                "|",
+                tokens | std::views::transform([](const auto& s) {return details::escape_for_regular_expression(s);})
+                ) + ")";
+            return std::make_shared<RegexMatcherPool>(pattern_string);
+        }
+
+        /**
+         * Get compiled pattern for given subset of special tokens, which is only compiled on first use of that subset
+         */
+        AllowedSpecialsPtr GetAllowedSpecials_(const std::ranges::input_range auto& tokens) {
+            std::vector<std::string> keys;
+            for (const auto& token: tokens) {
+                keys.push_back(details::conv_to_utf8_string(token));
+            }
+            std::ranges::sort(keys);
+            keys.erase(std::ranges::unique(keys).begin(), keys.end());
+            const auto cache_key = StringUtils::JoinWith(keys, std::string(1, '\0'));
+            if (auto cached = allowed_specials_cache_.Get(cache_key)) {
+                return cached.value();
+            }
+            auto allowed = std::make_shared<AllowedSpecials_>();
+            for(const auto& token: tokens) {
+                const auto itr = special_tokens_.find(token);
+                if (itr == special_tokens_.end()) {
+                    throw InstinctException("unknown special token: " + details::conv_to_utf8_string(token));
+                }
+                allowed->specials.emplace(token, itr->second);
+            }
+            allowed->matchers = CreateSpecialMatchers_(allowed->specials | std::views::keys);
+            allowed_specials_cache_.Put(cache_key, allowed);
+            return allowed;
+        }
+
+        /**
+         * Encode text segments between special tokens as ordinary text, and special tokens with their ids
+         */
+        std::vector<int32_t> EncodeWithSpecials_(const UnicodeString& text, RegexMatcherPool& special_matchers, const StringIDDict& specials) {
+            std::vector<int32_t> result;
+            const auto matcher = special_matchers.Acquire();
+            matcher->reset(text);
+            UErrorCode status = U_ZERO_ERROR;
+            int32_t last_end = 0;
+            const auto encode_ordinary = [&](const int32_t start, const int32_t end) {
+                if (start < end) {
+                    const auto ids = EncodeOrdinary_(text.tempSubStringBetween(start, end));
+                    result.insert(result.end(), ids.begin(), ids.end());
+                }
+            };
+            while (matcher->find()) {
+                const int32_t start = matcher->start(status);
+                const int32_t end = matcher->end(status);
+                if(U_FAILURE(status)) {
+                    throw InstinctException("Failed to match special tokens during encoding");
+                }
+                encode_ordinary(last_end, start);
+                result.push_back(specials.at(text.tempSubStringBetween(start, end)));
+                last_end = end;
+            }
+            encode_ordinary(last_end, text.length());
+            return result;
+        }
+
         virtual void HandleChunkBytes_(Bytes& text_bytes) {}
 
         std::vector<int32_t> EncodeChunk_(Bytes& text_bytes) {
+            // cache is keyed by original bytes, so that a hit skips `HandleChunkBytes_` as well
+            const bool cacheable = text_bytes.size() <= options_.max_cached_chunk_length;
+            if (cacheable) {
+                if (auto cached = chunk_cache_.Get(text_bytes)) {
+                    return std::move(cached.value());
+                }
+            }
+            Bytes chunk_bytes = cacheable ? text_bytes : std::move(text_bytes);
             // give subclass changes to alter `text_bytes`
-            HandleChunkBytes_(text_bytes);
+            HandleChunkBytes_(chunk_bytes);
             std::vector<int32_t> ids;
-            for(const auto &c: text_bytes) {
+            ids.reserve(chunk_bytes.size());
+            for(const auto &c: chunk_bytes) {
                 // from [-128,128) to [0,256)
                 ids.push_back(static_cast<u_int8_t>(c));
             }
-            while (ids.size()>=2) {
-                auto stats = details::compute_pairs_state(ids);
-                int32_t min_idx = INT32_MAX;
-                auto min_entry = stats.end();
-                for(auto itr=stats.begin();itr!=stats.end();++itr) {
-                    if(merges_.contains(itr->first)) {
-                        auto cur_idx = merges_[itr->first];
-                        if (cur_idx < min_idx) {
-                            min_idx = cur_idx;
-                            min_entry = itr;
-                        }
-                    }
-                }
-                if (min_entry==stats.end()) {// no mergeable found
-                    break;
-                }
-                auto idx = merges_[min_entry->first];
-                details::merge_u32_ids(ids, min_entry->first, idx);
+            details::bpe_merge_with_rank_heap(ids, rank_table_);
+            if (cacheable) {
+                chunk_cache_.Put(text_bytes, ids);
             }
             return ids;
         }
@@ -5,6 +5,7 @@
 #ifndef TIKTOKENTOKENIZER_HPP
 #define TIKTOKENTOKENIZER_HPP
 
+#include <array>
 #include <filesystem>
 #include "RegexTokenizer.hpp"
 #include <ranges>
@@ -67,22 +68,27 @@ namespace INSTINCT_LLM_NS {
     class TiktokenTokenizer final: public RegexTokenizer {
         ByteShuffle byte_shuffle_;
         ByteShuffle reversed_byte_shuffle_;
+        // flat copy of `byte_shuffle_` for fast lookup during encoding
+        std::array<char, 256> byte_shuffle_table_ {};
 
     public:
         TiktokenTokenizer(BPERanks bpe_ranks, Vocab vocab, const UnicodeString& regexp_string,
-            const StringIDDict& special_tokens, ByteShuffle byte_shuffle)
-            : RegexTokenizer(std::move(bpe_ranks), std::move(vocab), regexp_string, special_tokens),
+            const StringIDDict& special_tokens, ByteShuffle byte_shuffle, const RegexTokenizerOptions& options = {})
+            : RegexTokenizer(std::move(bpe_ranks), std::move(vocab), regexp_string, special_tokens, options),
               byte_shuffle_(std::move(byte_shuffle)) {
             for(const auto& [id,token]: byte_shuffle_) {
                 reversed_byte_shuffle_[token] = id;
             }
+            for(const auto i: std::ranges::iota_view {0, 256}) {
+                byte_shuffle_table_[i] = static_cast<char>(byte_shuffle_.at(i));
+            }
         }
 
         void Train(const UnicodeString& text, int vocab_size) override {
             throw InstinctException("Not implemented");
         }
 
-        static TokenizerPtr FromTiktokenConfig(const TiktokenConfig& config) {
+        static TokenizerPtr FromTiktokenConfig(const TiktokenConfig& config, const RegexTokenizerOptions& options = {}) {
             BPERanks bpe_ranks = details::recover_byte_pair_bpe_ranks(config.mergeable_ranks);
 
             // init vocab
@@ -104,7 +110,7 @@ namespace INSTINCT_LLM_NS {
                 // first 256 char have rank of less than 256,  so it's safe to cast back to uint8_t
                 byte_shuffle[i] = id;
             }
-            return std::make_shared<TiktokenTokenizer>(bpe_ranks, vocab, UnicodeString::fromUTF8(config.pat_str), config.special_tokens, byte_shuffle);
+            return std::make_shared<TiktokenTokenizer>(bpe_ranks, vocab, UnicodeString::fromUTF8(config.pat_str), config.special_tokens, byte_shuffle, options);
         }
 
         static TokenizerPtr MakeGPT2Tokenizer(const FileVaultPtr& file_vault = DEFAULT_FILE_VAULT) {
@@ -121,7 +127,8 @@ namespace INSTINCT_LLM_NS {
 
         static TokenizerPtr MakeGPT2Tokenizer(
             const std::filesystem::path& bpe_file_path,
-            const std::filesystem::path& encoder_json_file_path
+            const std::filesystem::path& encoder_json_file_path,
+            const RegexTokenizerOptions& options = {}
             ) {
             auto reader = GPT2BPEFileReader(bpe_file_path, encoder_json_file_path);
             return FromTiktokenConfig({
@@ -132,7 +139,7 @@ namespace INSTINCT_LLM_NS {
                 .special_tokens = {
                     {"<|endoftext|>", 50256}
                 }
-            });
+            }, options);
         }
 
         static TokenizerPtr MakeGPT4Tokenizer() {
@@ -147,12 +154,13 @@ namespace INSTINCT_LLM_NS {
         }
 
         static TokenizerPtr MakeGPT4Tokenizer(
-            const std::filesystem::path& tiktoken_bpe_file_path
+            const std::filesystem::path& tiktoken_bpe_file_path,
+            const RegexTokenizerOptions& options = {}
             ) {
             TiktokenBPEFileReader reader(tiktoken_bpe_file_path);
             return FromTiktokenConfig({
                 .name = "cl100k_base",
-                .pat_str = R"""('(?i:[sdmt]|ll|ve|re)|[^\r\n\p{L}\p{N}]?+\p{L}+|\p{N}{1,3}| ?[^\s\p{L}\p{N}]++[\r\n]*|\s*[\r\n]|\s+(?!\S)|\s+)""",
+                .pat_str = GPT4_SPLIT_PATTERN,
                 .mergeable_ranks = reader.Fetch(),
                 .special_tokens = {
                     {"<|endoftext|>", 100257},
@@ -161,7 +169,7 @@ namespace INSTINCT_LLM_NS {
                     {"<|fim_suffix|>", 100260},
                     {"<|endofprompt|>", 100276}
                 }
-            });
+            }, options);
         }
 
         UnicodeString Decode(const std::vector<int32_t>& ids) override {
@@ -178,11 +186,9 @@ namespace INSTINCT_LLM_NS {
 
     private:
         void HandleChunkBytes_(Bytes& text_bytes) override {
-            Bytes new_bytes;
-            for (const auto&c: text_bytes) {
-                new_bytes += static_cast<char>(byte_shuffle_.at(static_cast<u_int8_t>(c)));
+            for (auto& c: text_bytes) {
+                c = byte_shuffle_table_[static_cast<u_int8_t>(c)];
             }
-            text_bytes = new_bytes;
         }
     };
 
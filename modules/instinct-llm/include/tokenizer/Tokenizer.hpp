@@ -183,20 +183,15 @@ namespace INSTINCT_LLM_NS {
             return result;
         }
 
-        static void find_all_with_regex(const UnicodeString& text, const UnicodeString& regexp_pattern, std::vector<UnicodeString>& result) {
+        static void find_all_with_regex(const UnicodeString& text, RegexMatcher& regex_matcher, std::vector<UnicodeString>& result) {
             UErrorCode status = U_ZERO_ERROR;
-            RegexMatcher regex_matcher_(regexp_pattern, 0, status);
-            if(U_FAILURE(status)) {
-                std::string sep_utf8;
-                throw InstinctException("Failed to compile regex with seperator string: " + regexp_pattern.toUTF8String(sep_utf8));
-            }
-            regex_matcher_.reset(text);
-            while (regex_matcher_.find()) {
-                const int start = regex_matcher_.start(status);
+            regex_matcher.reset(text);
+            while (regex_matcher.find()) {
+                const int start = regex_matcher.start(status);
                 if(U_FAILURE(status)) {
                     throw InstinctException("Failed to match start during encoding");
                 }
-                int end = std::min(regex_matcher_.end(status), text.length());
+                int end = std::min(regex_matcher.end(status), text.length());
                 if(U_FAILURE(status)) {
                     throw InstinctException("Failed to match end during encoding");
                 }
@@ -204,6 +199,16 @@ namespace INSTINCT_LLM_NS {
             }
         }
 
+        static void find_all_with_regex(const UnicodeString& text, const UnicodeString& regexp_pattern, std::vector<UnicodeString>& result) {
+            UErrorCode status = U_ZERO_ERROR;
+            RegexMatcher regex_matcher_(regexp_pattern, 0, status);
+            if(U_FAILURE(status)) {
+                std::string sep_utf8;
+                throw InstinctException("Failed to compile regex with seperator string: " + regexp_pattern.toUTF8String(sep_utf8));
+            }
+            find_all_with_regex(text, regex_matcher_, result);
+        }
+
         /**
          *
          * https://stackoverflow.com/questions/39228912/stdregex-escape-special-characters-for-use-in-regex
@@ -2,6 +2,8 @@
 // Created by RobinQu on 2024/3/4.
 //
 #include <gtest/gtest.h>
+#include <random>
+#include <set>
 
 
 #include "CoreGlobals.hpp"
@@ -86,4 +88,104 @@ namespace INSTINCT_LLM_NS {
         const auto splits = text_splitter->SplitText(corpus::text3);
         details::print_splits("splits: ", splits);
     }
+
+    /**
+     * Length calculator that counts calls and characters measured by the wrapped one
+     */
+    class CountingLengthCalculator final: public ILengthCalculator {
+        LengthCalculatorPtr delegate_;
+    public:
+        size_t call_count = 0;
+        size_t measured_chars = 0;
+
+        explicit CountingLengthCalculator(LengthCalculatorPtr delegate)
+            : delegate_(std::move(delegate)) {
+        }
+
+        size_t GetLength(const UnicodeString &s) override {
+            ++call_count;
+            measured_chars += s.length();
+            return delegate_->GetLength(s);
+        }
+    };
+
+    TEST_F(RecursiveCharacterTextSplitterTest, OffsetsOfDuplicatedPassages) {
+        const UnicodeString passage = "The llama is a domesticated South American camelid.\nLlamas are social animals and live with others as a herd.";
+        UnicodeString text = "  Prelude 👋 with emoji.\n\n";
+        for (int i = 0; i < 6; ++i) {
+            text += passage;
+            text += "\n\n";
+        }
+        for (const auto& options: std::vector<RecursiveCharacterTextSplitterOptions> {{.chunk_size = 60}, {.chunk_size = 120, .chunk_overlap = 40}, {.chunk_size = 25, .chunk_overlap = 10}}) {
+            RecursiveCharacterTextSplitter splitter {options};
+            const auto chunks = splitter.SplitTextWithOffsets(text);
+            ASSERT_GT(chunks.size(), 6);
+            int32_t last_start = -1;
+            for (const auto& chunk: chunks) {
+                // each chunk is exactly where its offset points to, even if same text appears many times
+                ASSERT_EQ(text.tempSubString(chunk.start, chunk.text.length()), chunk.text);
+                ASSERT_GT(chunk.start, last_start);
+                last_start = chunk.start;
+            }
+            // identical passages get distinct offsets
+            std::set<int32_t> passage_starts;
+            for (const auto& chunk: chunks) {
+                for (int32_t i = chunk.text.indexOf("The llama"); i >= 0; i = chunk.text.indexOf("The llama", i + 1)) {
+                    passage_starts.insert(chunk.start + i);
+                }
+            }
+            ASSERT_EQ(passage_starts.size(), 6);
+            ASSERT_EQ(splitter.SplitText(text).size(), chunks.size());
+        }
+
+        // offsets in metadata are in UTF-8 bytes
+        Document doc;
+        text.toUTF8String(*doc.mutable_text());
+        const auto splitter = CreateRecursiveCharacterTextSplitter({.chunk_size = 60});
+        const auto docs = CollectVector(splitter->SplitDocuments(rpp::source::just(doc).as_dynamic()));
+        ASSERT_GT(docs.size(), 6);
+        std::set<int64_t> starts;
+        for (const auto& chunk_doc: docs) {
+            const auto start_index = DocumentUtils::GetIntValueMetadataField(chunk_doc, METADATA_SCHEMA_CHUNK_START_INDEX_KEY).value();
+            const auto end_index = DocumentUtils::GetIntValueMetadataField(chunk_doc, METADATA_SCHEMA_CHUNK_END_INDEX_KEY).value();
+            ASSERT_EQ(doc.text().substr(start_index, end_index - start_index), chunk_doc.text());
+            starts.insert(start_index);
+        }
+        ASSERT_EQ(starts.size(), docs.size());
+    }
+
+    TEST_F(RecursiveCharacterTextSplitterTest, MeasureEachCharacterFewTimes) {
+        const std::filesystem::path assets_dir = std::filesystem::current_path() / "_assets";
+        const auto tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(assets_dir / "bpe_ranks" / "cl100k_base.tiktoken", {.fast_gpt4_pretokenizer = true});
+        const auto length_calculator = std::make_shared<CountingLengthCalculator>(std::make_shared<TokenizerBasedLengthCalculator>(tokenizer));
+        RecursiveCharacterTextSplitter splitter {length_calculator, {.chunk_size = 512, .chunk_overlap = 64}};
+
+        // 256KB of paragraphs made of sentences from corpus
+        std::vector<std::string> sentences;
+        for (const auto& text: {corpus::text1, corpus::text2, corpus::text3}) {
+            std::string buf;
+            text.toUTF8String(buf);
+            for (const auto& sentence: StringUtils::ReSplit(buf, std::regex {"\\. "})) {
+                sentences.push_back(sentence + ". ");
+            }
+        }
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<size_t> sentence_dis(0, sentences.size() - 1), paragraph_dis(1, 12);
+        std::string buf;
+        while (buf.size() < 256 * 1024) {
+            for (size_t i = paragraph_dis(gen); i > 0; --i) {
+                buf += sentences[sentence_dis(gen)];
+            }
+            buf += "\n\n";
+        }
+        const auto text = UnicodeString::fromUTF8(buf);
+
+        const auto chunks = splitter.SplitTextWithOffsets(text);
+        ASSERT_GT(chunks.size(), 1);
+        // every character is measured at most a few times, one for each level of recursion
+        ASSERT_LT(length_calculator->measured_chars, static_cast<size_t>(text.length()) * 4);
+        for (const auto& chunk: chunks) {
+            ASSERT_EQ(text.tempSubString(chunk.start, chunk.text.length()), chunk.text);
+        }
+    }
 }
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include "LLMTestGlobals.hpp"
+#include "embedding_model/CachedEmbeddingModel.hpp"
+
+namespace INSTINCT_LLM_NS {
+
+    /**
+     * Embedding model counting texts it has embedded
+     */
+    class CountingEmbeddings final: public IEmbeddingModel {
+        HashedEmbeddings embeddings_ {16};
+    public:
+        std::atomic<size_t> text_count = 0;
+        std::atomic<size_t> call_count = 0;
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            text_count += texts.size();
+            ++call_count;
+            return embeddings_.EmbedDocuments(texts);
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return EmbedDocuments({text}).front();
+        }
+
+        size_t GetDimension() override {
+            return embeddings_.GetDimension();
+        }
+    };
+
+    class InMemoryEmbeddingCacheStore final: public IEmbeddingCacheStore {
+        std::unordered_map<std::string, Embedding> entries_;
+    public:
+        std::unordered_map<std::string, Embedding> MultiGet(const std::vector<std::string>& keys) override {
+            std::unordered_map<std::string, Embedding> result;
+            for (const auto& key: keys) {
+                if (const auto itr = entries_.find(key); itr != entries_.end()) {
+                    result.emplace(key, itr->second);
+                }
+            }
+            return result;
+        }
+
+        void MultiPut(const std::vector<std::pair<std::string, Embedding>>& entries) override {
+            for (const auto& [key, embedding]: entries) {
+                entries_.emplace(key, embedding);
+            }
+        }
+
+        [[nodiscard]] size_t Size() const {
+            return entries_.size();
+        }
+    };
+
+    class FailingEmbeddingCacheStore final: public IEmbeddingCacheStore {
+    public:
+        std::unordered_map<std::string, Embedding> MultiGet(const std::vector<std::string>&) override {
+            return {};
+        }
+
+        void MultiPut(const std::vector<std::pair<std::string, Embedding>>&) override {
+            throw InstinctException("cache store is unavailable");
+        }
+    };
+
+    class CachedEmbeddingModelTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+    };
+
+    TEST_F(CachedEmbeddingModelTest, MemoryTier) {
+        const auto model = std::make_shared<CountingEmbeddings>();
+        const auto cached = CreateCachedEmbeddingModel(model, {.model_name = "counting"});
+        ASSERT_EQ(cached->GetDimension(), 16);
+
+        // duplicates in one call are embedded once, and results are in order of input
+        const std::vector<std::string> texts {"a", "b", "a", "c"};
+        const auto embeddings = cached->EmbedDocuments(texts);
+        ASSERT_EQ(embeddings.size(), 4);
+        ASSERT_EQ(model->text_count, 3);
+        ASSERT_EQ(embeddings[0], embeddings[2]);
+        for (size_t i = 0; i < texts.size(); ++i) {
+            ASSERT_EQ(embeddings[i], HashedEmbeddings(16).EmbedQuery(texts[i]));
+        }
+
+        // only new text is embedded
+        ASSERT_EQ(cached->EmbedDocuments({"c", "d", "a"}), (std::vector {embeddings[3], HashedEmbeddings(16).EmbedQuery("d"), embeddings[0]}));
+        ASSERT_EQ(model->text_count, 4);
+        ASSERT_EQ(cached->EmbedQuery("b"), embeddings[1]);
+        ASSERT_EQ(model->text_count, 4);
+
+        // no call if all are cached
+        const auto call_count = model->call_count.load();
+        cached->EmbedDocuments(texts);
+        ASSERT_EQ(model->call_count, call_count);
+
+        const auto stats = cached->GetStats();
+        ASSERT_EQ(stats.miss_count, 4);
+        ASSERT_EQ(stats.memory_hit_count, 6);
+        ASSERT_EQ(stats.persistent_hit_count, 0);
+    }
+
+    TEST_F(CachedEmbeddingModelTest, PersistentTier) {
+        const auto cache_store = std::make_shared<InMemoryEmbeddingCacheStore>();
+        const auto model = std::make_shared<CountingEmbeddings>();
+        const auto cached = CreateCachedEmbeddingModel(model, {.model_name = "counting", .memory_capacity = 2}, cache_store);
+        const auto embeddings = cached->EmbedDocuments({"a", "b", "c", "d"});
+        ASSERT_EQ(cache_store->Size(), 4);
+        ASSERT_EQ(model->text_count, 4);
+
+        // evicted from memory, but found in persistent tier
+        ASSERT_EQ(cached->EmbedDocuments({"a", "b", "c", "d"}), embeddings);
+        ASSERT_EQ(model->text_count, 4);
+        ASSERT_GT(cached->GetStats().persistent_hit_count, 0);
+
+        // a new instance with the same store, like after restart
+        const auto restarted = CreateCachedEmbeddingModel(model, {.model_name = "counting"}, cache_store);
+        ASSERT_EQ(restarted->EmbedDocuments({"d", "c"}), (std::vector {embeddings[3], embeddings[2]}));
+        ASSERT_EQ(model->text_count, 4);
+        ASSERT_EQ(restarted->GetStats().persistent_hit_count, 2);
+
+        // entries of other model are never used
+        const auto other_model = CreateCachedEmbeddingModel(model, {.model_name = "other"}, cache_store);
+        other_model->EmbedDocuments({"a"});
+        ASSERT_EQ(model->text_count, 5);
+        ASSERT_EQ(cache_store->Size(), 5);
+
+        // queries are kept in memory tier only
+        ASSERT_EQ(restarted->EmbedQueries({"e", "f"}), (std::vector {HashedEmbeddings(16).EmbedQuery("e"), HashedEmbeddings(16).EmbedQuery("f")}));
+        ASSERT_EQ(restarted->EmbedQuery("e"), HashedEmbeddings(16).EmbedQuery("e"));
+        ASSERT_EQ(model->text_count, 7);
+        ASSERT_EQ(cache_store->Size(), 5);
+    }
+
+    TEST_F(CachedEmbeddingModelTest, PersistentTierFailure) {
+        const auto model = std::make_shared<CountingEmbeddings>();
+        const auto cached = CreateCachedEmbeddingModel(model, {.model_name = "counting"}, std::make_shared<FailingEmbeddingCacheStore>());
+        ASSERT_EQ(cached->EmbedDocuments({"a", "b"}), HashedEmbeddings(16).EmbedDocuments({"a", "b"}));
+        ASSERT_EQ(cached->EmbedDocuments({"a"}).front(), HashedEmbeddings(16).EmbedQuery("a"));
+        ASSERT_EQ(model->text_count, 2);
+    }
+
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "LLMTestGlobals.hpp"
+#include "embedding_model/CoalescingEmbeddingModel.hpp"
+
+namespace INSTINCT_LLM_NS {
+
+    /**
+     * Embedding model recording size of each call, which takes a while like a remote one
+     */
+    class RecordingEmbeddings final: public IEmbeddingModel {
+        HashedEmbeddings embeddings_ {16};
+        std::mutex mutex_;
+    public:
+        std::vector<size_t> batch_sizes;
+        bool fail = false;
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds {2});
+            if (fail) {
+                throw InstinctException("embedding failed");
+            }
+            {
+                std::lock_guard guard {mutex_};
+                batch_sizes.push_back(texts.size());
+            }
+            return embeddings_.EmbedDocuments(texts);
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return EmbedDocuments({text}).front();
+        }
+
+        size_t GetDimension() override {
+            return embeddings_.GetDimension();
+        }
+    };
+
+    class CoalescingEmbeddingModelTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+    };
+
+    TEST_F(CoalescingEmbeddingModelTest, CoalesceConcurrentCalls) {
+        const auto model = std::make_shared<RecordingEmbeddings>();
+        const auto coalescing = CreateCoalescingEmbeddingModel(model, {.max_batch_size = 32, .max_delay = std::chrono::milliseconds {20}, .max_concurrent_batches = 2});
+
+        constexpr int thread_count = 16;
+        constexpr int query_per_thread = 8;
+        std::vector<std::thread> threads;
+        std::atomic<int> ok = 0;
+        for (int i = 0; i < thread_count; ++i) {
+            threads.emplace_back([&, i] {
+                for (int j = 0; j < query_per_thread; ++j) {
+                    const auto text = fmt::format("text-{}-{}", i, j);
+                    ok += coalescing->EmbedQuery(text) == HashedEmbeddings(16).EmbedQuery(text);
+                }
+            });
+        }
+        for (auto& t: threads) {
+            t.join();
+        }
+        ASSERT_EQ(ok, thread_count * query_per_thread);
+
+        const auto stats = coalescing->GetStats();
+        ASSERT_EQ(stats.text_count, thread_count * query_per_thread);
+        ASSERT_EQ(stats.batch_count, model->batch_sizes.size());
+        // concurrent queries should share calls
+        ASSERT_LT(stats.batch_count, thread_count * query_per_thread);
+        for (const auto size: model->batch_sizes) {
+            ASSERT_LE(size, 32);
+        }
+    }
+
+    TEST_F(CoalescingEmbeddingModelTest, SplitLargeCall) {
+        const auto model = std::make_shared<RecordingEmbeddings>();
+        const auto coalescing = CreateCoalescingEmbeddingModel(model, {.max_batch_size = 64});
+        std::vector<std::string> texts;
+        for (int i = 0; i < 200; ++i) {
+            texts.push_back(fmt::format("text-{}", i));
+        }
+        ASSERT_EQ(coalescing->EmbedDocuments(texts), HashedEmbeddings(16).EmbedDocuments(texts));
+        ASSERT_EQ(model->batch_sizes.size(), 4);
+        ASSERT_TRUE(coalescing->EmbedDocuments({}).empty());
+    }
+
+    TEST_F(CoalescingEmbeddingModelTest, PropagateError) {
+        const auto model = std::make_shared<RecordingEmbeddings>();
+        model->fail = true;
+        const auto coalescing = CreateCoalescingEmbeddingModel(model);
+        ASSERT_THROW(coalescing->EmbedDocuments({"a", "b"}), InstinctException);
+        model->fail = false;
+        ASSERT_EQ(coalescing->EmbedQuery("a"), HashedEmbeddings(16).EmbedQuery("a"));
+    }
+
+}
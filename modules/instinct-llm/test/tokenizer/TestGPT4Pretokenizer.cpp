@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "tokenizer/GPT4Pretokenizer.hpp"
+#include "tokenizer/TiktokenTokenizer.hpp"
+
+namespace INSTINCT_LLM_NS {
+    using namespace U_ICU_NAMESPACE;
+
+    static std::vector<UnicodeString> MakeShortStrings(const size_t n, const unsigned seed = 42) {
+        // letters, numbers, white spaces, punctuations and contractions, with a few characters that are tricky for regex classes
+        const std::vector<UChar32> alphabet = {
+            ' ', ' ', ' ', '\t', '\n', '\r', '\v', '\f', 0x85, 0xA0, 0x2028, 0x3000,
+            'a', 'b', 'c', 's', 'S', 'd', 'T', 'l', 'L', 'v', 'e', 'E', 'r', 0x17F, 0xE9, 0x4E2D,
+            '0', '7', 0xBD, 0x216B, 0x661,
+            '!', '\'', '\'', '.', ',', '-', '$', 0x301, 0x1F44B, 0x1D400
+        };
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<size_t> char_dis(0, alphabet.size() - 1), length_dis(0, 48);
+        std::vector<UnicodeString> result;
+        for (size_t i = 0; i < n; ++i) {
+            UnicodeString s;
+            for (size_t j = length_dis(gen); j > 0; --j) {
+                s.append(alphabet[char_dis(gen)]);
+            }
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    TEST(GPT4Pretokenizer, TestMatchesRegex) {
+        const auto pattern = UnicodeString::fromUTF8(GPT4_SPLIT_PATTERN);
+        auto texts = MakeShortStrings(5000);
+        texts.push_back(UnicodeString::fromUTF8("hello world 👋"));
+        texts.push_back(UnicodeString::fromUTF8("I'm sure they'LL say it's 12345 dollars!!!\n\n  \n   ok   "));
+        for (const auto& text: texts) {
+            std::vector<UnicodeString> expected, actual;
+            details::find_all_with_regex(text, pattern, expected);
+            details::gpt4_pretokenize(text, actual);
+            ASSERT_EQ(actual, expected);
+        }
+    }
+
+    TEST(GPT4Pretokenizer, TestTokenizerMatchesRegexPretokenizer) {
+        const std::filesystem::path tiktoken_bpe_file_path = std::filesystem::current_path() / "_assets" / "bpe_ranks" / "cl100k_base.tiktoken";
+        const auto regex_tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(tiktoken_bpe_file_path);
+        const auto fast_tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(tiktoken_bpe_file_path, {.fast_gpt4_pretokenizer = true});
+        for (const auto& text: MakeShortStrings(5000, 7)) {
+            ASSERT_EQ(fast_tokenizer->Encode(text, {.allow_special = kAll}), regex_tokenizer->Encode(text, {.allow_special = kAll}));
+        }
+    }
+
+}
@@ -2,6 +2,8 @@
 // Created by RobinQu on 2024/3/2.
 //
 #include <gtest/gtest.h>
+#include <random>
+
 #include "tokenizer/TiktokenTokenizer.hpp"
 #include "tools/Assertions.hpp"
 #include "tools/ChronoUtils.hpp"
@@ -55,4 +57,76 @@ The ancestors of llamas are thought to have originated from the Great Plains of
         ASSERT_TRUE(check_equality(ids3, std::vector{100257, 791, 94776, 47325, 135, 230, 75, 133, 239, 135, 238, 76, 99638, 14, 26, 15506, 71722, 25, 510, 135, 230, 134, 236, 3105, 60, 477, 510, 135, 230, 134, 251, 3105, 2526, 320, 43, 3105, 2840, 3105, 8, 374, 264, 13018, 660, 4987, 3778, 50252, 307, 11, 13882, 1511, 439, 264, 13339, 323, 3854, 10065, 555, 1628, 5420, 27833, 2533, 279, 864, 7813, 1152, 13464, 11639, 627, 43, 24705, 300, 527, 3674, 10099, 323, 3974, 449, 3885, 439, 264, 59213, 13, 11205, 39640, 374, 8579, 323, 5727, 1193, 264, 2678, 3392, 315, 31791, 37737, 8032, 17, 60, 445, 24705, 300, 649, 4048, 4382, 9256, 1306, 264, 2478, 86066, 13, 3277, 1701, 264, 3854, 11, 814, 649, 6920, 922, 220, 914, 311, 220, 966, 4, 315, 872, 2547, 4785, 369, 220, 23, 311, 220, 1032, 13437, 320, 20, 4235, 23, 8931, 94638, 18, 60, 578, 836, 94776, 320, 258, 279, 3347, 1101, 68918, 330, 81101, 1, 477, 330, 6200, 3105, 909, 574, 18306, 555, 7665, 61107, 505, 10068, 3700, 12328, 5493, 8032, 19, 933, 791, 38618, 315, 9507, 29189, 527, 3463, 311, 617, 44853, 505, 279, 8681, 63911, 315, 4892, 5270, 922, 220, 1272, 3610, 1667, 4227, 11, 323, 28520, 73691, 311, 4987, 5270, 922, 2380, 3610, 1667, 4227, 2391, 279, 8681, 3778, 5783, 3455, 13, 3296, 279, 842, 315, 279, 1566, 10054, 4325, 320, 605, 11, 931, 4235, 717, 11, 931, 1667, 4227, 705, 50252, 3447, 1051, 69918, 304, 4892, 5270, 8032, 18, 60, 1666, 315, 220, 1049, 22, 11, 1070, 1051, 927, 8254, 3610, 9507, 29189, 323, 453, 46051, 300, 304, 4987, 5270, 323, 927, 220, 11286, 11, 931, 9507, 29189, 323, 220, 1041, 11, 931, 453, 46051, 300, 11, 58842, 505, 84360, 12170, 25973, 3389, 304, 279, 220, 508, 339, 9478, 11, 304, 279, 3723, 4273, 323, 7008, 8032, 20, 933, 100258, 644, 362, 1631, 5169, 59492, 11, 9507, 29189, 527, 3062, 23837, 13, 578, 88150, 445, 81101, 374, 1071, 311, 7172, 3090, 505, 279, 18435, 323, 4433, 258, 988, 439, 433, 62555, 8032, 21, 60, 10771, 311, 362, 1631, 5169, 1560, 9884, 2508, 11, 100260, 1405, 814, 2586, 505, 520, 279, 842, 315, 892, 8032, 21, 60, 100259, 9507, 29189, 690, 471, 311, 279, 3090, 42242, 323, 89455, 100276}));
     }
 
+    TEST(TiktokenTokenizer, TestEncodeWithSomeSpecials) {
+        const std::filesystem::path assets_dir = std::filesystem::current_path() / "_assets";
+        const auto tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(assets_dir / "bpe_ranks" / "cl100k_base.tiktoken");
+        const UnicodeString text = "<|endoftext|>hello<|fim_prefix|>";
+        const auto ids = tokenizer->Encode(text, {.allow_special = kSome, .specials = {"<|endoftext|>"}});
+        ASSERT_EQ(ids.front(), 100257);
+        ASSERT_EQ(std::ranges::count(ids, 100258), 0);
+        // pattern of same subset is reused, and it's not affected by other subsets
+        ASSERT_EQ(tokenizer->Encode(text, {.allow_special = kSome, .specials = {"<|fim_prefix|>", "<|endoftext|>"}}), (std::vector {100257, 15339, 100258}));
+        ASSERT_EQ(tokenizer->Encode(text, {.allow_special = kSome, .specials = {"<|endoftext|>"}}), ids);
+        ASSERT_THROW(tokenizer->Encode(text, {.allow_special = kSome, .specials = {"<|unknown|>"}}), InstinctException);
+    }
+
+    /**
+     * Generate a corpus of given size in UTF-8 bytes, by sampling words from sample texts with a few non-latin words.
+     */
+    static UnicodeString MakeCorpus(const size_t min_bytes, const unsigned seed = 42) {
+        std::vector<std::string> words;
+        for (const auto& text: {text1, text2}) {
+            std::string buf;
+            text.toUTF8String(buf);
+            for (const auto& word: StringUtils::ReSplit(buf)) {
+                words.push_back(word);
+            }
+        }
+        for (const auto& word: {"你好", "世界", "👋", "Ünïcödé", "1234567", "\n\n", "\t", "    "}) {
+            words.emplace_back(word);
+        }
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<size_t> dis(0, words.size() - 1);
+        std::string corpus;
+        while (corpus.size() < min_bytes) {
+            corpus += words[dis(gen)];
+            corpus += " ";
+        }
+        return UnicodeString::fromUTF8(corpus);
+    }
+
+    /**
+     * Encode with the reference BPE implementation, which recomputes pair statistics for every merge.
+     */
+    static std::vector<int32_t> ReferenceEncode(const UnicodeString& text, BPERanks& merges, const BPETokenRanks& mergeable_ranks) {
+        static const auto pattern = UnicodeString::fromUTF8(R"""('(?i:[sdmt]|ll|ve|re)|[^\r\n\p{L}\p{N}]?+\p{L}+|\p{N}{1,3}| ?[^\s\p{L}\p{N}]++[\r\n]*|\s*[\r\n]|\s+(?!\S)|\s+)""");
+        std::vector<UnicodeString> chunks;
+        details::find_all_with_regex(text, pattern, chunks);
+        std::vector<int32_t> result;
+        for (const auto& chunk: chunks) {
+            std::vector<int32_t> ids;
+            for (const auto& c: details::conv_to_utf8_string(chunk)) {
+                ids.push_back(mergeable_ranks.at(Bytes {c}));
+            }
+            details::bpe_merge_with_pair_stats(ids, merges);
+            result.insert(result.end(), ids.begin(), ids.end());
+        }
+        return result;
+    }
+
+    TEST(TiktokenTokenizer, TestEncodeMatchesReference) {
+        const std::filesystem::path tiktoken_bpe_file_path = std::filesystem::current_path() / "_assets" / "bpe_ranks" / "cl100k_base.tiktoken";
+        const auto tokenizer = TiktokenTokenizer::MakeGPT4Tokenizer(tiktoken_bpe_file_path);
+        const auto mergeable_ranks = TiktokenBPEFileReader(tiktoken_bpe_file_path).Fetch();
+        auto merges = std::dynamic_pointer_cast<RegexTokenizer>(tokenizer)->GetBPERanks();
+
+        for (const auto& text: {text1, text2, MakeCorpus(64 * 1024), UnicodeString::fromUTF8("  \n\n\t  👋👋👋 aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa")}) {
+            const auto expected = ReferenceEncode(text, merges, mergeable_ranks);
+            // first pass fills chunk cache, and second pass hits it
+            ASSERT_EQ(tokenizer->Encode(text, {.allow_special = kNone}), expected);
+            ASSERT_EQ(tokenizer->Encode(text, {.allow_special = kNone}), expected);
+            ASSERT_EQ(tokenizer->Decode(expected), text);
+        }
+    }
+
 }
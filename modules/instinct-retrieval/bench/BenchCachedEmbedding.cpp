@@ -0,0 +1,65 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "FakeOllamaServer.hpp"
+#include "embedding_model/CachedEmbeddingModel.hpp"
+#include "embedding_model/OllamaEmbedding.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t CACHED_EMBEDDING_BENCH_SIZE = 200;
+    static constexpr size_t CACHED_EMBEDDING_BENCH_DIM = 384;
+
+    static FakeOllamaEmbeddingServer& get_fake_ollama_embedding_server() {
+        static FakeOllamaEmbeddingServer server {CACHED_EMBEDDING_BENCH_DIM};
+        return server;
+    }
+
+    /**
+     * Re-ingest an unchanged corpus into a fresh in-memory vector store in every iteration, with embeddings computed by a (fake) Ollama server. With cache enabled, only the first iteration should reach the server. `requests_per_iteration` counter is the count of embedding requests sent per iteration, and `hit_rate` is the fraction of texts found in cache. Args: cached (0 or 1).
+     */
+    static void BM_CachedEmbedding_Ingest(benchmark::State& state) {
+        const bool cached = state.range(0) != 0;
+        auto& server = get_fake_ollama_embedding_server();
+        EmbeddingsPtr embeddings = CreateOllamaEmbedding({
+            .model_name = "fake-embed",
+            .endpoint = server.GetEndpoint(),
+            .dimension = CACHED_EMBEDDING_BENCH_DIM,
+            .max_parallel = 8
+        });
+        CachedEmbeddingModelPtr cached_embeddings;
+        if (cached) {
+            cached_embeddings = CreateCachedEmbeddingModel(embeddings, {.model_name = "fake-embed"});
+            embeddings = cached_embeddings;
+        }
+        const auto corpus = make_corpus(CACHED_EMBEDDING_BENCH_SIZE);
+
+        const size_t request_count_before = server.request_count;
+        for (auto _: state) {
+            state.PauseTiming();
+            auto docs = corpus;
+            const auto store = CreateDuckDBVectorStore(embeddings, {.table_name = "bench_cached_embedding_table", .dimension = CACHED_EMBEDDING_BENCH_DIM, .in_memory = true});
+            state.ResumeTiming();
+
+            UpdateResult update_result;
+            store->AddDocuments(docs, update_result);
+            assert_true(update_result.failed_documents_size() == 0, "should have all documents inserted");
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * CACHED_EMBEDDING_BENCH_SIZE));
+        state.counters["requests_per_iteration"] = static_cast<double>(server.request_count - request_count_before) / static_cast<double>(state.iterations());
+        if (cached_embeddings) {
+            const auto stats = cached_embeddings->GetStats();
+            const auto hit_count = stats.memory_hit_count + stats.persistent_hit_count;
+            state.counters["hit_rate"] = static_cast<double>(hit_count) / static_cast<double>(hit_count + stats.miss_count);
+        } else {
+            state.counters["hit_rate"] = 0;
+        }
+    }
+
+    BENCHMARK(BM_CachedEmbedding_Ingest)
+        ->ArgName("cached")
+        ->Arg(0)
+        ->Arg(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,80 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "FakeOllamaServer.hpp"
+#include "embedding_model/CoalescingEmbeddingModel.hpp"
+#include "embedding_model/OllamaEmbedding.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t COALESCING_BENCH_DIM = 384;
+    static constexpr size_t COALESCING_BENCH_QUERY_PER_THREAD = 32;
+
+    enum CoalescingBenchMode {
+        // one request to `/api/embeddings` for each text
+        kOneByOne,
+        // one request to `/api/embed` for each call
+        kBatchAPI,
+        // concurrent calls are coalesced into requests to `/api/embed`
+        kCoalesced
+    };
+
+    static FakeOllamaEmbeddingServer& get_slow_fake_ollama_embedding_server() {
+        // one millisecond per round trip
+        static FakeOllamaEmbeddingServer server {COALESCING_BENCH_DIM, std::chrono::microseconds {1000}};
+        return server;
+    }
+
+    /**
+     * Many threads calling `EmbedQuery` concurrently, like retrievers serving requests or ingestors embedding chunks one at a time. Each iteration runs `threads` threads, each of which embeds a fixed count of texts. Counters: `requests_per_text` is the count of HTTP requests per embedded text, `p50_ms` and `p99_ms` are latencies of single `EmbedQuery` calls. Args: mode (0 for one-by-one, 1 for batch API, 2 for coalesced), threads.
+     */
+    static void BM_OllamaEmbedding_ConcurrentQueries(benchmark::State& state) {
+        const auto mode = static_cast<CoalescingBenchMode>(state.range(0));
+        const auto thread_count = static_cast<size_t>(state.range(1));
+        auto& server = get_slow_fake_ollama_embedding_server();
+        EmbeddingsPtr embeddings = CreateOllamaEmbedding({
+            .model_name = "fake-embed",
+            .endpoint = server.GetEndpoint(),
+            .dimension = COALESCING_BENCH_DIM,
+            .embedding_batch_size = mode == kOneByOne ? 0ul : 64ul
+        });
+        if (mode == kCoalesced) {
+            embeddings = CreateCoalescingEmbeddingModel(embeddings, {.max_batch_size = 64, .max_delay = std::chrono::milliseconds {2}});
+        }
+        const auto queries = make_queries(thread_count * COALESCING_BENCH_QUERY_PER_THREAD);
+
+        std::vector<double> latencies;
+        std::mutex latencies_mutex;
+        const size_t request_count_before = server.request_count;
+        for (auto _: state) {
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < thread_count; ++i) {
+                threads.emplace_back([&, i] {
+                    std::vector<double> thread_latencies;
+                    for (size_t j = 0; j < COALESCING_BENCH_QUERY_PER_THREAD; ++j) {
+                        const auto t1 = std::chrono::steady_clock::now();
+                        benchmark::DoNotOptimize(embeddings->EmbedQuery(queries[i * COALESCING_BENCH_QUERY_PER_THREAD + j]));
+                        thread_latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count());
+                    }
+                    std::lock_guard guard {latencies_mutex};
+                    latencies.insert(latencies.end(), thread_latencies.begin(), thread_latencies.end());
+                });
+            }
+            for (auto& t: threads) {
+                t.join();
+            }
+        }
+
+        const auto text_count = state.iterations() * thread_count * COALESCING_BENCH_QUERY_PER_THREAD;
+        state.SetItemsProcessed(static_cast<int64_t>(text_count));
+        state.counters["requests_per_text"] = static_cast<double>(server.request_count - request_count_before) / static_cast<double>(text_count);
+        std::ranges::sort(latencies);
+        state.counters["p50_ms"] = latencies[latencies.size() / 2];
+        state.counters["p99_ms"] = latencies[latencies.size() * 99 / 100];
+    }
+
+    BENCHMARK(BM_OllamaEmbedding_ConcurrentQueries)
+        ->ArgNames({"mode", "threads"})
+        ->ArgsProduct({{kOneByOne, kBatchAPI, kCoalesced}, {1, 8, 32}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
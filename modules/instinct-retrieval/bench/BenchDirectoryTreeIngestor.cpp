@@ -0,0 +1,78 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "RetrieverObjectFactory.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t DIRECTORY_TREE_BENCH_TEXT_FILE_COUNT = 1000;
+    static constexpr size_t DIRECTORY_TREE_BENCH_FIXTURE_COPIES = 8;
+
+    struct DirectoryTreeFixture {
+        std::filesystem::path root;
+        uintmax_t total_bytes = 0;
+    };
+
+    /**
+     * Generate a tree of text files of various sizes, mixed with copies of PDF and DOCX fixtures from test corpus, which is copied to working directory of benchmark executable. The tree is generated once and shared by all benchmark runs.
+     */
+    static const DirectoryTreeFixture& get_directory_tree_fixture() {
+        static const DirectoryTreeFixture fixture = [] {
+            DirectoryTreeFixture result {.root = ensure_random_temp_folder() / "tree"};
+            const auto corpus = make_corpus(DIRECTORY_TREE_BENCH_TEXT_FILE_COUNT, 42, 160);
+            for (size_t i = 0; i < corpus.size(); ++i) {
+                const auto file_path = result.root / fmt::format("d{}", i % 10) / fmt::format("s{}", i % 7) / fmt::format("file-{}.{}", i, i % 2 == 0 ? "txt" : "md");
+                std::filesystem::create_directories(file_path.parent_path());
+                std::ofstream ofs {file_path};
+                // each line is about 1KB, so that file sizes range from 1KB to 64KB
+                for (size_t j = 0; j <= i % 64; ++j) {
+                    ofs << corpus[i].text() << "\n";
+                }
+            }
+
+            if (const auto corpus_dir = std::filesystem::current_path() / "_corpus"; std::filesystem::exists(corpus_dir)) {
+                for (const auto& fixture_path: {corpus_dir / "papers/attention_is_all_you_need.pdf", corpus_dir / "word/sample2.docx", corpus_dir / "word/lease_contract.docx"}) {
+                    for (size_t i = 0; i < DIRECTORY_TREE_BENCH_FIXTURE_COPIES; ++i) {
+                        const auto target_path = result.root / fmt::format("d{}", i) / "fixtures" / fmt::format("{}-{}", i, fixture_path.filename().string());
+                        std::filesystem::create_directories(target_path.parent_path());
+                        std::filesystem::copy_file(fixture_path, target_path);
+                    }
+                }
+            } else {
+                LOG_WARN("PDF and DOCX fixtures are skipped as corpus folder is missing: {}", corpus_dir.string());
+            }
+
+            for (const auto& dir_entry: std::filesystem::recursive_directory_iterator {result.root}) {
+                if (dir_entry.is_regular_file()) {
+                    result.total_bytes += dir_entry.file_size();
+                }
+            }
+            return result;
+        }();
+        return fixture;
+    }
+
+    /**
+     * Time to load all documents of a generated tree. Args: max_concurrency, ordered (0 or 1).
+     */
+    static void BM_DirectoryTreeIngestor_Load(benchmark::State& state) {
+        const auto& fixture = get_directory_tree_fixture();
+        const auto ingestor = RetrieverObjectFactory::CreateDirectoryTreeIngestor(fixture.root, {
+            .max_concurrency = static_cast<size_t>(state.range(0)),
+            .ordered = state.range(1) != 0
+        });
+        size_t doc_count = 0;
+        for (auto _: state) {
+            const auto docs = CollectVector(ingestor->Load());
+            doc_count = docs.size();
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * fixture.total_bytes));
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * doc_count));
+    }
+
+    BENCHMARK(BM_DirectoryTreeIngestor_Load)
+        ->ArgNames({"max_concurrency", "ordered"})
+        ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 1}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,237 @@
+#include <fstream>
+#include <unistd.h>
+
+#include "RetrievalBenchGlobals.hpp"
+#include "store/duckdb/DuckDBDocStore.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t BULK_BENCH_TABLE_SIZE = 200000;
+
+    /**
+     * Get a doc store with 200k short documents, and their ids. It's shared by id-set benchmarks.
+     */
+    static const std::pair<DocStorePtr, std::vector<std::string>>& get_bulk_doc_store() {
+        static const auto store_and_ids = [] {
+            auto store = CreateDuckDBDocStore({.table_name = "bench_doc_table", .in_memory = true});
+            auto docs = make_corpus(BULK_BENCH_TABLE_SIZE, 42, 8);
+            UpdateResult update_result;
+            store->AddDocuments(docs, update_result);
+            assert_true(update_result.failed_documents_size() == 0, "should have all documents inserted");
+            std::vector<std::string> doc_ids {update_result.returned_ids().begin(), update_result.returned_ids().end()};
+            return std::make_pair(store, doc_ids);
+        }();
+        return store_and_ids;
+    }
+
+    /**
+     * Latency of `MultiGetDocuments` with given count of ids out of a table with 200k rows. Ids are bound as a list parameter of a prepared statement, so that sql text doesn't grow with id count. Args: fan-in.
+     */
+    static void BM_DuckDBDocStore_MultiGet(benchmark::State& state) {
+        const auto fan_in = static_cast<size_t>(state.range(0));
+        const auto& [doc_store, ids] = get_bulk_doc_store();
+
+        std::mt19937_64 gen(fan_in);
+        for (auto _: state) {
+            state.PauseTiming();
+            std::vector<std::string> batch;
+            batch.reserve(fan_in);
+            for (size_t i = 0; i < fan_in; ++i) {
+                batch.push_back(ids[gen() % ids.size()]);
+            }
+            state.ResumeTiming();
+
+            const auto docs = CollectVector(doc_store->MultiGetDocuments(batch));
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fan_in));
+    }
+
+    BENCHMARK(BM_DuckDBDocStore_MultiGet)
+        ->ArgName("fan_in")
+        ->Arg(10)
+        ->Arg(1000)
+        ->Arg(100000)
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+
+    /**
+     * Latency of `DeleteDocuments` with given count of ids out of a table with 200k rows. Deleted documents are inserted before each iteration with timer paused. Args: fan-in.
+     */
+    static void BM_DuckDBDocStore_DeleteByIds(benchmark::State& state) {
+        const auto fan_in = static_cast<size_t>(state.range(0));
+        const auto doc_store = get_bulk_doc_store().first;
+        const auto corpus = make_corpus(fan_in, 7, 8);
+
+        for (auto _: state) {
+            state.PauseTiming();
+            auto docs = corpus;
+            UpdateResult insert_result;
+            doc_store->AddDocuments(docs, insert_result);
+            const std::vector<std::string> ids {insert_result.returned_ids().begin(), insert_result.returned_ids().end()};
+            state.ResumeTiming();
+
+            UpdateResult delete_result;
+            doc_store->DeleteDocuments(ids, delete_result);
+
+            state.PauseTiming();
+            if (delete_result.affected_rows() != static_cast<int32_t>(fan_in)) {
+                state.SkipWithError("should have all inserted documents deleted");
+            }
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fan_in));
+    }
+
+    BENCHMARK(BM_DuckDBDocStore_DeleteByIds)
+        ->ArgName("fan_in")
+        ->Arg(10)
+        ->Arg(1000)
+        ->Arg(100000)
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+
+    /**
+     * Baseline of converting query result with `duckdb::Value` for each cell, which is how documents were built before columnar conversion.
+     */
+    static std::vector<Document> conv_rows_with_values(QueryResult& query_result, const MetadataSchemaPtr& metadata_schema) {
+        std::vector<Document> docs;
+        for (const auto& row: query_result) {
+            Document document;
+            document.set_id(row.GetValue<std::string>(0));
+            document.set_text(row.GetValue<std::string>(1));
+            for (int i = 0; i < metadata_schema->fields_size(); i++) {
+                auto* metadata_field = document.add_metadata();
+                metadata_field->set_name(metadata_schema->fields(i).name());
+                if (metadata_schema->fields(i).type() == VARCHAR) {
+                    metadata_field->set_string_value(row.GetValue<std::string>(i + 2));
+                } else {
+                    metadata_field->set_int_value(row.GetValue<int32_t>(i + 2));
+                }
+            }
+            docs.push_back(std::move(document));
+        }
+        return docs;
+    }
+
+    /**
+     * Latency of converting a 100k-row result of `SELECT id, text, <metadata>` to documents. Args: columnar (0 for row-wise conversion with `duckdb::Value`, 1 for converter used by `FindDocuments`).
+     */
+    static void BM_DuckDBDocStore_ConvertQueryResult(benchmark::State& state) {
+        static constexpr size_t rows = 100000;
+        const bool columnar = state.range(0) != 0;
+        static const auto doc_store = [] {
+            const auto store = CreateDuckDBDocStore({.table_name = "bench_conversion_table", .in_memory = true});
+            auto docs = make_corpus(rows, 42, 16);
+            UpdateResult update_result;
+            store->AddDocuments(docs, update_result);
+            assert_true(update_result.failed_documents_size() == 0, "should have all documents inserted");
+            return std::dynamic_pointer_cast<BaseDuckDBStore>(store);
+        }();
+        const auto metadata_schema = doc_store->GetMetadataSchema();
+        std::string column_list = "id, text";
+        for (const auto& field: metadata_schema->fields()) {
+            column_list += ", " + field.name();
+        }
+        const auto sql = fmt::format("SELECT {} FROM bench_conversion_table;", column_list);
+
+        for (auto _: state) {
+            state.PauseTiming();
+            auto result = doc_store->GetConnection().Query(sql);
+            assert_query_ok(result);
+            state.ResumeTiming();
+
+            const auto docs = columnar
+                ? CollectVector(details::conv_query_result_to_iterator(std::move(result), metadata_schema))
+                : conv_rows_with_values(*result, metadata_schema);
+            assert_true(docs.size() == rows, "should have all rows converted");
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rows));
+    }
+
+    BENCHMARK(BM_DuckDBDocStore_ConvertQueryResult)
+        ->ArgName("columnar")
+        ->Arg(0)
+        ->Arg(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Resident set size of current process in bytes, read from `/proc/self/statm`. Zero if it's not available, e.g. on macOS.
+     */
+    static size_t get_current_rss() {
+        std::ifstream statm("/proc/self/statm");
+        size_t total_pages = 0, resident_pages = 0;
+        if (!(statm >> total_pages >> resident_pages)) {
+            return 0;
+        }
+        return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    /**
+     * Documents emitted one by one like a file being parsed, so that input itself is never materialized.
+     */
+    static AsyncIterator<Document> make_streaming_corpus(const size_t n, const uint64_t seed = 42, const size_t words_per_doc = 16) {
+        return rpp::source::create<Document>([n, seed, words_per_doc](const auto& observer) {
+            std::mt19937_64 gen(seed);
+            for (size_t i = 0; i < n; ++i) {
+                std::string text = fmt::format("doc-{}-{}:", seed, i);
+                for (size_t j = 0; j < words_per_doc; ++j) {
+                    text += " ";
+                    text += VOCABULARY[gen() % VOCABULARY.size()];
+                }
+                Document document;
+                document.set_text(text);
+                DocumentUtils::AddMissingPresetMetadataFields(document);
+                observer.on_next(document);
+            }
+            observer.on_completed();
+        });
+    }
+
+    /**
+     * Throughput and memory of `AddDocuments` with a streaming `AsyncIterator` of millions of documents. `peak_rss_mb` counter is growth of resident memory during ingestion, sampled every 10ms. Args: rows, chunk_size (0 for collecting all documents in one transaction).
+     */
+    static void BM_DuckDBDocStore_StreamingIngest(benchmark::State& state) {
+        const auto rows = static_cast<size_t>(state.range(0));
+        const auto chunk_size = static_cast<size_t>(state.range(1));
+        size_t peak_rss_growth = 0;
+        for (auto _: state) {
+            state.PauseTiming();
+            DuckDBStoreOptions options {.table_name = "bench_streaming_table", .in_memory = true};
+            options.ingestion.chunk_size = chunk_size;
+            const auto doc_store = CreateDuckDBDocStore(options);
+            const auto baseline_rss = get_current_rss();
+            std::atomic<bool> done = false;
+            std::thread sampler([&] {
+                while (!done) {
+                    if (const auto rss = get_current_rss(); rss > baseline_rss) {
+                        peak_rss_growth = std::max(peak_rss_growth, rss - baseline_rss);
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds {10});
+                }
+            });
+            state.ResumeTiming();
+
+            UpdateResult update_result;
+            doc_store->AddDocuments(make_streaming_corpus(rows), update_result);
+
+            state.PauseTiming();
+            done = true;
+            sampler.join();
+            assert_true(update_result.affected_rows() == static_cast<int>(rows), "should have all documents inserted");
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rows));
+        state.counters["peak_rss_mb"] = static_cast<double>(peak_rss_growth) / 1024.0 / 1024.0;
+    }
+
+    BENCHMARK(BM_DuckDBDocStore_StreamingIngest)
+        ->ArgNames({"rows", "chunk_size"})
+        ->ArgsProduct({{1 << 21}, {0, 4096}})
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,395 @@
+#include <ranges>
+
+#include "RetrievalBenchGlobals.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    /**
+     * Rows/sec of `AddDocuments` into a fresh table, including embedding with the fake model. Args: rows, dimension.
+     */
+    static void BM_DuckDBVectorStore_AddDocuments(benchmark::State& state) {
+        const auto rows = static_cast<size_t>(state.range(0));
+        const auto dimension = static_cast<size_t>(state.range(1));
+        const auto corpus = make_corpus(rows);
+        // store of last iteration is released while timer is paused
+        VectorStorePtr store;
+        for (auto _: state) {
+            state.PauseTiming();
+            store = create_in_memory_vector_store(dimension);
+            auto docs = corpus;
+            UpdateResult update_result;
+            state.ResumeTiming();
+
+            store->AddDocuments(docs, update_result);
+
+            state.PauseTiming();
+            if (update_result.failed_documents_size() > 0) {
+                state.SkipWithError("should have all documents inserted");
+            }
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rows));
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_AddDocuments)
+        ->ArgNames({"rows", "dim"})
+        ->ArgsProduct({{1000, 10000}, {128, 768}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Baseline of appending a row with embedding boxed as a `duckdb::Value` for each component, which is how rows were appended before chunked writing.
+     */
+    static void append_row_with_values(const details::MetadataColumnPlan& plan, Appender& appender, Document& doc, const Embedding& embedding, UpdateResult& update_result) {
+        const auto metadata_indices = details::resolve_metadata_indices(plan, doc, true);
+        appender.BeginRow();
+        details::append_row_basic_fields(appender, doc, update_result);
+        vector<duckdb::Value> vector_value;
+        for (const float& f: embedding) {
+            vector_value.push_back(duckdb::Value::FLOAT(f));
+        }
+        appender.Append(duckdb::Value::ARRAY(LogicalType::FLOAT, vector_value));
+        details::append_row_metadata_fields(appender, doc, metadata_indices);
+        appender.EndRow();
+    }
+
+    /**
+     * Rows/sec of appending documents with precomputed embeddings into a fresh table, which excludes cost of embedding model. Rows are either appended with embeddings boxed as `duckdb::Value`, or written into ARRAY child vector of data chunks by `details::EmbeddingRowChunkWriter`. Args: dimension, chunked (0 or 1).
+     */
+    static void BM_DuckDBDocWithEmbeddingStore_AppendRows(benchmark::State& state) {
+        constexpr size_t rows = 10000;
+        const auto dimension = static_cast<size_t>(state.range(0));
+        const bool chunked = state.range(1) != 0;
+        const auto corpus = make_corpus(rows, 42, 8);
+        std::vector<Embedding> embeddings;
+        embeddings.reserve(rows);
+        HashedEmbeddings hashed_embeddings {dimension};
+        for (const auto& doc: corpus) {
+            embeddings.push_back(hashed_embeddings.EmbedQuery(doc.text()));
+        }
+        const auto metadata_schema = CreateVectorStorePresetMetadataSchema();
+        const auto plan = details::make_metadata_column_plan(metadata_schema);
+        const auto db = std::make_shared<DuckDB>(nullptr);
+        Connection connection(*db);
+
+        for (auto _: state) {
+            state.PauseTiming();
+            assert_query_ok(connection.Query(details::make_create_table_sql("bench_append_table", dimension, metadata_schema, true)));
+            auto docs = corpus;
+            UpdateResult update_result;
+            state.ResumeTiming();
+
+            Appender appender(connection, "bench_append_table");
+            if (chunked) {
+                details::EmbeddingRowChunkWriter writer {appender};
+                for (size_t i = 0; i < rows; ++i) {
+                    writer.AppendRow(plan, docs[i], embeddings[i], update_result, true);
+                }
+                writer.Flush();
+            } else {
+                for (size_t i = 0; i < rows; ++i) {
+                    append_row_with_values(plan, appender, docs[i], embeddings[i], update_result);
+                }
+            }
+            appender.Close();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rows));
+    }
+
+    BENCHMARK(BM_DuckDBDocWithEmbeddingStore_AppendRows)
+        ->ArgNames({"dim", "chunked"})
+        ->ArgsProduct({{384, 1024, 3072}, {0, 1}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Fake embedding model taking `call_latency + text_latency * texts.size()` for each call, like a remote model server that serves concurrent calls in parallel
+     */
+    class SlowHashedEmbeddings final: public IEmbeddingModel {
+        HashedEmbeddings embeddings_;
+        std::chrono::microseconds call_latency_;
+        std::chrono::microseconds text_latency_;
+    public:
+        SlowHashedEmbeddings(const size_t dimension, const std::chrono::microseconds call_latency, const std::chrono::microseconds text_latency)
+            : embeddings_(dimension), call_latency_(call_latency), text_latency_(text_latency) {
+        }
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            std::this_thread::sleep_for(call_latency_ + text_latency_ * texts.size());
+            return embeddings_.EmbedDocuments(texts);
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return EmbedDocuments({text}).front();
+        }
+
+        size_t GetDimension() override {
+            return embeddings_.GetDimension();
+        }
+    };
+
+    /**
+     * Rows/sec of adding 4096 documents with an embedding model of 5ms latency per call and 100us per text. With `batch` of zero, all documents are embedded in one call before appending; otherwise micro-batches of that size are embedded with at most `in_flight` of them at the same time, while finished ones are appended. Args: batch, in_flight.
+     */
+    static void BM_DuckDBVectorStore_PipelinedIngest(benchmark::State& state) {
+        constexpr size_t rows = 4096, dimension = 384;
+        const auto embeddings = std::make_shared<SlowHashedEmbeddings>(dimension, std::chrono::milliseconds {5}, std::chrono::microseconds {100});
+        DuckDBStoreOptions options {.table_name = "bench_pipelined_table", .dimension = dimension, .in_memory = true, .create_or_replace_table = true};
+        options.ingestion.embedding_batch_size = static_cast<size_t>(state.range(0));
+        options.ingestion.max_in_flight_embedding_batches = static_cast<size_t>(state.range(1));
+        const auto corpus = make_corpus(rows, 42, 8);
+        VectorStorePtr store;
+        for (auto _: state) {
+            state.PauseTiming();
+            store = CreateDuckDBVectorStore(embeddings, options);
+            auto docs = corpus;
+            UpdateResult update_result;
+            state.ResumeTiming();
+
+            store->AddDocuments(docs, update_result);
+
+            state.PauseTiming();
+            if (update_result.failed_documents_size() > 0) {
+                state.SkipWithError("should have all documents inserted");
+            }
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(rows));
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_PipelinedIngest)
+        ->ArgNames({"batch", "in_flight"})
+        ->Args({0, 1})
+        ->Args({64, 1})
+        ->Args({64, 4})
+        ->Args({64, 8})
+        ->Args({256, 4})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Latency of top-k search without filter. Args: collection size, dimension, top_k.
+     */
+    static void BM_DuckDBVectorStore_Search(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto dimension = static_cast<size_t>(state.range(1));
+        const auto top_k = static_cast<int>(state.range(2));
+        const auto store = get_populated_vector_store(n, dimension);
+        const auto queries = make_queries(64);
+        size_t i = 0;
+        for (auto _: state) {
+            SearchRequest search_request;
+            search_request.set_query(queries[i++ % queries.size()]);
+            search_request.set_top_k(top_k);
+            const auto docs = CollectVector(store->SearchDocuments(search_request));
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_Search)
+        ->ArgNames({"n", "dim", "top_k"})
+        ->ArgsProduct({{1000, 10000, 50000}, {128, 768}, {10}})
+        ->Args({10000, 768, 100})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Get a populated vector store of 10000 documents with 768 dimensions, whose reads are served by a pool of `connection_count` connections
+     */
+    static VectorStorePtr get_pooled_vector_store(const int connection_count) {
+        static std::mutex mutex;
+        static std::map<int, VectorStorePtr> stores;
+        std::lock_guard guard {mutex};
+        if (const auto itr = stores.find(connection_count); itr != stores.end()) {
+            return itr->second;
+        }
+        const auto store = CreateDuckDBVectorStore(create_hashed_embedding_model(768), {
+            .table_name = "bench_pooled_vector_table",
+            .dimension = 768,
+            .in_memory = true,
+            .connection_pool = {.initial_connection_count = connection_count}
+        });
+        auto docs = make_corpus(10000);
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        assert_true(update_result.failed_documents_size() == 0, "should have all documents inserted");
+        stores.emplace(connection_count, store);
+        return store;
+    }
+
+    /**
+     * Throughput of top-k search issued from many threads against one store. Items processed are queries, so items/sec is QPS summed over all threads. With a single connection, searches are serialized on its lock, while a pool of connections lets them scale with thread count. Args: connection count.
+     */
+    static void BM_DuckDBVectorStore_ConcurrentSearch(benchmark::State& state) {
+        const auto store = get_pooled_vector_store(static_cast<int>(state.range(0)));
+        const auto queries = make_queries(64);
+        size_t i = state.thread_index();
+        for (auto _: state) {
+            SearchRequest search_request;
+            search_request.set_query(queries[i++ % queries.size()]);
+            search_request.set_top_k(10);
+            const auto docs = CollectVector(store->SearchDocuments(search_request));
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_ConcurrentSearch)
+        ->ArgName("connections")
+        ->Arg(1)
+        ->Arg(16)
+        ->ThreadRange(1, 16)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Latency of top-k search with quantized codes scanned and candidates re-scored with FLOAT column. Args: collection size, dimension, quantization type.
+     */
+    static void BM_DuckDBVectorStore_QuantizedSearch(benchmark::State& state) {
+        const auto n = static_cast<size_t>(state.range(0));
+        const auto dimension = static_cast<size_t>(state.range(1));
+        const auto quantization = static_cast<VectorQuantizationType>(state.range(2));
+        const auto store = get_populated_vector_store(n, dimension, 42, quantization);
+        const auto queries = make_queries(64);
+        size_t i = 0;
+        for (auto _: state) {
+            SearchRequest search_request;
+            search_request.set_query(queries[i++ % queries.size()]);
+            search_request.set_top_k(10);
+            const auto docs = CollectVector(store->SearchDocuments(search_request));
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_QuantizedSearch)
+        ->ArgNames({"n", "dim", "quantization"})
+        ->ArgsProduct({{10000, 50000}, {768}, {kNoQuantization, kInt8Quantization, kProductQuantization}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /**
+     * Latency of serving `Q` queries, either by `Q` sequential calls of `SearchDocuments`, or by one call of `BatchSearchDocuments` that scans the table once. Items processed are queries. Args: query count, batched.
+     */
+    static void BM_DuckDBVectorStore_BatchSearch(benchmark::State& state) {
+        const auto query_count = static_cast<size_t>(state.range(0));
+        const bool batched = state.range(1) != 0;
+        const auto store = get_populated_vector_store(10000, 768);
+        const auto queries = make_queries(64);
+        size_t i = 0;
+        for (auto _: state) {
+            if (batched) {
+                BatchSearchRequest batch_request;
+                batch_request.set_top_k(10);
+                for (size_t q = 0; q < query_count; ++q) {
+                    batch_request.add_queries(queries[i++ % queries.size()]);
+                }
+                const auto batch_result = store->BatchSearchDocuments(batch_request);
+                benchmark::DoNotOptimize(batch_result.results_size());
+            } else {
+                for (size_t q = 0; q < query_count; ++q) {
+                    SearchRequest search_request;
+                    search_request.set_query(queries[i++ % queries.size()]);
+                    search_request.set_top_k(10);
+                    const auto docs = CollectVector(store->SearchDocuments(search_request));
+                    benchmark::DoNotOptimize(docs.data());
+                }
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(query_count));
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_BatchSearch)
+        ->ArgNames({"queries", "batched"})
+        ->ArgsProduct({{1, 2, 4, 8, 16}, {0, 1}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    enum FilteredSearchBenchMode {
+        // query vector rendered as float literals in SQL text, which has to be parsed and planned for each request
+        kLiteralSQL,
+        // parameterized SQL prepared for each request
+        kPreparedPerRequest,
+        // parameterized SQL prepared once and cached by store
+        kCachedPreparedStatement
+    };
+
+    /**
+     * Latency of top-k search with a metadata filter of `IN` terms, which selects about 20% of 5000 documents. Args: mode (0 for literal SQL, 1 for prepared statement per request, 2 for cached prepared statement).
+     */
+    static void BM_DuckDBVectorStore_FilteredSearch(benchmark::State& state) {
+        static constexpr size_t dimension = 1024;
+        static constexpr int n = 5000, k = 10;
+        const auto mode = static_cast<FilteredSearchBenchMode>(state.range(0));
+        const auto embeddings = create_hashed_embedding_model(dimension);
+        const auto db = std::make_shared<DuckDB>(nullptr);
+        DuckDBStoreOptions options = {.table_name = "bench_filtered_vector_table", .dimension = dimension, .in_memory = true};
+        options.prepared_statement_cache_size = mode == kCachedPreparedStatement ? DuckDBStoreOptions {}.prepared_statement_cache_size : 0;
+        const auto store = CreateDuckDBVectorStore(db, embeddings, options);
+
+        auto docs = make_corpus(n);
+        for (size_t i = 0; i < docs.size(); ++i) {
+            for (auto& field: *docs[i].mutable_metadata()) {
+                if (field.name() == METADATA_SCHEMA_PARENT_DOC_ID_KEY) {
+                    field.set_string_value(std::to_string(i % 10));
+                }
+            }
+        }
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        assert_true(update_result.affected_rows() == n, "should have all documents inserted");
+
+        const auto queries = make_queries(64);
+        std::vector<SearchRequest> requests;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            SearchRequest search_request;
+            search_request.set_query(queries[i]);
+            search_request.set_top_k(k);
+            auto* term = search_request.mutable_metadata_filter()->mutable_terms();
+            term->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+            term->add_terms()->set_string_value(std::to_string(i % 10));
+            term->add_terms()->set_string_value(std::to_string((i + 1) % 10));
+            requests.push_back(search_request);
+        }
+
+        Connection connection {*db};
+        const auto search_with_literal_sql = [&](const SearchRequest& request) {
+            std::string column_list = "id, text, " + StringUtils::JoinWith(store->GetMetadataSchema()->fields() | std::views::transform([](const MetadataFieldSchema& field) { return field.name(); }), ", ");
+            column_list += ", array_cosine_similarity(vector, array_value(";
+            const auto query_vector = embeddings->EmbedQuery(request.query());
+            for (size_t i = 0; i < query_vector.size(); ++i) {
+                column_list += std::to_string(query_vector[i]) + "::FLOAT";
+                column_list += i < query_vector.size() - 1 ? "," : "";
+            }
+            column_list += ")) AS similarity";
+            Sorter sorter;
+            sorter.mutable_field()->set_field_name("similarity");
+            sorter.mutable_field()->set_order(DESC);
+            const auto result = connection.Query(SQLBuilder::ToSelectString(options.table_name, column_list, request.metadata_filter(), std::vector {sorter}, -1, k));
+            assert_query_ok(result);
+            return result->RowCount();
+        };
+
+        size_t i = 0;
+        for (auto _: state) {
+            const auto& request = requests[i++ % requests.size()];
+            if (mode == kLiteralSQL) {
+                benchmark::DoNotOptimize(search_with_literal_sql(request));
+            } else {
+                const auto result = CollectVector(store->SearchDocuments(request));
+                benchmark::DoNotOptimize(result.data());
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_DuckDBVectorStore_FilteredSearch)
+        ->ArgNames({"mode"})
+        ->Arg(kLiteralSQL)
+        ->Arg(kPreparedPerRequest)
+        ->Arg(kCachedPreparedStatement)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,79 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "database/duckdb/DuckDBConnectionPool.hpp"
+#include "database/duckdb/DuckDBDataTemplate.hpp"
+#include "store/duckdb/DuckDBVectorStoreOperator.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t VECTOR_STORE_OPERATOR_BENCH_DIM = 128;
+
+    /**
+     * Create an operator on a fresh in-memory database with metadata table provisioned and instance `vs-bench` created
+     */
+    static std::shared_ptr<DuckDBVectorStoreOperator> create_vector_store_operator(const DuckDBVectorStoreOperatorOptions& options) {
+        const auto db = std::make_shared<DuckDB>(nullptr);
+        Connection connection(*db);
+        assert_query_ok(connection.Query(R"(CREATE TABLE IF NOT EXISTS instinct_vector_store_metadata (
+    instance_id VARCHAR PRIMARY KEY,
+    metadata_schema VARCHAR NOT NULL,
+    created_at TIMESTAMP DEFAULT now() NOT NULL,
+    modified_at TIMESTAMP DEFAULT now() NOT NULL,
+    embedding_table_name VARCHAR NOT NULL,
+    custom VARCHAR
+);)"));
+        const auto metadata_data_mapper = std::make_shared<VectorStoreMetadataDataMapper>(CreateDuckDBDataMapper<VectorStoreInstanceMetadata, std::string>(CreateDuckDBConnectionPool(db)));
+        const auto vdb_operator = std::make_shared<DuckDBVectorStoreOperator>(
+            db,
+            create_hashed_embedding_model(VECTOR_STORE_OPERATOR_BENCH_DIM),
+            metadata_data_mapper,
+            CreateVectorStorePresetMetadataSchema(),
+            options);
+        const auto instance = vdb_operator->CreateInstance("vs-bench");
+        auto docs = make_corpus(1000);
+        UpdateResult update_result;
+        instance->AddDocuments(docs, update_result);
+        return vdb_operator;
+    }
+
+    /**
+     * Get a shared operator, with instance cache enabled or not. Operators are shared by threads of the same benchmark run.
+     */
+    static std::shared_ptr<DuckDBVectorStoreOperator> get_vector_store_operator(const bool cached) {
+        static std::mutex mutex;
+        static std::map<bool, std::shared_ptr<DuckDBVectorStoreOperator>> operators;
+        std::lock_guard guard {mutex};
+        if (const auto itr = operators.find(cached); itr != operators.end()) {
+            return itr->second;
+        }
+        auto vdb_operator = create_vector_store_operator({.instance_cache_size = static_cast<size_t>(cached ? 64 : 0)});
+        operators.emplace(cached, vdb_operator);
+        return vdb_operator;
+    }
+
+    /**
+     * Latency of `LoadInstance` followed by a search, which is what a retriever does in every run. Cold loads read instance metadata and create a new store with its statements prepared, while warm loads return cached store. Args: cached (0 or 1).
+     */
+    static void BM_DuckDBVectorStoreOperator_LoadInstance(benchmark::State& state) {
+        const auto vdb_operator = get_vector_store_operator(state.range(0) != 0);
+        const auto queries = make_queries(64);
+        size_t i = state.thread_index();
+        for (auto _: state) {
+            const auto instance = vdb_operator->LoadInstance("vs-bench");
+            SearchRequest search_request;
+            search_request.set_query(queries[i++ % queries.size()]);
+            search_request.set_top_k(10);
+            const auto docs = CollectVector(instance->SearchDocuments(search_request));
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_DuckDBVectorStoreOperator_LoadInstance)
+        ->ArgName("cached")
+        ->Arg(0)
+        ->Arg(1)
+        ->ThreadRange(1, 16)
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,89 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "retrieval/HybridRetriever.hpp"
+#include "retrieval/VectorStoreRetriever.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t HYBRID_BENCH_SIZE = 10000;
+
+    enum HybridBenchMode {
+        kVectorOnly,
+        kKeywordOnly,
+        kHybrid
+    };
+
+    static VectorStorePtr get_keyword_indexed_vector_store() {
+        static std::mutex mutex;
+        static VectorStorePtr store;
+        std::lock_guard guard {mutex};
+        if (!store) {
+            DuckDBStoreOptions options {.table_name = "bench_hybrid_table", .dimension = 384, .in_memory = true};
+            options.keyword_index.enabled = true;
+            store = CreateDuckDBVectorStore(create_hashed_embedding_model(384), options);
+            auto docs = make_corpus(HYBRID_BENCH_SIZE);
+            UpdateResult update_result;
+            store->AddDocuments(docs, update_result);
+            assert_true(update_result.failed_documents_size() == 0, "should have all documents inserted");
+        }
+        return store;
+    }
+
+    /**
+     * Latency and relevance of retrieving with identifier-like queries, e.g. `doc-42-123`, which should recall the document tagged with it. `recall` counter is the fraction of queries whose target document is in top-k. Args: mode (0 for vector only, 1 for keyword only, 2 for hybrid), top_k.
+     */
+    static void BM_HybridRetriever_Retrieve(benchmark::State& state) {
+        const auto mode = static_cast<HybridBenchMode>(state.range(0));
+        const auto top_k = static_cast<int>(state.range(1));
+        const auto store = get_keyword_indexed_vector_store();
+        StatefulRetrieverPtr retriever;
+        switch (mode) {
+            case kVectorOnly:
+                retriever = CreateVectorStoreRetriever(store);
+                break;
+            case kKeywordOnly:
+                retriever = CreateHybridRetriever(store, {.vector_weight = 0});
+                break;
+            case kHybrid:
+                retriever = CreateHybridRetriever(store);
+                break;
+        }
+
+        std::mt19937_64 gen(7);
+        std::vector<std::pair<std::string, std::string>> queries;
+        for (size_t i = 0; i < 64; ++i) {
+            const auto target = gen() % HYBRID_BENCH_SIZE;
+            queries.emplace_back(fmt::format("doc-42-{}", target), fmt::format("doc-42-{}:", target));
+        }
+        const auto search = [&](const std::string& query) {
+            SearchRequest search_request;
+            search_request.set_query(query);
+            search_request.set_top_k(top_k);
+            return CollectVector(retriever->Retrieve(search_request));
+        };
+
+        size_t i = 0;
+        for (auto _: state) {
+            const auto docs = search(queries[i++ % queries.size()].first);
+            benchmark::DoNotOptimize(docs.data());
+        }
+
+        size_t hits = 0;
+        for (const auto& [query, prefix]: queries) {
+            for (const auto& doc: search(query)) {
+                if (doc.text().starts_with(prefix)) {
+                    hits++;
+                    break;
+                }
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["recall"] = static_cast<double>(hits) / static_cast<double>(queries.size());
+    }
+
+    BENCHMARK(BM_HybridRetriever_Retrieve)
+        ->ArgNames({"mode", "top_k"})
+        ->ArgsProduct({{kVectorOnly, kKeywordOnly, kHybrid}, {10, 50}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,36 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "retrieval/MultiPathRetriever.hpp"
+#include "retrieval/VectorStoreRetriever.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    /**
+     * End-to-end latency of recalling candidates from two vector stores of 10k rows in parallel and re-ranking them with a keyword ranking model. Args: top_k.
+     */
+    static void BM_MultiPathRetriever_RetrieveAndRerank(benchmark::State& state) {
+        const auto top_k = static_cast<int>(state.range(0));
+        const auto retriever = CreateMultiPathRetriever(
+            create_keyword_ranking_model(),
+            CreateVectorStoreRetriever(get_populated_vector_store(10000, 384, 1)),
+            CreateVectorStoreRetriever(get_populated_vector_store(10000, 384, 2))
+        );
+        const auto queries = make_queries(64);
+        size_t i = 0;
+        for (auto _: state) {
+            SearchRequest search_request;
+            search_request.set_query(queries[i++ % queries.size()]);
+            search_request.set_top_k(top_k);
+            const auto docs = CollectVector(retriever->Retrieve(search_request));
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    BENCHMARK(BM_MultiPathRetriever_RetrieveAndRerank)
+        ->ArgName("top_k")
+        ->Arg(10)
+        ->Arg(50)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
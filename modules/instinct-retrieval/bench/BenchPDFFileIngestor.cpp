@@ -0,0 +1,87 @@
+#include <fpdf_edit.h>
+#include <fpdf_save.h>
+
+#include "RetrievalBenchGlobals.hpp"
+#include "document/RecursiveCharacterTextSplitter.hpp"
+#include "ingestor/PDFFileIngestor.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr int PDF_BENCH_LINES_PER_PAGE = 40;
+
+    struct PDFFileWriter: FPDF_FILEWRITE {
+        std::ofstream ofs;
+    };
+
+    static int write_pdf_block(FPDF_FILEWRITE* writer, const void* data, const unsigned long size) {
+        static_cast<PDFFileWriter*>(writer)->ofs.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        return 1;
+    }
+
+    /**
+     * Generate a PDF of `page_count` pages, each of which has lines of text made of words from bench vocabulary, using editing API of PDFium.
+     */
+    static std::filesystem::path generate_pdf(const int page_count) {
+        const auto file_path = ensure_random_temp_folder() / fmt::format("bench-{}-pages.pdf", page_count);
+        const auto lines = make_queries(page_count * PDF_BENCH_LINES_PER_PAGE, 42, 12);
+
+        std::lock_guard guard {PDFIUM_MUTEX};
+        FPDF_DOCUMENT doc = FPDF_CreateNewDocument();
+        for (int i = 0; i < page_count; ++i) {
+            FPDF_PAGE page = FPDFPage_New(doc, i, 612, 792);
+            for (int j = 0; j < PDF_BENCH_LINES_PER_PAGE; ++j) {
+                FPDF_PAGEOBJECT text_object = FPDFPageObj_NewTextObj(doc, "Helvetica", 10);
+                auto text = UnicodeString::fromUTF8(lines[i * PDF_BENCH_LINES_PER_PAGE + j]);
+                FPDFText_SetText(text_object, reinterpret_cast<FPDF_WIDESTRING>(text.getTerminatedBuffer()));
+                FPDFPageObj_Transform(text_object, 1, 0, 0, 1, 36, 756 - j * 18);
+                FPDFPage_InsertObject(page, text_object);
+            }
+            FPDFPage_GenerateContent(page);
+            FPDF_ClosePage(page);
+        }
+        PDFFileWriter writer;
+        writer.version = 1;
+        writer.WriteBlock = write_pdf_block;
+        writer.ofs.open(file_path, std::ios::binary);
+        assert_true(FPDF_SaveAsCopy(doc, &writer, 0), "should have PDF saved");
+        writer.ofs.close();
+        FPDF_CloseDocument(doc);
+        return file_path;
+    }
+
+    /**
+     * Get path of a generated PDF with `page_count` pages. PDFs are generated once and shared by all benchmark runs.
+     */
+    static std::filesystem::path get_generated_pdf(const int page_count) {
+        static std::mutex mutex;
+        static std::map<int, std::filesystem::path> pdfs;
+        std::lock_guard guard {mutex};
+        if (const auto itr = pdfs.find(page_count); itr != pdfs.end()) {
+            return itr->second;
+        }
+        auto file_path = generate_pdf(page_count);
+        pdfs.emplace(page_count, file_path);
+        return file_path;
+    }
+
+    /**
+     * Pages per second of loading a generated PDF, measured by `items_per_second`. With `split` on, documents are split by a recursive character text splitter, which is what `FileObjectTaskHandler` does before ingesting them, and pages are split as they are emitted. Args: page_count, split (0 or 1).
+     */
+    static void BM_PDFFileIngestor_Load(benchmark::State& state) {
+        const auto page_count = static_cast<int>(state.range(0));
+        const auto ingestor = CreatePDFFileIngestor(get_generated_pdf(page_count));
+        const auto splitter = state.range(1) != 0 ? CreateRecursiveCharacterTextSplitter({.chunk_size = 200, .chunk_overlap = 20}) : nullptr;
+        for (auto _: state) {
+            const auto docs = CollectVector(splitter ? ingestor->LoadWithSplitter(splitter) : ingestor->Load());
+            benchmark::DoNotOptimize(docs.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * page_count);
+    }
+
+    BENCHMARK(BM_PDFFileIngestor_Load)
+        ->ArgNames({"page_count", "split"})
+        ->ArgsProduct({{200, 800}, {0, 1}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,91 @@
+#include "RetrievalBenchGlobals.hpp"
+#include "ingestor/ParquetFileIngestor.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr int64_t PARQUET_BENCH_ROW_COUNT = 10'000'000;
+
+    /**
+     * Generate a parquet file of 10M rows once, with a text column, three metadata columns and a wide column that's never mapped.
+     */
+    static const std::filesystem::path& get_generated_parquet_file() {
+        static const std::filesystem::path file_path = [] {
+            auto path = ensure_random_temp_folder() / "bench-rows.parquet";
+            DuckDB db(nullptr);
+            Connection connection(db);
+            assert_query_ok(connection.Query(fmt::format(
+                "COPY (SELECT i AS row_id, 'row ' || i || ' of llama alpaca camel vicuna guanaco andes wool herd desert mountain' AS text, i * 0.5 AS score, i % 2 = 0 AS flag, repeat('x', 256) AS payload FROM range({}) t(i)) TO '{}' (FORMAT PARQUET);",
+                PARQUET_BENCH_ROW_COUNT,
+                StringUtils::EscapeSQLText(path.string()))));
+            return path;
+        }();
+        return file_path;
+    }
+
+    /**
+     * Reset peak RSS of current process, so that it can be measured for a single run. Only supported on Linux.
+     */
+    static void reset_peak_rss() {
+#ifdef __linux__
+        std::ofstream ofs {"/proc/self/clear_refs"};
+        ofs << "5";
+#endif
+    }
+
+    /**
+     * Peak RSS of current process in MB, or zero if unsupported.
+     */
+    static double get_peak_rss_mb() {
+#ifdef __linux__
+        std::ifstream ifs {"/proc/self/status"};
+        std::string line;
+        while (std::getline(ifs, line)) {
+            if (line.starts_with("VmHWM:")) {
+                return std::stod(line.substr(6)) / 1024;
+            }
+        }
+#endif
+        return 0;
+    }
+
+    /**
+     * Rows/sec and peak RSS of loading all rows of a 10M-row parquet file. Documents are consumed one by one without being collected, so that peak RSS reflects memory held by ingestor. Args: streaming (0 or 1), threads (0 for DuckDB's default).
+     */
+    static void BM_ParquetFileIngestor_Load(benchmark::State& state) {
+        const auto& file_path = get_generated_parquet_file();
+        const auto ingestor = CreateParquetIngestor(file_path, "1:t,0:m:row_id:int64,2:m:score:double,3:m:flag:bool", {
+            .streaming = state.range(0) != 0,
+            .threads = static_cast<size_t>(state.range(1))
+        });
+        double peak_rss_mb = 0;
+        for (auto _: state) {
+            reset_peak_rss();
+            int64_t row_count = 0;
+            ingestor->Load()
+                | rpp::operators::as_blocking()
+                | rpp::operators::subscribe(
+                    [&](const Document& document) {
+                        benchmark::DoNotOptimize(document.text().data());
+                        ++row_count;
+                    },
+                    [](const std::exception_ptr& err) { if (err) std::rethrow_exception(err); }
+                );
+            assert_true(row_count == PARQUET_BENCH_ROW_COUNT, "should have all rows loaded");
+            peak_rss_mb = std::max(peak_rss_mb, get_peak_rss_mb());
+        }
+        state.SetItemsProcessed(state.iterations() * PARQUET_BENCH_ROW_COUNT);
+        state.counters["peak_rss_mb"] = peak_rss_mb;
+    }
+
+    BENCHMARK(BM_ParquetFileIngestor_Load)
+        ->ArgNames({"streaming", "threads"})
+        // naive ingestor uses DuckDB's default thread count
+        ->Args({0, 0})
+        ->Args({1, 1})
+        ->Args({1, 4})
+        ->Args({1, 0})
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
@@ -0,0 +1,141 @@
+#include <unordered_set>
+
+#include "RetrievalBenchGlobals.hpp"
+#include "store/VectorQuantizer.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    static constexpr size_t QUANTIZER_BENCH_SIZE = 20000;
+    static constexpr size_t QUANTIZER_BENCH_TOP_K = 10;
+    static constexpr size_t QUANTIZER_BENCH_RESCORE_FACTOR = 4;
+
+    /**
+     * Vectors of corpus and queries laid out contiguously, shared by all quantizer benchmarks
+     */
+    struct QuantizerBenchData {
+        std::vector<float> vectors;
+        std::vector<std::vector<float>> queries;
+        // exact top-k ids by scanning FLOAT vectors
+        std::vector<std::vector<size_t>> ground_truth;
+    };
+
+    static float cosine_similarity(const float* a, const float* b, const size_t dimension) {
+        float dot = 0, na = 0, nb = 0;
+        for (size_t i = 0; i < dimension; ++i) {
+            dot += a[i] * b[i];
+            na += a[i] * a[i];
+            nb += b[i] * b[i];
+        }
+        return dot / (std::sqrt(na) * std::sqrt(nb));
+    }
+
+    /**
+     * @return indices of top `k` vectors by exact cosine similarity among `candidates`
+     */
+    static std::vector<size_t> exact_top_k(const std::vector<float>& vectors, const size_t dimension, const std::vector<float>& query, const std::vector<size_t>& candidates, const size_t k) {
+        std::vector<std::pair<float, size_t>> scores;
+        scores.reserve(candidates.size());
+        for (const auto i: candidates) {
+            scores.emplace_back(-cosine_similarity(vectors.data() + i * dimension, query.data(), dimension), i);
+        }
+        const auto n = std::min(k, scores.size());
+        std::partial_sort(scores.begin(), scores.begin() + static_cast<int64_t>(n), scores.end());
+        std::vector<size_t> result;
+        for (size_t i = 0; i < n; ++i) {
+            result.push_back(scores[i].second);
+        }
+        return result;
+    }
+
+    static const QuantizerBenchData& get_quantizer_bench_data(const size_t dimension) {
+        static std::mutex mutex;
+        static std::map<size_t, QuantizerBenchData> cache;
+        std::lock_guard guard {mutex};
+        if (const auto itr = cache.find(dimension); itr != cache.end()) {
+            return itr->second;
+        }
+        const auto embeddings = create_hashed_embedding_model(dimension);
+        QuantizerBenchData data;
+        std::vector<size_t> all(QUANTIZER_BENCH_SIZE);
+        std::iota(all.begin(), all.end(), 0);
+        for (const auto& doc: make_corpus(QUANTIZER_BENCH_SIZE)) {
+            const auto vector = embeddings->EmbedQuery(doc.text());
+            data.vectors.insert(data.vectors.end(), vector.begin(), vector.end());
+        }
+        for (const auto& query: make_queries(100)) {
+            data.queries.push_back(embeddings->EmbedQuery(query));
+            data.ground_truth.push_back(exact_top_k(data.vectors, dimension, data.queries.back(), all, QUANTIZER_BENCH_TOP_K));
+        }
+        return cache.emplace(dimension, std::move(data)).first->second;
+    }
+
+    /**
+     * Baseline: scan FLOAT vectors, which is exact.
+     */
+    static void BM_FloatVectorScan(benchmark::State& state) {
+        const auto dimension = static_cast<size_t>(state.range(0));
+        const auto& data = get_quantizer_bench_data(dimension);
+        std::vector<size_t> all(QUANTIZER_BENCH_SIZE);
+        std::iota(all.begin(), all.end(), 0);
+        size_t i = 0;
+        for (auto _: state) {
+            const auto result = exact_top_k(data.vectors, dimension, data.queries[i++ % data.queries.size()], all, QUANTIZER_BENCH_TOP_K);
+            benchmark::DoNotOptimize(result.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(QUANTIZER_BENCH_SIZE));
+        state.counters["bytes_per_vector"] = static_cast<double>(dimension * sizeof(float));
+        state.counters["recall"] = 1.0;
+    }
+
+    BENCHMARK(BM_FloatVectorScan)
+        ->ArgName("dim")
+        ->Arg(384)
+        ->Arg(1024)
+        ->Unit(benchmark::kMicrosecond);
+
+    /**
+     * ADC scan over quantized codes followed by exact re-scoring of `top_k * 4` candidates. Recall@10 is measured against FLOAT scan. Args: dimension, quantization type.
+     */
+    static void BM_QuantizedVectorScan(benchmark::State& state) {
+        const auto dimension = static_cast<size_t>(state.range(0));
+        const auto type = static_cast<VectorQuantizationType>(state.range(1));
+        const auto& data = get_quantizer_bench_data(dimension);
+        VectorQuantizer quantizer(dimension, {.type = type});
+        quantizer.Train(data.vectors);
+        for (size_t i = 0; i < QUANTIZER_BENCH_SIZE; ++i) {
+            quantizer.Add(std::to_string(i), data.vectors.data() + i * dimension, dimension);
+        }
+
+        const auto search = [&](const std::vector<float>& query) {
+            std::vector<size_t> candidates;
+            for (const auto& [id, _]: quantizer.Search(query, QUANTIZER_BENCH_TOP_K * QUANTIZER_BENCH_RESCORE_FACTOR)) {
+                candidates.push_back(std::stoul(id));
+            }
+            return exact_top_k(data.vectors, dimension, query, candidates, QUANTIZER_BENCH_TOP_K);
+        };
+
+        size_t i = 0;
+        for (auto _: state) {
+            const auto result = search(data.queries[i++ % data.queries.size()]);
+            benchmark::DoNotOptimize(result.data());
+        }
+
+        size_t hits = 0;
+        for (size_t q = 0; q < data.queries.size(); ++q) {
+            const auto result = search(data.queries[q]);
+            const std::unordered_set<size_t> actual(result.begin(), result.end());
+            for (const auto id: data.ground_truth[q]) {
+                hits += actual.contains(id);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(QUANTIZER_BENCH_SIZE));
+        state.counters["bytes_per_vector"] = static_cast<double>(quantizer.GetBytesPerVector());
+        state.counters["recall"] = static_cast<double>(hits) / static_cast<double>(data.queries.size() * QUANTIZER_BENCH_TOP_K);
+    }
+
+    BENCHMARK(BM_QuantizedVectorScan)
+        ->ArgNames({"dim", "quantization"})
+        ->ArgsProduct({{384, 1024}, {kInt8Quantization, kProductQuantization}})
+        ->Unit(benchmark::kMicrosecond);
+
+}
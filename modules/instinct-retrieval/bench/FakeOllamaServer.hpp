@@ -0,0 +1,68 @@
+#ifndef FAKEOLLAMASERVER_HPP
+#define FAKEOLLAMASERVER_HPP
+
+#include <httplib.h>
+
+#include "RetrievalBenchGlobals.hpp"
+#include "commons/OllamaCommons.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+
+    /**
+     * Loopback server speaking Ollama's `/api/embeddings` and `/api/embed`, which returns hashed embeddings of inputs and counts requests it has served. `request_latency` is added to every request to mimic cost of a round trip to model server.
+     */
+    class FakeOllamaEmbeddingServer {
+        httplib::Server server_;
+        std::thread server_thread_;
+        HashedEmbeddings embeddings_;
+        std::chrono::microseconds request_latency_;
+        int port_ = 0;
+
+    public:
+        std::atomic<size_t> request_count = 0;
+
+        explicit FakeOllamaEmbeddingServer(const size_t dimension, const std::chrono::microseconds request_latency = std::chrono::microseconds {0})
+            : embeddings_(dimension), request_latency_(request_latency) {
+            server_.new_task_queue = [] { return new httplib::ThreadPool(64); };
+            server_.Post(OLLAMA_EMBEDDING_PATH, [&](const httplib::Request& req, httplib::Response& resp) {
+                ++request_count;
+                std::this_thread::sleep_for(request_latency_);
+                const auto request = ProtobufUtils::Deserialize<OllamaEmbeddingRequest>(req.body);
+                OllamaEmbeddingResponse response;
+                for (const float f: embeddings_.EmbedQuery(request.prompt())) {
+                    response.add_embedding(f);
+                }
+                resp.set_content(ProtobufUtils::Serialize(response), HTTP_CONTENT_TYPES.at(kJSON));
+            });
+            server_.Post(OLLAMA_BATCH_EMBEDDING_PATH, [&](const httplib::Request& req, httplib::Response& resp) {
+                ++request_count;
+                std::this_thread::sleep_for(request_latency_);
+                const auto request = ProtobufUtils::Deserialize<OllamaBatchEmbeddingRequest>(req.body);
+                OllamaBatchEmbeddingResponse response;
+                response.set_model(request.model());
+                for (const auto& input: request.input()) {
+                    auto* list_value = response.add_embeddings();
+                    for (const float f: embeddings_.EmbedQuery(input)) {
+                        list_value->add_values()->set_number_value(f);
+                    }
+                }
+                resp.set_content(ProtobufUtils::Serialize(response), HTTP_CONTENT_TYPES.at(kJSON));
+            });
+            port_ = server_.bind_to_any_port("127.0.0.1");
+            server_thread_ = std::thread([&] { server_.listen_after_bind(); });
+            server_.wait_until_ready();
+        }
+
+        ~FakeOllamaEmbeddingServer() {
+            server_.stop();
+            server_thread_.join();
+        }
+
+        [[nodiscard]] Endpoint GetEndpoint() const {
+            return {.protocol = kHTTP, .host = "127.0.0.1", .port = port_};
+        }
+    };
+
+}
+
+#endif //FAKEOLLAMASERVER_HPP
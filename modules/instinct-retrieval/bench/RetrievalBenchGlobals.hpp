@@ -0,0 +1,90 @@
+#ifndef RETRIEVALBENCHGLOBALS_HPP
+#define RETRIEVALBENCHGLOBALS_HPP
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+#include "RetrievalGlobals.hpp"
+#include "RetrievalTestGlobals.hpp"
+#include "store/duckdb/DuckDBVectorStore.hpp"
+#include "tools/DocumentUtils.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS::bench {
+    using namespace INSTINCT_LLM_NS;
+
+    static const std::vector<std::string> VOCABULARY = {
+        "llama", "alpaca", "camel", "vicuna", "guanaco", "andes", "wool", "herd", "desert", "mountain",
+        "vector", "index", "query", "search", "rank", "token", "embedding", "model", "store", "table",
+        "river", "forest", "ocean", "island", "valley", "glacier", "canyon", "meadow", "harbor", "village"
+    };
+
+    /**
+     * Generate `n` documents made of words from a fixed vocabulary. Texts are deterministic for given `seed`, and each of them is unique as it's tagged with its index.
+     * @param n
+     * @param seed
+     * @param words_per_doc
+     * @return
+     */
+    static std::vector<Document> make_corpus(const size_t n, const uint64_t seed = 42, const size_t words_per_doc = 64) {
+        std::mt19937_64 gen(seed);
+        std::vector<Document> docs;
+        docs.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            std::string text = fmt::format("doc-{}-{}:", seed, i);
+            for (size_t j = 0; j < words_per_doc; ++j) {
+                text += " ";
+                text += VOCABULARY[gen() % VOCABULARY.size()];
+            }
+            Document document;
+            document.set_text(text);
+            DocumentUtils::AddMissingPresetMetadataFields(document);
+            docs.push_back(std::move(document));
+        }
+        return docs;
+    }
+
+    /**
+     * Generate `n` short queries, deterministic for given `seed`
+     */
+    static std::vector<std::string> make_queries(const size_t n, const uint64_t seed = 7, const size_t words_per_query = 3) {
+        std::mt19937_64 gen(seed);
+        std::vector<std::string> queries;
+        queries.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            std::vector<std::string> words;
+            for (size_t j = 0; j < words_per_query; ++j) {
+                words.push_back(VOCABULARY[gen() % VOCABULARY.size()]);
+            }
+            queries.push_back(StringUtils::JoinWith(words, " "));
+        }
+        return queries;
+    }
+
+    static VectorStorePtr create_in_memory_vector_store(const size_t dimension, const VectorQuantizationType quantization = kNoQuantization, const std::string& table_name = "bench_vector_table") {
+        DuckDBStoreOptions options {.table_name = table_name, .dimension = dimension, .in_memory = true};
+        options.vector_quantization.type = quantization;
+        return CreateDuckDBVectorStore(create_hashed_embedding_model(dimension), options);
+    }
+
+    /**
+     * Get a populated vector store with `n` documents of `dimension`. Stores are built once and shared by all benchmark runs with same arguments, as building them is much more expensive than searching.
+     */
+    static VectorStorePtr get_populated_vector_store(const size_t n, const size_t dimension, const uint64_t seed = 42, const VectorQuantizationType quantization = kNoQuantization) {
+        static std::mutex mutex;
+        static std::map<std::tuple<size_t, size_t, uint64_t, VectorQuantizationType>, VectorStorePtr> stores;
+        std::lock_guard guard {mutex};
+        const auto key = std::make_tuple(n, dimension, seed, quantization);
+        if (const auto itr = stores.find(key); itr != stores.end()) {
+            return itr->second;
+        }
+        auto store = create_in_memory_vector_store(dimension, quantization);
+        auto docs = make_corpus(n, seed);
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        assert_true(update_result.failed_documents_size() == 0, "should have all documents inserted");
+        stores.emplace(key, store);
+        return store;
+    }
+}
+
+#endif //RETRIEVALBENCHGLOBALS_HPP
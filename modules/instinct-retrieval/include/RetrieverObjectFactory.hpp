@@ -48,9 +48,9 @@ namespace INSTINCT_RETRIEVAL_NS {
 
         static IngestorPtr CreateDirectoryTreeIngestor(
             const std::filesystem::path& folder,
+            const DirectoryTreeIngestorOptions& options,
             std::unique_ptr<RegexMatcher> regex_matcher = nullptr,
-            IngestorFactoryFunction ingestor_factory_function = nullptr,
-            bool recursive = true
+            IngestorFactoryFunction ingestor_factory_function = nullptr
         ) {
             if (!ingestor_factory_function) {
                 ingestor_factory_function = [](const std::filesystem::path& path) {return CreateIngestor(path);};
@@ -59,7 +59,21 @@ namespace INSTINCT_RETRIEVAL_NS {
                 folder,
                 std::move(regex_matcher),
                 ingestor_factory_function,
-                recursive
+                options
+            );
+        }
+
+        static IngestorPtr CreateDirectoryTreeIngestor(
+            const std::filesystem::path& folder,
+            std::unique_ptr<RegexMatcher> regex_matcher = nullptr,
+            IngestorFactoryFunction ingestor_factory_function = nullptr,
+            bool recursive = true
+        ) {
+            return CreateDirectoryTreeIngestor(
+                folder,
+                DirectoryTreeIngestorOptions {.recursive = recursive},
+                std::move(regex_matcher),
+                std::move(ingestor_factory_function)
             );
         }
 
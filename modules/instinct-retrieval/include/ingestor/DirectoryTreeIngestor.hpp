@@ -8,7 +8,11 @@
 
 #include "BaseIngestor.hpp"
 #include "tools/Assertions.hpp"
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <mutex>
+#include <numeric>
 
 #include "SingleFileIngestor.hpp"
 
@@ -17,63 +21,323 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     using IngestorFactoryFunction = std::function<IngestorPtr(const std::filesystem::path& entry_path)>;
 
+    struct DirectoryTreeIngestorOptions {
+        /**
+         * Walk into sub-folders
+         */
+        bool recursive = true;
+
+        /**
+         * Max count of files being parsed at the same time
+         */
+        size_t max_concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+
+        /**
+         * Max count of files that are being parsed or parsed but not yet emitted downstream, which bounds memory held by parsed documents. Default to twice of `max_concurrency` if zero.
+         */
+        size_t max_buffered_files = 0;
+
+        /**
+         * Emit documents in lexicographic order of file paths, regardless of which file is parsed first. Otherwise, documents of a file are emitted as soon as it's parsed, and larger files are scheduled first so that they won't be stragglers at the tail. Documents of the same file are always emitted in their original order.
+         */
+        bool ordered = true;
+
+        /**
+         * Glob patterns of files to be included. If not empty, a file should match at least one of them. `*` matches any characters except `/`, `**` matches any characters including `/`, and `?` matches a single character except `/`. Patterns without `/` are matched against file names, and others are matched against paths relative to the folder.
+         */
+        std::vector<std::string> include_globs;
+
+        /**
+         * Glob patterns of files to be excluded, with same syntax of `include_globs`.
+         */
+        std::vector<std::string> exclude_globs;
+
+        /**
+         * Count of shards that files are partitioned into. Files are assigned to shards by size, so that shards have similar total bytes. It's useful to split a large tree among many processes.
+         */
+        size_t shard_count = 1;
+
+        /**
+         * Index of shard to be loaded by this ingestor, in `[0, shard_count)`.
+         */
+        size_t shard_index = 0;
+    };
+
+    namespace details {
+        static bool match_glob(const std::string_view pattern, const std::string_view path, const size_t pi, const size_t si, std::vector<int8_t>& memo) {
+            auto& cached = memo[pi * (path.size() + 1) + si];
+            if (cached >= 0) {
+                return cached;
+            }
+            bool matched = false;
+            if (pi == pattern.size()) {
+                matched = si == path.size();
+            } else if (pattern[pi] == '*' && pi + 1 < pattern.size() && pattern[pi + 1] == '*') {
+                // `**/` also matches zero folder
+                if (pi + 2 < pattern.size() && pattern[pi + 2] == '/') {
+                    matched = match_glob(pattern, path, pi + 3, si, memo);
+                }
+                for (size_t k = si; !matched && k <= path.size(); ++k) {
+                    matched = match_glob(pattern, path, pi + 2, k, memo);
+                }
+            } else if (pattern[pi] == '*') {
+                for (size_t k = si; !matched && k <= path.size(); ++k) {
+                    matched = match_glob(pattern, path, pi + 1, k, memo);
+                    if (k < path.size() && path[k] == '/') {
+                        break;
+                    }
+                }
+            } else if (si < path.size() && (pattern[pi] == '?' ? path[si] != '/' : pattern[pi] == path[si])) {
+                matched = match_glob(pattern, path, pi + 1, si + 1, memo);
+            }
+            cached = matched;
+            return matched;
+        }
+
+        /**
+         * Match `relative_path`, which uses `/` as separator, against glob pattern. See `DirectoryTreeIngestorOptions::include_globs` for syntax.
+         */
+        static bool match_glob(const std::string_view pattern, const std::string_view relative_path) {
+            std::string_view path = relative_path;
+            if (pattern.find('/') == std::string_view::npos) {
+                if (const auto pos = path.rfind('/'); pos != std::string_view::npos) {
+                    path = path.substr(pos + 1);
+                }
+            }
+            std::vector<int8_t> memo((pattern.size() + 1) * (path.size() + 1), -1);
+            return match_glob(pattern, path, 0, 0, memo);
+        }
+
+        /**
+         * Partition files into `shard_count` shards of similar total bytes by assigning each file, from the largest one, to the shard with least bytes so far. Returns shard index of each file. Result is deterministic as long as paths are sorted.
+         */
+        static std::vector<size_t> assign_file_shards(const std::vector<uintmax_t>& file_sizes, const size_t shard_count) {
+            std::vector<size_t> order(file_sizes.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+                return file_sizes[a] > file_sizes[b];
+            });
+            std::vector<uintmax_t> shard_bytes(shard_count, 0);
+            std::vector<size_t> shards(file_sizes.size(), 0);
+            for (const auto i: order) {
+                const auto shard = static_cast<size_t>(std::distance(shard_bytes.begin(), std::ranges::min_element(shard_bytes)));
+                shard_bytes[shard] += file_sizes[i];
+                shards[i] = shard;
+            }
+            return shards;
+        }
+    }
+
     /**
-     * DirectoryTreeIngestor is capable of turning regular files in a directory into split documents.
+     * DirectoryTreeIngestor is capable of turning regular files in a directory into split documents. Files are parsed by a bounded worker pool, and documents are streamed downstream as files are parsed.
      */
     class DirectoryTreeIngestor final: public BaseIngestor {
+        struct FileEntry {
+            std::filesystem::path path;
+            uintmax_t size = 0;
+        };
+
+        struct ParsedFile {
+            size_t index = 0;
+            std::vector<Document> documents;
+            std::exception_ptr error;
+        };
+
+        struct ParsedFileQueue {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::deque<ParsedFile> parsed_files;
+        };
+
         std::filesystem::path folder_path_;
         std::unique_ptr<RegexMatcher> regex_matcher_;
         IngestorFactoryFunction ingestor_factory_function_;
-        bool recursive_;
+        DirectoryTreeIngestorOptions options_;
+        // created on first call to `Load`, so that ingestors which are never loaded hold no threads
+        std::once_flag worker_pool_flag_;
+        std::unique_ptr<ThreadPool> worker_pool_;
     public:
         DirectoryTreeIngestor(
             std::filesystem::path folder_path,
             std::unique_ptr<RegexMatcher> regex_matcher,
             IngestorFactoryFunction ingestor_factory_function,
-            const bool recursive
+            DirectoryTreeIngestorOptions options = {}
             )
             : BaseIngestor(nullptr),
-            folder_path_(std::move(folder_path)), regex_matcher_(std::move(regex_matcher)), ingestor_factory_function_(std::move(ingestor_factory_function)),  recursive_(recursive) {
+            folder_path_(std::move(folder_path)), regex_matcher_(std::move(regex_matcher)), ingestor_factory_function_(std::move(ingestor_factory_function)), options_(std::move(options)) {
             assert_true(std::filesystem::exists(folder_path_), "Given folder should exist");
             assert_true(std::filesystem::is_directory(folder_path_), "should be a folder");
+            assert_true(ingestor_factory_function_, "should provide ingestor factory function");
+            assert_positive(options_.shard_count, "shard_count should be positive");
+            assert_true(options_.shard_index < options_.shard_count, "shard_index should be less than shard_count");
         }
 
         AsyncIterator<Document> Load() override {
-            std::vector<std::filesystem::path> valid_files;
-            if (recursive_) {
+            return rpp::source::create<Document>([&](const auto& observer) {
+                try {
+                    ParseFiles_(ListFiles_(), observer);
+                    observer.on_completed();
+                } catch (...) {
+                    observer.on_error(std::current_exception());
+                }
+            });
+        }
+
+    private:
+        /**
+         * Walk the tree and return matched files of current shard, in lexicographic order of paths
+         */
+        [[nodiscard]] std::vector<FileEntry> ListFiles_() const {
+            std::vector<FileEntry> files;
+            const auto collect = [&](const std::filesystem::directory_entry& dir_entry) {
+                if (MatchSingleEntry_(dir_entry)) {
+                    files.push_back({.path = dir_entry.path(), .size = dir_entry.file_size()});
+                }
+            };
+            if (options_.recursive) {
                 for (const auto& dir_entry: std::filesystem::recursive_directory_iterator{folder_path_}) {
-                    if (MatchSingleEntry_(dir_entry)) {
-                        valid_files.push_back(dir_entry.path());
-                    }
+                    collect(dir_entry);
                 }
             } else {
                 for (auto const& dir_entry : std::filesystem::directory_iterator{folder_path_}) {
-                    if (MatchSingleEntry_(dir_entry)) {
-                        valid_files.push_back(dir_entry.path());
+                    collect(dir_entry);
+                }
+            }
+            // iteration order of directory is unspecified
+            std::ranges::sort(files, [](const FileEntry& a, const FileEntry& b) { return a.path < b.path; });
+
+            if (options_.shard_count > 1) {
+                std::vector<uintmax_t> file_sizes;
+                file_sizes.reserve(files.size());
+                for (const auto& file: files) {
+                    file_sizes.push_back(file.size);
+                }
+                const auto shards = details::assign_file_shards(file_sizes, options_.shard_count);
+                std::vector<FileEntry> shard_files;
+                for (size_t i = 0; i < files.size(); ++i) {
+                    if (shards[i] == options_.shard_index) {
+                        shard_files.push_back(std::move(files[i]));
                     }
                 }
+                files = std::move(shard_files);
             }
+            LOG_DEBUG("Listed files in {}: files.size()={}, shard_index={}, shard_count={}", folder_path_.string(), files.size(), options_.shard_index, options_.shard_count);
+            return files;
+        }
+
+        template<typename Observer>
+        void ParseFiles_(std::vector<FileEntry> files, const Observer& observer) {
+            if (!options_.ordered) {
+                std::ranges::stable_sort(files, std::ranges::greater {}, &FileEntry::size);
+            }
+            std::call_once(worker_pool_flag_, [&] {
+                worker_pool_ = std::make_unique<ThreadPool>(std::max<size_t>(options_.max_concurrency, 1));
+            });
+            const size_t max_buffered_files = options_.max_buffered_files > 0 ? options_.max_buffered_files : 2 * std::max<size_t>(options_.max_concurrency, 1);
+            // shared with tasks so that it outlives them even if downstream throws
+            const auto queue = std::make_shared<ParsedFileQueue>();
+            // parsed files waiting for files before them, in ordered mode
+            std::map<size_t, ParsedFile> pending_files;
+            size_t submitted_count = 0, in_flight_count = 0, emitted_count = 0;
+            std::exception_ptr error;
 
-            // TODO Do it in parallel
-            return rpp::source::from_iterable(valid_files)
-                | rpp::operators::flat_map([&](const std::filesystem::path& entry) {
-                    const auto ingestor = ingestor_factory_function_(entry);
-                    return ingestor->Load();
-                });
+            const auto emit = [&](const ParsedFile& parsed_file) {
+                for (const auto& document: parsed_file.documents) {
+                    observer.on_next(document);
+                }
+                ++emitted_count;
+            };
+
+            while (true) {
+                while (!error && submitted_count < files.size() && in_flight_count + pending_files.size() < max_buffered_files) {
+                    worker_pool_->detach_task([queue, index = submitted_count, file_path = files[submitted_count].path, ingestor_factory_function = ingestor_factory_function_] {
+                        ParsedFile parsed_file {.index = index};
+                        try {
+                            // factory may return null for unsupported files
+                            if (const auto ingestor = ingestor_factory_function(file_path)) {
+                                parsed_file.documents = CollectVector(ingestor->Load());
+                            } else {
+                                LOG_DEBUG("No ingestor for file: {}", file_path.string());
+                            }
+                        } catch (...) {
+                            parsed_file.error = std::current_exception();
+                        }
+                        {
+                            std::lock_guard guard {queue->mutex};
+                            queue->parsed_files.push_back(std::move(parsed_file));
+                        }
+                        queue->cv.notify_one();
+                    });
+                    ++submitted_count;
+                    ++in_flight_count;
+                }
+                if (in_flight_count == 0) {
+                    break;
+                }
+
+                ParsedFile parsed_file;
+                {
+                    std::unique_lock lock {queue->mutex};
+                    queue->cv.wait(lock, [&] { return !queue->parsed_files.empty(); });
+                    parsed_file = std::move(queue->parsed_files.front());
+                    queue->parsed_files.pop_front();
+                }
+                --in_flight_count;
+                if (error) {
+                    // draining in-flight tasks
+                    continue;
+                }
+                if (parsed_file.error) {
+                    LOG_ERROR("Failed to parse file: {}", files[parsed_file.index].path.string());
+                    error = parsed_file.error;
+                    continue;
+                }
+
+                try {
+                    if (options_.ordered) {
+                        pending_files.emplace(parsed_file.index, std::move(parsed_file));
+                        while (!pending_files.empty() && pending_files.begin()->first == emitted_count) {
+                            emit(pending_files.begin()->second);
+                            pending_files.erase(pending_files.begin());
+                        }
+                    } else {
+                        emit(parsed_file);
+                    }
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
         }
 
-    private:
         [[nodiscard]] bool MatchSingleEntry_(const std::filesystem::directory_entry& dir_entry) const {
             // only accepting regular file, skipping directories, symlinks and block files, etc.
-            if (dir_entry.is_regular_file()) {
-                if (this->regex_matcher_) {
-                    const UnicodeString absolute_path = UnicodeString::fromUTF8(dir_entry.path().string());
-                    this->regex_matcher_->reset(absolute_path);
-                    return this->regex_matcher_->find();
+            if (!dir_entry.is_regular_file()) {
+                return false;
+            }
+            if (!options_.include_globs.empty() || !options_.exclude_globs.empty()) {
+                const auto relative_path = dir_entry.path().lexically_relative(folder_path_).generic_string();
+                const auto match_any = [&](const std::vector<std::string>& globs) {
+                    return std::ranges::any_of(globs, [&](const std::string& glob) {
+                        return details::match_glob(glob, relative_path);
+                    });
+                };
+                if (!options_.include_globs.empty() && !match_any(options_.include_globs)) {
+                    return false;
+                }
+                if (match_any(options_.exclude_globs)) {
+                    return false;
                 }
-                return true;
             }
-            return false;
+            if (this->regex_matcher_) {
+                const UnicodeString absolute_path = UnicodeString::fromUTF8(dir_entry.path().string());
+                this->regex_matcher_->reset(absolute_path);
+                return this->regex_matcher_->find();
+            }
+            return true;
         }
     };
 
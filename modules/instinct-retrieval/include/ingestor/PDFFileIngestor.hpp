@@ -5,6 +5,7 @@
 #ifndef PDFFILEINGESTOR_HPP
 #define PDFFILEINGESTOR_HPP
 
+#include <mutex>
 #include <fpdfview.h>
 #include <fpdf_text.h>
 #include <unicode/unistr.h>
@@ -15,6 +16,11 @@
 
 
 namespace INSTINCT_RETRIEVAL_NS {
+    /**
+     * PDFium is not thread-safe, so calls to it are serialized with this process-wide lock, e.g. when many files are parsed by `DirectoryTreeIngestor` at the same time.
+     */
+    inline std::mutex PDFIUM_MUTEX;
+
     class PDFIUMConfig {
     public:
         PDFIUMConfig() {
@@ -37,8 +43,9 @@ namespace INSTINCT_RETRIEVAL_NS {
         FPDF_PAGE page_{};
 
     public:
-        PDFIUMPage(FPDF_DOCUMENT doc, const int page_index)
-            : page_(FPDF_LoadPage(doc, page_index)) {
+        PDFIUMPage(FPDF_DOCUMENT doc, const int page_index) {
+            std::lock_guard guard {PDFIUM_MUTEX};
+            page_ = FPDF_LoadPage(doc, page_index);
         }
 
         explicit PDFIUMPage(FPDF_PAGE page)
@@ -46,24 +53,19 @@ namespace INSTINCT_RETRIEVAL_NS {
         }
 
         ~PDFIUMPage() {
+            std::lock_guard guard {PDFIUM_MUTEX};
             FPDF_ClosePage(page_);
         }
 
         UnicodeString ExtractPageText() {
+            std::lock_guard guard {PDFIUM_MUTEX};
             auto* text_page = FPDFText_LoadPage(page_);
             UnicodeString result;
-            int buf_size = 1024;
-            // int processed_count = 0;
-            int start_index = 0;
-            unsigned short buf[buf_size];
-            const auto char_count = FPDFText_CountChars(text_page);
-            while (true) {
-                int processed_count = FPDFText_GetText(text_page, start_index, buf_size, buf);
-                start_index += processed_count;
-                result += UnicodeString(buf, processed_count);
-                if(start_index >= char_count) {
-                    break;
-                }
+            if (const int char_count = FPDFText_CountChars(text_page); char_count > 0) {
+                // text is written into buffer of exact size in a single call. returned count includes trailing terminator.
+                auto* buf = result.getBuffer(char_count + 1);
+                const int written = FPDFText_GetText(text_page, 0, char_count, reinterpret_cast<unsigned short*>(buf));
+                result.releaseBuffer(std::max(written - 1, 0));
             }
             FPDFText_ClosePage(text_page);
             return result;
@@ -75,9 +77,11 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     public:
         PDFIUMDoc(const std::filesystem::path& file_path, const std::string& password) {
+            std::unique_lock lock {PDFIUM_MUTEX};
             doc_ = FPDF_LoadDocument(file_path.c_str(), password.c_str());
             if (!doc_) {
                 unsigned long err = FPDF_GetLastError();
+                lock.unlock();
                 auto path_string = file_path.string();
                 std::string error_string;
                 switch (err) {
@@ -110,10 +114,12 @@ namespace INSTINCT_RETRIEVAL_NS {
         }
 
         ~PDFIUMDoc() {
+            std::lock_guard guard {PDFIUM_MUTEX};
             FPDF_CloseDocument(doc_);
         }
 
         [[nodiscard]] int GetPageCount() const {
+            std::lock_guard guard {PDFIUM_MUTEX};
             return FPDF_GetPageCount(doc_);
         }
 
@@ -124,9 +130,8 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     static PDFIUMConfig GLOBAL_CONFIG;
 
-
     /**
-    * Parsing PDF files using PDFium library
+    * Parsing PDF files using PDFium library. Page documents are emitted one by one as pages are extracted, so that downstream consumers don't wait for the whole file.
     */
     class PDFFileIngestor final : public BaseIngestor {
         std::filesystem::path file_path_;
@@ -148,9 +153,9 @@ namespace INSTINCT_RETRIEVAL_NS {
 
         AsyncIterator<Document> Load() override {
             return rpp::source::create<Document>([&](const auto& observer) {
-                const auto pdf_doc = PDFIUMDoc(file_path_, password_);
-                const int count = pdf_doc.GetPageCount();
                 try {
+                    const PDFIUMDoc pdf_doc {file_path_, password_};
+                    const int count = pdf_doc.GetPageCount();
                     for (int i = 0; i < count; i++) {
                         auto text = pdf_doc.LoadPage(i).ExtractPageText();
                         std::string u8_text;
@@ -29,10 +29,93 @@ namespace INSTINCT_RETRIEVAL_NS {
     };
 
     struct ParquetFileIngestorOptions {
-        // used by naive ingestor to limit line count
-        size_t limit;
+        /**
+         * Max count of rows to read. Zero means no limit.
+         */
+        size_t limit = 0;
+
+        /**
+         * Create `StreamingParquetFileIngestor` in `CreateParquetIngestor`. Otherwise, `NaiveParquetFileIngestor` is created.
+         */
+        bool streaming = true;
+
+        /**
+         * Count of DuckDB threads reading row groups in parallel, used by streaming ingestor. Zero to use DuckDB's default, which is count of CPU cores.
+         */
+        size_t threads = 0;
+
+        /**
+         * Emit rows in order of file, used by streaming ingestor. Otherwise, rows of row groups read in parallel are emitted as soon as they are ready.
+         */
+        bool preserve_order = true;
+
+        /**
+         * Memory limit of DuckDB instance, e.g. `1GB`, used by streaming ingestor. DuckDB's default is used if blank.
+         */
+        std::string memory_limit;
     };
 
+    namespace details {
+        static std::string get_parquet_column_sql_type(const ParquetColumnMapping& column_mapping) {
+            if (column_mapping.column_type == kTextColumn) {
+                return "VARCHAR";
+            }
+            if (column_mapping.column_type == kMetadataColumn) {
+                switch (column_mapping.metadata_field_schema.type()) {
+                    case INT32:
+                        return "INTEGER";
+                    case INT64:
+                        return "BIGINT";
+                    case FLOAT:
+                        return "FLOAT";
+                    case DOUBLE:
+                        return "DOUBLE";
+                    case VARCHAR:
+                        return "VARCHAR";
+                    case BOOL:
+                        return "BOOLEAN";
+                    default:
+                        throw InstinctException("unknown field type for field named " + column_mapping.metadata_field_schema.name());
+                }
+            }
+            throw InstinctException(fmt::format("unknown column type at index {}, column name {}, given column type {}",
+                column_mapping.column_index,
+                column_mapping.metadata_field_schema.name(),
+                static_cast<int>(column_mapping.column_type)
+            ));
+        }
+
+        /**
+         * Make SQL selecting mapped columns of parquet file, in order of column mapping. Each column is cast to the type of its mapping, so that values can be read from flat vectors of result directly. Parquet reader reads only the selected columns.
+         * @param parquet_column_names names of all columns in parquet file
+         * @param column_mapping
+         * @param file_source
+         * @param limit
+         * @return
+         */
+        static std::string make_parquet_select_sql(
+            const std::vector<std::string>& parquet_column_names,
+            const std::vector<ParquetColumnMapping>& column_mapping,
+            const std::string& file_source,
+            const size_t limit) {
+            std::vector<std::string> columns;
+            for (const auto& mapping: column_mapping) {
+                assert_true(mapping.column_index >= 0 && static_cast<size_t>(mapping.column_index) < parquet_column_names.size(), fmt::format("column index {} is out of range, parquet file has {} columns", mapping.column_index, parquet_column_names.size()));
+                std::string name;
+                for (const char c: parquet_column_names[mapping.column_index]) {
+                    // quote identifier
+                    name += c == '"' ? "\"\"" : std::string(1, c);
+                }
+                columns.push_back(fmt::format("CAST(\"{}\" AS {})", name, get_parquet_column_sql_type(mapping)));
+            }
+            auto sql = fmt::format("SELECT {} FROM read_parquet('{}')", StringUtils::JoinWith(columns, ", "), StringUtils::EscapeSQLText(file_source));
+            if (limit > 0) {
+                sql += fmt::format(" LIMIT {}", limit);
+            }
+            return sql + ";";
+        }
+    }
+
     class BaseParquetFileIngestor: public BaseIngestor {
         std::string file_source_;
         std::vector<ParquetColumnMapping> column_mapping_;
@@ -45,71 +128,117 @@ namespace INSTINCT_RETRIEVAL_NS {
               file_source_id_(std::move(file_source_id)) {
         }
 
-        virtual unique_ptr<MaterializedQueryResult> ReadParquet(Connection& conn, const std::string& file_source) = 0;
+        /**
+         * Query rows of parquet file. Columns of result should be those in column mapping, in the same order and of types given by `details::get_parquet_column_sql_type`.
+         */
+        virtual unique_ptr<QueryResult> ReadParquet(Connection& conn, const std::string& file_source) = 0;
 
         AsyncIterator<Document> Load() override {
             return rpp::source::create<Document>([&](const auto & observer) {
-                duckdb::DuckDB duck_db(nullptr);
-                duckdb::Connection conn(duck_db);
-                if(const auto result = ReadParquet(conn, file_source_); check_query_ok(result)) {
-                    for(int i=0; const auto& row: *result) {
-                        Document document = CreateNewDocument(
-                            "",
-                            ROOT_DOC_ID,
-                            ++i,
-                            StringUtils::IsBlankString(file_source_id_) ? file_source_ : file_source_id_
-                        );
-                        for(const auto&[column_type, metadata_field_schema, column_idx] : column_mapping_) {
-                            if(column_type == kTextColumn) {
-                                document.set_text(row.GetValue<std::string>(column_idx));
-                                continue;
-                            }
-                            if (column_type == kMetadataColumn) {
-                                auto* metadata_field = document.add_metadata();
-                                metadata_field->set_name(metadata_field_schema.name());
-                                switch (const auto field_schema = metadata_field_schema; field_schema.type()) {
-                                    case INT32:
-                                        metadata_field->set_int_value(row.GetValue<int32_t>(column_idx));
-                                        break;
-                                    case INT64:
-                                        metadata_field->set_long_value(row.GetValue<int64_t>(column_idx));
-                                        break;
-                                    case FLOAT:
-                                        metadata_field->set_float_value(row.GetValue<float>(column_idx));
-                                        break;
-                                    case DOUBLE:
-                                        metadata_field->set_double_value(row.GetValue<double>(column_idx));
-                                        break;
-                                    case VARCHAR:
-                                        metadata_field->set_string_value(row.GetValue<std::string>(column_idx));
-                                        break;
-                                    case BOOL:
-                                        metadata_field->set_bool_value(row.GetValue<bool>(column_idx));
-                                        break;
-                                    default:
-                                        observer.on_error(std::make_exception_ptr(InstinctException("unknown field type for field named " + field_schema.name())));
-                                }
-                                continue;
-                            }
-                            observer.on_error(std::make_exception_ptr(InstinctException(fmt::format("unknown column type at index {}, column name {}, given column type {}",
-                                std::to_string(column_idx),
-                                metadata_field_schema.name(),
-                                metadata_field_schema.type()
-                                ))));
+                try {
+                    duckdb::DuckDB duck_db(nullptr);
+                    duckdb::Connection conn(duck_db);
+                    const auto result = ReadParquet(conn, file_source_);
+                    assert_query_ok(result);
+                    assert_true(result->ColumnCount() == column_mapping_.size(), "should have one result column for each column mapping");
+                    int row_count = 0;
+                    // rows are converted chunk by chunk, so that a streamed result is never materialized as a whole
+                    while (const auto chunk = result->Fetch()) {
+                        if (chunk->size() == 0) {
+                            break;
                         }
-                        DocumentUtils::AddMissingPresetMetadataFields(document);
-                        observer.on_next(document);
+                        ConvertChunk_(*chunk, row_count, observer);
+                        row_count += static_cast<int>(chunk->size());
                     }
+                    assert_query_ok(result);
+                    LOG_DEBUG("{} rows read from parquet file {}", row_count, file_source_);
                     observer.on_completed();
-                } else {
-                    observer.on_error(std::make_exception_ptr(InstinctException(result->GetError())));
+                } catch (...) {
+                    observer.on_error(std::current_exception());
                 }
             });
         }
+
+        [[nodiscard]] const std::vector<ParquetColumnMapping>& GetColumnMapping() const {
+            return column_mapping_;
+        }
+
+    protected:
+        /**
+         * Read names of all columns in parquet file, which only touches its metadata
+         */
+        static std::vector<std::string> ReadParquetColumnNames(Connection& conn, const std::string& file_source) {
+            const auto result = conn.Query(fmt::format("DESCRIBE SELECT * FROM read_parquet('{}');", StringUtils::EscapeSQLText(file_source)));
+            assert_query_ok(result);
+            std::vector<std::string> names;
+            for (idx_t i = 0; i < result->RowCount(); ++i) {
+                names.push_back(result->GetValue(0, i).ToString());
+            }
+            return names;
+        }
+
+    private:
+        template<typename Observer>
+        void ConvertChunk_(DataChunk& chunk, const int row_offset, const Observer& observer) const {
+            chunk.Flatten();
+            const auto source = StringUtils::IsBlankString(file_source_id_) ? file_source_ : file_source_id_;
+            for (idx_t row = 0; row < chunk.size(); ++row) {
+                Document document = CreateNewDocument(
+                    "",
+                    ROOT_DOC_ID,
+                    row_offset + static_cast<int>(row) + 1,
+                    source
+                );
+                for (idx_t i = 0; i < column_mapping_.size(); ++i) {
+                    const auto& [column_type, metadata_field_schema, column_idx] = column_mapping_[i];
+                    const auto& vector = chunk.data[i];
+                    const bool is_valid = FlatVector::Validity(vector).RowIsValid(row);
+                    if (column_type == kTextColumn) {
+                        if (is_valid) {
+                            const auto text = details::get_string_view(vector, row);
+                            document.set_text(text.data(), text.size());
+                        }
+                        continue;
+                    }
+                    auto* metadata_field = document.add_metadata();
+                    metadata_field->set_name(metadata_field_schema.name());
+                    if (!is_valid) {
+                        metadata_field->set_is_null(true);
+                        continue;
+                    }
+                    switch (metadata_field_schema.type()) {
+                        case INT32:
+                            metadata_field->set_int_value(FlatVector::GetData<int32_t>(vector)[row]);
+                            break;
+                        case INT64:
+                            metadata_field->set_long_value(FlatVector::GetData<int64_t>(vector)[row]);
+                            break;
+                        case FLOAT:
+                            metadata_field->set_float_value(FlatVector::GetData<float>(vector)[row]);
+                            break;
+                        case DOUBLE:
+                            metadata_field->set_double_value(FlatVector::GetData<double>(vector)[row]);
+                            break;
+                        case VARCHAR: {
+                            const auto value = details::get_string_view(vector, row);
+                            metadata_field->set_string_value(value.data(), value.size());
+                            break;
+                        }
+                        case BOOL:
+                            metadata_field->set_bool_value(FlatVector::GetData<bool>(vector)[row]);
+                            break;
+                        default:
+                            throw InstinctException("unknown field type for field named " + metadata_field_schema.name());
+                    }
+                }
+                DocumentUtils::AddMissingPresetMetadataFields(document);
+                observer.on_next(document);
+            }
+        }
     };
 
     /**
-     * This ingestor will trigger a `SELECT *` against parquet file. A more delicate handling is needed for large parquet file.
+     * This ingestor will trigger a query against parquet file, whose result is fully materialized before any document is emitted. Use `StreamingParquetFileIngestor` for large parquet file.
      */
     class NaiveParquetFileIngestor final: public BaseParquetFileIngestor {
         ParquetFileIngestorOptions options_;
@@ -119,17 +248,45 @@ namespace INSTINCT_RETRIEVAL_NS {
             : BaseParquetFileIngestor(file_source, column_mapping, document_post_processor, parent_doc_id), options_(options) {
         }
 
-        unique_ptr<MaterializedQueryResult> ReadParquet(Connection &conn, const std::string &file_source) override {
-            const auto sql_line = options_.limit > 0 ?
-                fmt::format("select * from read_parquet('{}') limit {};", file_source, options_.limit):
-                fmt::format("select * from read_parquet('{}');", file_source);
+        unique_ptr<QueryResult> ReadParquet(Connection &conn, const std::string &file_source) override {
+            const auto sql_line = details::make_parquet_select_sql(ReadParquetColumnNames(conn, file_source), GetColumnMapping(), file_source, options_.limit);
             LOG_DEBUG("Query SQL: {}", sql_line);
             return conn.Query(sql_line);
         }
     };
 
+    /**
+     * This ingestor streams rows of parquet file with DuckDB's `StreamQueryResult`, and documents are emitted chunk by chunk as row groups are read. Only mapped columns are read from the file. Row groups are read by DuckDB threads in parallel, whose count is limited by `ParquetFileIngestorOptions::threads`.
+     */
+    class StreamingParquetFileIngestor final: public BaseParquetFileIngestor {
+        ParquetFileIngestorOptions options_;
+    public:
+        StreamingParquetFileIngestor(const std::string &file_source,
+            const std::vector<ParquetColumnMapping> &column_mapping, const ParquetFileIngestorOptions& options = {}, const DocumentPostProcessor &document_post_processor = nullptr, const std::string& parent_doc_id = ROOT_DOC_ID)
+            : BaseParquetFileIngestor(file_source, column_mapping, document_post_processor, parent_doc_id), options_(options) {
+        }
+
+        unique_ptr<QueryResult> ReadParquet(Connection &conn, const std::string &file_source) override {
+            // settings are applied to the DuckDB instance owned by this load
+            if (options_.threads > 0) {
+                assert_query_ok(conn.Query(fmt::format("SET threads = {};", options_.threads)));
+            }
+            if (!options_.preserve_order) {
+                assert_query_ok(conn.Query("SET preserve_insertion_order = false;"));
+            }
+            if (StringUtils::IsNotBlankString(options_.memory_limit)) {
+                assert_query_ok(conn.Query(fmt::format("SET memory_limit = '{}';", StringUtils::EscapeSQLText(options_.memory_limit))));
+            }
+            const auto sql_line = details::make_parquet_select_sql(ReadParquetColumnNames(conn, file_source), GetColumnMapping(), file_source, options_.limit);
+            LOG_DEBUG("Query SQL: {}", sql_line);
+            return conn.SendQuery(sql_line);
+        }
+    };
 
     static IngestorPtr CreateParquetIngestor(const std::string& file_source, const std::vector<ParquetColumnMapping> &column_mapping, const ParquetFileIngestorOptions& options = {}, const DocumentPostProcessor &document_post_processor = nullptr, const std::string& parent_doc_id = ROOT_DOC_ID) {
+        if (options.streaming) {
+            return std::make_shared<StreamingParquetFileIngestor>(file_source, column_mapping, options, document_post_processor, parent_doc_id);
+        }
         return std::make_shared<NaiveParquetFileIngestor>(file_source, column_mapping, options, document_post_processor, parent_doc_id);
     }
 
@@ -145,7 +302,7 @@ namespace INSTINCT_RETRIEVAL_NS {
     static IngestorPtr CreateParquetIngestor(const std::string& file_source, const std::string& mapping_string, const ParquetFileIngestorOptions& options = {}, const DocumentPostProcessor &document_post_processor = nullptr, const std::string& parent_doc_id = ROOT_DOC_ID) {
         std::vector<ParquetColumnMapping> mappings;
 
-        bool found_text;
+        bool found_text = false;
         for(const auto& column: StringUtils::ReSplit(StringUtils::Trim(mapping_string), std::regex(","))) {
             if(StringUtils::IsBlankString(column)) continue;
             ParquetColumnMapping column_mapping;
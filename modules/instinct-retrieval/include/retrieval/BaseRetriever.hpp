@@ -9,6 +9,7 @@
 #include "tools/DocumentUtils.hpp"
 #include "functional/StepFunctions.hpp"
 #include "store/IDocStore.hpp"
+#include "store/IVectorStore.hpp"
 
 namespace INSTINCT_RETRIEVAL_NS {
     using namespace INSTINCT_LLM_NS;
@@ -34,6 +35,19 @@ namespace INSTINCT_RETRIEVAL_NS {
          */
         [[nodiscard]] virtual AsyncIterator<Document> Retrieve(const SearchRequest& search_request) const = 0;
 
+        /**
+         * Retrieve with multiple queries sharing the same `top_k` and metadata filter. This default implementation retrieves them one by one, and retrievers backed by a vector store should override it with `IVectorStore::BatchSearchDocuments`.
+         * @param request
+         * @return per-query results, and fused results if requested
+         */
+        [[nodiscard]] virtual BatchSearchResult BatchRetrieve(const BatchSearchRequest& request) const {
+            std::vector<std::vector<Document>> ranked_lists;
+            for (const auto& query: request.queries()) {
+                ranked_lists.push_back(CollectVector(Retrieve(details::make_search_request(request, query))));
+            }
+            return details::make_batch_search_result(request, ranked_lists);
+        }
+
         [[nodiscard]] StepFunctionPtr AsContextRetrieverFunction(const RetrieverFunctionOptions& options = {}) const {
             return std::make_shared<LambdaStepFunction>([&, options](const JSONContextPtr &ctx) {
                     const auto question_string = ctx->RequirePrimitive<std::string>();
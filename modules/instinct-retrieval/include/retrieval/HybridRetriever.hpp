@@ -0,0 +1,93 @@
+#ifndef HYBRIDRETRIEVER_HPP
+#define HYBRIDRETRIEVER_HPP
+
+#include "BaseRetriever.hpp"
+#include "store/IVectorStore.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    struct HybridRetrieverOptions {
+        /**
+         * Weight of ranked list from vector search in fusion. Zero means vector search is skipped.
+         */
+        double vector_weight = 1.0;
+
+        /**
+         * Weight of ranked list from keyword search in fusion. Zero means keyword search is skipped.
+         */
+        double keyword_weight = 1.0;
+
+        /**
+         * Smoothing constant of reciprocal rank fusion
+         */
+        int rrf_k = 60;
+
+        /**
+         * Each path recalls `top_k * candidate_factor` documents before fusion, so that documents ranked low by one path can still be promoted by the other.
+         */
+        size_t candidate_factor = 2;
+    };
+
+    /**
+     * Retriever combining dense vector search and BM25 keyword search over the same store with weighted reciprocal rank fusion. Keyword search recovers exact matches of rare tokens like error codes and identifiers, which are usually poorly represented by embeddings.
+     *
+     * Keyword index should be enabled in store, e.g. `DuckDBStoreOptions::keyword_index`. As a `BaseRetriever`, it can be used as one path of `MultiPathRetriever`.
+     */
+    class HybridRetriever final: public BaseStatefulRetriever {
+        VectorStorePtr vector_store_;
+        HybridRetrieverOptions options_;
+
+    public:
+        explicit HybridRetriever(VectorStorePtr vector_store, const HybridRetrieverOptions& options = {})
+            : vector_store_(std::move(vector_store)), options_(options) {
+            assert_true(vector_store_, "should provide vector store");
+            assert_true(options_.vector_weight >= 0 && options_.keyword_weight >= 0, "weights should be non-negative");
+            assert_true(options_.vector_weight > 0 || options_.keyword_weight > 0, "should have at least one path enabled");
+            assert_positive(options_.candidate_factor, "candidate_factor should be positive");
+        }
+
+        DocStorePtr GetDocStore() override {
+            return vector_store_;
+        }
+
+        void Remove(const SearchQuery &metadata_query) override {
+            UpdateResult update_result;
+            vector_store_->DeleteDocuments(metadata_query, update_result);
+            assert_true(update_result.failed_documents_size() == 0, "should have all documents deleted");
+        }
+
+        void Ingest(const AsyncIterator<Document>& input) override {
+            UpdateResult update_result;
+            vector_store_->AddDocuments(input, update_result);
+            LOG_DEBUG("Ingest done, added={}, failed={}", update_result.affected_rows(), update_result.failed_documents().size());
+            assert_true(update_result.failed_documents_size() == 0, "should not have failed documents");
+        }
+
+        [[nodiscard]] AsyncIterator<Document> Retrieve(const SearchRequest &search_request) const override {
+            const int top_k = search_request.top_k() > 0 ? search_request.top_k() : 10;
+            SearchRequest candidate_request = search_request;
+            candidate_request.set_top_k(static_cast<int>(top_k * options_.candidate_factor));
+
+            // both paths share the connection of store, so they are executed sequentially. path with zero weight is skipped.
+            std::vector<std::vector<Document>> ranked_lists;
+            std::vector<double> weights;
+            if (options_.vector_weight > 0) {
+                ranked_lists.push_back(CollectVector(vector_store_->SearchDocuments(candidate_request)));
+                weights.push_back(options_.vector_weight);
+            }
+            if (options_.keyword_weight > 0) {
+                ranked_lists.push_back(CollectVector(vector_store_->SearchDocumentsByKeywords(candidate_request)));
+                weights.push_back(options_.keyword_weight);
+            }
+            auto fused = details::weighted_reciprocal_rank_fusion(ranked_lists, weights, top_k, options_.rrf_k);
+            LOG_DEBUG("Hybrid search done, paths={}, fused={}", ranked_lists.size(), fused.size());
+            return rpp::source::from_iterable(std::move(fused));
+        }
+    };
+
+    static StatefulRetrieverPtr CreateHybridRetriever(const VectorStorePtr& vector_store, const HybridRetrieverOptions& options = {}) {
+        return std::make_shared<HybridRetriever>(vector_store, options);
+    }
+}
+
+#endif //HYBRIDRETRIEVER_HPP
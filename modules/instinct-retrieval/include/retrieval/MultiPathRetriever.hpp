@@ -51,30 +51,85 @@ namespace INSTINCT_RETRIEVAL_NS {
                 const auto& batch =f.get();
                 docs.insert(docs.end(), batch.begin(), batch.end());
             }
+            // ranked documents are collected eagerly, as locals above are gone when returned iterator is subscribed
+            return rpp::source::from_iterable(Rerank_(search_request.query(), docs, search_request.top_k()));
+        }
+
+        /**
+         * Each child retriever is asked once for all queries, so that retrievers backed by vector stores can search them together. Documents recalled for each query are then re-ranked against it.
+         */
+        [[nodiscard]] BatchSearchResult BatchRetrieve(const BatchSearchRequest& request) const override {
+            using namespace std::chrono_literals;
 
-            auto multi_futures_2 = thread_pool_.submit_sequence<size_t>(0, docs.size(), [&](const size_t idx) {
-                return ranking_model_->GetRankingScore(search_request.query(), docs[idx].text());
+            if(retrievers_.size() == 1) return retrievers_[0]->BatchRetrieve(request);
+
+            auto multi_futures = thread_pool_.submit_sequence<size_t>(0, retrievers_.size(), [&](const size_t idx) {
+                return retrievers_[idx]->BatchRetrieve(request);
             });
+            if (!multi_futures.wait_for(60s)) {
+                throw InstinctException("Retrieving with multiple retrievers has been timeout");
+            }
+
+            std::vector<std::vector<Document>> recalled_lists(request.queries_size());
+            for (auto& f: multi_futures) {
+                const auto batch_result = f.get();
+                for (int i = 0; i < batch_result.results_size(); ++i) {
+                    const auto& documents = batch_result.results(i).documents();
+                    recalled_lists[i].insert(recalled_lists[i].end(), documents.begin(), documents.end());
+                }
+            }
+            std::vector<std::vector<Document>> ranked_lists;
+            ranked_lists.reserve(recalled_lists.size());
+            for (int i = 0; i < request.queries_size(); ++i) {
+                ranked_lists.push_back(Rerank_(request.queries(i), recalled_lists[i], request.top_k()));
+            }
+            return details::make_batch_search_result(request, ranked_lists);
+        }
+
+    private:
+        /**
+         * Score documents against query with ranking model, and return at most `top_k` of them with highest scores. Documents are scored with batch API of ranking model. If ranking model can evaluate calls in parallel, they are split into blocks, at most one for each thread in pool, which are scored in parallel.
+         */
+        [[nodiscard]] std::vector<Document> Rerank_(const std::string& query, const std::vector<Document>& docs, const int top_k) const {
+            std::vector<std::string> texts;
+            texts.reserve(docs.size());
+            for (const auto& doc: docs) {
+                texts.push_back(doc.text());
+            }
+            std::vector<float> scores;
+            if (const auto block_count = std::min<size_t>(ranking_model_->GetMaxConcurrency(), thread_pool_.get_thread_count()); block_count > 1) {
+                auto score_futures = thread_pool_.submit_blocks<size_t>(0, texts.size(), [&](const size_t start, const size_t end) {
+                    return ranking_model_->GetRankingScores(query, {texts.begin() + static_cast<long>(start), texts.begin() + static_cast<long>(end)});
+                }, block_count);
+                scores.reserve(texts.size());
+                for (auto& f: score_futures) {
+                    const auto& block_scores = f.get();
+                    scores.insert(scores.end(), block_scores.begin(), block_scores.end());
+                }
+            } else {
+                scores = ranking_model_->GetRankingScores(query, texts);
+            }
+            assert_true(scores.size() == docs.size(), "should have one score for each document");
             std::vector<std::pair<std::string, float>> doc_id_with_score;
             doc_id_with_score.reserve(docs.size());
-            for(int i=0; auto& f: multi_futures_2) {
-                doc_id_with_score.emplace_back(docs[i++].id(), f.get());
+            for(size_t i=0; i<docs.size(); ++i) {
+                doc_id_with_score.emplace_back(docs[i].id(), scores[i]);
             }
             std::ranges::sort(doc_id_with_score, [](const auto& a, const auto& b) {
                 return a.second > b.second;
             });
 
             std::map<std::string, size_t> doc_id_idx;
-            for(int i=0;i<docs.size();++i) {
+            for(size_t i=0;i<docs.size();++i) {
                 doc_id_idx[docs[i].id()] = i;
             }
 
-            return rpp::source::create<Document>([&](const auto& observer) {
-                for(int i=0;i<search_request.top_k() && i<doc_id_with_score.size();++i) {
-                    const auto&[doc_id, score] = doc_id_with_score[i];
-                    observer.on_next(docs.at(doc_id_idx.at(doc_id)));
-                }
-            });
+            std::vector<Document> ranked_docs;
+            for(size_t i=0;i<static_cast<size_t>(std::max(top_k, 0)) && i<doc_id_with_score.size();++i) {
+                const auto&[doc_id, score] = doc_id_with_score[i];
+                ranked_docs.push_back(docs.at(doc_id_idx.at(doc_id)));
+            }
+            return ranked_docs;
         }
 
     };
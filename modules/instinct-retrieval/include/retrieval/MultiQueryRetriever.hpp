@@ -33,12 +33,18 @@ namespace INSTINCT_RETRIEVAL_NS {
             const auto queries = query_chain_->Invoke(search_request.query());
             assert_true(queries.lines_size() > 1, "should have multiple generated queries.");
             LOG_DEBUG("orignal query: {}, rewrite queries: {}", search_request.query(), queries.ShortDebugString());
-            return rpp::source::from_iterable(queries.lines())
-                | rpp::operators::flat_map([&, search_request](const std::string& q)   {
-                    SearchRequest copied_request = search_request;
-                    copied_request.set_query(q);
-                    return base_retriever_->Retrieve(copied_request);
-                })
+            // generated queries are searched together, so that a vector store can embed and scan for them at once
+            BatchSearchRequest batch_request;
+            batch_request.mutable_queries()->CopyFrom(queries.lines());
+            batch_request.set_top_k(search_request.top_k());
+            if (search_request.has_metadata_filter()) {
+                batch_request.mutable_metadata_filter()->CopyFrom(search_request.metadata_filter());
+            }
+            std::vector<Document> docs;
+            for (const auto& query_result: base_retriever_->BatchRetrieve(batch_request).results()) {
+                docs.insert(docs.end(), query_result.documents().begin(), query_result.documents().end());
+            }
+            return rpp::source::from_iterable(std::move(docs))
                 // see following specializations for std::hash and std::equal_to
                 // modules/instinct-core/src/tools/DocumentUtils.hpp
                 | rpp::operators::distinct();
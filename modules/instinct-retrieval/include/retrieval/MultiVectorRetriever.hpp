@@ -88,19 +88,23 @@ namespace INSTINCT_RETRIEVAL_NS {
             input
             | rpp::operators::as_blocking()
             | rpp::operators::buffer(BATCH_SIZE)
-            | rpp::operators::subscribe([&](const std::vector<Document>& buf) {
-                std::vector<Document> batch = buf;
+            | rpp::operators::subscribe([&](std::vector<Document> batch) {
                 // insert all parent docs
                 UpdateResult updateResult;
                 doc_store_->AddDocuments(batch, updateResult);
-                // insert all child docs
+                // insert all child docs of this batch at once, so that embedding model, and its cache if any, is called once for the whole batch
+                std::vector<Document> sub_docs;
                 for(const auto& parent_doc: batch) {
-                    auto sub_docs = std::invoke(guidance_, parent_doc);
-                            LOG_DEBUG("{} guidance doc(s) generated for parent doc with id {}", sub_docs.size(), parent_doc.id());
-                    UpdateResult update_result;
-                    vector_store_->AddDocuments(sub_docs, update_result);
-                    assert_true(update_result.failed_documents_size()==0, "all sub docs should be inserted successfully");
+                    auto guidance_docs = std::invoke(guidance_, parent_doc);
+                    LOG_DEBUG("{} guidance doc(s) generated for parent doc with id {}", guidance_docs.size(), parent_doc.id());
+                    std::ranges::move(guidance_docs, std::back_inserter(sub_docs));
                 }
+                if (sub_docs.empty()) {
+                    return;
+                }
+                UpdateResult update_result;
+                vector_store_->AddDocuments(sub_docs, update_result);
+                assert_true(update_result.failed_documents_size()==0, "all sub docs should be inserted successfully");
             });
         }
 
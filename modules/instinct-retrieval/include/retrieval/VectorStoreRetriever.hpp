@@ -37,6 +37,10 @@ namespace INSTINCT_RETRIEVAL_NS {
             return vecstore_store_->SearchDocuments(search_request);
         }
 
+        [[nodiscard]] BatchSearchResult BatchRetrieve(const BatchSearchRequest& request) const override {
+            return vecstore_store_->BatchSearchDocuments(request);
+        }
+
         void Ingest(const AsyncIterator<Document>& input) override {
             UpdateResult update_result;
             vecstore_store_->AddDocuments(input, update_result);
@@ -0,0 +1,641 @@
+#ifndef HNSWINDEX_HPP
+#define HNSWINDEX_HPP
+
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <shared_mutex>
+
+#include "RetrievalGlobals.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    struct HNSWIndexOptions {
+        /**
+         * A flag to enable HNSW index. Brute-force scan is used if disabled.
+         */
+        bool enabled = false;
+
+        /**
+         * Max count of neighbors per node on upper layers. Layer zero allows `2*m` neighbors.
+         */
+        size_t m = 16;
+
+        /**
+         * Size of dynamic candidate list during insertion
+         */
+        size_t ef_construction = 200;
+
+        /**
+         * Size of dynamic candidate list during search. Actual value will be `max(ef_search, top_k)`.
+         */
+        size_t ef_search = 64;
+
+        /**
+         * Tables with fewer rows than this threshold are searched with brute-force scan, which is both exact and fast enough for them.
+         */
+        size_t brute_force_threshold = 5000;
+
+        /**
+         * When metadata filter is given, `top_k * filter_overfetch_factor` candidates are recalled from index before post-checking.
+         */
+        size_t filter_overfetch_factor = 4;
+
+        /**
+         * Graph is written to snapshot table once this many vectors are added or removed since last snapshot, or a quarter of graph size if that's larger, so that cost of rewriting the whole graph is amortized. Pending changes are written by `IVectorStore::Persist`. Zero means graph is only written by `Persist`.
+         */
+        size_t snapshot_interval = 10000;
+
+        /**
+         * Seed for level generator. Fixed seed makes graph construction reproducible.
+         */
+        uint64_t seed = 42;
+    };
+
+    /**
+     * Hierarchical Navigable Small World graph for approximate nearest neighbor search with cosine similarity, following Malkov & Yashunin (https://arxiv.org/abs/1603.09320).
+     *
+     * Vectors are normalized on insertion, so that cosine similarity equals to inner product. Deletion is implemented with tombstones, which are still used for graph traversal but never returned. Call `Compact` to rebuild graph when too many tombstones are accumulated.
+     *
+     * This class is thread-safe: searches share a read lock while mutations take exclusive lock.
+     */
+    class HNSWIndex final {
+        using Label = uint32_t;
+
+        /**
+         * Epoch-tagged visited marks reused across searches in the same thread, which avoids allocating and hashing for every layer search.
+         */
+        class VisitedList_ {
+            std::vector<uint32_t> marks_;
+            uint32_t epoch_ = 0;
+        public:
+            static VisitedList_& Acquire(const size_t capacity) {
+                thread_local VisitedList_ list;
+                if (list.marks_.size() < capacity) {
+                    list.marks_.resize(capacity, 0);
+                }
+                if (++list.epoch_ == 0) {
+                    std::ranges::fill(list.marks_, 0);
+                    list.epoch_ = 1;
+                }
+                return list;
+            }
+
+            /**
+             * @return true if label is not visited before
+             */
+            bool Visit(const Label label) {
+                if (marks_[label] == epoch_) {
+                    return false;
+                }
+                marks_[label] = epoch_;
+                return true;
+            }
+        };
+
+        struct Node {
+            std::string id;
+            std::vector<float> vector;
+            std::vector<std::vector<Label>> neighbors;
+            bool deleted = false;
+        };
+
+        /**
+         * distance and label pair. smaller distance means closer.
+         */
+        using Candidate = std::pair<float, Label>;
+        using MaxHeap = std::priority_queue<Candidate>;
+        using MinHeap = std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>>;
+
+        static constexpr uint32_t SERIALIZATION_MAGIC = 0x484E5357; // "HNSW"
+        static constexpr uint32_t SERIALIZATION_VERSION = 1;
+
+        size_t dimension_;
+        HNSWIndexOptions options_;
+        std::vector<Node> nodes_;
+        std::unordered_map<std::string, Label> labels_;
+        int64_t entry_point_ = -1;
+        int max_level_ = -1;
+        size_t deleted_count_ = 0;
+        double level_multiplier_;
+        std::mt19937_64 level_generator_;
+        mutable std::shared_mutex mutex_;
+
+    public:
+        HNSWIndex(const size_t dimension, const HNSWIndexOptions& options)
+            : dimension_(dimension),
+              options_(options),
+              level_multiplier_(1.0 / std::log(static_cast<double>(std::max<size_t>(options.m, 2)))),
+              level_generator_(options.seed) {
+            assert_positive(dimension_, "dimension should be positive");
+            assert_gte(options_.m, 2, "m should be at least 2");
+            assert_positive(options_.ef_construction, "ef_construction should be positive");
+        }
+
+        /**
+         * Insert a vector. If `id` already exists, previous vector will be replaced.
+         * @param id Document id
+         * @param vector Raw embedding, which is not required to be normalized
+         */
+        void Add(const std::string& id, const std::vector<float>& vector) {
+            Add(id, vector.data(), vector.size());
+        }
+
+        void Add(const std::string& id, const float* data, const size_t size) {
+            assert_true(size == dimension_, fmt::format("vector dimension mismatch: expected={}, actual={}", dimension_, size));
+            std::unique_lock lock(mutex_);
+            if (const auto itr = labels_.find(id); itr != labels_.end()) {
+                MarkDeleted_(itr->second);
+                labels_.erase(itr);
+            }
+            Insert_(id, Normalize_(data));
+        }
+
+        /**
+         * Remove a vector by id
+         * @param id
+         * @return true if vector is found and removed
+         */
+        bool Remove(const std::string& id) {
+            std::unique_lock lock(mutex_);
+            const auto itr = labels_.find(id);
+            if (itr == labels_.end()) {
+                return false;
+            }
+            MarkDeleted_(itr->second);
+            labels_.erase(itr);
+            return true;
+        }
+
+        /**
+         * Search k nearest neighbors
+         * @param query Raw query vector
+         * @param k Count of results
+         * @param ef Size of dynamic candidate list. `options.ef_search` is used if zero is given.
+         * @return list of id and cosine similarity, sorted by similarity in descending order
+         */
+        [[nodiscard]] std::vector<std::pair<std::string, float>> Search(const std::vector<float>& query, const size_t k, size_t ef = 0) const {
+            assert_true(query.size() == dimension_, fmt::format("query dimension mismatch: expected={}, actual={}", dimension_, query.size()));
+            std::vector<std::pair<std::string, float>> result;
+            if (k == 0) {
+                return result;
+            }
+            const auto normalized_query = Normalize_(query.data());
+            ef = std::max(ef > 0 ? ef : options_.ef_search, k);
+
+            std::shared_lock lock(mutex_);
+            if (entry_point_ < 0) {
+                return result;
+            }
+            auto current = static_cast<Label>(entry_point_);
+            auto current_distance = Distance_(normalized_query.data(), current);
+            for (int level = max_level_; level > 0; --level) {
+                GreedySearch_(normalized_query.data(), level, current, current_distance);
+            }
+            auto top_candidates = SearchLayer_(normalized_query.data(), {current}, ef, 0, true);
+            while (top_candidates.size() > k) {
+                top_candidates.pop();
+            }
+            result.resize(top_candidates.size());
+            for (auto i = static_cast<int64_t>(top_candidates.size()) - 1; i >= 0; --i) {
+                const auto& [distance, label] = top_candidates.top();
+                result[i] = {nodes_[label].id, 1.0f - distance};
+                top_candidates.pop();
+            }
+            return result;
+        }
+
+        /**
+         * @return count of live vectors
+         */
+        [[nodiscard]] size_t Size() const {
+            std::shared_lock lock(mutex_);
+            return labels_.size();
+        }
+
+        /**
+         * @return count of tombstones
+         */
+        [[nodiscard]] size_t CountDeleted() const {
+            std::shared_lock lock(mutex_);
+            return deleted_count_;
+        }
+
+        [[nodiscard]] bool Contains(const std::string& id) const {
+            std::shared_lock lock(mutex_);
+            return labels_.contains(id);
+        }
+
+        [[nodiscard]] size_t GetDimension() const {
+            return dimension_;
+        }
+
+        [[nodiscard]] const HNSWIndexOptions& GetOptions() const {
+            return options_;
+        }
+
+        void Clear() {
+            std::unique_lock lock(mutex_);
+            Clear_();
+        }
+
+        /**
+         * Rebuild graph with live vectors only
+         */
+        void Compact() {
+            std::unique_lock lock(mutex_);
+            auto previous_nodes = std::move(nodes_);
+            Clear_();
+            for (auto& node: previous_nodes) {
+                if (!node.deleted) {
+                    Insert_(node.id, std::move(node.vector));
+                }
+            }
+        }
+
+        /**
+         * Serialize graph structure. Vectors are excluded unless `with_vectors` is true, as they are normally persisted elsewhere, e.g. in the vector column of DuckDB table.
+         * Tombstones are dropped from output by compacting labels.
+         * @param with_vectors
+         * @return binary payload
+         */
+        [[nodiscard]] std::string Serialize(const bool with_vectors = false) const {
+            std::shared_lock lock(mutex_);
+            // remap labels to skip tombstones
+            std::vector<int64_t> remapped(nodes_.size(), -1);
+            uint32_t live = 0;
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                if (!nodes_[i].deleted) {
+                    remapped[i] = live++;
+                }
+            }
+
+            std::string payload;
+            Write_(payload, SERIALIZATION_MAGIC);
+            Write_(payload, SERIALIZATION_VERSION);
+            Write_(payload, static_cast<uint64_t>(dimension_));
+            Write_(payload, static_cast<uint8_t>(with_vectors));
+            Write_(payload, live);
+            // entry point may be a tombstone, so it's re-selected in `Deserialize` if so.
+            Write_(payload, static_cast<int64_t>(entry_point_ >= 0 ? remapped[entry_point_] : -1));
+            for (const auto& node: nodes_) {
+                if (node.deleted) {
+                    continue;
+                }
+                Write_(payload, static_cast<uint32_t>(node.id.size()));
+                payload.append(node.id);
+                if (with_vectors) {
+                    payload.append(reinterpret_cast<const char*>(node.vector.data()), sizeof(float) * dimension_);
+                }
+                Write_(payload, static_cast<uint32_t>(node.neighbors.size()));
+                for (const auto& links: node.neighbors) {
+                    uint32_t n = 0;
+                    for (const auto& link: links) {
+                        if (remapped[link] >= 0) ++n;
+                    }
+                    Write_(payload, n);
+                    for (const auto& link: links) {
+                        if (remapped[link] >= 0) {
+                            Write_(payload, static_cast<uint32_t>(remapped[link]));
+                        }
+                    }
+                }
+            }
+            return payload;
+        }
+
+        /**
+         * Restore index from payload generated by `Serialize`. Counts in payload are checked against its length before anything is allocated for them.
+         * @param payload
+         * @param dimension Expected dimension of vectors. Payload of other dimension is rejected.
+         * @param options
+         * @param vector_loader Function to retrieve raw vector by id, which is required if vectors are not included in payload. Returning false means vector is missing and the whole payload is considered stale.
+         * @return nullptr if payload is stale or malformed
+         */
+        static std::unique_ptr<HNSWIndex> Deserialize(
+            const std::string& payload,
+            const size_t dimension,
+            const HNSWIndexOptions& options,
+            const std::function<bool(const std::string& id, std::vector<float>& vector)>& vector_loader = nullptr) {
+            size_t offset = 0;
+            uint32_t magic, version, count;
+            uint64_t payload_dimension;
+            uint8_t with_vectors;
+            int64_t entry_point;
+            if (!Read_(payload, offset, magic) || magic != SERIALIZATION_MAGIC ||
+                !Read_(payload, offset, version) || version != SERIALIZATION_VERSION ||
+                !Read_(payload, offset, payload_dimension) ||
+                !Read_(payload, offset, with_vectors) ||
+                !Read_(payload, offset, count) ||
+                !Read_(payload, offset, entry_point)) {
+                LOG_WARN("Malformed HNSW payload header");
+                return nullptr;
+            }
+            if (payload_dimension != dimension) {
+                LOG_WARN("HNSW payload has dimension {}, but {} is expected", payload_dimension, dimension);
+                return nullptr;
+            }
+            // every node takes at least its id size and level count, plus vector if included
+            const size_t min_node_size = 2 * sizeof(uint32_t) + (with_vectors ? sizeof(float) * dimension : 0);
+            if (count > (payload.size() - offset) / min_node_size || entry_point >= static_cast<int64_t>(count)) {
+                LOG_WARN("HNSW payload claims {} nodes, which doesn't fit in {} bytes", count, payload.size());
+                return nullptr;
+            }
+            if (!with_vectors && !vector_loader) {
+                LOG_WARN("HNSW payload has no vectors and no vector loader is given");
+                return nullptr;
+            }
+
+            auto index = std::make_unique<HNSWIndex>(dimension, options);
+            index->nodes_.resize(count);
+            for (uint32_t label = 0; label < count; ++label) {
+                auto& node = index->nodes_[label];
+                uint32_t id_size, level_count;
+                if (!Read_(payload, offset, id_size) || id_size > payload.size() - offset) {
+                    return nullptr;
+                }
+                node.id = payload.substr(offset, id_size);
+                offset += id_size;
+                if (with_vectors) {
+                    if (sizeof(float) * dimension > payload.size() - offset) {
+                        return nullptr;
+                    }
+                    node.vector.resize(dimension);
+                    std::memcpy(node.vector.data(), payload.data() + offset, sizeof(float) * dimension);
+                    offset += sizeof(float) * dimension;
+                } else {
+                    std::vector<float> raw;
+                    if (!vector_loader(node.id, raw) || raw.size() != dimension) {
+                        LOG_WARN("Vector for id {} is missing, HNSW payload is stale", node.id);
+                        return nullptr;
+                    }
+                    node.vector = index->Normalize_(raw.data());
+                }
+                // every level takes at least its link count, and every link takes a label
+                if (!Read_(payload, offset, level_count) || level_count > (payload.size() - offset) / sizeof(uint32_t)) {
+                    return nullptr;
+                }
+                node.neighbors.resize(level_count);
+                for (auto& links: node.neighbors) {
+                    uint32_t n;
+                    if (!Read_(payload, offset, n) || n > (payload.size() - offset) / sizeof(uint32_t)) {
+                        return nullptr;
+                    }
+                    links.resize(n);
+                    for (auto& link: links) {
+                        if (!Read_(payload, offset, link) || link >= count) {
+                            return nullptr;
+                        }
+                    }
+                }
+                index->labels_[node.id] = label;
+            }
+
+            // restore entry point and max level
+            if (entry_point < 0 && count > 0) {
+                entry_point = 0;
+            }
+            for (uint32_t label = 0; label < count; ++label) {
+                if (static_cast<int>(index->nodes_[label].neighbors.size()) - 1 > index->max_level_) {
+                    index->max_level_ = static_cast<int>(index->nodes_[label].neighbors.size()) - 1;
+                    entry_point = label;
+                }
+            }
+            index->entry_point_ = entry_point;
+            return index;
+        }
+
+    private:
+        [[nodiscard]] std::vector<float> Normalize_(const float* data) const {
+            std::vector<float> normalized(data, data + dimension_);
+            float norm = 0;
+            for (const auto& f: normalized) {
+                norm += f * f;
+            }
+            if (norm > 0) {
+                norm = std::sqrt(norm);
+                for (auto& f: normalized) {
+                    f /= norm;
+                }
+            }
+            return normalized;
+        }
+
+        [[nodiscard]] float Distance_(const float* query, const Label label) const {
+            const float* v = nodes_[label].vector.data();
+            // independent accumulators let compiler vectorize without -ffast-math
+            float acc[8] = {};
+            size_t i = 0;
+            for (; i + 8 <= dimension_; i += 8) {
+                for (size_t j = 0; j < 8; ++j) {
+                    acc[j] += query[i + j] * v[i + j];
+                }
+            }
+            float dot = 0;
+            for (; i < dimension_; ++i) {
+                dot += query[i] * v[i];
+            }
+            for (const auto& a: acc) {
+                dot += a;
+            }
+            return 1.0f - dot;
+        }
+
+        [[nodiscard]] size_t MaxNeighbors_(const int level) const {
+            return level == 0 ? options_.m * 2 : options_.m;
+        }
+
+        int RandomLevel_() {
+            std::uniform_real_distribution<double> distribution(std::numeric_limits<double>::min(), 1.0);
+            return static_cast<int>(-std::log(distribution(level_generator_)) * level_multiplier_);
+        }
+
+        void Clear_() {
+            nodes_.clear();
+            labels_.clear();
+            entry_point_ = -1;
+            max_level_ = -1;
+            deleted_count_ = 0;
+        }
+
+        void MarkDeleted_(const Label label) {
+            nodes_[label].deleted = true;
+            ++deleted_count_;
+        }
+
+        void GreedySearch_(const float* query, const int level, Label& current, float& current_distance) const {
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (const auto& neighbor: nodes_[current].neighbors[level]) {
+                    if (const auto d = Distance_(query, neighbor); d < current_distance) {
+                        current_distance = d;
+                        current = neighbor;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Search a single layer.
+         * @param query
+         * @param entry_points
+         * @param ef
+         * @param level
+         * @param skip_deleted Whether tombstones should be excluded from result. They are still used as stepping stones.
+         * @return max heap of at most `ef` candidates
+         */
+        [[nodiscard]] MaxHeap SearchLayer_(const float* query, const std::vector<Label>& entry_points, const size_t ef, const int level, const bool skip_deleted) const {
+            auto& visited = VisitedList_::Acquire(nodes_.size());
+            MinHeap candidates;
+            MaxHeap top_candidates;
+            float lower_bound = std::numeric_limits<float>::max();
+            for (const auto& ep: entry_points) {
+                const auto d = Distance_(query, ep);
+                visited.Visit(ep);
+                candidates.emplace(d, ep);
+                if (!skip_deleted || !nodes_[ep].deleted) {
+                    top_candidates.emplace(d, ep);
+                    lower_bound = top_candidates.top().first;
+                }
+            }
+
+            while (!candidates.empty()) {
+                const auto [distance, label] = candidates.top();
+                if (distance > lower_bound && top_candidates.size() >= ef) {
+                    break;
+                }
+                candidates.pop();
+                for (const auto& neighbor: nodes_[label].neighbors[level]) {
+                    if (!visited.Visit(neighbor)) {
+                        continue;
+                    }
+                    const auto d = Distance_(query, neighbor);
+                    if (top_candidates.size() < ef || d < lower_bound) {
+                        candidates.emplace(d, neighbor);
+                        if (!skip_deleted || !nodes_[neighbor].deleted) {
+                            top_candidates.emplace(d, neighbor);
+                            if (top_candidates.size() > ef) {
+                                top_candidates.pop();
+                            }
+                        }
+                        if (!top_candidates.empty()) {
+                            lower_bound = top_candidates.top().first;
+                        }
+                    }
+                }
+            }
+            return top_candidates;
+        }
+
+        /**
+         * Neighbor selection heuristic (algorithm 4 in paper), which keeps a candidate only if it's closer to base than to any selected neighbor.
+         * @param top_candidates
+         * @param m
+         * @return selected labels, closest first
+         */
+        [[nodiscard]] std::vector<Label> SelectNeighbors_(MaxHeap top_candidates, const size_t m) const {
+            std::vector<Candidate> sorted;
+            sorted.reserve(top_candidates.size());
+            while (!top_candidates.empty()) {
+                sorted.push_back(top_candidates.top());
+                top_candidates.pop();
+            }
+            std::ranges::reverse(sorted);
+
+            std::vector<Label> selected;
+            selected.reserve(m);
+            for (const auto& [distance, label]: sorted) {
+                if (selected.size() >= m) {
+                    break;
+                }
+                bool good = true;
+                for (const auto& s: selected) {
+                    if (Distance_(nodes_[label].vector.data(), s) < distance) {
+                        good = false;
+                        break;
+                    }
+                }
+                if (good) {
+                    selected.push_back(label);
+                }
+            }
+            return selected;
+        }
+
+        void Connect_(const Label from, const Label to, const int level) {
+            auto& links = nodes_[from].neighbors[level];
+            links.push_back(to);
+            if (const auto max_neighbors = MaxNeighbors_(level); links.size() > max_neighbors) {
+                MaxHeap candidates;
+                for (const auto& link: links) {
+                    candidates.emplace(Distance_(nodes_[from].vector.data(), link), link);
+                }
+                links = SelectNeighbors_(std::move(candidates), max_neighbors);
+            }
+        }
+
+        void Insert_(const std::string& id, std::vector<float> normalized) {
+            const auto label = static_cast<Label>(nodes_.size());
+            const int level = RandomLevel_();
+            nodes_.push_back({.id = id, .vector = std::move(normalized), .neighbors = std::vector<std::vector<Label>>(level + 1)});
+            labels_[id] = label;
+
+            if (entry_point_ < 0) {
+                entry_point_ = label;
+                max_level_ = level;
+                return;
+            }
+
+            const float* query = nodes_[label].vector.data();
+            auto current = static_cast<Label>(entry_point_);
+            auto current_distance = Distance_(query, current);
+            for (int lc = max_level_; lc > level; --lc) {
+                GreedySearch_(query, lc, current, current_distance);
+            }
+
+            std::vector<Label> entry_points {current};
+            for (int lc = std::min(level, max_level_); lc >= 0; --lc) {
+                auto top_candidates = SearchLayer_(query, entry_points, options_.ef_construction, lc, false);
+                entry_points.clear();
+                auto copy = top_candidates;
+                while (!copy.empty()) {
+                    entry_points.push_back(copy.top().second);
+                    copy.pop();
+                }
+                const auto neighbors = SelectNeighbors_(std::move(top_candidates), options_.m);
+                nodes_[label].neighbors[lc] = neighbors;
+                for (const auto& neighbor: neighbors) {
+                    Connect_(neighbor, label, lc);
+                }
+            }
+
+            if (level > max_level_) {
+                max_level_ = level;
+                entry_point_ = label;
+            }
+        }
+
+        template<typename T>
+        static void Write_(std::string& buf, const T& value) {
+            buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        static bool Read_(const std::string& buf, size_t& offset, T& value) {
+            if (offset + sizeof(T) > buf.size()) {
+                return false;
+            }
+            std::memcpy(&value, buf.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+    };
+
+    using HNSWIndexPtr = std::shared_ptr<HNSWIndex>;
+}
+
+#endif //HNSWINDEX_HPP
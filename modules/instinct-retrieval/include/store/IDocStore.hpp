@@ -43,6 +43,13 @@ namespace INSTINCT_RETRIEVAL_NS {
 
         virtual AsyncIterator<Document> FindDocuments(const FindRequest& find_request) = 0;
 
+        /**
+         * Search documents by keywords in `text`, ranked by relevance score like BM25
+         * @param request Search request with query text, top_k and optional metadata filter
+         * @return documents ordered by relevance
+         */
+        virtual AsyncIterator<Document> SearchDocumentsByKeywords(const SearchRequest& request) = 0;
+
         [[nodiscard]] virtual std::shared_ptr<MetadataSchema> GetMetadataSchema() const = 0;
 
         virtual size_t CountDocuments() = 0;
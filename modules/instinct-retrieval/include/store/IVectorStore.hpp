@@ -7,14 +7,105 @@
 
 #include <retrieval.pb.h>
 #include "RetrievalGlobals.hpp"
+#include "functional/ReactiveFunctions.hpp"
 #include "model/IEmbeddingModel.hpp"
 #include "store/IDocStore.hpp"
+#include "tools/Assertions.hpp"
 #include "tools/MetadataSchemaBuilder.hpp"
 
 
 namespace INSTINCT_RETRIEVAL_NS {
     using namespace INSTINCT_CORE_NS;
 
+    namespace details {
+        /**
+         * Fuse ranked lists of documents with weighted Reciprocal Rank Fusion (https://dl.acm.org/doi/10.1145/1571941.1572114), in which each document is scored by `sum(weight / (k + rank))` across lists, with rank starting from 1.
+         * @param ranked_lists
+         * @param weights weight of each list, which should be of same size as `ranked_lists`
+         * @param top_k max count of fused documents
+         * @param k smoothing constant. 60 is used if it's not positive.
+         * @return documents ordered by fused score, with ties broken by first appearance
+         */
+        static std::vector<Document> weighted_reciprocal_rank_fusion(const std::vector<std::vector<Document>>& ranked_lists, const std::vector<double>& weights, const size_t top_k, int k = 60) {
+            assert_true(weights.size() == ranked_lists.size(), "should have one weight for each ranked list");
+            k = k > 0 ? k : 60;
+            std::unordered_map<std::string, size_t> positions;
+            std::vector<std::pair<double, const Document*>> scored;
+            for (size_t i = 0; i < ranked_lists.size(); ++i) {
+                const auto& ranked_list = ranked_lists[i];
+                for (size_t rank = 0; rank < ranked_list.size(); ++rank) {
+                    const auto& doc = ranked_list[rank];
+                    const double score = weights[i] / static_cast<double>(k + rank + 1);
+                    if (const auto itr = positions.find(doc.id()); itr != positions.end()) {
+                        scored[itr->second].first += score;
+                    } else {
+                        positions.emplace(doc.id(), scored.size());
+                        scored.emplace_back(score, &doc);
+                    }
+                }
+            }
+            std::ranges::stable_sort(scored, [](const auto& a, const auto& b) {
+                return a.first > b.first;
+            });
+            std::vector<Document> fused;
+            for (size_t i = 0; i < scored.size() && i < top_k; ++i) {
+                fused.push_back(*scored[i].second);
+            }
+            return fused;
+        }
+
+        /**
+         * Fuse ranked lists of documents with Reciprocal Rank Fusion, in which all lists are equally weighted
+         * @param ranked_lists
+         * @param top_k max count of fused documents
+         * @param k smoothing constant. 60 is used if it's not positive.
+         * @return documents ordered by fused score, with ties broken by first appearance
+         */
+        static std::vector<Document> reciprocal_rank_fusion(const std::vector<std::vector<Document>>& ranked_lists, const size_t top_k, const int k = 60) {
+            return weighted_reciprocal_rank_fusion(ranked_lists, std::vector<double>(ranked_lists.size(), 1.0), top_k, k);
+        }
+
+        /**
+         * Make search request for one of queries in batch search request, sharing its `top_k` and metadata filter
+         * @param request
+         * @param query
+         * @return
+         */
+        static SearchRequest make_search_request(const BatchSearchRequest& request, const std::string& query) {
+            SearchRequest search_request;
+            search_request.set_query(query);
+            search_request.set_top_k(request.top_k());
+            if (request.has_metadata_filter()) {
+                search_request.mutable_metadata_filter()->CopyFrom(request.metadata_filter());
+            }
+            return search_request;
+        }
+
+        /**
+         * Assemble result of batch search from per-query results, which are in the same order of queries in request
+         * @param request
+         * @param ranked_lists
+         * @return
+         */
+        static BatchSearchResult make_batch_search_result(const BatchSearchRequest& request, const std::vector<std::vector<Document>>& ranked_lists) {
+            BatchSearchResult batch_result;
+            for (int i = 0; i < request.queries_size(); ++i) {
+                auto* query_result = batch_result.add_results();
+                query_result->set_query(request.queries(i));
+                for (const auto& doc: ranked_lists[i]) {
+                    query_result->add_documents()->CopyFrom(doc);
+                }
+            }
+            if (request.fuse_results()) {
+                const size_t top_k = request.top_k() > 0 ? request.top_k() : 10;
+                for (const auto& doc: reciprocal_rank_fusion(ranked_lists, top_k, request.rrf_k())) {
+                    batch_result.add_fused_documents()->CopyFrom(doc);
+                }
+            }
+            return batch_result;
+        }
+    }
+
     /**
      * Interface for document store. Forgive the poor name of `VectorStore`, which is follows convention in langchain, etc., but actually misleading in two ways:
      *
@@ -27,6 +118,24 @@ namespace INSTINCT_RETRIEVAL_NS {
     public:
         virtual AsyncIterator<Document> SearchDocuments(const SearchRequest& request) = 0;
         virtual EmbeddingsPtr GetEmbeddingModel() = 0;
+
+        /**
+         * Search with multiple queries sharing the same `top_k` and metadata filter. This default implementation searches them one by one, and implementations should override it if queries can be answered together more efficiently.
+         * @param request
+         * @return per-query results, and fused results if requested
+         */
+        virtual BatchSearchResult BatchSearchDocuments(const BatchSearchRequest& request) {
+            std::vector<std::vector<Document>> ranked_lists;
+            for (const auto& query: request.queries()) {
+                ranked_lists.push_back(CollectVector(SearchDocuments(details::make_search_request(request, query))));
+            }
+            return details::make_batch_search_result(request, ranked_lists);
+        }
+
+        /**
+         * Write in-memory structures which are not yet saved, e.g. snapshots of vector index, to underlying storage. They are never written on destruction, so owners should call it before dropping a store whose changes should survive. This default implementation does nothing.
+         */
+        virtual void Persist() {}
     };
     using VectorStorePtr = std::shared_ptr<IVectorStore>;
 
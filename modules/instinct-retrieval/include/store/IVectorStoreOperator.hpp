@@ -22,6 +22,12 @@ namespace INSTINCT_RETRIEVAL_NS {
         virtual VectorStorePtr LoadInstance(const std::string& instance_id)=0;
         virtual std::vector<std::string> ListInstances() = 0;
         virtual bool RemoveInstance(const std::string& instance_id) = 0;
+
+        /**
+         * Drop any state kept for given instance, e.g. a cached store, so that it's loaded with latest instance metadata next time. This should be called whenever instance is altered or dropped elsewhere.
+         * @param instance_id
+         */
+        virtual void InvalidateInstance(const std::string& instance_id) = 0;
     };
 
     using VectorStoreOperatorPtr = std::shared_ptr<IVectorStoreOperator>;
@@ -0,0 +1,285 @@
+#ifndef KEYWORDINDEX_HPP
+#define KEYWORDINDEX_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <queue>
+#include <shared_mutex>
+
+#include "RetrievalGlobals.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    struct KeywordIndexOptions {
+        /**
+         * A flag to maintain an in-memory inverted index over `text` column, which enables BM25 search with `IDocStore::SearchDocumentsByKeywords`.
+         */
+        bool enabled = false;
+
+        /**
+         * BM25 term frequency saturation
+         */
+        float k1 = 1.2f;
+
+        /**
+         * BM25 document length normalization
+         */
+        float b = 0.75f;
+
+        /**
+         * When metadata filter is given, `top_k * filter_overfetch_factor` candidates are recalled from index before post-checking.
+         */
+        size_t filter_overfetch_factor = 4;
+    };
+
+    namespace details {
+        /**
+         * Split text into lower-cased terms. ASCII letters and digits form terms, and other ASCII characters are separators. Bytes of multibyte UTF-8 characters are kept as term characters, so that non-latin words are not broken.
+         * @param text
+         * @return
+         */
+        static std::vector<std::string> tokenize_keywords(const std::string_view text) {
+            std::vector<std::string> terms;
+            std::string term;
+            for (const char c: text) {
+                if (const auto u = static_cast<unsigned char>(c); u >= 0x80 || std::isalnum(u)) {
+                    term += static_cast<char>(std::tolower(u));
+                } else if (!term.empty()) {
+                    terms.push_back(std::move(term));
+                    term.clear();
+                }
+            }
+            if (!term.empty()) {
+                terms.push_back(std::move(term));
+            }
+            return terms;
+        }
+    }
+
+    /**
+     * In-memory inverted index with Okapi BM25 scoring (https://en.wikipedia.org/wiki/Okapi_BM25).
+     *
+     * Each document is assigned a slot, and posting lists hold `(slot, term frequency)` pairs. Deletion only marks the slot as free and updates collection statistics, and stale postings are skipped during search until they are purged by compaction, which happens automatically when more than half of slots are dead.
+     *
+     * This class is thread-safe: searches share a read lock while mutations take exclusive lock.
+     */
+    class KeywordIndex final {
+        using Slot = uint32_t;
+
+        struct DocEntry {
+            std::string id;
+            uint32_t length = 0;
+            bool deleted = false;
+        };
+
+        struct Posting {
+            Slot slot;
+            uint32_t frequency;
+        };
+
+        KeywordIndexOptions options_;
+        std::vector<DocEntry> docs_;
+        std::unordered_map<std::string, Slot> slots_;
+        std::unordered_map<std::string, std::vector<Posting>> postings_;
+        // count of live documents containing each term
+        std::unordered_map<std::string, uint32_t> document_frequencies_;
+        // distinct terms of each slot, which are needed to update document frequencies on deletion
+        std::vector<std::vector<std::string>> slot_terms_;
+        uint64_t total_length_ = 0;
+        size_t deleted_count_ = 0;
+        mutable std::shared_mutex mutex_;
+
+    public:
+        explicit KeywordIndex(const KeywordIndexOptions& options = {}): options_(options) {
+            assert_true(options_.k1 >= 0, "k1 should be non-negative");
+            assert_true(options_.b >= 0 && options_.b <= 1, "b should be in range of [0,1]");
+        }
+
+        /**
+         * Index text of a document. If `id` already exists, previous text will be replaced.
+         * @param id Document id
+         * @param text
+         */
+        void Add(const std::string& id, const std::string_view text) {
+            const auto terms = details::tokenize_keywords(text);
+            std::unordered_map<std::string, uint32_t> frequencies;
+            for (const auto& term: terms) {
+                frequencies[term]++;
+            }
+
+            std::unique_lock lock(mutex_);
+            if (const auto itr = slots_.find(id); itr != slots_.end()) {
+                MarkDeleted_(itr->second);
+                slots_.erase(itr);
+            }
+            const auto slot = static_cast<Slot>(docs_.size());
+            docs_.push_back({id, static_cast<uint32_t>(terms.size()), false});
+            slots_[id] = slot;
+            auto& distinct_terms = slot_terms_.emplace_back();
+            distinct_terms.reserve(frequencies.size());
+            for (auto& [term, frequency]: frequencies) {
+                postings_[term].push_back({slot, frequency});
+                document_frequencies_[term]++;
+                distinct_terms.push_back(term);
+            }
+            total_length_ += terms.size();
+            CompactIfNecessary_();
+        }
+
+        /**
+         * Remove a document by id
+         * @param id
+         * @return true if document is found and removed
+         */
+        bool Remove(const std::string& id) {
+            std::unique_lock lock(mutex_);
+            const auto itr = slots_.find(id);
+            if (itr == slots_.end()) {
+                return false;
+            }
+            MarkDeleted_(itr->second);
+            slots_.erase(itr);
+            CompactIfNecessary_();
+            return true;
+        }
+
+        /**
+         * Search documents matching any term in query
+         * @param query
+         * @param k Count of results
+         * @return list of id and BM25 score, sorted by score in descending order
+         */
+        [[nodiscard]] std::vector<std::pair<std::string, float>> Search(const std::string_view query, const size_t k) const {
+            std::vector<std::pair<std::string, float>> result;
+            if (k == 0) {
+                return result;
+            }
+            auto terms = details::tokenize_keywords(query);
+            std::ranges::sort(terms);
+            const auto [first, last] = std::ranges::unique(terms);
+            terms.erase(first, last);
+
+            std::shared_lock lock(mutex_);
+            const auto live_count = static_cast<double>(slots_.size());
+            if (live_count == 0) {
+                return result;
+            }
+            const double average_length = std::max(static_cast<double>(total_length_) / live_count, 1.0);
+            std::unordered_map<Slot, float> scores;
+            for (const auto& term: terms) {
+                // postings of a term may outlive its document frequency until compaction
+                const auto posting_itr = postings_.find(term);
+                const auto df_itr = document_frequencies_.find(term);
+                if (posting_itr == postings_.end() || df_itr == document_frequencies_.end()) {
+                    continue;
+                }
+                const auto df = static_cast<double>(df_itr->second);
+                const double idf = std::log(1.0 + (live_count - df + 0.5) / (df + 0.5));
+                for (const auto& [slot, frequency]: posting_itr->second) {
+                    const auto& doc = docs_[slot];
+                    if (doc.deleted) {
+                        continue;
+                    }
+                    const double tf = frequency;
+                    const double norm = options_.k1 * (1.0 - options_.b + options_.b * doc.length / average_length);
+                    scores[slot] += static_cast<float>(idf * tf * (options_.k1 + 1.0) / (tf + norm));
+                }
+            }
+
+            // min-heap of size k, with ties broken by slot so that result is deterministic
+            using ScoredSlot = std::pair<float, int64_t>;
+            std::priority_queue<ScoredSlot, std::vector<ScoredSlot>, std::greater<>> heap;
+            for (const auto& [slot, score]: scores) {
+                const ScoredSlot candidate {score, -static_cast<int64_t>(slot)};
+                if (heap.size() < k) {
+                    heap.push(candidate);
+                } else if (candidate > heap.top()) {
+                    heap.pop();
+                    heap.push(candidate);
+                }
+            }
+            result.resize(heap.size());
+            for (auto itr = result.rbegin(); itr != result.rend(); ++itr) {
+                const auto& [score, negative_slot] = heap.top();
+                *itr = {docs_[static_cast<Slot>(-negative_slot)].id, score};
+                heap.pop();
+            }
+            return result;
+        }
+
+        [[nodiscard]] size_t Size() const {
+            std::shared_lock lock(mutex_);
+            return slots_.size();
+        }
+
+        [[nodiscard]] bool Contains(const std::string& id) const {
+            std::shared_lock lock(mutex_);
+            return slots_.contains(id);
+        }
+
+        void Clear() {
+            std::unique_lock lock(mutex_);
+            docs_.clear();
+            slots_.clear();
+            postings_.clear();
+            document_frequencies_.clear();
+            slot_terms_.clear();
+            total_length_ = 0;
+            deleted_count_ = 0;
+        }
+
+    private:
+        void MarkDeleted_(const Slot slot) {
+            auto& doc = docs_[slot];
+            doc.deleted = true;
+            total_length_ -= doc.length;
+            for (const auto& term: slot_terms_[slot]) {
+                if (const auto itr = document_frequencies_.find(term); itr != document_frequencies_.end() && --itr->second == 0) {
+                    document_frequencies_.erase(itr);
+                }
+            }
+            slot_terms_[slot].clear();
+            deleted_count_++;
+        }
+
+        /**
+         * Re-assign slots to live documents and drop stale postings, if dead slots outnumber live ones
+         */
+        void CompactIfNecessary_() {
+            if (deleted_count_ < 1024 || deleted_count_ <= slots_.size()) {
+                return;
+            }
+            std::vector<Slot> mapping(docs_.size());
+            std::vector<DocEntry> docs;
+            std::vector<std::vector<std::string>> slot_terms;
+            docs.reserve(slots_.size());
+            slot_terms.reserve(slots_.size());
+            for (Slot slot = 0; slot < docs_.size(); ++slot) {
+                if (docs_[slot].deleted) {
+                    continue;
+                }
+                mapping[slot] = static_cast<Slot>(docs.size());
+                slots_[docs_[slot].id] = mapping[slot];
+                docs.push_back(std::move(docs_[slot]));
+                slot_terms.push_back(std::move(slot_terms_[slot]));
+            }
+            for (auto itr = postings_.begin(); itr != postings_.end();) {
+                auto& list = itr->second;
+                std::erase_if(list, [&](const Posting& posting) { return docs_[posting.slot].deleted; });
+                for (auto& posting: list) {
+                    posting.slot = mapping[posting.slot];
+                }
+                itr = list.empty() ? postings_.erase(itr) : std::next(itr);
+            }
+            docs_ = std::move(docs);
+            slot_terms_ = std::move(slot_terms);
+            deleted_count_ = 0;
+        }
+    };
+
+    using KeywordIndexPtr = std::shared_ptr<KeywordIndex>;
+}
+
+#endif //KEYWORDINDEX_HPP
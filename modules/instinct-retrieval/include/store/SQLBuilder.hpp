@@ -9,28 +9,54 @@
 
 namespace INSTINCT_RETRIEVAL_NS {
 
+    /**
+     * Values to be bound to placeholders of a parameterized statement, in order of their appearance
+     */
+    using SQLParameters = std::vector<PrimitiveValue>;
+
+    /**
+     * In all functions below, values are rendered as SQL literals if `parameters` is null. Otherwise, a `?` placeholder is rendered and the value is appended to `parameters`, so that SQL text only depends on shape of the query.
+     */
     namespace details {
-        static void build_bool_query(const BoolQuery& bool_query, std::string& sql);
-        static void build_term_query(const TermQuery& term_query, std::string& sql);
-        static void build_terms_query(const TermsQuery& terms_query, std::string& sql);
-        static void build_search_query(const SearchQuery& search_query, std::string& sql);
-        static void build_int_range_query(const IntRangeQuery& range_query, std::string& sql);
-        static void build_double_range_query(const DoubleRangeQuery& range_query, std::string& sql);
-
-        static void build_int_range_query(const IntRangeQuery& range_query, std::string& sql) {
+        static void build_bool_query(const BoolQuery& bool_query, std::string& sql, SQLParameters* parameters = nullptr);
+        static void build_term_query(const TermQuery& term_query, std::string& sql, SQLParameters* parameters = nullptr);
+        static void build_terms_query(const TermsQuery& terms_query, std::string& sql, SQLParameters* parameters = nullptr);
+        static void build_search_query(const SearchQuery& search_query, std::string& sql, SQLParameters* parameters = nullptr);
+        static void build_int_range_query(const IntRangeQuery& range_query, std::string& sql, SQLParameters* parameters = nullptr);
+        static void build_double_range_query(const DoubleRangeQuery& range_query, std::string& sql, SQLParameters* parameters = nullptr);
+
+        static void build_int_range_bound(const int64_t bound, std::string& sql, SQLParameters* parameters) {
+            if (parameters) {
+                sql += "?";
+                parameters->emplace_back().set_long_value(bound);
+            } else {
+                sql += std::to_string(bound);
+            }
+        }
+
+        static void build_double_range_bound(const double bound, std::string& sql, SQLParameters* parameters) {
+            if (parameters) {
+                sql += "?";
+                parameters->emplace_back().set_double_value(bound);
+            } else {
+                sql += fmt::format("{}", bound);
+            }
+        }
+
+        static void build_int_range_query(const IntRangeQuery& range_query, std::string& sql, SQLParameters* parameters) {
             std::vector<std::string> ranges;
             if (range_query.has_from()) {
                 std::string range;
                 range += range_query.name();
                 range += range_query.inclusive_start() ? " >= " : " > ";
-                range += std::to_string(range_query.from());
+                build_int_range_bound(range_query.from(), range, parameters);
                 ranges.push_back(range);
             }
             if (range_query.has_to()) {
                 std::string range;
                 range += range_query.name();
                 range += range_query.inclusive_end() ? " <= " : " < ";
-                range += std::to_string(range_query.to());
+                build_int_range_bound(range_query.to(), range, parameters);
                 ranges.push_back(range);
             }
             if (!ranges.empty()) {
@@ -44,20 +70,20 @@ namespace INSTINCT_RETRIEVAL_NS {
             }
         }
 
-        static void build_double_range_query(const DoubleRangeQuery& range_query, std::string& sql) {
+        static void build_double_range_query(const DoubleRangeQuery& range_query, std::string& sql, SQLParameters* parameters) {
             std::vector<std::string> ranges;
             if (range_query.has_from()) {
                 std::string range;
                 range += range_query.name();
                 range += range_query.inclusive_start() ? " >= " : " > ";
-                range += fmt::format("{}", range_query.from());
+                build_double_range_bound(range_query.from(), range, parameters);
                 ranges.push_back(range);
             }
             if (range_query.has_to()) {
                 std::string range;
                 range += range_query.name();
                 range += range_query.inclusive_end() ? " <= " : " < ";
-                range += fmt::format("{}", range_query.to());
+                build_double_range_bound(range_query.to(), range, parameters);
                 ranges.push_back(range);
             }
             if (!ranges.empty()) {
@@ -71,23 +97,27 @@ namespace INSTINCT_RETRIEVAL_NS {
             }
         }
 
-        static void build_search_query(const SearchQuery& search_query, std::string& sql) {
+        static void build_search_query(const SearchQuery& search_query, std::string& sql, SQLParameters* parameters) {
             if (search_query.has_bool_()) {
-                build_bool_query(search_query.bool_(), sql);
+                build_bool_query(search_query.bool_(), sql, parameters);
             } else if (search_query.has_term()) {
-                build_term_query(search_query.term(), sql);
+                build_term_query(search_query.term(), sql, parameters);
             } else if(search_query.has_terms()) {
-                build_terms_query(search_query.terms(), sql);
+                build_terms_query(search_query.terms(), sql, parameters);
             } else if(search_query.has_double_range()) {
-                build_double_range_query(search_query.double_range(), sql);
+                build_double_range_query(search_query.double_range(), sql, parameters);
             } else if(search_query.has_int_range()) {
-                build_int_range_query(search_query.int_range(), sql);
+                build_int_range_query(search_query.int_range(), sql, parameters);
             }
         }
 
-        static void build_term_value(const PrimitiveValue& value, std::string& sql) {
+        static void build_term_value(const PrimitiveValue& value, std::string& sql, SQLParameters* parameters = nullptr) {
             if (value.is_null()) {
+                // NULL is kept as literal, as it's part of query shape
                 sql += "NULL";
+            } else if (parameters) {
+                sql += "?";
+                parameters->push_back(value);
             } else {
                 if (value.has_double_value()) {
                     sql += std::to_string(value.double_value());
@@ -99,7 +129,7 @@ namespace INSTINCT_RETRIEVAL_NS {
                     sql += std::to_string(value.int_value());
                 }
                 if (value.has_long_value()) {
-                    sql += std::to_string(value.double_value());
+                    sql += std::to_string(value.long_value());
                 }
                 if (value.has_bool_value()) {
                     sql += value.bool_value() ? '1' : '0';
@@ -112,38 +142,38 @@ namespace INSTINCT_RETRIEVAL_NS {
             }
         }
 
-        static void build_terms_query(const TermsQuery& terms_query, std::string& sql) {
+        static void build_terms_query(const TermsQuery& terms_query, std::string& sql, SQLParameters* parameters) {
             sql += terms_query.name();
             sql += " IN (";
-            const auto term_values = terms_query.terms() | std::views::transform([&](const auto& term) {
-                std::string v;
-                build_term_value(term,v);
-                return v;
-            });
+            // values are rendered eagerly so that parameters are appended in order
+            std::vector<std::string> term_values;
+            for (const auto& term: terms_query.terms()) {
+                build_term_value(term, term_values.emplace_back(), parameters);
+            }
             sql += StringUtils::JoinWith(term_values, ", ");
             sql += ")";
         }
 
-        static void build_term_query(const TermQuery& term_query, std::string& sql) {
+        static void build_term_query(const TermQuery& term_query, std::string& sql, SQLParameters* parameters) {
             sql += term_query.name();
             sql += " = ";
-            build_term_value(term_query.term(), sql);
+            build_term_value(term_query.term(), sql, parameters);
 
         }
 
-        static void build_bool_query(const BoolQuery& bool_query, std::string& sql) {
+        static void build_bool_query(const BoolQuery& bool_query, std::string& sql, SQLParameters* parameters) {
             std::vector<std::string> predicates;
             if (bool_query.must_size()>0) {
                 std::string predicate;
                 if (const auto n = bool_query.must_size(); n>1) {
                     predicate+= "(";
                     for(int i=0; i< n;++i) {
-                        build_search_query(bool_query.must(i), predicate);
+                        build_search_query(bool_query.must(i), predicate, parameters);
                         predicate += i==n-1 ?  "" : " AND ";
                     }
                     predicate += ")";
                 } else {
-                    build_search_query(bool_query.must(0), predicate);
+                    build_search_query(bool_query.must(0), predicate, parameters);
                 }
                 predicates.push_back(predicate);
             }
@@ -152,12 +182,12 @@ namespace INSTINCT_RETRIEVAL_NS {
                 if (const auto n = bool_query.should_size(); n>1) {
                     predicate+= "(";
                     for(int i=0; i< bool_query.should_size();++i) {
-                        build_search_query(bool_query.should(i), predicate);
+                        build_search_query(bool_query.should(i), predicate, parameters);
                         predicate += i==n-1 ?  "" : " OR ";
                     }
                     predicate += ")";
                 } else {
-                    build_search_query(bool_query.should(0), predicate);
+                    build_search_query(bool_query.should(0), predicate, parameters);
                 }
                 predicates.push_back(predicate);
             }
@@ -167,13 +197,13 @@ namespace INSTINCT_RETRIEVAL_NS {
                     predicate+= "(";
                     for(int i=0; i< bool_query.mustnot_size();++i) {
                         predicate+= "NOT ";
-                        build_search_query(bool_query.mustnot(i), predicate);
+                        build_search_query(bool_query.mustnot(i), predicate, parameters);
                         predicate += i==n-1 ?  "" : " AND ";
                     }
                     predicate += ")";
                 } else {
                     predicate += "NOT ";
-                    build_search_query(bool_query.mustnot(0), predicate);
+                    build_search_query(bool_query.mustnot(0), predicate, parameters);
                 }
                 predicates.push_back(predicate);
             }
@@ -210,13 +240,91 @@ namespace INSTINCT_RETRIEVAL_NS {
             R&& sorters = {},
             const int offset = -1,
             const int limit = -1) {
-            std::vector<std::string> parts = {"SELECT", column_list, "FROM", table_name};
+            return BuildSelectString_(table_name, column_list, search_query, std::forward<R>(sorters), offset, limit, nullptr);
+        }
+
+        /**
+         * Build SELECT statement with placeholders for values in search query, offset and limit. Queries of same shape produce identical SQL text, so that the statement can be prepared once and executed with different parameters.
+         * @param table_name
+         * @param column_list
+         * @param search_query
+         * @param parameters Values to be bound are appended to it, in order of placeholders. Caller should prepend values for placeholders in `column_list` if any.
+         * @param sorters
+         * @param offset
+         * @param limit
+         * @return
+         */
+        template<typename R = std::vector<Sorter>>
+        requires RangeOf<R, Sorter>
+        static std::string ToParameterizedSelectString(
+            const std::string& table_name,
+            const std::string& column_list,
+            const SearchQuery& search_query,
+            SQLParameters& parameters,
+            R&& sorters = {},
+            const int offset = -1,
+            const int limit = -1) {
+            return BuildSelectString_(table_name, column_list, search_query, std::forward<R>(sorters), offset, limit, &parameters);
+        }
+
+        static std::string ToDeleteString(
+            const std::string& table_name,
+            const SearchQuery& search_query) {
+            std::vector<std::string> parts = {"DELETE", "FROM",  table_name};
             if (search_query.query_case() != SearchQuery::QUERY_NOT_SET) {
                 parts.emplace_back("WHERE");
                 std::string sql;
                 details::build_search_query(search_query, sql);
                 parts.push_back(sql);
             }
+            return StringUtils::JoinWith(parts, " ") + ";";
+        }
+
+        /**
+         * Build DELETE statement with placeholders for values in search query, like `ToParameterizedSelectString`.
+         * @param table_name
+         * @param search_query
+         * @param parameters Values to be bound are appended to it, in order of placeholders
+         * @param returning_column_list Columns of deleted rows to be returned, or empty to return count of deleted rows
+         * @return
+         */
+        static std::string ToParameterizedDeleteString(
+            const std::string& table_name,
+            const SearchQuery& search_query,
+            SQLParameters& parameters,
+            const std::string& returning_column_list = "") {
+            std::vector<std::string> parts = {"DELETE", "FROM",  table_name};
+            if (search_query.query_case() != SearchQuery::QUERY_NOT_SET) {
+                parts.emplace_back("WHERE");
+                std::string sql;
+                details::build_search_query(search_query, sql, &parameters);
+                parts.push_back(sql);
+            }
+            if (!returning_column_list.empty()) {
+                parts.emplace_back("RETURNING");
+                parts.push_back(returning_column_list);
+            }
+            return StringUtils::JoinWith(parts, " ") + ";";
+        }
+
+    private:
+        template<typename R>
+        requires RangeOf<R, Sorter>
+        static std::string BuildSelectString_(
+            const std::string& table_name,
+            const std::string& column_list,
+            const SearchQuery& search_query,
+            R&& sorters,
+            const int offset,
+            const int limit,
+            SQLParameters* parameters) {
+            std::vector<std::string> parts = {"SELECT", column_list, "FROM", table_name};
+            if (search_query.query_case() != SearchQuery::QUERY_NOT_SET) {
+                parts.emplace_back("WHERE");
+                std::string sql;
+                details::build_search_query(search_query, sql, parameters);
+                parts.push_back(sql);
+            }
             if (!std::ranges::empty(sorters)) {
                 std::string sql;
                 details::build_sorters(sorters, sql);
@@ -225,23 +333,14 @@ namespace INSTINCT_RETRIEVAL_NS {
 
             if (limit>0) {
                 parts.emplace_back("LIMIT");
-                parts.emplace_back(std::to_string(limit));
+                std::string sql;
+                details::build_int_range_bound(limit, sql, parameters);
+                parts.push_back(sql);
             }
             if (offset>0) {
                 parts.emplace_back("OFFSET");
-                parts.push_back(std::to_string(offset));
-            }
-            return StringUtils::JoinWith(parts, " ") + ";";
-        }
-
-        static std::string ToDeleteString(
-            const std::string& table_name,
-            const SearchQuery& search_query) {
-            std::vector<std::string> parts = {"DELETE", "FROM",  table_name};
-            if (search_query.query_case() != SearchQuery::QUERY_NOT_SET) {
-                parts.emplace_back("WHERE");
                 std::string sql;
-                details::build_search_query(search_query, sql);
+                details::build_int_range_bound(offset, sql, parameters);
                 parts.push_back(sql);
             }
             return StringUtils::JoinWith(parts, " ") + ";";
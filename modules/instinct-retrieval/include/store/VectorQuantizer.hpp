@@ -0,0 +1,618 @@
+#ifndef VECTORQUANTIZER_HPP
+#define VECTORQUANTIZER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+
+#include "RetrievalGlobals.hpp"
+#include "tools/Assertions.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    enum VectorQuantizationType {
+        kNoQuantization,
+        kInt8Quantization,
+        kProductQuantization
+    };
+
+    struct VectorQuantizationOptions {
+        /**
+         * Encoding of vectors for approximate scan. `kNoQuantization` means FLOAT vectors are scanned directly.
+         */
+        VectorQuantizationType type = kNoQuantization;
+
+        /**
+         * Count of sub-spaces for product quantization, and each of them is encoded in one byte. Dimension should be divisible by it. Zero means `dimension / 4`, which recalls well for typical text embeddings with 16x fewer bytes than FLOAT array.
+         */
+        size_t pq_subspaces = 0;
+
+        /**
+         * Count of Lloyd iterations when training PQ codebooks
+         */
+        size_t pq_training_iterations = 10;
+
+        /**
+         * Max count of vectors sampled for training
+         */
+        size_t training_sample_size = 10000;
+
+        /**
+         * Tables with fewer rows than this threshold are searched with brute-force scan, and quantizer is trained only after table has this many rows.
+         */
+        size_t brute_force_threshold = 5000;
+
+        /**
+         * `top_k * rescore_factor` candidates are recalled by scanning codes, and then re-scored with FLOAT vectors.
+         */
+        size_t rescore_factor = 4;
+
+        /**
+         * When metadata filter is given, count of candidates is multiplied by this factor before post-checking.
+         */
+        size_t filter_overfetch_factor = 4;
+
+        /**
+         * Codes are written to snapshot table once this many vectors are added or removed since last snapshot, or a quarter of code count if that's larger, so that cost of rewriting all codes is amortized. Pending changes are always written when store is destructed. Zero means codes are only written on destruction.
+         */
+        size_t snapshot_interval = 10000;
+
+        /**
+         * Seed for sampling and centroid initialization. Fixed seed makes training reproducible.
+         */
+        uint64_t seed = 42;
+    };
+
+    /**
+     * Compact codes of vectors for asymmetric distance computation (ADC), in which query vector is kept in full precision while stored vectors are scanned as codes.
+     *
+     * 1. `kInt8Quantization`: each component is encoded in one byte, using per-dimension range learnt during training.
+     * 2. `kProductQuantization`: vector is split into `m` sub-vectors, and each of them is encoded as index of nearest centroid in a codebook of 256 entries, following Jégou et al. (https://hal.inria.fr/inria-00514462).
+     *
+     * Vectors are normalized before encoding, and approximate cosine similarity is computed against reconstructed vectors with a lookup table built for each query. Results are approximate, so callers should re-score candidates with original vectors.
+     *
+     * This class is thread-safe: searches share a read lock while mutations take exclusive lock.
+     */
+    class VectorQuantizer final {
+        static constexpr uint32_t SERIALIZATION_MAGIC = 0x56514E54; // "VQNT"
+        static constexpr uint32_t SERIALIZATION_VERSION = 1;
+        static constexpr size_t PQ_CENTROIDS = 256;
+
+        size_t dimension_;
+        VectorQuantizationOptions options_;
+        size_t subspaces_ = 0;
+        size_t code_size_ = 0;
+        bool trained_ = false;
+
+        // int8: per-dimension offset and step
+        std::vector<float> mins_;
+        std::vector<float> steps_;
+        // pq: `subspaces_ * PQ_CENTROIDS` centroids of `dimension_ / subspaces_` components
+        std::vector<float> centroids_;
+
+        std::vector<std::string> ids_;
+        std::vector<uint8_t> codes_;
+        // norms of reconstructed vectors
+        std::vector<float> norms_;
+        std::unordered_map<std::string, size_t> slots_;
+        mutable std::shared_mutex mutex_;
+
+    public:
+        VectorQuantizer(const size_t dimension, const VectorQuantizationOptions& options)
+            : dimension_(dimension),
+              options_(options) {
+            assert_positive(dimension_, "dimension should be positive");
+            assert_true(options_.type != kNoQuantization, "should specify quantization type");
+            if (options_.type == kInt8Quantization) {
+                code_size_ = dimension_;
+            } else {
+                subspaces_ = options_.pq_subspaces > 0 ? options_.pq_subspaces : std::max<size_t>(dimension_ / 4, 1);
+                assert_true(dimension_ % subspaces_ == 0, fmt::format("dimension {} should be divisible by count of PQ sub-spaces {}", dimension_, subspaces_));
+                code_size_ = subspaces_;
+            }
+        }
+
+        /**
+         * Learn quantization parameters from sample vectors. Codes added before are dropped, as they are meaningless with new parameters.
+         * @param vectors Sample vectors laid out contiguously, so its size should be multiple of dimension. At most `training_sample_size` of them are used.
+         */
+        void Train(const std::vector<float>& vectors) {
+            assert_true(vectors.size() % dimension_ == 0, "size of sample vectors should be multiple of dimension");
+            const auto n = vectors.size() / dimension_;
+            assert_positive(n, "should provide at least one sample vector");
+
+            // sample and normalize
+            std::vector<size_t> picked(n);
+            std::iota(picked.begin(), picked.end(), 0);
+            std::mt19937_64 gen(options_.seed);
+            if (n > options_.training_sample_size && options_.training_sample_size > 0) {
+                std::ranges::shuffle(picked, gen);
+                picked.resize(options_.training_sample_size);
+            }
+            std::vector<float> samples(picked.size() * dimension_);
+            for (size_t i = 0; i < picked.size(); ++i) {
+                Normalize_(vectors.data() + picked[i] * dimension_, samples.data() + i * dimension_);
+            }
+
+            std::unique_lock lock(mutex_);
+            if (options_.type == kInt8Quantization) {
+                TrainScalar_(samples, picked.size());
+            } else {
+                TrainProduct_(samples, picked.size(), gen);
+            }
+            trained_ = true;
+            if (!ids_.empty()) {
+                LOG_WARN("Quantizer is re-trained, {} previous codes are dropped", ids_.size());
+            }
+            Clear_();
+        }
+
+        /**
+         * Encode and insert a vector. If `id` already exists, previous code will be replaced.
+         * @param id Document id
+         * @param data Raw embedding, which is not required to be normalized
+         * @param size
+         */
+        void Add(const std::string& id, const float* data, const size_t size) {
+            assert_true(size == dimension_, fmt::format("vector dimension mismatch: expected={}, actual={}", dimension_, size));
+            std::vector<float> normalized(dimension_);
+            Normalize_(data, normalized.data());
+            std::unique_lock lock(mutex_);
+            assert_true(trained_, "quantizer should be trained before adding vectors");
+            size_t slot;
+            if (const auto itr = slots_.find(id); itr != slots_.end()) {
+                slot = itr->second;
+            } else {
+                slot = ids_.size();
+                ids_.push_back(id);
+                codes_.resize(codes_.size() + code_size_);
+                norms_.push_back(0);
+                slots_[id] = slot;
+            }
+            norms_[slot] = Encode_(normalized.data(), codes_.data() + slot * code_size_);
+        }
+
+        void Add(const std::string& id, const std::vector<float>& vector) {
+            Add(id, vector.data(), vector.size());
+        }
+
+        /**
+         * Remove a vector by id. Last vector is moved into the freed slot, so that codes are always contiguous.
+         * @param id
+         * @return true if vector is found and removed
+         */
+        bool Remove(const std::string& id) {
+            std::unique_lock lock(mutex_);
+            const auto itr = slots_.find(id);
+            if (itr == slots_.end()) {
+                return false;
+            }
+            const auto slot = itr->second;
+            slots_.erase(itr);
+            if (const auto last = ids_.size() - 1; slot != last) {
+                ids_[slot] = std::move(ids_[last]);
+                std::memcpy(codes_.data() + slot * code_size_, codes_.data() + last * code_size_, code_size_);
+                norms_[slot] = norms_[last];
+                slots_[ids_[slot]] = slot;
+            }
+            ids_.pop_back();
+            codes_.resize(codes_.size() - code_size_);
+            norms_.pop_back();
+            return true;
+        }
+
+        /**
+         * Scan all codes to find k nearest neighbors by approximate cosine similarity
+         * @param query Raw query vector
+         * @param k Count of results
+         * @return list of id and approximate cosine similarity, sorted by similarity in descending order
+         */
+        [[nodiscard]] std::vector<std::pair<std::string, float>> Search(const std::vector<float>& query, const size_t k) const {
+            assert_true(query.size() == dimension_, fmt::format("query dimension mismatch: expected={}, actual={}", dimension_, query.size()));
+            std::vector<std::pair<std::string, float>> result;
+            if (k == 0) {
+                return result;
+            }
+            std::vector<float> normalized_query(dimension_);
+            Normalize_(query.data(), normalized_query.data());
+
+            std::shared_lock lock(mutex_);
+            if (!trained_ || ids_.empty()) {
+                return result;
+            }
+            // min heap of (similarity, slot), whose top is the worst among kept candidates
+            using Candidate = std::pair<float, size_t>;
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> top_candidates;
+            const auto keep = [&](const float dot, const size_t slot) {
+                const float similarity = norms_[slot] > 0 ? dot / norms_[slot] : 0;
+                if (top_candidates.size() < k) {
+                    top_candidates.emplace(similarity, slot);
+                } else if (similarity > top_candidates.top().first) {
+                    top_candidates.pop();
+                    top_candidates.emplace(similarity, slot);
+                }
+            };
+
+            if (options_.type == kInt8Quantization) {
+                // dot(q, min + step * c) = dot(q, min) + sum(q * step * c)
+                float bias = 0;
+                std::vector<float> weights(dimension_);
+                for (size_t i = 0; i < dimension_; ++i) {
+                    bias += normalized_query[i] * mins_[i];
+                    weights[i] = normalized_query[i] * steps_[i];
+                }
+                for (size_t slot = 0; slot < ids_.size(); ++slot) {
+                    keep(bias + ScalarDot_(weights.data(), codes_.data() + slot * code_size_), slot);
+                }
+            } else {
+                // lookup table of dot products between each sub-query and each centroid
+                const auto sub_dimension = dimension_ / subspaces_;
+                std::vector<float> table(subspaces_ * PQ_CENTROIDS);
+                for (size_t m = 0; m < subspaces_; ++m) {
+                    const float* sub_query = normalized_query.data() + m * sub_dimension;
+                    for (size_t c = 0; c < PQ_CENTROIDS; ++c) {
+                        const float* centroid = centroids_.data() + (m * PQ_CENTROIDS + c) * sub_dimension;
+                        float dot = 0;
+                        for (size_t j = 0; j < sub_dimension; ++j) {
+                            dot += sub_query[j] * centroid[j];
+                        }
+                        table[m * PQ_CENTROIDS + c] = dot;
+                    }
+                }
+                for (size_t slot = 0; slot < ids_.size(); ++slot) {
+                    const uint8_t* code = codes_.data() + slot * code_size_;
+                    float dot = 0;
+                    for (size_t m = 0; m < subspaces_; ++m) {
+                        dot += table[m * PQ_CENTROIDS + code[m]];
+                    }
+                    keep(dot, slot);
+                }
+            }
+
+            result.resize(top_candidates.size());
+            for (auto i = static_cast<int64_t>(top_candidates.size()) - 1; i >= 0; --i) {
+                const auto& [similarity, slot] = top_candidates.top();
+                result[i] = {ids_[slot], similarity};
+                top_candidates.pop();
+            }
+            return result;
+        }
+
+        /**
+         * @return count of encoded vectors
+         */
+        [[nodiscard]] size_t Size() const {
+            std::shared_lock lock(mutex_);
+            return ids_.size();
+        }
+
+        [[nodiscard]] bool Contains(const std::string& id) const {
+            std::shared_lock lock(mutex_);
+            return slots_.contains(id);
+        }
+
+        [[nodiscard]] bool IsTrained() const {
+            std::shared_lock lock(mutex_);
+            return trained_;
+        }
+
+        /**
+         * @return bytes scanned for each vector during search, including code and norm
+         */
+        [[nodiscard]] size_t GetBytesPerVector() const {
+            return code_size_ + sizeof(float);
+        }
+
+        [[nodiscard]] size_t GetDimension() const {
+            return dimension_;
+        }
+
+        [[nodiscard]] const VectorQuantizationOptions& GetOptions() const {
+            return options_;
+        }
+
+        /**
+         * Drop all codes. Quantization parameters are kept.
+         */
+        void Clear() {
+            std::unique_lock lock(mutex_);
+            Clear_();
+        }
+
+        /**
+         * Serialize quantization parameters and codes
+         * @return binary payload
+         */
+        [[nodiscard]] std::string Serialize() const {
+            std::shared_lock lock(mutex_);
+            std::string payload;
+            Write_(payload, SERIALIZATION_MAGIC);
+            Write_(payload, SERIALIZATION_VERSION);
+            Write_(payload, static_cast<uint32_t>(options_.type));
+            Write_(payload, static_cast<uint64_t>(dimension_));
+            Write_(payload, static_cast<uint64_t>(code_size_));
+            Write_(payload, static_cast<uint8_t>(trained_));
+            WriteFloats_(payload, mins_);
+            WriteFloats_(payload, steps_);
+            WriteFloats_(payload, centroids_);
+            Write_(payload, static_cast<uint64_t>(ids_.size()));
+            for (size_t slot = 0; slot < ids_.size(); ++slot) {
+                Write_(payload, static_cast<uint32_t>(ids_[slot].size()));
+                payload.append(ids_[slot]);
+                Write_(payload, norms_[slot]);
+                payload.append(reinterpret_cast<const char*>(codes_.data() + slot * code_size_), code_size_);
+            }
+            return payload;
+        }
+
+        /**
+         * Restore quantizer from payload generated by `Serialize`.
+         * @param payload
+         * @param options
+         * @return nullptr if payload is malformed or it's generated with different type of quantization
+         */
+        static std::unique_ptr<VectorQuantizer> Deserialize(const std::string& payload, const VectorQuantizationOptions& options) {
+            size_t offset = 0;
+            uint32_t magic, version, type;
+            uint64_t dimension, code_size, count;
+            uint8_t trained;
+            if (!Read_(payload, offset, magic) || magic != SERIALIZATION_MAGIC ||
+                !Read_(payload, offset, version) || version != SERIALIZATION_VERSION ||
+                !Read_(payload, offset, type) || type != static_cast<uint32_t>(options.type) ||
+                !Read_(payload, offset, dimension) ||
+                !Read_(payload, offset, code_size) ||
+                !Read_(payload, offset, trained)) {
+                LOG_WARN("Malformed or incompatible quantizer payload header");
+                return nullptr;
+            }
+            if (dimension == 0 || (options.type == kProductQuantization && options.pq_subspaces > 0 && dimension % options.pq_subspaces != 0)) {
+                LOG_WARN("Dimension of quantizer payload is incompatible with options: dimension={}, pq_subspaces={}", dimension, options.pq_subspaces);
+                return nullptr;
+            }
+            auto quantizer = std::make_unique<VectorQuantizer>(dimension, options);
+            if (quantizer->code_size_ != code_size) {
+                LOG_WARN("Code size of quantizer payload mismatches: expected={}, actual={}", quantizer->code_size_, code_size);
+                return nullptr;
+            }
+            quantizer->trained_ = trained;
+            if (!ReadFloats_(payload, offset, quantizer->mins_) ||
+                !ReadFloats_(payload, offset, quantizer->steps_) ||
+                !ReadFloats_(payload, offset, quantizer->centroids_) ||
+                !Read_(payload, offset, count)) {
+                return nullptr;
+            }
+            // quantization parameters are indexed by dimension or sub-space without bounds check in `Search` and `Add`, so their sizes are validated here
+            const auto [expected_scalar_size, expected_centroids_size] = quantizer->GetExpectedParameterSizes_();
+            if (quantizer->mins_.size() != expected_scalar_size || quantizer->steps_.size() != expected_scalar_size || quantizer->centroids_.size() != expected_centroids_size) {
+                LOG_WARN("Quantization parameters in payload have wrong sizes: mins={}, steps={}, centroids={}, expected_mins={}, expected_centroids={}",
+                    quantizer->mins_.size(), quantizer->steps_.size(), quantizer->centroids_.size(), expected_scalar_size, expected_centroids_size);
+                return nullptr;
+            }
+            quantizer->ids_.reserve(count);
+            quantizer->norms_.reserve(count);
+            quantizer->codes_.reserve(count * code_size);
+            for (uint64_t slot = 0; slot < count; ++slot) {
+                uint32_t id_size;
+                float norm;
+                if (!Read_(payload, offset, id_size) || offset + id_size > payload.size()) {
+                    return nullptr;
+                }
+                auto id = payload.substr(offset, id_size);
+                offset += id_size;
+                if (!Read_(payload, offset, norm) || offset + code_size > payload.size()) {
+                    return nullptr;
+                }
+                quantizer->codes_.insert(quantizer->codes_.end(), payload.begin() + static_cast<int64_t>(offset), payload.begin() + static_cast<int64_t>(offset + code_size));
+                offset += code_size;
+                quantizer->norms_.push_back(norm);
+                quantizer->slots_[id] = slot;
+                quantizer->ids_.push_back(std::move(id));
+            }
+            return quantizer;
+        }
+
+    private:
+        /**
+         * @return expected count of floats in `mins_` (and `steps_`), and in `centroids_`
+         */
+        [[nodiscard]] std::pair<size_t, size_t> GetExpectedParameterSizes_() const {
+            if (!trained_) {
+                return {0, 0};
+            }
+            if (options_.type == kInt8Quantization) {
+                return {dimension_, 0};
+            }
+            return {0, subspaces_ * PQ_CENTROIDS * (dimension_ / subspaces_)};
+        }
+
+        void Normalize_(const float* data, float* output) const {
+            float norm = 0;
+            for (size_t i = 0; i < dimension_; ++i) {
+                norm += data[i] * data[i];
+            }
+            norm = norm > 0 ? std::sqrt(norm) : 1;
+            for (size_t i = 0; i < dimension_; ++i) {
+                output[i] = data[i] / norm;
+            }
+        }
+
+        [[nodiscard]] float ScalarDot_(const float* weights, const uint8_t* code) const {
+            // independent accumulators let compiler vectorize without -ffast-math
+            float acc[8] = {};
+            size_t i = 0;
+            for (; i + 8 <= dimension_; i += 8) {
+                for (size_t j = 0; j < 8; ++j) {
+                    acc[j] += weights[i + j] * static_cast<float>(code[i + j]);
+                }
+            }
+            float dot = 0;
+            for (; i < dimension_; ++i) {
+                dot += weights[i] * static_cast<float>(code[i]);
+            }
+            for (const auto& a: acc) {
+                dot += a;
+            }
+            return dot;
+        }
+
+        void TrainScalar_(const std::vector<float>& samples, const size_t n) {
+            mins_.assign(dimension_, std::numeric_limits<float>::max());
+            std::vector<float> maxs(dimension_, std::numeric_limits<float>::lowest());
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < dimension_; ++j) {
+                    mins_[j] = std::min(mins_[j], samples[i * dimension_ + j]);
+                    maxs[j] = std::max(maxs[j], samples[i * dimension_ + j]);
+                }
+            }
+            steps_.resize(dimension_);
+            for (size_t j = 0; j < dimension_; ++j) {
+                steps_[j] = maxs[j] > mins_[j] ? (maxs[j] - mins_[j]) / 255.0f : 0;
+            }
+        }
+
+        void TrainProduct_(const std::vector<float>& samples, const size_t n, std::mt19937_64& gen) {
+            const auto sub_dimension = dimension_ / subspaces_;
+            centroids_.assign(subspaces_ * PQ_CENTROIDS * sub_dimension, 0);
+            // initial centroids are picked from distinct samples, and repeated if there are fewer samples than centroids
+            std::vector<size_t> seeds(n);
+            std::iota(seeds.begin(), seeds.end(), 0);
+            std::ranges::shuffle(seeds, gen);
+
+            // sub-spaces are independent, so they are trained in parallel
+            const auto train_subspace = [&](const size_t m) {
+                float* centroids = centroids_.data() + m * PQ_CENTROIDS * sub_dimension;
+                for (size_t c = 0; c < PQ_CENTROIDS; ++c) {
+                    std::memcpy(centroids + c * sub_dimension, samples.data() + seeds[c % n] * dimension_ + m * sub_dimension, sizeof(float) * sub_dimension);
+                }
+                std::vector<uint8_t> assignments(n);
+                std::vector<float> sums(PQ_CENTROIDS * sub_dimension);
+                std::vector<size_t> counts(PQ_CENTROIDS);
+                for (size_t iteration = 0; iteration < std::max<size_t>(options_.pq_training_iterations, 1); ++iteration) {
+                    for (size_t i = 0; i < n; ++i) {
+                        assignments[i] = NearestCentroid_(centroids, samples.data() + i * dimension_ + m * sub_dimension, sub_dimension);
+                    }
+                    std::ranges::fill(sums, 0);
+                    std::ranges::fill(counts, 0);
+                    for (size_t i = 0; i < n; ++i) {
+                        const float* sub_vector = samples.data() + i * dimension_ + m * sub_dimension;
+                        float* sum = sums.data() + assignments[i] * sub_dimension;
+                        for (size_t j = 0; j < sub_dimension; ++j) {
+                            sum[j] += sub_vector[j];
+                        }
+                        ++counts[assignments[i]];
+                    }
+                    // empty clusters keep their previous centroids
+                    for (size_t c = 0; c < PQ_CENTROIDS; ++c) {
+                        if (counts[c] == 0) continue;
+                        for (size_t j = 0; j < sub_dimension; ++j) {
+                            centroids[c * sub_dimension + j] = sums[c * sub_dimension + j] / static_cast<float>(counts[c]);
+                        }
+                    }
+                }
+            };
+            const auto concurrency = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), subspaces_);
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < concurrency; ++t) {
+                workers.emplace_back([&, t] {
+                    for (size_t m = t; m < subspaces_; m += concurrency) {
+                        train_subspace(m);
+                    }
+                });
+            }
+            for (auto& worker: workers) {
+                worker.join();
+            }
+        }
+
+        [[nodiscard]] static uint8_t NearestCentroid_(const float* centroids, const float* sub_vector, const size_t sub_dimension) {
+            size_t best = 0;
+            float best_distance = std::numeric_limits<float>::max();
+            for (size_t c = 0; c < PQ_CENTROIDS; ++c) {
+                float distance = 0;
+                for (size_t j = 0; j < sub_dimension; ++j) {
+                    const float d = sub_vector[j] - centroids[c * sub_dimension + j];
+                    distance += d * d;
+                }
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = c;
+                }
+            }
+            return static_cast<uint8_t>(best);
+        }
+
+        /**
+         * Encode normalized vector
+         * @return norm of reconstructed vector
+         */
+        float Encode_(const float* normalized, uint8_t* code) const {
+            float norm = 0;
+            if (options_.type == kInt8Quantization) {
+                for (size_t i = 0; i < dimension_; ++i) {
+                    const float q = steps_[i] > 0 ? std::round((normalized[i] - mins_[i]) / steps_[i]) : 0;
+                    code[i] = static_cast<uint8_t>(std::clamp(q, 0.0f, 255.0f));
+                    const float reconstructed = mins_[i] + steps_[i] * static_cast<float>(code[i]);
+                    norm += reconstructed * reconstructed;
+                }
+            } else {
+                const auto sub_dimension = dimension_ / subspaces_;
+                for (size_t m = 0; m < subspaces_; ++m) {
+                    const float* centroids = centroids_.data() + m * PQ_CENTROIDS * sub_dimension;
+                    code[m] = NearestCentroid_(centroids, normalized + m * sub_dimension, sub_dimension);
+                    for (size_t j = 0; j < sub_dimension; ++j) {
+                        norm += centroids[code[m] * sub_dimension + j] * centroids[code[m] * sub_dimension + j];
+                    }
+                }
+            }
+            return std::sqrt(norm);
+        }
+
+        void Clear_() {
+            ids_.clear();
+            codes_.clear();
+            norms_.clear();
+            slots_.clear();
+        }
+
+        template<typename T>
+        static void Write_(std::string& buf, const T& value) {
+            buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        static void WriteFloats_(std::string& buf, const std::vector<float>& values) {
+            Write_(buf, static_cast<uint64_t>(values.size()));
+            buf.append(reinterpret_cast<const char*>(values.data()), sizeof(float) * values.size());
+        }
+
+        template<typename T>
+        static bool Read_(const std::string& buf, size_t& offset, T& value) {
+            if (offset + sizeof(T) > buf.size()) {
+                return false;
+            }
+            std::memcpy(&value, buf.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        static bool ReadFloats_(const std::string& buf, size_t& offset, std::vector<float>& values) {
+            uint64_t size;
+            if (!Read_(buf, offset, size) || offset + sizeof(float) * size > buf.size()) {
+                return false;
+            }
+            values.resize(size);
+            std::memcpy(values.data(), buf.data() + offset, sizeof(float) * size);
+            offset += sizeof(float) * size;
+            return true;
+        }
+    };
+
+    using VectorQuantizerPtr = std::shared_ptr<VectorQuantizer>;
+}
+
+#endif //VECTORQUANTIZER_HPP
@@ -6,6 +6,7 @@
 #define BASEDUCKDBSTORE_HPP
 
 #include <duckdb.hpp>
+#include <random>
 #include "tools/Assertions.hpp"
 
 #include "RetrievalGlobals.hpp"
@@ -13,7 +14,13 @@
 #include "tools/StringUtils.hpp"
 #include "functional/ReactiveFunctions.hpp"
 #include "store/SQLBuilder.hpp"
+#include "store/HNSWIndex.hpp"
+#include "store/VectorQuantizer.hpp"
+#include "store/KeywordIndex.hpp"
 #include "tools/DocumentUtils.hpp"
+#include "tools/ChronoUtils.hpp"
+#include "tools/LRUCache.hpp"
+#include "database/duckdb/DuckDBConnectionPool.hpp"
 
 
 namespace INSTINCT_RETRIEVAL_NS {
@@ -23,6 +30,45 @@ namespace INSTINCT_RETRIEVAL_NS {
     using namespace INSTINCT_LLM_NS;
     using namespace INSTINCT_DATA_NS;
 
+    struct IngestionProgress {
+        /**
+         * Count of chunks committed, or count of embedding micro-batches appended in `IngestionOptions::on_batch_appended`
+         */
+        size_t chunk_count = 0;
+        size_t row_count = 0;
+        size_t failed_count = 0;
+        long elapsed_ms = 0;
+    };
+
+    using IngestionProgressCallback = std::function<void(const IngestionProgress&)>;
+
+    struct IngestionOptions {
+        /**
+         * Max count of documents buffered when adding documents from `AsyncIterator`. Each chunk is appended and committed in its own transaction as soon as it's full, so that memory usage is bounded by chunk size rather than size of input. Zero means all documents are collected and committed in a single transaction.
+         */
+        size_t chunk_size = 4096;
+
+        /**
+         * Optional callback invoked after each chunk is committed
+         */
+        IngestionProgressCallback on_progress;
+
+        /**
+         * Count of documents embedded in one call by stores with embeddings. Documents to be added are split into micro-batches of this size, which are embedded concurrently and appended in order by a single writer as soon as they are ready. Zero means all documents of a call are embedded at once before appending.
+         */
+        size_t embedding_batch_size = 64;
+
+        /**
+         * Max count of micro-batches being embedded at the same time, which also bounds count of embeddings waiting to be appended
+         */
+        size_t max_in_flight_embedding_batches = 4;
+
+        /**
+         * Optional callback invoked after each embedding micro-batch is appended, with counts accumulated in current chunk. Rows are not committed until the chunk is.
+         */
+        IngestionProgressCallback on_batch_appended;
+    };
+
     struct DuckDBStoreOptions {
         /**
          * Table for storing data
@@ -63,15 +109,59 @@ namespace INSTINCT_RETRIEVAL_NS {
          * Optional instance id
          */
         std::string instance_id;
+
+        /**
+         * Options for ANN index on vector field. Only applicable to vector stores.
+         */
+        HNSWIndexOptions vector_index = {};
+
+        /**
+         * Max count of prepared statements cached for each pooled connection, keyed by SQL, e.g. search statements of different shapes of metadata filter. Zero means statements are prepared for each request.
+         */
+        size_t prepared_statement_cache_size = 32;
+
+        /**
+         * Options for pool of connections used by read operations, so that concurrent readers don't contend for a single connection. `initial_connection_count` is the max count of concurrent readers, and other readers wait for a released connection without timeout by default.
+         */
+        ConnectionPoolOptions connection_pool = {.initial_connection_count = 8, .max_wait_duration_for_acquire = std::chrono::seconds {0}};
+
+        /**
+         * Pool of connections shared with other stores of the same DuckDB instance, e.g. all instances created by a `DuckDBVectorStoreOperator`. If it's null, a private pool is created with `connection_pool`.
+         */
+        DuckDBConnectionPoolPtr shared_connection_pool = nullptr;
+
+        /**
+         * Options for scanning quantized codes instead of FLOAT vectors, followed by exact re-scoring of top candidates. Only applicable to vector stores, and HNSW index takes precedence if both are enabled.
+         */
+        VectorQuantizationOptions vector_quantization = {};
+
+        /**
+         * Options for BM25 keyword search over `text` column
+         */
+        KeywordIndexOptions keyword_index = {};
+
+        /**
+         * Options for adding documents from `AsyncIterator`
+         */
+        IngestionOptions ingestion = {};
+
+        /**
+         * Max count of ids bound to a single statement in `MultiGetDocuments` and `DeleteDocuments`. Larger id sets are split into chunks of this size.
+         */
+        size_t max_ids_per_statement = 10000;
     };
 
     namespace details {
+        /**
+         * make sql to select documents with ids in list bound to its only parameter, so that sql text is the same for any id set and can be prepared once
+         * @param table_name
+         * @param metadata_schema
+         * @return
+         */
         static std::string make_mget_sql(
             const std::string& table_name,
-            const std::shared_ptr<MetadataSchema>& metadata_schema,
-            const std::vector<std::string>& ids
+            const std::shared_ptr<MetadataSchema>& metadata_schema
         ) {
-            assert_non_empty_range(ids, "ID list cannot be empty");
             std::string select_sql = "SELECT id, text";
             auto name_view = metadata_schema->fields() | std::views::transform(
                                  [](const MetadataFieldSchema& field)-> std::string {
@@ -80,16 +170,69 @@ namespace INSTINCT_RETRIEVAL_NS {
             select_sql += name_view.empty() ? "" : ", " + StringUtils::JoinWith(name_view, ", ");
             select_sql += " FROM ";
             select_sql += table_name;
-            select_sql += " WHERE id in (";
-            for (int i = 0; i < ids.size(); ++i) {
-                select_sql += "'";
-                select_sql += ids[i];
-                select_sql += "'";
-                if (i < ids.size()) {
-                    select_sql += ",";
-                }
+            select_sql += " WHERE id IN (SELECT UNNEST(?::UUID[]));";
+            return select_sql;
+        }
+
+        /**
+         * make LIST value of ids in range of `[offset, offset + count)` for binding to parameter of id set
+         * @param ids
+         * @param offset
+         * @param count
+         * @return
+         */
+        static Value make_id_list_value(const std::vector<std::string>& ids, const size_t offset, const size_t count) {
+            vector<Value> values;
+            values.reserve(count);
+            for (size_t i = offset; i < offset + count; ++i) {
+                values.emplace_back(ids[i]);
+            }
+            return Value::LIST(LogicalType::VARCHAR, std::move(values));
+        }
+
+        /**
+         * make filter to select candidates by id, with optional metadata filter
+         * @param ids
+         * @param metadata_filter
+         * @return
+         */
+        static SearchQuery make_candidates_filter(const std::vector<std::string>& ids, const SearchQuery& metadata_filter) {
+            SearchQuery id_query;
+            id_query.mutable_terms()->set_name("id");
+            for (const auto& id: ids) {
+                id_query.mutable_terms()->add_terms()->set_string_value(id);
+            }
+            if (metadata_filter.query_case() == SearchQuery::QUERY_NOT_SET) {
+                return id_query;
             }
-            return select_sql + ");";
+            SearchQuery query;
+            query.mutable_bool_()->add_must()->CopyFrom(id_query);
+            query.mutable_bool_()->add_must()->CopyFrom(metadata_filter);
+            return query;
+        }
+
+        /**
+         * make sql to fetch documents of candidates recalled by index, with optional metadata filter applied as post-check
+         * @param table_name
+         * @param metadata_schema
+         * @param ids
+         * @param metadata_filter
+         * @return
+         */
+        static std::string make_select_candidates_sql(
+            const std::string& table_name,
+            const std::shared_ptr<MetadataSchema>& metadata_schema,
+            const std::vector<std::string>& ids,
+            const SearchQuery& metadata_filter
+        ) {
+            assert_non_empty_range(ids, "ID list cannot be empty");
+            std::string column_list = "id, text";
+            auto name_view = metadata_schema->fields() | std::views::transform(
+                                 [](const MetadataFieldSchema& field)-> std::string {
+                                     return field.name();
+                                 });
+            column_list += name_view.empty() ? ""  : ", " + StringUtils::JoinWith(name_view, ", ");
+            return SQLBuilder::ToSelectString(table_name, column_list, make_candidates_filter(ids, metadata_filter));
         }
 
         static std::string make_prepared_count_sql(const std::string& table_name) {
@@ -141,61 +284,168 @@ namespace INSTINCT_RETRIEVAL_NS {
             return create_table_sql;
         }
 
-        static std::string make_delete_sql(const std::string& table_name, const std::vector<std::string>& ids) {
-            assert_non_empty_range(ids, "ids should not be empty");
-            std::string delete_sql = "DELETE FROM " + table_name + " WHERE id IN (";
-            // delete_sql += StringUtils::JoinWith(ids, ", ");
-
-            for (int i = 0; i < ids.size(); ++i) {
-                delete_sql += "'";
-                delete_sql += ids[i];
-                delete_sql += "'";
-                if (i < ids.size()-1) {
-                    delete_sql += ",";
+        /**
+         * make sql to delete documents with ids in list bound to its only parameter
+         * @param table_name
+         * @return
+         */
+        static std::string make_delete_sql(const std::string& table_name) {
+            return "DELETE FROM " + table_name + " WHERE id IN (SELECT UNNEST(?::UUID[]));";
+        }
+
+
+        /**
+         * Format 128 bits as UUID string in canonical form, i.e. `xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx`
+         */
+        static void format_uuid(const uint64_t high, const uint64_t low, char* buf) {
+            static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+            size_t pos = 0;
+            for (int i = 0; i < 32; ++i) {
+                if (i == 8 || i == 12 || i == 16 || i == 20) {
+                    buf[pos++] = '-';
                 }
+                const uint64_t word = i < 16 ? high : low;
+                buf[pos++] = HEX_DIGITS[(word >> (60 - 4 * (i % 16))) & 0xF];
             }
-            delete_sql += ");";
-            return delete_sql;
         }
 
+        /**
+         * Generate 128 random bits of a UUID of version 4 and variant 1
+         */
+        static void generate_row_id_bits(uint64_t& high, uint64_t& low) {
+            thread_local std::mt19937_64 gen {std::random_device {}()};
+            high = (gen() & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+            low = (gen() & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+        }
 
-        static void observe_query_result(QueryResult& query_result, const std::shared_ptr<MetadataSchema>& metadata_schema_, const auto& observer) {
-            int count = 0;
-            for (const auto& row: query_result) {
+        /**
+         * Generate a random UUID string of version 4. It's much cheaper than `StringUtils::GenerateUUIDString` which may go through system calls for every id, and it's sufficient for row ids as they are never used for security purpose.
+         */
+        static std::string generate_row_id() {
+            uint64_t high, low;
+            generate_row_id_bits(high, low);
+            std::string id(36, '-');
+            format_uuid(high, low, id.data());
+            return id;
+        }
+
+        /**
+         * Mapping from columns of query result to fields of `Document`, which is computed once for a result. Columns are matched by name, so that unrelated columns, like `vector` in `SELECT *` or `similarity` in vector search, are skipped.
+         */
+        struct DocumentColumnMapping {
+            std::optional<idx_t> id_column;
+            std::optional<idx_t> text_column;
+            // pairs of column index and index of field in metadata schema
+            std::vector<std::pair<idx_t, int>> metadata_columns;
+        };
+
+        static DocumentColumnMapping make_document_column_mapping(const QueryResult& query_result, const MetadataSchemaPtr& metadata_schema) {
+            DocumentColumnMapping mapping;
+            std::unordered_map<std::string, idx_t> column_indices;
+            for (idx_t i = 0; i < query_result.names.size(); ++i) {
+                column_indices.emplace(query_result.names[i], i);
+            }
+            if (const auto itr = column_indices.find("id"); itr != column_indices.end()) {
+                mapping.id_column = itr->second;
+            }
+            if (const auto itr = column_indices.find("text"); itr != column_indices.end()) {
+                mapping.text_column = itr->second;
+            }
+            for (int i = 0; i < metadata_schema->fields_size(); ++i) {
+                const auto& field_schema = metadata_schema->fields(i);
+                const auto itr = column_indices.find(field_schema.name());
+                assert_true(itr != column_indices.end(), "should have column for metadata field named " + field_schema.name());
+                mapping.metadata_columns.emplace_back(itr->second, i);
+            }
+            return mapping;
+        }
+
+        static std::string_view get_string_view(const Vector& vector, const idx_t row) {
+            const auto& str = FlatVector::GetData<string_t>(vector)[row];
+            return {str.GetData(), str.GetSize()};
+        }
+
+        /**
+         * Convert rows in a chunk to documents. Values are read from flat vectors directly, rather than through `duckdb::Value` for each cell.
+         */
+        static void conv_data_chunk_to_documents(
+            DataChunk& chunk,
+            const DocumentColumnMapping& mapping,
+            const MetadataSchemaPtr& metadata_schema,
+            const std::function<void(Document&&)>& consumer
+        ) {
+            chunk.Flatten();
+            const idx_t row_count = chunk.size();
+            for (idx_t row = 0; row < row_count; ++row) {
                 Document document;
-                document.set_id(row.GetValue<std::string>(0));
-                document.set_text(row.GetValue<std::string>(1));
-                for (int i = 0; i < metadata_schema_->fields_size(); i++) {
-                    // plus 2 means skipping first two columns of  id and text in table
-                    int column_idx = i + 2;
-                    auto& field_schema = metadata_schema_->fields(i);
+                if (mapping.id_column) {
+                    const auto& id_vector = chunk.data[mapping.id_column.value()];
+                    if (id_vector.GetType().id() == LogicalTypeId::UUID) {
+                        const auto& uuid = FlatVector::GetData<hugeint_t>(id_vector)[row];
+                        // DuckDB flips the most significant bit of UUID to keep order when it's stored as signed integer
+                        char buf[36];
+                        format_uuid(static_cast<uint64_t>(uuid.upper) ^ (uint64_t {1} << 63), uuid.lower, buf);
+                        document.set_id(buf, sizeof(buf));
+                    } else if (id_vector.GetType().id() == LogicalTypeId::VARCHAR) {
+                        const auto id = get_string_view(id_vector, row);
+                        document.set_id(id.data(), id.size());
+                    } else {
+                        document.set_id(chunk.GetValue(mapping.id_column.value(), row).ToString());
+                    }
+                }
+                if (mapping.text_column) {
+                    const auto text = get_string_view(chunk.data[mapping.text_column.value()], row);
+                    document.set_text(text.data(), text.size());
+                }
+                for (const auto& [column_idx, field_idx]: mapping.metadata_columns) {
+                    const auto& field_schema = metadata_schema->fields(field_idx);
+                    const auto& vector = chunk.data[column_idx];
                     auto* metadata_field = document.add_metadata();
                     metadata_field->set_name(field_schema.name());
+                    if (!FlatVector::Validity(vector).RowIsValid(row)) {
+                        metadata_field->set_is_null(true);
+                        continue;
+                    }
                     switch (field_schema.type()) {
                         case INT32:
-                            metadata_field->set_int_value(row.GetValue<int32_t>(column_idx));
+                            metadata_field->set_int_value(FlatVector::GetData<int32_t>(vector)[row]);
                             break;
                         case INT64:
-                            metadata_field->set_long_value(row.GetValue<int64_t>(column_idx));
+                            metadata_field->set_long_value(FlatVector::GetData<int64_t>(vector)[row]);
                             break;
                         case FLOAT:
-                            metadata_field->set_float_value(row.GetValue<float>(column_idx));
+                            metadata_field->set_float_value(FlatVector::GetData<float>(vector)[row]);
                             break;
                         case DOUBLE:
-                            metadata_field->set_double_value(row.GetValue<double>(column_idx));
+                            metadata_field->set_double_value(FlatVector::GetData<double>(vector)[row]);
                             break;
-                        case VARCHAR:
-                            metadata_field->set_string_value(row.GetValue<std::string>(column_idx));
+                        case VARCHAR: {
+                            const auto value = get_string_view(vector, row);
+                            metadata_field->set_string_value(value.data(), value.size());
                             break;
+                        }
                         case BOOL:
-                            metadata_field->set_bool_value(row.GetValue<bool>(column_idx));
+                            metadata_field->set_bool_value(FlatVector::GetData<bool>(vector)[row]);
                             break;
                         default:
                             throw InstinctException("unknown field type for field named " + field_schema.name());
                     }
                 }
-                count++;
-                observer.on_next(document);
+                consumer(std::move(document));
+            }
+        }
+
+        static void observe_query_result(QueryResult& query_result, const std::shared_ptr<MetadataSchema>& metadata_schema_, const auto& observer) {
+            const auto mapping = make_document_column_mapping(query_result, metadata_schema_);
+            size_t count = 0;
+            while (const auto chunk = query_result.Fetch()) {
+                if (chunk->size() == 0) {
+                    break;
+                }
+                count += chunk->size();
+                conv_data_chunk_to_documents(*chunk, mapping, metadata_schema_, [&](Document&& document) {
+                    observer.on_next(std::move(document));
+                });
             }
             LOG_DEBUG("{} docs recalled", count);
             observer.on_completed();
@@ -217,59 +467,106 @@ namespace INSTINCT_RETRIEVAL_NS {
             });
         }
 
+        /**
+         * Convert value for binding to placeholder in prepared statement
+         * @param value
+         * @return
+         */
+        static duckdb::Value conv_primitive_value_to_duckdb_value(const PrimitiveValue& value) {
+            if (value.is_null()) {
+                return {};
+            }
+            switch (value.kind_case()) {
+                case PrimitiveValue::kIntValue:
+                    return duckdb::Value::INTEGER(value.int_value());
+                case PrimitiveValue::kLongValue:
+                    return duckdb::Value::BIGINT(value.long_value());
+                case PrimitiveValue::kFloatValue:
+                    return duckdb::Value::FLOAT(value.float_value());
+                case PrimitiveValue::kDoubleValue:
+                    return duckdb::Value::DOUBLE(value.double_value());
+                case PrimitiveValue::kBoolValue:
+                    return duckdb::Value::BOOLEAN(value.bool_value());
+                case PrimitiveValue::kStringValue:
+                    return duckdb::Value {value.string_value()};
+                case PrimitiveValue::kBytesValue:
+                    return duckdb::Value::BLOB(reinterpret_cast<const_data_ptr_t>(value.bytes_value().data()), value.bytes_value().size());
+                default:
+                    return {};
+            }
+        }
+
+        /**
+         * Positions of metadata fields in table, which are computed once for a schema rather than for each row during appending.
+         */
+        struct MetadataColumnPlan {
+            MetadataSchemaPtr metadata_schema;
+            std::unordered_map<std::string, int> field_positions;
+        };
+
+        static MetadataColumnPlan make_metadata_column_plan(const MetadataSchemaPtr& metadata_schema) {
+            MetadataColumnPlan plan {.metadata_schema = metadata_schema};
+            if (!metadata_schema || metadata_schema == EMPTY_METADATA_SCHEMA) {
+                return plan;
+            }
+            for (int i = 0; i < metadata_schema->fields_size(); ++i) {
+                plan.field_positions.emplace(metadata_schema->fields(i).name(), i);
+            }
+            return plan;
+        }
+
         static void append_row_basic_fields(
             Appender& appender,
             Document& doc,
             UpdateResult& update_result
         ) {
             // column of id
-            const std::string new_id = StringUtils::GenerateUUIDString();
+            const std::string new_id = generate_row_id();
             update_result.add_returned_ids(new_id);
             doc.set_id(new_id);
-            appender.Append<>(new_id.c_str());
+            appender.Append(string_t {new_id.data(), static_cast<uint32_t>(new_id.size())});
 
             // column of text
-            appender.Append<>(doc.text().c_str());
+            appender.Append(string_t {doc.text().data(), static_cast<uint32_t>(doc.text().size())});
         }
 
-        static void append_row_metadata_fields(
-            const std::shared_ptr<MetadataSchema>& metadata_schema,
-            Appender& appender,
+        /**
+         * Find index of metadata in doc for each metadata column. It should be called before row is begun, so that invalid doc is rejected without leaving a partial row in appender.
+         */
+        static std::vector<int> resolve_metadata_indices(
+            const MetadataColumnPlan& plan,
             const Document& doc,
             const bool bypass_unknown_fields
         ) {
-            if (!metadata_schema || metadata_schema == EMPTY_METADATA_SCHEMA || metadata_schema->fields_size() == 0) {
-                return;
+            std::vector<int> metadata_indices(plan.field_positions.size(), -1);
+            for (int i = 0; i < doc.metadata_size(); i++) {
+                const auto& name = doc.metadata(i).name();
+                if (const auto itr = plan.field_positions.find(name); itr != plan.field_positions.end()) {
+                    metadata_indices[itr->second] = i;
+                } else if (!bypass_unknown_fields) {
+                    throw InstinctException("Metadata cannot contain field not defined by schema. Problematic field is " + name);
+                }
             }
 
-            // handle rows defined in metadata_schema
-            auto name_view = metadata_schema->fields() | std::views::transform(
-                                 [](const MetadataFieldSchema& field)-> std::string {
-                                     return field.name();
-                                 });
-            std::unordered_set<std::string> known_field_names{name_view.begin(), name_view.end()};
-
-            const int metadata_size = doc.metadata_size();
-            auto defined_field_schema_map = DocumentUtils::ConvertToMetadataSchemaMap(metadata_schema);
-            std::unordered_map<std::string, int> metadata_field_name_index_map;
-
-            for (int i = 0; i < metadata_size; i++) {
-                auto name = doc.metadata(i).name();
-                metadata_field_name_index_map[name] = i;
-                if (!bypass_unknown_fields) {
-                    assert_true((known_field_names.contains(name)),
-                                "Metadata cannot contain field not defined by schema. Problematic field is " + name);
+            if (std::ranges::find(metadata_indices, -1) != metadata_indices.end()) {
+                std::vector<std::string> missing_field_names;
+                for (size_t i = 0; i < metadata_indices.size(); ++i) {
+                    if (metadata_indices[i] == -1) {
+                        missing_field_names.push_back(plan.metadata_schema->fields(static_cast<int>(i)).name());
+                    }
                 }
-                known_field_names.erase(name);
+                throw InstinctException("Some metadata fields not set: " + StringUtils::JoinWith(missing_field_names, ","));
             }
+            return metadata_indices;
+        }
 
-            assert_true(known_field_names.empty(),
-                        "Some metadata fields not set: " + StringUtils::JoinWith(known_field_names, ","));
-
-
+        static void append_row_metadata_fields(
+            Appender& appender,
+            const Document& doc,
+            const std::vector<int>& metadata_indices
+        ) {
             // append columns according to the order in metadata schema, or DuckDB will complain with SQL errors.
-            for (const auto& metadata_field_schema: metadata_schema->fields()) {
-                const int i = metadata_field_name_index_map[metadata_field_schema.name()];
+            for (const int i: metadata_indices) {
                 if (const auto& value = doc.metadata(i); value.is_null()) {
                     appender.Append(nullptr);
                 } else {
@@ -289,21 +586,95 @@ namespace INSTINCT_RETRIEVAL_NS {
                         appender.Append<int64_t>(value.long_value());
                     }
                     if (value.has_string_value()) {
-                        appender.Append(value.string_value().c_str());
+                        appender.Append(string_t {value.string_value().data(), static_cast<uint32_t>(value.string_value().size())});
                     }
                 }
             }
         }
+
+        /**
+         * Merge result of a committed chunk into overall result
+         */
+        static void merge_update_result(const UpdateResult& chunk_result, UpdateResult& update_result) {
+            update_result.set_affected_rows(update_result.affected_rows() + chunk_result.affected_rows());
+            update_result.mutable_returned_ids()->MergeFrom(chunk_result.returned_ids());
+            update_result.mutable_failed_documents()->MergeFrom(chunk_result.failed_documents());
+        }
+
+        /**
+         * Get counter of writes to a table, which is shared by all store instances opened on the same table of the same DuckDB instance in this process. A DuckDB database file can be opened for writing by only one process, so in-memory structures can check their freshness with this counter instead of querying tables.
+         * @param db
+         * @param table_name
+         * @param scope Name of structures tracked by counter, e.g. `rows` for keyword index bumped by every write of `BaseDuckDBStore`, and `vectors` for vector index and quantizer bumped by `DuckDBVectorStore`
+         * @return
+         */
+        inline std::shared_ptr<std::atomic<int64_t>> get_table_write_counter(const DuckDBPtr& db, const std::string& table_name, const std::string& scope) {
+            static std::mutex mutex;
+            static std::map<std::tuple<const DuckDB*, std::string, std::string>, std::weak_ptr<std::atomic<int64_t>>> counters;
+            std::lock_guard guard {mutex};
+            std::erase_if(counters, [](const auto& entry) { return entry.second.expired(); });
+            auto& entry = counters[{db.get(), table_name, scope}];
+            if (auto counter = entry.lock()) {
+                return counter;
+            }
+            auto counter = std::make_shared<std::atomic<int64_t>>(0);
+            entry = counter;
+            return counter;
+        }
     }
 
 
 
+    /**
+     * Connection borrowed from pool, which is released back to pool when lease goes out of scope. Results of streaming queries should be consumed before that.
+     */
+    class ConnectionLease final {
+        DuckDBConnectionPoolPtr pool_;
+        DuckDBConnectionPtr connection_;
+    public:
+        explicit ConnectionLease(DuckDBConnectionPoolPtr pool)
+            : pool_(std::move(pool)), connection_(pool_->Acquire()) {
+        }
+
+        ~ConnectionLease() {
+            pool_->Release(connection_);
+        }
+
+        ConnectionLease(const ConnectionLease&) = delete;
+        ConnectionLease(ConnectionLease&&) = delete;
+
+        Connection* operator->() const {
+            return &connection_->GetImpl();
+        }
+
+        Connection& operator*() const {
+            return connection_->GetImpl();
+        }
+
+        [[nodiscard]] const std::string& GetId() const {
+            return connection_->GetId();
+        }
+    };
+
+    /**
+     * Base class of DuckDB stores. Writes are executed with a dedicated connection for each call, and reads are executed with connections leased from a pool sharing the same DuckDB instance, so that concurrent readers are not serialized on lock of a single connection.
+     */
     class BaseDuckDBStore : public virtual IDocStore {
         DuckDBStoreOptions options_;
         DuckDBPtr db_;
         std::shared_ptr<MetadataSchema> metadata_schema_;
-        unique_ptr<PreparedStatement> prepared_count_all_statement_;
+        details::MetadataColumnPlan metadata_column_plan_;
         Connection connection_;
+        DuckDBConnectionPoolPtr connection_pool_;
+        LRUCache<std::string, std::shared_ptr<PreparedStatement>> prepared_statements_;
+        std::string count_sql_;
+        std::shared_ptr<std::atomic<int64_t>> write_counter_;
+        KeywordIndexPtr keyword_index_;
+        /**
+         * Value of `write_counter_` that keyword index reflects. Index is stale if they differ, which means table is written by another store instance.
+         */
+        int64_t keyword_index_version_ = 0;
+        std::mutex keyword_index_mutex_;
 
     public:
         explicit BaseDuckDBStore(
@@ -313,11 +684,16 @@ namespace INSTINCT_RETRIEVAL_NS {
         ): options_(options),
            db_(std::move(db)),
            metadata_schema_(metadata_schema),
-            connection_(*db_)
+           metadata_column_plan_(details::make_metadata_column_plan(metadata_schema)),
+           connection_(*db_),
+           prepared_statements_(options.prepared_statement_cache_size * std::max(options.connection_pool.initial_connection_count, 1)),
+           count_sql_(details::make_prepared_count_sql(options.table_name)),
+           write_counter_(details::get_table_write_counter(db_, options.table_name, "rows"))
         {
             assert_true(metadata_schema, "should provide schema");
             assert_lt(options_.dimension, 10000, "dimension should be less than 10000");
             assert_true(!StringUtils::IsBlankString(options_.table_name), "table_name cannot be blank");
+            assert_positive(options_.connection_pool.initial_connection_count, "connection_pool.initial_connection_count should be positive");
 
             const auto sql = details::make_create_table_sql(options_.table_name, options_.dimension, metadata_schema_, options_.create_or_replace_table);
             LOG_DEBUG("create document table with SQL if necessary: {}", sql);
@@ -325,12 +701,19 @@ namespace INSTINCT_RETRIEVAL_NS {
                 const auto create_table_result = connection_.Query(sql);
                 assert_query_ok(create_table_result);
             }
-            prepared_count_all_statement_ = connection_.Prepare(details::make_prepared_count_sql(options_.table_name));
-            assert_prepared_ok(prepared_count_all_statement_, "Failed to prepare count statement");
+            connection_pool_ = options_.shared_connection_pool ? options_.shared_connection_pool : CreateDuckDBConnectionPool(db_, options_.connection_pool);
+
+            if (options_.keyword_index.enabled) {
+                std::unique_lock lock(keyword_index_mutex_);
+                LoadKeywordIndex_();
+            }
         }
 
         bool Destroy() override {
             const auto result = connection_.Query(fmt::format("drop table {};", options_.table_name));
+            OnTableWritten_([](KeywordIndex& index) {
+                index.Clear();
+            });
             return check_query_ok(result);
         }
 
@@ -346,10 +729,37 @@ namespace INSTINCT_RETRIEVAL_NS {
             return metadata_schema_;
         }
 
+        [[nodiscard]] const details::MetadataColumnPlan& GetMetadataColumnPlan() const {
+            return metadata_column_plan_;
+        }
+
         Connection& GetConnection() {
             return connection_;
         }
 
+        /**
+         * Borrow a connection from pool for read operations
+         */
+        ConnectionLease LeaseConnection() const {
+            return ConnectionLease {connection_pool_};
+        }
+
+        /**
+         * Get prepared statement of given sql for leased connection from cache, or prepare a new one if it's missing. Prepared statements are bound to connection, so they are cached for each pooled connection.
+         */
+        std::shared_ptr<PreparedStatement> GetPreparedStatement(const ConnectionLease& lease, const std::string& sql) {
+            const auto key = lease.GetId() + "\n" + sql;
+            if (auto statement = prepared_statements_.Get(key)) {
+                return statement.value();
+            }
+            LOG_DEBUG("prepare sql for connection {}: {}", lease.GetId(), sql);
+            auto prepared_statement = lease->Prepare(sql);
+            assert_prepared_ok(prepared_statement, "Failed to prepare statement");
+            const std::shared_ptr<PreparedStatement> statement {prepared_statement.release()};
+            prepared_statements_.Put(key, statement);
+            return statement;
+        }
+
         [[nodiscard]] Connection MakeConnection() const {
             return std::move(Connection(*db_));
         }
@@ -357,7 +767,8 @@ namespace INSTINCT_RETRIEVAL_NS {
         AsyncIterator<Document> FindDocuments(const FindRequest &find_request) override {
             const auto sql = SQLBuilder::ToSelectString(options_.table_name, "*", find_request.query(), find_request.sorters());
             LOG_DEBUG("FindDocuments with sql: {}", sql);
-            auto result = GetConnection().Query(sql);
+            const auto lease = LeaseConnection();
+            auto result = lease->Query(sql);
             assert_query_ok(result);
             return details::conv_query_result_to_iterator(std::move(result), metadata_schema_);
         }
@@ -367,13 +778,31 @@ namespace INSTINCT_RETRIEVAL_NS {
                 return rpp::source::empty<Document>();
             }
 
-            auto result = GetConnection().Query(details::make_mget_sql(options_.table_name, metadata_schema_, ids));
-            assert_query_ok(result);
-            return details::conv_query_result_to_iterator(std::move(result), metadata_schema_);
+            const auto chunk_size = std::max<size_t>(options_.max_ids_per_statement, 1);
+            const auto lease = LeaseConnection();
+            const auto statement = GetPreparedStatement(lease, details::make_mget_sql(options_.table_name, metadata_schema_));
+            if (ids.size() <= chunk_size) {
+                vector<Value> values {details::make_id_list_value(ids, 0, ids.size())};
+                auto result = statement->Execute(values, false);
+                assert_query_ok(result);
+                return details::conv_query_result_to_iterator(std::move(result), metadata_schema_);
+            }
+
+            std::vector<Document> docs;
+            for (size_t offset = 0; offset < ids.size(); offset += chunk_size) {
+                vector<Value> values {details::make_id_list_value(ids, offset, std::min(chunk_size, ids.size() - offset))};
+                auto result = statement->Execute(values, false);
+                assert_query_ok(result);
+                for (auto& doc: CollectVector(details::conv_query_result_to_iterator(std::move(result), metadata_schema_))) {
+                    docs.push_back(std::move(doc));
+                }
+            }
+            return rpp::source::from_iterable(std::move(docs));
         }
 
         size_t CountDocuments() override {
-            const auto result = prepared_count_all_statement_->Execute();
+            const auto lease = LeaseConnection();
+            const auto result = GetPreparedStatement(lease, count_sql_)->Execute();
             assert_query_ok(result);
             for (const auto& row: *result) {
                 return row.GetValue<uint32_t>(0);
@@ -381,10 +810,41 @@ namespace INSTINCT_RETRIEVAL_NS {
             throw InstinctException("Empty count result");
         }
 
+        /**
+         * Add documents in chunks of `ingestion.chunk_size` as they are emitted by iterator. Each chunk is committed in its own transaction, so chunks committed before an error are kept.
+         */
         void AddDocuments(const AsyncIterator<Document>& documents_iterator, UpdateResult& update_result) override {
-            std::vector<Document> docs;
-            CollectVector(documents_iterator, docs);
-            AddDocuments(docs, update_result);
+            const auto chunk_size = options_.ingestion.chunk_size;
+            if (chunk_size == 0) {
+                std::vector<Document> docs;
+                CollectVector(documents_iterator, docs);
+                AddDocuments(docs, update_result);
+                return;
+            }
+
+            const long t1 = ChronoUtils::GetCurrentTimeMillis();
+            IngestionProgress progress;
+            documents_iterator
+                | rpp::operators::as_blocking()
+                | rpp::operators::buffer(chunk_size)
+                | rpp::operators::subscribe(
+                    // buffer is emitted as rvalue, so it's moved into `chunk` rather than copied
+                    [&](std::vector<Document> chunk) {
+                        UpdateResult chunk_result;
+                        AddDocuments(chunk, chunk_result);
+                        details::merge_update_result(chunk_result, update_result);
+                        progress.chunk_count++;
+                        progress.row_count += chunk_result.affected_rows();
+                        progress.failed_count += chunk_result.failed_documents_size();
+                        progress.elapsed_ms = ChronoUtils::GetCurrentTimeMillis() - t1;
+                        LOG_DEBUG("Chunk committed to table {}, chunks={}, rows={}, failed={}, rt={}ms", options_.table_name, progress.chunk_count, progress.row_count, progress.failed_count, progress.elapsed_ms);
+                        if (options_.ingestion.on_progress) {
+                            options_.ingestion.on_progress(progress);
+                        }
+                    },
+                    [](const std::exception_ptr& err) { if (err) std::rethrow_exception(err); }
+                );
+            LOG_INFO("Documents added to table {}, chunks={}, rows={}, failed={}, rt={}ms", options_.table_name, progress.chunk_count, progress.row_count, progress.failed_count, ChronoUtils::GetCurrentTimeMillis() - t1);
         }
 
         virtual void AppendRows(Appender& appender, std::vector<Document>& records, UpdateResult& update_result) = 0;
@@ -405,6 +865,17 @@ namespace INSTINCT_RETRIEVAL_NS {
                 connection.Rollback();
                 std::rethrow_exception(std::current_exception());
             }
+            OnTableWritten_([&](KeywordIndex& index) {
+                std::unordered_set<std::string> failed_ids;
+                for (const auto& failed_doc: update_result.failed_documents()) {
+                    failed_ids.insert(failed_doc.id());
+                }
+                for (const auto& record: records) {
+                    if (!record.id().empty() && !failed_ids.contains(record.id())) {
+                        index.Add(record.id(), record.text());
+                    }
+                }
+            });
         }
 
         virtual void AppendRow(Appender& appender, Document& doc, UpdateResult& update_result) = 0;
@@ -429,28 +900,178 @@ namespace INSTINCT_RETRIEVAL_NS {
                 connection.Rollback();
                 std::rethrow_exception(std::current_exception());
             }
-
+            OnTableWritten_([&](KeywordIndex& index) {
+                index.Add(doc.id(), doc.text());
+            });
         }
 
+        /**
+         * Delete documents by ids, which are bound as list parameters in chunks of `max_ids_per_statement`. All chunks are deleted in one transaction.
+         */
         void DeleteDocuments(const std::vector<std::string>& ids, UpdateResult& update_result) override {
+            assert_non_empty_range(ids, "ids should not be empty");
+            const auto chunk_size = std::max<size_t>(options_.max_ids_per_statement, 1);
             auto connection = MakeConnection();
-            const auto sql = details::make_delete_sql(options_.table_name, ids);
-            LOG_DEBUG("DeleteDocuments with sql: {}", sql);
-            const auto result = connection.Query(sql);
-            assert_query_ok(result);
-            const auto xn = result->GetValue<int32_t>(0, 0);
-            update_result.set_affected_rows(xn);
+            const auto sql = details::make_delete_sql(options_.table_name);
+            LOG_DEBUG("DeleteDocuments with sql: {}, ids.size()={}", sql, ids.size());
+            const auto statement = connection.Prepare(sql);
+            assert_prepared_ok(statement, "Failed to prepare delete statement");
+            int64_t xn = 0;
+            connection.BeginTransaction();
+            try {
+                for (size_t offset = 0; offset < ids.size(); offset += chunk_size) {
+                    vector<Value> values {details::make_id_list_value(ids, offset, std::min(chunk_size, ids.size() - offset))};
+                    const auto result = statement->Execute(values, false);
+                    assert_query_ok(result);
+                    const auto chunk = result->Fetch();
+                    xn += chunk->GetValue(0, 0).GetValue<int64_t>();
+                }
+                connection.Commit();
+            } catch (...) {
+                connection.Rollback();
+                std::rethrow_exception(std::current_exception());
+            }
+            update_result.set_affected_rows(static_cast<int32_t>(xn));
             update_result.mutable_returned_ids()->Add(ids.begin(), ids.end());
+            OnTableWritten_([&](KeywordIndex& index) {
+                for (const auto& id: ids) {
+                    index.Remove(id);
+                }
+            });
         }
 
+        /**
+         * Delete documents matching filter with a single parameterized statement, which returns ids of deleted rows in `update_result`.
+         */
         void DeleteDocuments(const SearchQuery &filter, UpdateResult &update_result) override {
             auto connection = MakeConnection();
-            const auto sql = SQLBuilder::ToDeleteString(options_.table_name, filter);
+            SQLParameters parameters;
+            const auto sql = SQLBuilder::ToParameterizedDeleteString(options_.table_name, filter, parameters, "id");
             LOG_DEBUG("DeleteDocuments with sql: {}", sql);
-            const auto result = connection.Query(sql);
+            const auto statement = connection.Prepare(sql);
+            assert_prepared_ok(statement, "Failed to prepare delete statement");
+            vector<Value> values;
+            for (const auto& parameter: parameters) {
+                values.push_back(details::conv_primitive_value_to_duckdb_value(parameter));
+            }
+            const auto result = statement->Execute(values, false);
             assert_query_ok(result);
-            const auto xn = result->GetValue<int32_t>(0, 0);
-            update_result.set_affected_rows(xn);
+            std::vector<std::string> ids;
+            while (const auto chunk = result->Fetch()) {
+                if (chunk->size() == 0) {
+                    break;
+                }
+                for (idx_t i = 0; i < chunk->size(); ++i) {
+                    ids.push_back(chunk->GetValue(0, i).ToString());
+                }
+            }
+            update_result.set_affected_rows(static_cast<int32_t>(ids.size()));
+            update_result.mutable_returned_ids()->Add(ids.begin(), ids.end());
+            OnTableWritten_([&](KeywordIndex& index) {
+                for (const auto& id: ids) {
+                    index.Remove(id);
+                }
+            });
+        }
+
+        /**
+         * Search with BM25 keyword index. Candidates are fetched from table with metadata filter applied as post-check, and more candidates are recalled until enough documents pass the filter or index is exhausted.
+         */
+        AsyncIterator<Document> SearchDocumentsByKeywords(const SearchRequest& request) override {
+            assert_true(options_.keyword_index.enabled, fmt::format("keyword index is not enabled for table {}", options_.table_name));
+            const int limit = request.top_k() > 0 ? std::min(request.top_k(), 10000) : 10;
+            const long t1 = ChronoUtils::GetCurrentTimeMillis();
+            const auto index = GetFreshKeywordIndex_();
+            const bool has_filter = request.has_metadata_filter() && request.metadata_filter().query_case() != SearchQuery::QUERY_NOT_SET;
+            size_t candidate_count = has_filter ? limit * std::max<size_t>(options_.keyword_index.filter_overfetch_factor, 1) : limit;
+
+            std::vector<Document> docs;
+            while (true) {
+                const auto candidates = index->Search(request.query(), candidate_count);
+                if (candidates.empty()) {
+                    break;
+                }
+                std::unordered_map<std::string, size_t> ranks;
+                std::vector<std::string> ids;
+                ids.reserve(candidates.size());
+                for (size_t i = 0; i < candidates.size(); ++i) {
+                    ranks[candidates[i].first] = i;
+                    ids.push_back(candidates[i].first);
+                }
+                const auto lease = LeaseConnection();
+                auto result = lease->Query(details::make_select_candidates_sql(
+                    options_.table_name,
+                    metadata_schema_,
+                    ids,
+                    has_filter ? request.metadata_filter() : SearchQuery {}));
+                assert_query_ok(result);
+                docs = CollectVector(details::conv_query_result_to_iterator(std::move(result), metadata_schema_));
+                std::ranges::sort(docs, [&](const Document& a, const Document& b) {
+                    return ranks.at(a.id()) < ranks.at(b.id());
+                });
+                // index is exhausted if it returns fewer candidates than requested, so partial result is final.
+                if (docs.size() >= static_cast<size_t>(limit) || candidates.size() < candidate_count) {
+                    break;
+                }
+                candidate_count *= 4;
+            }
+            if (docs.size() > static_cast<size_t>(limit)) {
+                docs.resize(limit);
+            }
+            LOG_DEBUG("Keyword search done, query={}, returned={}, rt={}ms", request.query(), docs.size(), ChronoUtils::GetCurrentTimeMillis()-t1);
+            return rpp::source::from_iterable(std::move(docs));
+        }
+
+    private:
+        /**
+         * Bump write counter of table after a committed write, and apply the write to keyword index with `update` if index reflects all previous writes. Otherwise, index is left stale and reloaded by next keyword search.
+         */
+        template<typename Fn>
+        void OnTableWritten_(Fn&& update) {
+            if (!options_.keyword_index.enabled) {
+                ++*write_counter_;
+                return;
+            }
+            std::unique_lock lock(keyword_index_mutex_);
+            const auto version = ++*write_counter_;
+            if (keyword_index_version_ == version - 1) {
+                update(*keyword_index_);
+                keyword_index_version_ = version;
+            }
+        }
+
+        /**
+         * Rebuild keyword index from `text` column. Caller should hold `keyword_index_mutex_`.
+         */
+        void LoadKeywordIndex_() {
+            keyword_index_version_ = write_counter_->load();
+            const auto index = std::make_shared<KeywordIndex>(options_.keyword_index);
+            // streaming result is consumed before lease is released
+            const auto lease = LeaseConnection();
+            auto result = lease->SendQuery(fmt::format("SELECT id, text FROM {};", options_.table_name));
+            assert_query_ok(result);
+            while (auto chunk = result->Fetch()) {
+                if (chunk->size() == 0) {
+                    break;
+                }
+                for (idx_t i = 0; i < chunk->size(); ++i) {
+                    index->Add(chunk->GetValue(0, i).ToString(), chunk->GetValue(1, i).GetValue<std::string>());
+                }
+            }
+            LOG_INFO("Keyword index for table {} is built with {} documents", options_.table_name, index->Size());
+            keyword_index_ = index;
+        }
+
+        /**
+         * Reload keyword index if table is written by another store instance opened on the same table since index is built.
+         */
+        KeywordIndexPtr GetFreshKeywordIndex_() {
+            std::unique_lock lock(keyword_index_mutex_);
+            if (write_counter_->load() != keyword_index_version_) {
+                LOG_INFO("Keyword index for table {} is stale, reloading", options_.table_name);
+                LoadKeywordIndex_();
+            }
+            return keyword_index_;
         }
     };
 }
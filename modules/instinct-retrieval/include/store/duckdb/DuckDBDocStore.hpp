@@ -22,19 +22,21 @@ namespace INSTINCT_RETRIEVAL_NS {
     namespace details {
 
         static void append_row(
-                const std::shared_ptr<MetadataSchema>& metadata_schema,
+                const MetadataColumnPlan& metadata_column_plan,
                 Appender& appender,
                 Document& doc,
                 UpdateResult& update_result,
                 const bool bypass_unknown_fields
         ) {
+            // validate metadata before any column is appended
+            const auto metadata_indices = resolve_metadata_indices(metadata_column_plan, doc, bypass_unknown_fields);
             appender.BeginRow();
 
             // basic fields
             append_row_basic_fields(appender, doc, update_result);
 
             // metadata fields
-            append_row_metadata_fields(metadata_schema, appender, doc, bypass_unknown_fields);
+            append_row_metadata_fields(appender, doc, metadata_indices);
 
             appender.EndRow();
         }
@@ -65,7 +67,7 @@ namespace INSTINCT_RETRIEVAL_NS {
             int affected_row = 0;
             for (auto & record : records) {
                 try {
-                    details::append_row(GetMetadataSchema(), appender, record, update_result, GetOptions().bypass_unknown_fields);
+                    details::append_row(GetMetadataColumnPlan(), appender, record, update_result, GetOptions().bypass_unknown_fields);
                     affected_row++;
                 } catch (const InstinctException& e) {
                     update_result.add_failed_documents()->CopyFrom(record);
@@ -77,7 +79,7 @@ namespace INSTINCT_RETRIEVAL_NS {
         }
 
         void AppendRow(Appender &appender, Document &doc, UpdateResult &update_result) override {
-            details::append_row(GetMetadataSchema(), appender, doc, update_result, GetOptions().bypass_unknown_fields);
+            details::append_row(GetMetadataColumnPlan(), appender, doc, update_result, GetOptions().bypass_unknown_fields);
         }
     };
 
@@ -5,6 +5,11 @@
 #ifndef BASEDUCKDBVECTORSTORE_HPP
 #define BASEDUCKDBVECTORSTORE_HPP
 
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+
 #include "BaseDuckDBStore.hpp"
 #include "RetrievalGlobals.hpp"
 #include "model/IEmbeddingModel.hpp"
@@ -14,39 +19,159 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     namespace details {
 
-        static void append_row(
-                const std::shared_ptr<MetadataSchema>& metadata_schema,
-                Appender& appender,
+        /**
+         * Write metadata value into flat vector of its column. Values of the same type as column are written directly, and others are cast like `Appender` does.
+         */
+        static void write_metadata_cell(Vector& column, const idx_t row, const PrimitiveValue& value) {
+            if (value.is_null()) {
+                FlatVector::SetNull(column, row, true);
+                return;
+            }
+            FlatVector::SetNull(column, row, false);
+            switch (column.GetType().id()) {
+                case LogicalTypeId::INTEGER:
+                    if (value.has_int_value()) {
+                        FlatVector::GetData<int32_t>(column)[row] = value.int_value();
+                        return;
+                    }
+                    break;
+                case LogicalTypeId::BIGINT:
+                    if (value.has_long_value()) {
+                        FlatVector::GetData<int64_t>(column)[row] = value.long_value();
+                        return;
+                    }
+                    break;
+                case LogicalTypeId::FLOAT:
+                    if (value.has_float_value()) {
+                        FlatVector::GetData<float>(column)[row] = value.float_value();
+                        return;
+                    }
+                    break;
+                case LogicalTypeId::DOUBLE:
+                    if (value.has_double_value()) {
+                        FlatVector::GetData<double>(column)[row] = value.double_value();
+                        return;
+                    }
+                    break;
+                case LogicalTypeId::BOOLEAN:
+                    if (value.has_bool_value()) {
+                        FlatVector::GetData<bool>(column)[row] = value.bool_value();
+                        return;
+                    }
+                    break;
+                case LogicalTypeId::VARCHAR:
+                    if (value.has_string_value()) {
+                        FlatVector::GetData<string_t>(column)[row] = StringVector::AddString(column, value.string_value());
+                        return;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            column.SetValue(row, conv_primitive_value_to_duckdb_value(value));
+        }
+
+        /**
+         * Writer of rows with embeddings, which fills typed column vectors of a `DataChunk` and hands full chunks to appender. Embedding is copied into child vector of ARRAY column with a single `memcpy`, instead of being boxed as a `duckdb::Value` for each component.
+         */
+        class EmbeddingRowChunkWriter {
+            static constexpr idx_t ID_COLUMN = 0;
+            static constexpr idx_t TEXT_COLUMN = 1;
+            static constexpr idx_t VECTOR_COLUMN = 2;
+            static constexpr idx_t METADATA_COLUMN_OFFSET = 3;
+
+            Appender& appender_;
+            DataChunk chunk_;
+            size_t dimension_;
+
+        public:
+            explicit EmbeddingRowChunkWriter(Appender& appender): appender_(appender) {
+                const auto& types = appender_.GetTypes();
+                assert_true(types.size() >= METADATA_COLUMN_OFFSET && types[VECTOR_COLUMN].id() == LogicalTypeId::ARRAY, "should have table with vector column");
+                dimension_ = ArrayType::GetSize(types[VECTOR_COLUMN]);
+                chunk_.Initialize(Allocator::DefaultAllocator(), types);
+            }
+
+            /**
+             * Write a row to chunk. Metadata and embedding are validated before any column is written, so that an invalid document is rejected alone.
+             */
+            void AppendRow(
+                const MetadataColumnPlan& metadata_column_plan,
                 Document& doc,
                 const Embedding& embedding,
                 UpdateResult& update_result,
                 const bool bypass_unknown_fields
-        ) {
-            appender.BeginRow();
+            ) {
+                const auto metadata_indices = resolve_metadata_indices(metadata_column_plan, doc, bypass_unknown_fields);
+                assert_true(embedding.size() == dimension_, fmt::format("should have embedding of dimension {}, but got {}", dimension_, embedding.size()));
+                assert_true(metadata_indices.size() + METADATA_COLUMN_OFFSET == chunk_.ColumnCount(), "should have metadata fields matching table columns");
+                const idx_t row = chunk_.size();
 
-            // basic fields
-            append_row_basic_fields(appender, doc, update_result);
+                // column of id
+                uint64_t high, low;
+                generate_row_id_bits(high, low);
+                std::string new_id(36, '-');
+                format_uuid(high, low, new_id.data());
+                // UUID is stored as hugeint with top bit flipped, so that it's ordered like its string form
+                hugeint_t& uuid = FlatVector::GetData<hugeint_t>(chunk_.data[ID_COLUMN])[row];
+                uuid.upper = static_cast<int64_t>(high ^ (uint64_t {1} << 63));
+                uuid.lower = low;
 
-            // column of vector
-            vector<duckdb::Value> vector_value;
-            for (const float& f: embedding) {
-                vector_value.push_back(duckdb::Value::FLOAT(f));
-            }
-            appender.Append(duckdb::Value::ARRAY(LogicalType::FLOAT, vector_value));
+                // column of text
+                auto& text_vector = chunk_.data[TEXT_COLUMN];
+                FlatVector::GetData<string_t>(text_vector)[row] = StringVector::AddString(text_vector, doc.text());
 
-            // metadata fields
-            append_row_metadata_fields(metadata_schema, appender, doc, bypass_unknown_fields);
+                // column of vector
+                auto& vector_child = ArrayVector::GetEntry(chunk_.data[VECTOR_COLUMN]);
+                std::memcpy(FlatVector::GetData<float>(vector_child) + row * dimension_, embedding.data(), dimension_ * sizeof(float));
 
-            appender.EndRow();
-        }
+                // metadata fields
+                for (size_t i = 0; i < metadata_indices.size(); ++i) {
+                    write_metadata_cell(chunk_.data[METADATA_COLUMN_OFFSET + i], row, doc.metadata(metadata_indices[i]));
+                }
+
+                chunk_.SetCardinality(row + 1);
+                update_result.add_returned_ids(new_id);
+                doc.set_id(new_id);
+                if (chunk_.size() == STANDARD_VECTOR_SIZE) {
+                    Flush();
+                }
+            }
+
+            /**
+             * Hand written rows to appender
+             */
+            void Flush() {
+                if (chunk_.size() == 0) {
+                    return;
+                }
+                appender_.AppendDataChunk(chunk_);
+                chunk_.Reset();
+            }
+        };
     }
 
 
     /**
-     * Specialized DocStore that will embed input documents
+     * Specialized DocStore that will embed input documents.
+     *
+     * Documents are added in a pipeline: they are split into micro-batches of `IngestionOptions::embedding_batch_size`, at most `IngestionOptions::max_in_flight_embedding_batches` of which are embedded concurrently, while the calling thread appends finished batches in order as the single writer. So appending doesn't wait for the whole input to be embedded, and embedding model is kept busy during appending.
      */
     class DuckDBDocWithEmbeddingStore final: public BaseDuckDBStore {
+        /**
+         * Micro-batch being embedded
+         */
+        struct EmbeddingBatch {
+            size_t offset;
+            size_t count;
+            std::future<std::vector<Embedding>> embeddings;
+        };
+
         EmbeddingsPtr embeddings_;
+        // created on first call to `AppendRows`, so that stores which are only searched, e.g. those cached by `DuckDBVectorStoreOperator`, hold no threads
+        std::once_flag embedding_thread_pool_flag_;
+        // declared last, so that pending embedding tasks are waited before other members are destroyed
+        std::unique_ptr<ThreadPool> embedding_thread_pool_;
     public:
         DuckDBDocWithEmbeddingStore(
             const DuckDBPtr& db,
@@ -54,35 +179,96 @@ namespace INSTINCT_RETRIEVAL_NS {
             const EmbeddingsPtr& embedding_model,
             const DuckDBStoreOptions &options
             )
-            : BaseDuckDBStore(db, metadata_schema, options), embeddings_(embedding_model) {
+            : BaseDuckDBStore(db, metadata_schema, options),
+              embeddings_(embedding_model) {
         }
 
         [[nodiscard]] EmbeddingsPtr GetEmbedding() const {
             return embeddings_;
         }
 
+        /**
+         * Embed and append records in a pipeline. If a micro-batch fails to be embedded, its records are reported as failed documents, and other micro-batches are not affected.
+         */
         void AppendRows(Appender &appender, std::vector<Document> &records, UpdateResult &update_result) override {
-            auto text_view = records | std::views::transform([](auto&& record) -> std::string {
-                return record.text();
+            const auto& ingestion = GetOptions().ingestion;
+            const size_t batch_size = ingestion.embedding_batch_size > 0 ? ingestion.embedding_batch_size : std::max<size_t>(records.size(), 1);
+            const size_t max_in_flight = std::max<size_t>(ingestion.max_in_flight_embedding_batches, 1);
+            const long t1 = ChronoUtils::GetCurrentTimeMillis();
+            std::call_once(embedding_thread_pool_flag_, [&] {
+                embedding_thread_pool_ = std::make_unique<ThreadPool>(max_in_flight);
             });
-            auto embeddings = embeddings_->EmbedDocuments({text_view.begin(), text_view.end()});
-            assert_equal_size(embeddings, records, "Count of result embeddings is not equal to that of records");
+
+            std::deque<EmbeddingBatch> in_flight;
+            size_t next_offset = 0;
+            details::EmbeddingRowChunkWriter writer {appender};
+            IngestionProgress progress;
             int affected_row = 0;
-            for (int i=0;i<records.size();i++) {
+            size_t failed_count = 0;
+            while (next_offset < records.size() || !in_flight.empty()) {
+                // keep at most `max_in_flight` batches being embedded
+                while (next_offset < records.size() && in_flight.size() < max_in_flight) {
+                    const size_t count = std::min(batch_size, records.size() - next_offset);
+                    std::vector<std::string> texts;
+                    texts.reserve(count);
+                    for (size_t i = next_offset; i < next_offset + count; ++i) {
+                        texts.push_back(records[i].text());
+                    }
+                    in_flight.push_back({
+                        .offset = next_offset,
+                        .count = count,
+                        .embeddings = embedding_thread_pool_->submit_task([embeddings = embeddings_, texts = std::move(texts)] {
+                            return embeddings->EmbedDocuments(texts);
+                        })
+                    });
+                    next_offset += count;
+                }
+
+                // append batches in order of input
+                auto batch = std::move(in_flight.front());
+                in_flight.pop_front();
+                std::vector<Embedding> embeddings;
+                bool embedded = true;
                 try {
-                    details::append_row(GetMetadataSchema(), appender, records[i], embeddings[i], update_result, GetOptions().bypass_unknown_fields);
-                    affected_row++;
-                } catch (const InstinctException& e) {
-                    update_result.add_failed_documents()->CopyFrom(records[i]);
-                    LOG_WARN("AppendRows error: {}", e.what());
+                    embeddings = batch.embeddings.get();
+                    assert_true(embeddings.size() == batch.count, "Count of result embeddings is not equal to that of records");
+                } catch (const std::exception& e) {
+                    LOG_WARN("Failed to embed batch of {} records at offset {}: {}", batch.count, batch.offset, e.what());
+                    embedded = false;
+                }
+                for (size_t i = 0; i < batch.count; ++i) {
+                    auto& record = records[batch.offset + i];
+                    if (!embedded) {
+                        update_result.add_failed_documents()->CopyFrom(record);
+                        failed_count++;
+                        continue;
+                    }
+                    try {
+                        writer.AppendRow(GetMetadataColumnPlan(), record, embeddings[i], update_result, GetOptions().bypass_unknown_fields);
+                        affected_row++;
+                    } catch (const InstinctException& e) {
+                        update_result.add_failed_documents()->CopyFrom(record);
+                        failed_count++;
+                        LOG_WARN("AppendRows error: {}", e.what());
+                    }
+                }
+                progress.chunk_count++;
+                progress.row_count = affected_row;
+                progress.failed_count = failed_count;
+                progress.elapsed_ms = ChronoUtils::GetCurrentTimeMillis() - t1;
+                if (ingestion.on_batch_appended) {
+                    ingestion.on_batch_appended(progress);
                 }
             }
+            writer.Flush();
             update_result.set_affected_rows(affected_row);
         }
 
         void AppendRow(Appender &appender, Document &doc, UpdateResult &update_result) override {
             const auto embeddings = embeddings_->EmbedDocuments({doc.text()});
-            details::append_row(GetMetadataSchema(), appender, doc, embeddings[0], update_result, GetOptions().bypass_unknown_fields);
+            details::EmbeddingRowChunkWriter writer {appender};
+            writer.AppendRow(GetMetadataColumnPlan(), doc, embeddings[0], update_result, GetOptions().bypass_unknown_fields);
+            writer.Flush();
         }
     };
 }
@@ -0,0 +1,152 @@
+#ifndef DUCKDBEMBEDDINGCACHESTORE_HPP
+#define DUCKDBEMBEDDINGCACHESTORE_HPP
+
+#include <cstring>
+#include <duckdb.hpp>
+
+#include "RetrievalGlobals.hpp"
+#include "BaseDuckDBStore.hpp"
+#include "model/IEmbeddingCacheStore.hpp"
+#include "tools/Assertions.hpp"
+#include "tools/StringUtils.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+    using namespace duckdb;
+    using namespace INSTINCT_LLM_NS;
+    using namespace INSTINCT_DATA_NS;
+
+    namespace details {
+        static std::string make_create_embedding_cache_table_sql(const std::string& table_name) {
+            return fmt::format("CREATE TABLE IF NOT EXISTS {}(key VARCHAR PRIMARY KEY, embedding FLOAT[] NOT NULL);", table_name);
+        }
+
+        /**
+         * make sql to select cached embeddings, whose keys are bound as a single list parameter
+         */
+        static std::string make_select_embedding_cache_sql(const std::string& table_name) {
+            return fmt::format("SELECT key, embedding FROM {} WHERE key IN (SELECT UNNEST(?::VARCHAR[]));", table_name);
+        }
+
+        /**
+         * Connection-local table where new entries are appended before being merged into cache table, as appender cannot skip existing keys
+         */
+        static constexpr auto EMBEDDING_CACHE_STAGING_TABLE = "instinct_embedding_cache_staging";
+
+        static std::string make_create_embedding_cache_staging_table_sql() {
+            return fmt::format("CREATE TEMP TABLE IF NOT EXISTS {}(key VARCHAR NOT NULL, embedding FLOAT[] NOT NULL);", EMBEDDING_CACHE_STAGING_TABLE);
+        }
+
+        static std::string make_merge_embedding_cache_staging_sql(const std::string& table_name) {
+            return fmt::format("INSERT OR IGNORE INTO {} SELECT DISTINCT ON (key) key, embedding FROM {}; DELETE FROM {};", table_name, EMBEDDING_CACHE_STAGING_TABLE, EMBEDDING_CACHE_STAGING_TABLE);
+        }
+
+        /**
+         * Write entries in `[offset, offset + count)` to a chunk of `(VARCHAR, FLOAT[])`. Each embedding is copied into child vector of LIST column with a single `memcpy`.
+         */
+        static void write_embedding_cache_chunk(const std::vector<std::pair<std::string, Embedding>>& entries, const size_t offset, const size_t count, DataChunk& chunk) {
+            auto& key_vector = chunk.data[0];
+            auto& embedding_vector = chunk.data[1];
+            idx_t total = 0;
+            for (size_t i = offset; i < offset + count; ++i) {
+                total += entries[i].second.size();
+            }
+            // child buffer may be reallocated by reserving, so it's resolved afterward
+            ListVector::Reserve(embedding_vector, total);
+            auto* list_entries = FlatVector::GetData<list_entry_t>(embedding_vector);
+            auto* floats = FlatVector::GetData<float>(ListVector::GetEntry(embedding_vector));
+            idx_t list_offset = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const auto& [key, embedding] = entries[offset + i];
+                FlatVector::GetData<string_t>(key_vector)[i] = StringVector::AddString(key_vector, key);
+                list_entries[i] = {list_offset, embedding.size()};
+                std::memcpy(floats + list_offset, embedding.data(), embedding.size() * sizeof(float));
+                list_offset += embedding.size();
+            }
+            ListVector::SetListSize(embedding_vector, total);
+            chunk.SetCardinality(count);
+        }
+    }
+
+    /**
+     * Persistent tier of embedding cache in a DuckDB table of `(key VARCHAR PRIMARY KEY, embedding FLOAT[])`. Embeddings are read from and written to list child vectors directly, without boxing each float into a `duckdb::Value`.
+     */
+    class DuckDBEmbeddingCacheStore final: public IEmbeddingCacheStore {
+        DuckDBPtr db_;
+        std::string table_name_;
+        Connection connection_;
+        unique_ptr<PreparedStatement> prepared_select_statement_;
+        // connection is not safe for concurrent use
+        std::mutex mutex_;
+
+    public:
+        DuckDBEmbeddingCacheStore(DuckDBPtr db, std::string table_name)
+            : db_(std::move(db)),
+              table_name_(std::move(table_name)),
+              connection_(*db_) {
+            assert_true(!StringUtils::IsBlankString(table_name_), "table_name cannot be blank");
+            const auto create_table_result = connection_.Query(details::make_create_embedding_cache_table_sql(table_name_));
+            assert_query_ok(create_table_result);
+            assert_query_ok(connection_.Query(details::make_create_embedding_cache_staging_table_sql()));
+            prepared_select_statement_ = connection_.Prepare(details::make_select_embedding_cache_sql(table_name_));
+            assert_prepared_ok(prepared_select_statement_, "Failed to prepare select statement for embedding cache");
+        }
+
+        std::unordered_map<std::string, Embedding> MultiGet(const std::vector<std::string>& keys) override {
+            std::unordered_map<std::string, Embedding> result;
+            if (keys.empty()) {
+                return result;
+            }
+            std::lock_guard guard {mutex_};
+            vector<duckdb::Value> values {details::make_id_list_value(keys, 0, keys.size())};
+            const auto query_result = prepared_select_statement_->Execute(values, false);
+            assert_query_ok(query_result);
+            while (const auto chunk = query_result->Fetch()) {
+                auto& key_vector = chunk->data[0];
+                auto& embedding_vector = chunk->data[1];
+                key_vector.Flatten(chunk->size());
+                embedding_vector.Flatten(chunk->size());
+                const auto* list_entries = FlatVector::GetData<list_entry_t>(embedding_vector);
+                const auto* floats = FlatVector::GetData<float>(ListVector::GetEntry(embedding_vector));
+                for (idx_t i = 0; i < chunk->size(); ++i) {
+                    const auto& entry = list_entries[i];
+                    result.emplace(
+                        FlatVector::GetData<string_t>(key_vector)[i].GetString(),
+                        Embedding(floats + entry.offset, floats + entry.offset + entry.length)
+                    );
+                }
+            }
+            return result;
+        }
+
+        void MultiPut(const std::vector<std::pair<std::string, Embedding>>& entries) override {
+            if (entries.empty()) {
+                return;
+            }
+            std::lock_guard guard {mutex_};
+            connection_.BeginTransaction();
+            try {
+                {
+                    Appender appender {connection_, details::EMBEDDING_CACHE_STAGING_TABLE};
+                    for (size_t offset = 0; offset < entries.size(); offset += STANDARD_VECTOR_SIZE) {
+                        DataChunk chunk;
+                        chunk.Initialize(Allocator::DefaultAllocator(), appender.GetTypes());
+                        details::write_embedding_cache_chunk(entries, offset, std::min<size_t>(STANDARD_VECTOR_SIZE, entries.size() - offset), chunk);
+                        appender.AppendDataChunk(chunk);
+                    }
+                    appender.Close();
+                }
+                assert_query_ok(connection_.Query(details::make_merge_embedding_cache_staging_sql(table_name_)));
+                connection_.Commit();
+            } catch (...) {
+                connection_.Rollback();
+                std::rethrow_exception(std::current_exception());
+            }
+        }
+    };
+
+    static EmbeddingCacheStorePtr CreateDuckDBEmbeddingCacheStore(const DuckDBPtr& db, const std::string& table_name = "embedding_cache") {
+        return std::make_shared<DuckDBEmbeddingCacheStore>(db, table_name);
+    }
+}
+
+#endif //DUCKDBEMBEDDINGCACHESTORE_HPP
@@ -5,6 +5,7 @@
 #ifndef DUCKDBVECTORSTORE_HPP
 #define DUCKDBVECTORSTORE_HPP
 
+#include <queue>
 #include <duckdb.hpp>
 #include <retrieval.pb.h>
 
@@ -26,38 +27,32 @@ namespace INSTINCT_RETRIEVAL_NS {
     namespace details {
 
         /**
-         * make sql text for prepared statement, ignoring metadata filter
+         * Max count of documents returned by a single search. Larger `top_k` is clamped to it.
+         */
+        static constexpr int MAX_SEARCH_LIMIT = 10000;
+
+        /**
+         * make parameterized sql for search with optional metadata filter. SQL text only depends on shape of metadata filter, so that it can be prepared once.
+         *
+         * Query vector is bound to first placeholder as a list of floats, which is cast to `FLOAT[dimension]`, followed by values appended to `parameters`, i.e. values in metadata filter and limit.
          * @param table_name
          * @param metadata_schema
+         * @param dimension
+         * @param metadata_filter
+         * @param parameters
+         * @param limit
          * @return
          */
-        static std::string make_prepared_search_sql(
-            const std::string& table_name,
-            const std::shared_ptr<MetadataSchema>& metadata_schema
-
-            ) {
-            std::string select_sql = "SELECT id, text";
-            auto name_view = metadata_schema->fields() | std::views::transform(
-                                 [](const MetadataFieldSchema& field)-> std::string {
-                                     return field.name();
-                                 });
-            select_sql += name_view.empty() ? ""  : ", " + StringUtils::JoinWith(name_view, ", ");
-            select_sql += ", array_cosine_similarity(vector, ?) AS similarity FROM ";
-            select_sql += table_name;
-            select_sql += " ORDER BY similarity DESC LIMIT ?";
-            return select_sql;
-        }
-
-
         static std::string make_search_sql(
             const std::string& table_name,
             const std::shared_ptr<MetadataSchema>& metadata_schema,
-            const std::vector<float>& query_vector,
+            const size_t dimension,
             const SearchQuery& metadata_filter,
+            SQLParameters& parameters,
             const int limit = 10
         ) {
             assert_gt(limit, 0, "limit should be positive");
-            assert_lt(limit, 1000, "limit should be less than 1000");
+            assert_lte(limit, MAX_SEARCH_LIMIT, fmt::format("limit should be less than or equal to {}", MAX_SEARCH_LIMIT));
 
             // omit vector field to reduce payload size
             std::string column_list = "id, text";
@@ -66,33 +61,97 @@ namespace INSTINCT_RETRIEVAL_NS {
                                      return field.name();
                                  });
             column_list += name_view.empty() ? ""  : ", " + StringUtils::JoinWith(name_view, ", ");
-            column_list += ", array_cosine_similarity(vector, array_value(";
-
-            for (int i = 0; i < query_vector.size(); i++) {
-                column_list += std::to_string(query_vector.at(i)) + "::FLOAT";
-                if (i < query_vector.size() - 1) {
-                    column_list += ",";
-                }
-            }
-            column_list += ")) AS similarity";
+            column_list += fmt::format(", array_cosine_similarity(vector, ?::FLOAT[{}]) AS similarity", dimension);
 
             Sorter sorter;
             auto* field_sort = sorter.mutable_field();
             field_sort->set_field_name("similarity");
             field_sort->set_order(DESC);
-            return SQLBuilder::ToSelectString(table_name, column_list, metadata_filter, std::vector {sorter}, -1, limit);
+            return SQLBuilder::ToParameterizedSelectString(table_name, column_list, metadata_filter, parameters, std::vector {sorter}, -1, limit);
+        }
+
+        /**
+         * make value of query vector for binding to placeholder of `FLOAT[dimension]` in sql generated by `make_search_sql`
+         * @param query_vector
+         * @return
+         */
+        static duckdb::Value make_query_vector_value(const std::vector<float>& query_vector) {
+            vector<duckdb::Value> values;
+            values.reserve(query_vector.size());
+            for (const auto& v: query_vector) {
+                values.push_back(duckdb::Value::FLOAT(v));
+            }
+            return duckdb::Value::LIST(LogicalType::FLOAT, std::move(values));
+        }
+
+        static std::string make_hnsw_snapshot_table_name(const std::string& table_name) {
+            return table_name + "_hnsw";
+        }
+
+        static std::string make_create_hnsw_snapshot_table_sql(const std::string& table_name) {
+            return fmt::format("CREATE TABLE IF NOT EXISTS {}(version BIGINT NOT NULL, payload BLOB NOT NULL);", make_hnsw_snapshot_table_name(table_name));
+        }
+
+        static std::string make_quantizer_snapshot_table_name(const std::string& table_name) {
+            return table_name + "_codes";
+        }
+
+        static std::string make_create_quantizer_snapshot_table_sql(const std::string& table_name) {
+            return fmt::format("CREATE TABLE IF NOT EXISTS {}(version BIGINT NOT NULL, payload BLOB NOT NULL);", make_quantizer_snapshot_table_name(table_name));
+        }
+
+        static std::string make_select_embeddings_by_ids_sql(const std::string& table_name) {
+            return fmt::format("SELECT id, vector FROM {} WHERE id IN (SELECT UNNEST(?::UUID[]));", table_name);
+        }
+
+        /**
+         * Iterate over (id, vector) rows in query result, reading float array data in chunks without boxing each component
+         * @param query_result Result of `SELECT id, vector FROM ...`
+         * @param dimension
+         * @param fn
+         */
+        static void scan_embedding_rows(QueryResult& query_result, const size_t dimension, const std::function<void(const std::string& id, const float* data)>& fn) {
+            while (auto chunk = query_result.Fetch()) {
+                if (chunk->size() == 0) {
+                    break;
+                }
+                auto& vector_column = chunk->data[1];
+                vector_column.Flatten(chunk->size());
+                const auto* data = FlatVector::GetData<float>(ArrayVector::GetEntry(vector_column));
+                for (idx_t i = 0; i < chunk->size(); ++i) {
+                    fn(chunk->GetValue(0, i).ToString(), data + i * dimension);
+                }
+            }
         }
 
     }
 
 
     /**
-     * IVectorStore implementation using brute-force cosine similarly executed by DuckDB instance
+     * IVectorStore implementation using cosine similarly executed by DuckDB instance.
+     *
+     * Brute-force scan is used by default, and it's executed with prepared statements cached by shape of metadata filter for each pooled connection, so that concurrent searches are executed on different connections in parallel. If `DuckDBStoreOptions::vector_index` is enabled, an in-memory HNSW graph is maintained alongside the table and used to recall candidates for large tables. Graph structure is persisted in a sidecar table named `<table_name>_hnsw`, so that it can be restored without rebuilding as long as it's consistent with vector table. Snapshots are written after `HNSWIndexOptions::snapshot_interval` changes and by `Persist`, never on destruction. A snapshot that misses later changes, e.g. one left by a crashed process, is stale and graph is rebuilt from table.
+     *
+     * If `DuckDBStoreOptions::vector_quantization` is enabled, int8 or PQ codes of vectors are kept in memory and scanned with asymmetric distance, which reads 4 to 32 times fewer bytes per vector than FLOAT array. Top candidates are then re-scored exactly with FLOAT column in DuckDB. Codes are persisted lazily in a sidecar table named `<table_name>_codes`, following `VectorQuantizationOptions::snapshot_interval`, and by `Persist`.
      */
     class DuckDBVectorStore final: public virtual IVectorStore {
         DuckDBDocWithEmbeddingStore store_;
-        unique_ptr<PreparedStatement> prepared_search_statement_;
         EmbeddingsPtr embeddings_;
+        std::shared_ptr<std::atomic<int64_t>> write_counter_;
+        HNSWIndexPtr index_;
+        /**
+         * Value of `write_counter_` that index reflects. Index is stale if they differ, which means table is written by another store instance.
+         */
+        int64_t index_version_ = 0;
+        size_t index_pending_changes_ = 0;
+        std::mutex index_mutex_;
+        VectorQuantizerPtr quantizer_;
+        /**
+         * Value of `write_counter_` that quantizer reflects
+         */
+        int64_t quantizer_version_ = 0;
+        size_t quantizer_pending_changes_ = 0;
+        std::mutex quantizer_mutex_;
     public:
         DuckDBVectorStore() = delete;
 
@@ -102,74 +161,225 @@ namespace INSTINCT_RETRIEVAL_NS {
             const std::shared_ptr<MetadataSchema>& metadata_schema,
             const DuckDBStoreOptions& options
         ):  store_(db, metadata_schema, embeddings_model, options),
-            embeddings_(embeddings_model)
+            embeddings_(embeddings_model),
+            write_counter_(details::get_table_write_counter(db, options.table_name, "vectors"))
         {
             assert_gt(options.dimension, 0);
             assert_true(embeddings_ != nullptr, "should provide embeddings object pointer");
             assert_true(embeddings_->GetDimension() == options.dimension, "should have dimension set correctly");
             assert_true(metadata_schema, "should have provide valid metadata schema");
 
-            auto search_sql = details::make_prepared_search_sql(options.table_name, metadata_schema);
-            LOG_DEBUG("prepare search sql: {}", search_sql);
-            prepared_search_statement_ =  store_.GetConnection().Prepare(search_sql);
-            assert_prepared_ok(prepared_search_statement_, "Failed to prepare search statement");
+            // prepare statement for search without metadata filter in advance. lease is returned before loading index or quantizer, which lease connections of their own.
+            {
+                SQLParameters parameters;
+                const auto lease = store_.LeaseConnection();
+                store_.GetPreparedStatement(lease, details::make_search_sql(options.table_name, metadata_schema, options.dimension, {}, parameters));
+            }
+
+            if (options.vector_index.enabled) {
+                std::unique_lock lock(index_mutex_);
+                LoadIndex_();
+            }
+
+            if (options.vector_quantization.type != kNoQuantization) {
+                std::unique_lock lock(quantizer_mutex_);
+                LoadQuantizer_();
+            }
+        }
+
+        ~DuckDBVectorStore() override {
+            if (index_pending_changes_ > 0 || quantizer_pending_changes_ > 0) {
+                LOG_WARN("Snapshots for table {} are dropped without being persisted, and they will be rebuilt on next load. index_pending_changes={}, quantizer_pending_changes={}", store_.GetOptions().table_name, index_pending_changes_, quantizer_pending_changes_);
+            }
+        }
+
+        /**
+         * Write snapshots of HNSW graph and quantized codes if they have changes not yet written
+         */
+        void Persist() override {
+            std::scoped_lock lock(index_mutex_, quantizer_mutex_);
+            if (index_ && index_pending_changes_ > 0) {
+                PersistIndex_();
+            }
+            if (quantizer_ && quantizer_pending_changes_ > 0) {
+                PersistQuantizer_();
+            }
         }
 
         AsyncIterator<Document> FindDocuments(const FindRequest &find_request) override {
             return store_.FindDocuments(find_request);
         }
 
+        AsyncIterator<Document> SearchDocumentsByKeywords(const SearchRequest& request) override {
+            return store_.SearchDocumentsByKeywords(request);
+        }
+
         EmbeddingsPtr GetEmbeddingModel() override {
             return embeddings_;
         }
 
         AsyncIterator<Document> SearchDocuments(const SearchRequest& request) override {
-            // limit should be in range of [1,10000]
-            const int limit = request.top_k() > 0 ? std::min(request.top_k(), 10000) : 10;
+            // limit should be in range of [1,MAX_SEARCH_LIMIT]
+            const int limit = request.top_k() > 0 ? std::min(request.top_k(), details::MAX_SEARCH_LIMIT) : 10;
             LOG_DEBUG("Search started: request.query={}, request.top_k={}, normalized_limit={}", request.query(), request.top_k(), limit);
             long t1 = ChronoUtils::GetCurrentTimeMillis();
             const auto query_embedding = embeddings_->EmbedQuery(request.query());
-            unique_ptr<QueryResult> result;
-            if (request.has_metadata_filter()) {
-                const auto search_sql = details::make_search_sql(
+            if (const auto index = GetFreshIndex_(); index && index->Size() >= store_.GetOptions().vector_index.brute_force_threshold) {
+                std::vector<Document> docs;
+                if (SearchWithIndex_(*index, query_embedding, request, limit, docs)) {
+                    return CreateAsyncIteratorWithRange<Document>(docs) | rpp::operators::tap({}, {}, [t1]() {
+                        LOG_INFO("Search with HNSW index done, rt={}ms", ChronoUtils::GetCurrentTimeMillis()-t1);
+                    });
+                }
+                LOG_DEBUG("Not enough candidates passed metadata filter, fallback to brute-force search");
+            }
+            if (const auto quantizer = GetFreshQuantizer_()) {
+                std::vector<Document> docs;
+                if (SearchWithQuantizer_(*quantizer, query_embedding, request, limit, docs)) {
+                    return CreateAsyncIteratorWithRange<Document>(docs) | rpp::operators::tap({}, {}, [t1]() {
+                        LOG_INFO("Search with quantized vectors done, rt={}ms", ChronoUtils::GetCurrentTimeMillis()-t1);
+                    });
+                }
+                LOG_DEBUG("Not enough candidates passed metadata filter, fallback to brute-force search");
+            }
+            return SearchExactly_(query_embedding, request, limit, t1);
+        }
+
+        /**
+         * Search for all queries with a single scan of vector table. Each row is scored against all of them, keeping one top-k heap per query. Vector index and quantized codes are per-query structures, so requests are served by `IVectorStore::BatchSearchDocuments` if either is active.
+         */
+        BatchSearchResult BatchSearchDocuments(const BatchSearchRequest& request) override {
+            if (request.queries_size() == 0) {
+                return {};
+            }
+            if (const auto index = GetFreshIndex_(); (index && index->Size() >= store_.GetOptions().vector_index.brute_force_threshold) || GetFreshQuantizer_()) {
+                return IVectorStore::BatchSearchDocuments(request);
+            }
+            const size_t limit = request.top_k() > 0 ? std::min(request.top_k(), details::MAX_SEARCH_LIMIT) : 10;
+            const size_t query_count = request.queries_size();
+            const auto dimension = store_.GetOptions().dimension;
+            LOG_DEBUG("Batch search started: request.queries_size={}, request.top_k={}, normalized_limit={}", query_count, request.top_k(), limit);
+            const long t1 = ChronoUtils::GetCurrentTimeMillis();
+
+            // queries are embedded in one `EmbedQueries` call rather than `EmbedDocuments`, as asymmetric models encode queries differently from documents. query vectors are normalized once, so that cosine similarity is reduced to dot product divided by row norm
+            const std::vector<std::string> queries(request.queries().begin(), request.queries().end());
+            auto query_embeddings = embeddings_->EmbedQueries(queries);
+            assert_true(query_embeddings.size() == query_count, "should have an embedding for each query");
+            for (auto& query_embedding: query_embeddings) {
+                assert_true(query_embedding.size() == dimension, "should have query embedding of correct dimension");
+                float norm = 0;
+                for (const auto f: query_embedding) {
+                    norm += f * f;
+                }
+                norm = std::sqrt(norm);
+                for (auto& f: query_embedding) {
+                    f = norm > 0 ? f / norm : 0;
+                }
+            }
+
+            using ScoredId = std::pair<float, std::string>;
+            std::vector<std::priority_queue<ScoredId, std::vector<ScoredId>, std::greater<>>> heaps(query_count);
+            SQLParameters parameters;
+            const auto sql = SQLBuilder::ToParameterizedSelectString(
                 store_.GetOptions().table_name,
-                GetMetadataSchema(),
-                query_embedding,
-                request.metadata_filter(),
-                limit);
-                LOG_DEBUG("search_sql: {}", search_sql);
-                result = store_.GetConnection().Query(search_sql);
-            } else {
-                // use prepared statement for better performance when no filter is actually given
-                vector<duckdb::Value> vector_array;
-                for(const float& f: query_embedding) {
-                    vector_array.push_back(duckdb::Value::FLOAT(f));
+                "id, vector",
+                request.has_metadata_filter() ? request.metadata_filter() : SearchQuery {},
+                parameters);
+            {
+                // rows are streamed, so connection is held until scan is done. Both lease and streaming result are released before candidates are fetched below, so that a single-connection pool won't be exhausted.
+                const auto lease = store_.LeaseConnection();
+                const auto statement = store_.GetPreparedStatement(lease, sql);
+                vector<duckdb::Value> values;
+                for (const auto& parameter: parameters) {
+                    values.push_back(details::conv_primitive_value_to_duckdb_value(parameter));
                 }
-                result = prepared_search_statement_->Execute(duckdb::Value::ARRAY(LogicalType::FLOAT, vector_array), limit);
+                const auto vector_result = statement->Execute(values);
+                assert_query_ok(vector_result);
+                details::scan_embedding_rows(*vector_result, dimension, [&](const std::string& id, const float* data) {
+                    float norm = 0;
+                    for (size_t i = 0; i < dimension; ++i) {
+                        norm += data[i] * data[i];
+                    }
+                    if (norm == 0) {
+                        return;
+                    }
+                    norm = std::sqrt(norm);
+                    for (size_t q = 0; q < query_count; ++q) {
+                        const auto* query_data = query_embeddings[q].data();
+                        float dot = 0;
+                        for (size_t i = 0; i < dimension; ++i) {
+                            dot += data[i] * query_data[i];
+                        }
+                        const float similarity = dot / norm;
+                        auto& heap = heaps[q];
+                        if (heap.size() < limit) {
+                            heap.emplace(similarity, id);
+                        } else if (similarity > heap.top().first) {
+                            heap.pop();
+                            heap.emplace(similarity, id);
+                        }
+                    }
+                });
             }
-            assert_query_ok(result);
-            return details::conv_query_result_to_iterator(
-                    std::move(result),
-                    GetMetadataSchema()
-            ) | rpp::operators::tap({}, {}, [t1]() {
-                LOG_INFO("Search done, rt={}ms", ChronoUtils::GetCurrentTimeMillis()-t1);
-            });
+
+            // drain heaps into ranked ids, and fetch union of them in one query
+            std::vector<std::vector<std::string>> ranked_ids(query_count);
+            std::set<std::string> all_ids;
+            for (size_t q = 0; q < query_count; ++q) {
+                auto& ids = ranked_ids[q];
+                ids.resize(heaps[q].size());
+                for (auto itr = ids.rbegin(); itr != ids.rend(); ++itr) {
+                    *itr = heaps[q].top().second;
+                    heaps[q].pop();
+                }
+                all_ids.insert(ids.begin(), ids.end());
+            }
+            std::unordered_map<std::string, Document> docs_by_id;
+            if (!all_ids.empty()) {
+                const auto candidates_lease = store_.LeaseConnection();
+                auto result = candidates_lease->Query(details::make_select_candidates_sql(
+                    store_.GetOptions().table_name,
+                    GetMetadataSchema(),
+                    {all_ids.begin(), all_ids.end()},
+                    {}));
+                assert_query_ok(result);
+                for (auto& doc: CollectVector(details::conv_query_result_to_iterator(std::move(result), GetMetadataSchema()))) {
+                    docs_by_id.emplace(doc.id(), std::move(doc));
+                }
+            }
+
+            std::vector<std::vector<Document>> ranked_lists(query_count);
+            for (size_t q = 0; q < query_count; ++q) {
+                for (const auto& id: ranked_ids[q]) {
+                    if (const auto itr = docs_by_id.find(id); itr != docs_by_id.end()) {
+                        ranked_lists[q].push_back(itr->second);
+                    }
+                }
+            }
+            LOG_INFO("Batch search done, queries={}, rt={}ms", query_count, ChronoUtils::GetCurrentTimeMillis()-t1);
+            return details::make_batch_search_result(request, ranked_lists);
         }
 
         void AddDocuments(const AsyncIterator<Document>& documents_iterator, UpdateResult& update_result) override {
             store_.AddDocuments(documents_iterator, update_result);
+            IndexInsertedDocuments_(update_result);
         }
 
         void AddDocuments(std::vector<Document>& records, UpdateResult& update_result) override {
             store_.AddDocuments(records, update_result);
+            IndexInsertedDocuments_(update_result);
         }
 
         void AddDocument(Document& doc) override {
             store_.AddDocument(doc);
+            UpdateResult update_result;
+            update_result.add_returned_ids(doc.id());
+            IndexInsertedDocuments_(update_result);
         }
 
         void DeleteDocuments(const std::vector<std::string>& ids, UpdateResult& update_result) override {
             store_.DeleteDocuments(ids, update_result);
+            IndexDeletedDocuments_(ids);
         }
 
         AsyncIterator<Document> MultiGetDocuments(const std::vector<std::string>& ids) override {
@@ -185,11 +395,428 @@ namespace INSTINCT_RETRIEVAL_NS {
         }
 
         void DeleteDocuments(const SearchQuery &filter, UpdateResult &update_result) override {
+            // ids of deleted rows are returned by the same statement, so that they can be removed from index
+            const auto id_offset = update_result.returned_ids_size();
             store_.DeleteDocuments(filter, update_result);
+            IndexDeletedDocuments_({update_result.returned_ids().begin() + id_offset, update_result.returned_ids().end()});
         }
 
         bool Destroy() override {
-            return store_.Destroy();
+            std::scoped_lock lock(index_mutex_, quantizer_mutex_);
+            if (index_) {
+                const auto result = store_.MakeConnection().Query(fmt::format("DROP TABLE IF EXISTS {};", details::make_hnsw_snapshot_table_name(store_.GetOptions().table_name)));
+                assert_query_ok(result);
+                index_->Clear();
+                index_pending_changes_ = 0;
+            }
+            if (quantizer_) {
+                const auto result = store_.MakeConnection().Query(fmt::format("DROP TABLE IF EXISTS {};", details::make_quantizer_snapshot_table_name(store_.GetOptions().table_name)));
+                assert_query_ok(result);
+                quantizer_->Clear();
+                quantizer_pending_changes_ = 0;
+            }
+            const auto destroyed = store_.Destroy();
+            index_version_ = quantizer_version_ = ++*write_counter_;
+            return destroyed;
+        }
+
+    private:
+        /**
+         * Search by brute-force scan, which is always exact
+         */
+        AsyncIterator<Document> SearchExactly_(const Embedding& query_embedding, const SearchRequest& request, const int limit, const long t1) {
+            SQLParameters parameters;
+            const auto search_sql = details::make_search_sql(
+                store_.GetOptions().table_name,
+                GetMetadataSchema(),
+                store_.GetOptions().dimension,
+                request.has_metadata_filter() ? request.metadata_filter() : SearchQuery {},
+                parameters,
+                limit);
+            return details::conv_query_result_to_iterator(
+                    ExecuteSearchStatement_(search_sql, query_embedding, parameters),
+                    GetMetadataSchema()
+            ) | rpp::operators::tap({}, {}, [t1]() {
+                LOG_INFO("Search done, rt={}ms", ChronoUtils::GetCurrentTimeMillis()-t1);
+            });
+        }
+
+        /**
+         * Execute search sql generated by `details::make_search_sql` with query vector and parameters bound. Result is materialized, so that leased connection can be returned to pool before result is consumed.
+         */
+        unique_ptr<QueryResult> ExecuteSearchStatement_(const std::string& search_sql, const Embedding& query_embedding, const SQLParameters& parameters) {
+            const auto lease = store_.LeaseConnection();
+            const auto statement = store_.GetPreparedStatement(lease, search_sql);
+            vector<duckdb::Value> values;
+            values.reserve(parameters.size() + 1);
+            values.push_back(details::make_query_vector_value(query_embedding));
+            for (const auto& parameter: parameters) {
+                values.push_back(details::conv_primitive_value_to_duckdb_value(parameter));
+            }
+            auto result = statement->Execute(values, false);
+            assert_query_ok(result);
+            return result;
+        }
+
+        /**
+         * Search with HNSW index. Candidates are fetched from table with metadata filter applied, and sorted by similarity computed by index.
+         * @return false if candidates are not enough after post-checking with metadata filter, which requires a fallback to brute-force search.
+         */
+        bool SearchWithIndex_(const HNSWIndex& index, const Embedding& query_embedding, const SearchRequest& request, const int limit, std::vector<Document>& docs) {
+            const auto& index_options = store_.GetOptions().vector_index;
+            const bool has_filter = request.has_metadata_filter() && request.metadata_filter().query_case() != SearchQuery::QUERY_NOT_SET;
+            const size_t candidate_count = has_filter ? limit * std::max<size_t>(index_options.filter_overfetch_factor, 1) : limit;
+            const auto candidates = index.Search(query_embedding, candidate_count, std::max(index_options.ef_search, candidate_count));
+            if (candidates.empty()) {
+                return false;
+            }
+
+            std::unordered_map<std::string, size_t> ranks;
+            std::vector<std::string> ids;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                ranks[candidates[i].first] = i;
+                ids.push_back(candidates[i].first);
+            }
+            const auto sql = details::make_select_candidates_sql(
+                store_.GetOptions().table_name,
+                GetMetadataSchema(),
+                ids,
+                has_filter ? request.metadata_filter() : SearchQuery {});
+            LOG_DEBUG("select candidates with sql: {}", sql);
+            const auto lease = store_.LeaseConnection();
+            auto result = lease->Query(sql);
+            assert_query_ok(result);
+            docs = CollectVector(details::conv_query_result_to_iterator(std::move(result), GetMetadataSchema()));
+
+            // index is exhausted if it returns fewer candidates than requested, so partial result is final.
+            if (has_filter && docs.size() < static_cast<size_t>(limit) && candidates.size() == candidate_count) {
+                return false;
+            }
+            std::ranges::sort(docs, [&](const Document& a, const Document& b) {
+                return ranks.at(a.id()) < ranks.at(b.id());
+            });
+            if (docs.size() > static_cast<size_t>(limit)) {
+                docs.resize(limit);
+            }
+            return true;
+        }
+
+        /**
+         * Search by scanning quantized codes, and re-score top candidates with FLOAT vectors in table, with metadata filter applied as post-check.
+         * @return false if candidates are not enough after post-checking with metadata filter, which requires a fallback to brute-force search.
+         */
+        bool SearchWithQuantizer_(const VectorQuantizer& quantizer, const Embedding& query_embedding, const SearchRequest& request, const int limit, std::vector<Document>& docs) {
+            const auto& quantization_options = store_.GetOptions().vector_quantization;
+            const bool has_filter = request.has_metadata_filter() && request.metadata_filter().query_case() != SearchQuery::QUERY_NOT_SET;
+            size_t candidate_count = limit * std::max<size_t>(quantization_options.rescore_factor, 1);
+            if (has_filter) {
+                candidate_count *= std::max<size_t>(quantization_options.filter_overfetch_factor, 1);
+            }
+            const auto candidates = quantizer.Search(query_embedding, candidate_count);
+            if (candidates.empty()) {
+                return false;
+            }
+
+            std::vector<std::string> ids;
+            ids.reserve(candidates.size());
+            for (const auto& [id, _]: candidates) {
+                ids.push_back(id);
+            }
+            SQLParameters parameters;
+            const auto sql = details::make_search_sql(
+                store_.GetOptions().table_name,
+                GetMetadataSchema(),
+                store_.GetOptions().dimension,
+                details::make_candidates_filter(ids, has_filter ? request.metadata_filter() : SearchQuery {}),
+                parameters,
+                limit);
+            docs = CollectVector(details::conv_query_result_to_iterator(ExecuteSearchStatement_(sql, query_embedding, parameters), GetMetadataSchema()));
+
+            // codes are exhausted if fewer candidates than requested are returned, so partial result is final.
+            return !(has_filter && docs.size() < static_cast<size_t>(limit) && candidates.size() == candidate_count);
+        }
+
+        /**
+         * Reload index if vector table is modified by others, e.g. another store instance opened on the same table. Freshness is checked against in-memory write counter, so no query is issued unless index is stale.
+         * @return index pointer if index is enabled
+         */
+        HNSWIndexPtr GetFreshIndex_() {
+            if (!index_) {
+                return nullptr;
+            }
+            std::unique_lock lock(index_mutex_);
+            if (const auto version = write_counter_->load(); version != index_version_) {
+                LOG_INFO("HNSW index for table {} is stale, reloading. version={}, expected_version={}", store_.GetOptions().table_name, index_version_, version);
+                LoadIndex_();
+            }
+            return index_;
+        }
+
+        /**
+         * Load index from snapshot, or rebuild it with all vectors in table if snapshot is missing or stale. Caller should hold `index_mutex_`.
+         */
+        void LoadIndex_() {
+            const auto& options = store_.GetOptions();
+            // writes committed after this point are applied by their writers, or detected by next freshness check
+            index_version_ = write_counter_->load();
+            index_pending_changes_ = 0;
+            auto connection = store_.MakeConnection();
+            assert_query_ok(connection.Query(details::make_create_hnsw_snapshot_table_sql(options.table_name)));
+
+            std::unordered_map<std::string, std::vector<float>> vectors;
+            const auto vector_result = connection.Query(fmt::format("SELECT id, vector FROM {};", options.table_name));
+            assert_query_ok(vector_result);
+            details::scan_embedding_rows(*vector_result, options.dimension, [&](const std::string& id, const float* data) {
+                vectors.emplace(id, std::vector<float>(data, data + options.dimension));
+            });
+
+            const auto snapshot_result = connection.Query(fmt::format("SELECT version, payload FROM {} ORDER BY version DESC LIMIT 1;", details::make_hnsw_snapshot_table_name(options.table_name)));
+            assert_query_ok(snapshot_result);
+            std::unique_ptr<HNSWIndex> index;
+            if (snapshot_result->RowCount() > 0) {
+                index = HNSWIndex::Deserialize(
+                    StringValue::Get(snapshot_result->GetValue(1, 0)),
+                    options.dimension,
+                    options.vector_index,
+                    [&](const std::string& id, std::vector<float>& vector) {
+                        const auto itr = vectors.find(id);
+                        if (itr == vectors.end()) {
+                            return false;
+                        }
+                        vector = itr->second;
+                        return true;
+                    });
+                if (index && index->Size() != vectors.size()) {
+                    LOG_WARN("HNSW snapshot covers {} vectors but table has {}", index->Size(), vectors.size());
+                    index = nullptr;
+                }
+            }
+            if (index) {
+                LOG_INFO("HNSW index for table {} restored from snapshot, size={}", options.table_name, index->Size());
+                index_ = std::move(index);
+                return;
+            }
+
+            const auto t1 = ChronoUtils::GetCurrentTimeMillis();
+            index_ = std::make_shared<HNSWIndex>(options.dimension, options.vector_index);
+            for (const auto& [id, vector]: vectors) {
+                index_->Add(id, vector);
+            }
+            LOG_INFO("HNSW index for table {} rebuilt, size={}, rt={}ms", options.table_name, index_->Size(), ChronoUtils::GetCurrentTimeMillis() - t1);
+            PersistIndex_();
+        }
+
+        /**
+         * Save graph structure to snapshot table. Caller should hold `index_mutex_`.
+         */
+        void PersistIndex_() {
+            WriteSnapshot_(details::make_hnsw_snapshot_table_name(store_.GetOptions().table_name), index_->Serialize());
+            index_pending_changes_ = 0;
+        }
+
+        /**
+         * Save graph structure if enough changes are accumulated since last snapshot. Caller should hold `index_mutex_`.
+         */
+        void MaybePersistIndex_() {
+            const auto interval = store_.GetOptions().vector_index.snapshot_interval;
+            if (interval > 0 && index_pending_changes_ >= std::max(interval, index_->Size() / 4)) {
+                PersistIndex_();
+            }
+        }
+
+        /**
+         * Reload quantizer if vector table is modified by others. Freshness is checked against in-memory write counter, and a fresh quantizer holds codes of all rows, so no query is issued unless quantizer is stale. Tables below `brute_force_threshold` are always searched by brute-force scan.
+         * @return quantizer pointer if quantization is enabled and quantizer is ready for search
+         */
+        VectorQuantizerPtr GetFreshQuantizer_() {
+            if (!quantizer_) {
+                return nullptr;
+            }
+            std::unique_lock lock(quantizer_mutex_);
+            if (const auto version = write_counter_->load(); version != quantizer_version_) {
+                LOG_INFO("Quantized codes for table {} are stale, reloading. version={}, expected_version={}", store_.GetOptions().table_name, quantizer_version_, version);
+                LoadQuantizer_();
+            }
+            return quantizer_->IsTrained() && quantizer_->Size() >= store_.GetOptions().vector_quantization.brute_force_threshold ? quantizer_ : nullptr;
+        }
+
+        /**
+         * Load quantizer from snapshot, or train a new one and encode all vectors in table if snapshot is missing or stale. Training is deferred until table has at least `brute_force_threshold` rows. Caller should hold `quantizer_mutex_`.
+         */
+        void LoadQuantizer_() {
+            const auto& options = store_.GetOptions();
+            quantizer_version_ = write_counter_->load();
+            quantizer_pending_changes_ = 0;
+            auto connection = store_.MakeConnection();
+            assert_query_ok(connection.Query(details::make_create_quantizer_snapshot_table_sql(options.table_name)));
+
+            const auto count = store_.CountDocuments();
+            const auto snapshot_result = connection.Query(fmt::format("SELECT version, payload FROM {} ORDER BY version DESC LIMIT 1;", details::make_quantizer_snapshot_table_name(options.table_name)));
+            assert_query_ok(snapshot_result);
+            if (snapshot_result->RowCount() > 0) {
+                auto quantizer = VectorQuantizer::Deserialize(StringValue::Get(snapshot_result->GetValue(1, 0)), options.vector_quantization);
+                if (quantizer && quantizer->IsTrained() && quantizer->Size() == count) {
+                    LOG_INFO("Quantized codes for table {} restored from snapshot, size={}", options.table_name, quantizer->Size());
+                    quantizer_ = std::move(quantizer);
+                    return;
+                }
+                LOG_WARN("Quantizer snapshot for table {} is stale or malformed, table has {} vectors", options.table_name, count);
+            }
+
+            quantizer_ = std::make_shared<VectorQuantizer>(options.dimension, options.vector_quantization);
+            if (count < options.vector_quantization.brute_force_threshold) {
+                return;
+            }
+            const auto t1 = ChronoUtils::GetCurrentTimeMillis();
+            std::vector<std::string> ids;
+            std::vector<float> vectors;
+            const auto vector_result = connection.Query(fmt::format("SELECT id, vector FROM {};", options.table_name));
+            assert_query_ok(vector_result);
+            details::scan_embedding_rows(*vector_result, options.dimension, [&](const std::string& id, const float* data) {
+                ids.push_back(id);
+                vectors.insert(vectors.end(), data, data + options.dimension);
+            });
+            quantizer_->Train(vectors);
+            for (size_t i = 0; i < ids.size(); ++i) {
+                quantizer_->Add(ids[i], vectors.data() + i * options.dimension, options.dimension);
+            }
+            LOG_INFO("Quantized codes for table {} rebuilt, size={}, bytes_per_vector={}, rt={}ms", options.table_name, quantizer_->Size(), quantizer_->GetBytesPerVector(), ChronoUtils::GetCurrentTimeMillis() - t1);
+            PersistQuantizer_();
+        }
+
+        /**
+         * Save codes to snapshot table. Caller should hold `quantizer_mutex_`.
+         */
+        void PersistQuantizer_() {
+            WriteSnapshot_(details::make_quantizer_snapshot_table_name(store_.GetOptions().table_name), quantizer_->Serialize());
+            quantizer_pending_changes_ = 0;
+        }
+
+        /**
+         * Save codes if enough changes are accumulated since last snapshot. Caller should hold `quantizer_mutex_`.
+         */
+        void MaybePersistQuantizer_() {
+            const auto interval = store_.GetOptions().vector_quantization.snapshot_interval;
+            if (interval > 0 && quantizer_pending_changes_ >= std::max(interval, quantizer_->Size() / 4)) {
+                PersistQuantizer_();
+            }
+        }
+
+        /**
+         * Replace payload in snapshot table with a bumped version
+         */
+        void WriteSnapshot_(const std::string& snapshot_table_name, const std::string& payload) {
+            auto connection = store_.MakeConnection();
+            connection.BeginTransaction();
+            try {
+                const auto version_result = connection.Query(fmt::format("SELECT max(version) FROM {};", snapshot_table_name));
+                assert_query_ok(version_result);
+                const auto version_value = version_result->GetValue(0, 0);
+                const int64_t version = (version_value.IsNull() ? 0 : version_value.GetValue<int64_t>()) + 1;
+                assert_query_ok(connection.Query(fmt::format("DELETE FROM {};", snapshot_table_name)));
+                const auto insert_statement = connection.Prepare(fmt::format("INSERT INTO {} VALUES (?, ?);", snapshot_table_name));
+                assert_prepared_ok(insert_statement, "Failed to prepare snapshot insert statement");
+                const auto insert_result = insert_statement->Execute(
+                    duckdb::Value::BIGINT(version),
+                    duckdb::Value::BLOB(reinterpret_cast<const_data_ptr_t>(payload.data()), payload.size()));
+                assert_query_ok(insert_result);
+                connection.Commit();
+            } catch (...) {
+                connection.Rollback();
+                std::rethrow_exception(std::current_exception());
+            }
+        }
+
+        void IndexInsertedDocuments_(const UpdateResult& update_result) {
+            if (update_result.returned_ids_size() == 0) {
+                return;
+            }
+            if (!index_ && !quantizer_) {
+                // structures of other store instances on the same table are made stale
+                ++*write_counter_;
+                return;
+            }
+            // read vectors back from table, as returned ids may contain failed documents which are never committed.
+            const auto& options = store_.GetOptions();
+            const auto dimension = options.dimension;
+            const std::vector<std::string> returned_ids {update_result.returned_ids().begin(), update_result.returned_ids().end()};
+            const auto chunk_size = std::max<size_t>(options.max_ids_per_statement, 1);
+            std::vector<std::string> ids;
+            std::vector<float> vectors;
+            {
+                const auto lease = store_.LeaseConnection();
+                const auto statement = store_.GetPreparedStatement(lease, details::make_select_embeddings_by_ids_sql(options.table_name));
+                for (size_t offset = 0; offset < returned_ids.size(); offset += chunk_size) {
+                    vector<duckdb::Value> values {details::make_id_list_value(returned_ids, offset, std::min(chunk_size, returned_ids.size() - offset))};
+                    const auto result = statement->Execute(values);
+                    assert_query_ok(result);
+                    details::scan_embedding_rows(*result, dimension, [&](const std::string& id, const float* data) {
+                        ids.push_back(id);
+                        vectors.insert(vectors.end(), data, data + dimension);
+                    });
+                }
+            }
+
+            // counter is bumped with both locks held, so that concurrent searches on this instance never see a transient mismatch. A structure which is already stale is left untouched, and it will be reloaded with these vectors on next search.
+            std::scoped_lock lock(index_mutex_, quantizer_mutex_);
+            const auto version = ++*write_counter_;
+            if (index_ && index_version_ == version - 1) {
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    index_->Add(ids[i], vectors.data() + i * dimension, dimension);
+                }
+                index_pending_changes_ += ids.size();
+                index_version_ = version;
+                MaybePersistIndex_();
+            }
+            if (quantizer_ && quantizer_version_ == version - 1) {
+                if (quantizer_->IsTrained()) {
+                    for (size_t i = 0; i < ids.size(); ++i) {
+                        quantizer_->Add(ids[i], vectors.data() + i * dimension, dimension);
+                    }
+                    quantizer_pending_changes_ += ids.size();
+                    quantizer_version_ = version;
+                    MaybePersistQuantizer_();
+                } else if (store_.CountDocuments() >= options.vector_quantization.brute_force_threshold) {
+                    // train with all vectors once table is large enough
+                    LoadQuantizer_();
+                } else {
+                    quantizer_version_ = version;
+                }
+            }
+        }
+
+        void IndexDeletedDocuments_(const std::vector<std::string>& ids) {
+            if (ids.empty()) {
+                return;
+            }
+            if (!index_ && !quantizer_) {
+                ++*write_counter_;
+                return;
+            }
+            std::scoped_lock lock(index_mutex_, quantizer_mutex_);
+            const auto version = ++*write_counter_;
+            if (index_ && index_version_ == version - 1) {
+                for (const auto& id: ids) {
+                    index_->Remove(id);
+                }
+                // tombstones slow down traversal, so graph is rebuilt once they outnumber live nodes
+                if (index_->CountDeleted() > index_->Size()) {
+                    index_->Compact();
+                }
+                index_pending_changes_ += ids.size();
+                index_version_ = version;
+                MaybePersistIndex_();
+            }
+            if (quantizer_ && quantizer_version_ == version - 1) {
+                if (quantizer_->IsTrained()) {
+                    for (const auto& id: ids) {
+                        quantizer_->Remove(id);
+                    }
+                    quantizer_pending_changes_ += ids.size();
+                }
+                quantizer_version_ = version;
+                MaybePersistQuantizer_();
+            }
         }
     };
 
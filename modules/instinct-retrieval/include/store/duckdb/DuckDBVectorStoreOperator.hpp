@@ -4,37 +4,66 @@
 
 #ifndef DUCKDBVECTORSTOREOPERATOR_HPP
 #define DUCKDBVECTORSTOREOPERATOR_HPP
+#include <future>
+
 #include "BaseDuckDBStore.hpp"
 #include "DuckDBDocStore.hpp"
 #include "DuckDBVectorStore.hpp"
 #include "../IVectorStoreOperator.hpp"
 #include "store/VectorStoreMetadataDataMapper.hpp"
 #include "tools/HashUtils.hpp"
+#include "tools/LRUCache.hpp"
 #include "tools/RandomUtils.hpp"
 
 namespace INSTINCT_RETRIEVAL_NS {
 
     using EmbeddingModelSelector = std::function<EmbeddingsPtr(const std::string& instance_id, const MetadataSchemaPtr& metadata_schema)>;
 
+    struct DuckDBVectorStoreOperatorOptions {
+        /**
+         * Max count of loaded instances kept in memory, so that `LoadInstance` returns them without reading instance metadata and preparing statements again. Zero means a new instance is created for each call. Connections are shared by all instances, so each cached instance mainly holds its prepared statements and in-memory indexes.
+         */
+        size_t instance_cache_size = 16;
+
+        /**
+         * Options for pool of read connections shared by all instances, so that count of connections doesn't grow with count of loaded instances. Readers wait for a released connection without timeout by default.
+         */
+        ConnectionPoolOptions connection_pool = {.initial_connection_count = 8, .max_wait_duration_for_acquire = std::chrono::seconds {0}};
+    };
+
     /**
-     * Operator for DuckDB-based vector search, which uses a standalone table for each VectorStore instance
+     * Operator for DuckDB-based vector search, which uses a standalone table for each VectorStore instance.
+     *
+     * Loaded instances are cached by instance id, and they read with connections from a pool owned by this operator. Concurrent loads of an uncached instance are coalesced, so that it's created only once. Cache entry is replaced by `CreateInstance` and dropped by `RemoveInstance`. If instance metadata is modified elsewhere, e.g. metadata schema is changed by another process, `InvalidateInstance` should be called. Instances that are replaced, evicted or invalidated are persisted with `IVectorStore::Persist` after cache lock is released.
      */
     class DuckDBVectorStoreOperator final: public IVectorStoreOperator {
+        /**
+         * Instance being loaded or loaded. Waiters of a pending load share the same future.
+         */
+        struct CachedInstance {
+            std::shared_future<VectorStorePtr> instance;
+        };
+
         DuckDBPtr duck_db_;
         MetadataSchemaPtr default_metadata_schema_;
         EmbeddingModelSelector embedding_model_selector_;
         VectorStoreMetadataDataMapperPtr metadata_data_mapper_;
+        DuckDBConnectionPoolPtr connection_pool_;
+        LRUCache<std::string, std::shared_ptr<CachedInstance>> instance_cache_;
+        std::mutex instance_cache_mutex_;
     public:
         DuckDBVectorStoreOperator(
             const DuckDBPtr &db,
             const EmbeddingsPtr& embedding_model,
             const VectorStoreMetadataDataMapperPtr &metadata_data_mapper,
-            const MetadataSchemaPtr &default_metadata_schema
+            const MetadataSchemaPtr &default_metadata_schema,
+            const DuckDBVectorStoreOperatorOptions& options = {}
         ): DuckDBVectorStoreOperator(
             db,
             [embedding_model](const std::string& instance_id, const MetadataSchemaPtr& metadata_schema) { return embedding_model; },
             metadata_data_mapper,
-            default_metadata_schema
+            default_metadata_schema,
+            options
             ) {
             assert_true(duck_db_, "should provide DuckDB instance");
             assert_true(default_metadata_schema_, "should provide default metadata schema");
@@ -46,11 +75,14 @@ namespace INSTINCT_RETRIEVAL_NS {
             DuckDBPtr db,
             EmbeddingModelSelector embedding_model_selector,
             VectorStoreMetadataDataMapperPtr metadata_data_mapper,
-            MetadataSchemaPtr  default_metadata_schema)
+            MetadataSchemaPtr  default_metadata_schema,
+            const DuckDBVectorStoreOperatorOptions& options = {})
             : duck_db_(std::move(db)),
               default_metadata_schema_(std::move(default_metadata_schema)),
               embedding_model_selector_(std::move(embedding_model_selector)),
-              metadata_data_mapper_(std::move(metadata_data_mapper)) {
+              metadata_data_mapper_(std::move(metadata_data_mapper)),
+              connection_pool_(CreateDuckDBConnectionPool(duck_db_, options.connection_pool)),
+              instance_cache_(options.instance_cache_size) {
         }
 
         VectorStorePtr CreateInstance(const std::string& instance_id, MetadataSchemaPtr metadata_schema) override {
@@ -69,6 +101,16 @@ namespace INSTINCT_RETRIEVAL_NS {
             instance_metadata.set_embedding_table_name(TableNameForInstance_(instance_id));
             instance_metadata.mutable_metadata_schema()->CopyFrom(*metadata_schema);
             assert_true(metadata_data_mapper_->InsertInstance(instance_metadata), "should have one instance inserted");
+
+            // replace stale entry, e.g. of an instance removed elsewhere
+            std::promise<VectorStorePtr> promise;
+            promise.set_value(vdb_instance);
+            std::optional<std::shared_ptr<CachedInstance>> displaced;
+            {
+                std::lock_guard guard {instance_cache_mutex_};
+                displaced = instance_cache_.Put(instance_id, std::make_shared<CachedInstance>(promise.get_future().share()));
+            }
+            ReleaseInstance_(displaced);
             return vdb_instance;
         }
 
@@ -76,8 +118,74 @@ namespace INSTINCT_RETRIEVAL_NS {
             return CreateInstance(instance_id, default_metadata_schema_);
         }
 
+        /**
+         * Get instance from cache, or load it if it's missing. Only one of concurrent callers loads an uncached instance, and others wait for its result. Missing instances and failed loads are not cached.
+         */
         VectorStorePtr LoadInstance(const std::string &instance_id) override {
             assert_not_blank(instance_id, "should have non-blank instance_id");
+            std::shared_ptr<CachedInstance> entry;
+            std::promise<VectorStorePtr> promise;
+            std::optional<std::shared_ptr<CachedInstance>> evicted;
+            bool is_loader = false;
+            {
+                std::lock_guard guard {instance_cache_mutex_};
+                if (const auto cached = instance_cache_.Get(instance_id)) {
+                    entry = cached.value();
+                } else {
+                    entry = std::make_shared<CachedInstance>(promise.get_future().share());
+                    evicted = instance_cache_.Put(instance_id, entry);
+                    is_loader = true;
+                }
+            }
+            ReleaseInstance_(evicted);
+            if (!is_loader) {
+                return entry->instance.get();
+            }
+
+            try {
+                auto instance = LoadInstance_(instance_id);
+                promise.set_value(instance);
+                if (!instance) {
+                    EvictInstance_(instance_id, entry);
+                }
+                return instance;
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+                EvictInstance_(instance_id, entry);
+                throw;
+            }
+        }
+
+        /**
+         * Drop cached instance, so that it's loaded with latest instance metadata in next `LoadInstance` call
+         */
+        void InvalidateInstance(const std::string& instance_id) override {
+            std::optional<std::shared_ptr<CachedInstance>> invalidated;
+            {
+                std::lock_guard guard {instance_cache_mutex_};
+                invalidated = instance_cache_.Get(instance_id);
+                instance_cache_.Remove(instance_id);
+            }
+            ReleaseInstance_(invalidated);
+        }
+
+        std::vector<std::string> ListInstances() override {
+            const auto ids_view = metadata_data_mapper_->ListInstances() | std::views::transform([](const VectorStoreInstanceMetadata& instance) {
+                return instance.instance_id();
+            });
+            return {ids_view.begin(), ids_view.end()};
+        }
+
+        bool RemoveInstance(const std::string &instance_id) override {
+            if (const auto instance = LoadInstance(instance_id)) {
+                instance->Destroy();
+            }
+            const bool removed = metadata_data_mapper_->RemoveInstance(instance_id) == 1;
+            InvalidateInstance(instance_id);
+            return removed;
+        }
+    private:
+        VectorStorePtr LoadInstance_(const std::string &instance_id) {
             const auto instance = metadata_data_mapper_->GetInstance(instance_id);
             if (!instance) {
                 return nullptr;
@@ -92,20 +200,32 @@ namespace INSTINCT_RETRIEVAL_NS {
             return CreateDuckDBVectorStore(duck_db_, embedding_model, options, metadata_schema);
         }
 
-        std::vector<std::string> ListInstances() override {
-            const auto ids_view = metadata_data_mapper_->ListInstances() | std::views::transform([](const VectorStoreInstanceMetadata& instance) {
-                return instance.instance_id();
-            });
-            return {ids_view.begin(), ids_view.end()};
+        /**
+         * Persist instance of an entry dropped from cache. It should be called without holding `instance_cache_mutex_`, as snapshots are written to database. Entries still being loaded are skipped, and failures are logged, as the dropped instance is still usable by its holders.
+         */
+        void ReleaseInstance_(const std::optional<std::shared_ptr<CachedInstance>>& entry) const {
+            if (!entry || entry.value()->instance.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            try {
+                if (const auto instance = entry.value()->instance.get()) {
+                    instance->Persist();
+                }
+            } catch (const std::exception& e) {
+                LOG_ERROR("Failed to persist instance dropped from cache: {}", e.what());
+            }
         }
 
-        bool RemoveInstance(const std::string &instance_id) override {
-            if (const auto instance = LoadInstance(instance_id)) {
-                instance->Destroy();
+        /**
+         * Remove entry from cache if it's not replaced by others
+         */
+        void EvictInstance_(const std::string& instance_id, const std::shared_ptr<CachedInstance>& entry) {
+            std::lock_guard guard {instance_cache_mutex_};
+            if (const auto cached = instance_cache_.Get(instance_id); cached && cached.value() == entry) {
+                instance_cache_.Remove(instance_id);
             }
-            return metadata_data_mapper_->RemoveInstance(instance_id) == 1;
         }
-    private:
+
         [[nodiscard]] std::string TableNameForInstance_(const std::string& instance_id) const {
             return "vs_" + HashUtils::HashForString<SHA256>(instance_id);
         }
@@ -116,6 +236,7 @@ namespace INSTINCT_RETRIEVAL_NS {
             options.create_or_replace_table = false;
             options.in_memory = false;
             options.bypass_unknown_fields = true;
+            options.shared_connection_pool = connection_pool_;
         }
     };
 
@@ -123,13 +244,14 @@ namespace INSTINCT_RETRIEVAL_NS {
         const DuckDBPtr &db,
         const EmbeddingsPtr& embedding_model,
         const VectorStoreMetadataDataMapperPtr &metadata_data_mapper,
-        MetadataSchemaPtr default_metadata_schema = nullptr
+        MetadataSchemaPtr default_metadata_schema = nullptr,
+        const DuckDBVectorStoreOperatorOptions& options = {}
         ) {
         if (!default_metadata_schema) {
             default_metadata_schema = CreateVectorStorePresetMetadataSchema();
         }
         assert_true(embedding_model, "should provide valid embedding model");
-        return std::make_shared<DuckDBVectorStoreOperator>(db, embedding_model, metadata_data_mapper, default_metadata_schema);
+        return std::make_shared<DuckDBVectorStoreOperator>(db, embedding_model, metadata_data_mapper, default_metadata_schema, options);
     }
 
 }
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include "RetrievalTestGlobals.hpp"
+#include "RetrieverObjectFactory.hpp"
+#include "ingestor/DirectoryTreeIngestor.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    class DirectoryTreeIngestorTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+            corpus_dir = std::filesystem::current_path() / "_corpus";
+            tree_dir = INSTINCT_LLM_NS::ensure_random_temp_folder() / "tree";
+            // file i has i+1 lines, so that files are of different sizes
+            for (int i = 0; i < 120; ++i) {
+                const auto file_path = tree_dir / fmt::format("d{}", i % 3) / fmt::format("s{}", i % 2) / fmt::format("file-{:03}.{}", i, i % 4 == 0 ? "txt" : "md");
+                std::filesystem::create_directories(file_path.parent_path());
+                std::ofstream ofs {file_path};
+                for (int j = 0; j <= i; ++j) {
+                    ofs << file_path.filename().string() << "\n";
+                }
+                file_paths.push_back(file_path);
+            }
+            std::sort(file_paths.begin(), file_paths.end());
+        }
+
+        [[nodiscard]] static std::vector<std::string> LoadTexts(const IngestorPtr& ingestor) {
+            std::vector<std::string> texts;
+            for (const auto& doc: CollectVector(ingestor->Load())) {
+                texts.push_back(doc.text());
+            }
+            return texts;
+        }
+
+        [[nodiscard]] static std::string ReadText(const std::filesystem::path& file_path) {
+            std::ifstream t(file_path);
+            std::stringstream buffer;
+            buffer << t.rdbuf();
+            return buffer.str();
+        }
+
+        std::filesystem::path corpus_dir;
+        std::filesystem::path tree_dir;
+        std::vector<std::filesystem::path> file_paths;
+    };
+
+    TEST_F(DirectoryTreeIngestorTest, MatchGlob) {
+        ASSERT_TRUE(details::match_glob("*.md", "a/b/c.md"));
+        ASSERT_FALSE(details::match_glob("*.md", "a/b/c.txt"));
+        ASSERT_TRUE(details::match_glob("**/*.md", "c.md"));
+        ASSERT_TRUE(details::match_glob("**/*.md", "a/b/c.md"));
+        ASSERT_TRUE(details::match_glob("a/**", "a/b/c.md"));
+        ASSERT_FALSE(details::match_glob("a/*.md", "a/b/c.md"));
+        ASSERT_TRUE(details::match_glob("a/?.md", "a/c.md"));
+        ASSERT_FALSE(details::match_glob("a/?.md", "a/cc.md"));
+    }
+
+    TEST_F(DirectoryTreeIngestorTest, OrderedLoad) {
+        std::vector<std::string> expected;
+        for (const auto& file_path: file_paths) {
+            expected.push_back(ReadText(file_path));
+        }
+        for (const size_t max_concurrency: {1, 4, 16}) {
+            const auto ingestor = RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.max_concurrency = max_concurrency, .ordered = true});
+            ASSERT_EQ(LoadTexts(ingestor), expected);
+        }
+    }
+
+    TEST_F(DirectoryTreeIngestorTest, UnorderedLoad) {
+        std::vector<std::string> expected;
+        for (const auto& file_path: file_paths) {
+            expected.push_back(ReadText(file_path));
+        }
+        std::ranges::sort(expected);
+        const auto ingestor = RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.max_concurrency = 8, .max_buffered_files = 4, .ordered = false});
+        auto texts = LoadTexts(ingestor);
+        std::ranges::sort(texts);
+        ASSERT_EQ(texts, expected);
+    }
+
+    TEST_F(DirectoryTreeIngestorTest, FilterWithGlobs) {
+        const auto ingestor = RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {
+            .include_globs = {"*.md"},
+            .exclude_globs = {"d0/**", "d1/s1/*"}
+        });
+        std::vector<std::string> expected;
+        for (const auto& file_path: file_paths) {
+            const auto relative_path = file_path.lexically_relative(tree_dir).generic_string();
+            if (file_path.extension() == ".md" && !relative_path.starts_with("d0/") && !relative_path.starts_with("d1/s1/")) {
+                expected.push_back(ReadText(file_path));
+            }
+        }
+        ASSERT_FALSE(expected.empty());
+        ASSERT_EQ(LoadTexts(ingestor), expected);
+
+        const auto non_recursive_ingestor = RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.recursive = false});
+        ASSERT_TRUE(LoadTexts(non_recursive_ingestor).empty());
+    }
+
+    TEST_F(DirectoryTreeIngestorTest, ShardBySize) {
+        constexpr size_t shard_count = 3;
+        std::vector<std::string> all_texts;
+        std::vector<uintmax_t> shard_bytes;
+        for (size_t i = 0; i < shard_count; ++i) {
+            const auto texts = LoadTexts(RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.shard_count = shard_count, .shard_index = i}));
+            ASSERT_FALSE(texts.empty());
+            uintmax_t bytes = 0;
+            for (const auto& text: texts) {
+                bytes += text.size();
+                all_texts.push_back(text);
+            }
+            shard_bytes.push_back(bytes);
+        }
+        // shards are disjoint and cover all files
+        std::vector<std::string> expected;
+        for (const auto& file_path: file_paths) {
+            expected.push_back(ReadText(file_path));
+        }
+        std::ranges::sort(expected);
+        std::ranges::sort(all_texts);
+        ASSERT_EQ(all_texts, expected);
+        // shards are balanced by size, within size of the largest file
+        const auto [min_bytes, max_bytes] = std::ranges::minmax(shard_bytes);
+        ASSERT_LE(max_bytes - min_bytes, std::filesystem::file_size(tree_dir / "d2/s1/file-119.md"));
+
+        ASSERT_THROW(RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.shard_count = 2, .shard_index = 2}), InstinctException);
+    }
+
+    TEST_F(DirectoryTreeIngestorTest, LoadMixedFixtures) {
+        // recipes in markdown and documents in word
+        for (const auto& dir: {corpus_dir / "recipes", corpus_dir / "word"}) {
+            std::filesystem::copy(dir, tree_dir / "fixtures" / dir.filename(), std::filesystem::copy_options::recursive);
+        }
+        const auto sequential = CollectVector(RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.max_concurrency = 1})->Load());
+        const auto parallel = CollectVector(RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.max_concurrency = 8})->Load());
+        ASSERT_GT(sequential.size(), file_paths.size());
+        ASSERT_EQ(sequential.size(), parallel.size());
+        for (size_t i = 0; i < sequential.size(); ++i) {
+            ASSERT_EQ(sequential[i].text(), parallel[i].text());
+        }
+    }
+
+    TEST_F(DirectoryTreeIngestorTest, PropagateError) {
+        const auto ingestor = RetrieverObjectFactory::CreateDirectoryTreeIngestor(tree_dir, {.max_concurrency = 4}, nullptr, [](const std::filesystem::path& path) {
+            if (path.filename() == "file-040.txt") {
+                throw InstinctException("cannot parse file");
+            }
+            return RetrieverObjectFactory::CreateIngestor(path);
+        });
+        ASSERT_THROW(CollectVector(ingestor->Load()), InstinctException);
+    }
+
+}
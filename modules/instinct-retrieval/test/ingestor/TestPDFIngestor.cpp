@@ -34,4 +34,14 @@ namespace INSTINCT_RETRIEVAL_NS {
         ASSERT_EQ(docs.size(), 15);
     }
 
+    TEST_F(TestPDFIngestor, LoadPagesInOrder) {
+        const auto docs = CollectVector(PDFFileIngestor {corpus_dir / "papers/attention_is_all_you_need.pdf"}.Load());
+        ASSERT_EQ(docs.size(), 15);
+        for (size_t i = 0; i < docs.size(); ++i) {
+            ASSERT_EQ(DocumentUtils::GetIntValueMetadataField(docs[i], METADATA_SCHEMA_PAGE_NO_KEY), static_cast<int32_t>(i + 1));
+            // no terminator is left in text
+            ASSERT_EQ(docs[i].text().find('\0'), std::string::npos);
+        }
+    }
+
 }
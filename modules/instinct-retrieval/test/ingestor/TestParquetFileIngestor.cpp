@@ -36,5 +36,62 @@ namespace INSTINCT_RETRIEVAL_NS {
         const auto records = CollectVector(ingestor->Load());
         ASSERT_EQ(records.size(), 5);
     }
+
+    TEST_F(ParquetFileIngestorTest, StreamingMatchesNaive) {
+        const std::string mapping = "1:t,0:m:context:varchar,2:m:answer:varchar";
+        const auto naive_records = CollectVector(CreateParquetIngestor(asset_dir_ / "huggingface_doc_qa_eval.parquet", mapping, {.streaming = false})->Load());
+        const auto streaming_records = CollectVector(CreateParquetIngestor(asset_dir_ / "huggingface_doc_qa_eval.parquet", mapping, {.streaming = true})->Load());
+        ASSERT_EQ(naive_records.size(), 67);
+        ASSERT_EQ(streaming_records.size(), naive_records.size());
+        for (size_t i = 0; i < naive_records.size(); ++i) {
+            ASSERT_EQ(streaming_records[i].DebugString(), naive_records[i].DebugString());
+        }
+
+        // column out of range
+        ASSERT_THROW(CollectVector(CreateParquetIngestor(asset_dir_ / "huggingface_doc_qa_eval.parquet", "99:t")->Load()), InstinctException);
+    }
+
+    TEST_F(ParquetFileIngestorTest, StreamRowGroups) {
+        constexpr int row_count = 100000;
+        const auto file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "rows.parquet";
+        {
+            duckdb::DuckDB db(nullptr);
+            duckdb::Connection connection(db);
+            assert_query_ok(connection.Query(fmt::format(
+                "COPY (SELECT i AS row_id, 'text of row ' || i AS text, i * 0.5 AS score, i % 2 = 0 AS flag, 'unused' AS extra FROM range({}) t(i)) TO '{}' (FORMAT PARQUET, ROW_GROUP_SIZE 8192);",
+                row_count,
+                file_path.string())));
+        }
+        const std::string mapping = "1:t,0:m:row_id:int64,2:m:score:double,3:m:flag:bool";
+        const auto get_row_id = [](const Document& document) {
+            for (const auto& field: document.metadata()) {
+                if (field.name() == "row_id") {
+                    return field.long_value();
+                }
+            }
+            return int64_t {-1};
+        };
+
+        // rows are emitted in order of file
+        const auto records = CollectVector(CreateParquetIngestor(file_path, mapping, {.threads = 4})->Load());
+        ASSERT_EQ(records.size(), row_count);
+        for (int i = 0; i < row_count; ++i) {
+            ASSERT_EQ(get_row_id(records[i]), i);
+            ASSERT_EQ(records[i].text(), fmt::format("text of row {}", i));
+            ASSERT_EQ(DocumentUtils::GetIntValueMetadataField(records[i], METADATA_SCHEMA_PAGE_NO_KEY), i + 1);
+        }
+
+        // all rows are emitted in any order
+        const auto unordered_records = CollectVector(CreateParquetIngestor(file_path, mapping, {.threads = 4, .preserve_order = false})->Load());
+        std::vector<int64_t> row_ids;
+        for (const auto& record: unordered_records) {
+            row_ids.push_back(get_row_id(record));
+        }
+        std::ranges::sort(row_ids);
+        ASSERT_EQ(row_ids.size(), row_count);
+        for (int i = 0; i < row_count; ++i) {
+            ASSERT_EQ(row_ids[i], i);
+        }
+    }
 }
 
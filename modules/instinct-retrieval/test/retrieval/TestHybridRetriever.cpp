@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "RetrievalTestGlobals.hpp"
+#include "retrieval/HybridRetriever.hpp"
+#include "retrieval/MultiPathRetriever.hpp"
+#include "retrieval/VectorStoreRetriever.hpp"
+#include "store/duckdb/DuckDBVectorStore.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+    using namespace INSTINCT_LLM_NS;
+
+    class HybridRetrieverTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+            const auto db_file_path = ensure_random_temp_folder() / "test.db";
+            db_ = std::make_shared<DuckDB>(db_file_path);
+            options_ = {.table_name = "hybrid_table", .db_file_path = db_file_path, .dimension = 128};
+            options_.keyword_index.enabled = true;
+            vector_store_ = CreateDuckDBVectorStore(db_, create_hashed_embedding_model(128), options_);
+
+            std::vector<Document> docs;
+            for (int i = 0; i < 500; ++i) {
+                Document document;
+                document.set_text(fmt::format("ticket {} reports error ERR-{} in module {}", i, 10000 + i, i % 7));
+                auto* parent_id = document.mutable_metadata()->Add();
+                parent_id->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+                parent_id->set_string_value(std::to_string(i % 2));
+                DocumentUtils::AddMissingPresetMetadataFields(document);
+                docs.push_back(document);
+            }
+            UpdateResult update_result;
+            vector_store_->AddDocuments(docs, update_result);
+            ASSERT_EQ(update_result.affected_rows(), 500);
+        }
+
+        DuckDBPtr db_;
+        DuckDBStoreOptions options_;
+        VectorStorePtr vector_store_;
+    };
+
+    TEST_F(HybridRetrieverTest, SearchDocumentsByKeywords) {
+        SearchRequest search_request;
+        search_request.set_query("what does err-10042 mean");
+        search_request.set_top_k(5);
+        auto docs = CollectVector(vector_store_->SearchDocumentsByKeywords(search_request));
+        ASSERT_FALSE(docs.empty());
+        ASSERT_EQ(docs[0].text(), "ticket 42 reports error ERR-10042 in module 0");
+
+        // metadata filter is applied, and enough documents are returned
+        search_request.set_query("error module");
+        search_request.set_top_k(20);
+        auto* term = search_request.mutable_metadata_filter()->mutable_term();
+        term->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+        term->mutable_term()->set_string_value("1");
+        docs = CollectVector(vector_store_->SearchDocumentsByKeywords(search_request));
+        ASSERT_EQ(docs.size(), 20);
+
+        // deleted documents are not recalled
+        UpdateResult delete_result;
+        vector_store_->DeleteDocuments(std::vector {docs[0].id()}, delete_result);
+        search_request.clear_metadata_filter();
+        search_request.set_query(docs[0].text());
+        search_request.set_top_k(500);
+        for (const auto& doc: CollectVector(vector_store_->SearchDocumentsByKeywords(search_request))) {
+            ASSERT_NE(doc.id(), docs[0].id());
+        }
+
+        // index is rebuilt from table by another store instance
+        const auto reopened_store = CreateDuckDBVectorStore(db_, vector_store_->GetEmbeddingModel(), options_);
+        search_request.set_query("ERR-10042");
+        search_request.set_top_k(1);
+        ASSERT_EQ(CollectVector(reopened_store->SearchDocumentsByKeywords(search_request))[0].text(), "ticket 42 reports error ERR-10042 in module 0");
+
+        // index is reloaded after writes of another store instance, even if row count is unchanged
+        UpdateResult replace_result;
+        reopened_store->DeleteDocuments(std::vector {docs[1].id()}, replace_result);
+        ASSERT_EQ(replace_result.affected_rows(), 1);
+        Document replacement;
+        replacement.set_text("ticket 9999 reports error ERR-19999 in module 0");
+        DocumentUtils::AddMissingPresetMetadataFields(replacement);
+        reopened_store->AddDocument(replacement);
+        search_request.set_query("ERR-19999");
+        ASSERT_EQ(CollectVector(vector_store_->SearchDocumentsByKeywords(search_request))[0].id(), replacement.id());
+    }
+
+    TEST_F(HybridRetrieverTest, Retrieve) {
+        // embeddings of hashed model have nothing to do with keywords, so it's found by keyword path, which is weighted higher to break tie with top-1 of vector path
+        const auto retriever = CreateHybridRetriever(vector_store_, {.vector_weight = 0.5});
+        const auto docs = CollectVector(retriever->Retrieve({.text = "ERR-10123", .top_k = 10}));
+        ASSERT_EQ(docs.size(), 10);
+        ASSERT_EQ(docs[0].text(), "ticket 123 reports error ERR-10123 in module 4");
+
+        // keyword path is ignored if its weight is zero
+        const auto vector_only = CreateHybridRetriever(vector_store_, {.keyword_weight = 0});
+        SearchRequest search_request;
+        search_request.set_query("ERR-10123");
+        search_request.set_top_k(10);
+        const auto expected = CollectVector(vector_store_->SearchDocuments(search_request));
+        const auto actual = CollectVector(vector_only->Retrieve(search_request));
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_EQ(actual[i].id(), expected[i].id());
+        }
+
+        // pluggable into multi-path retriever. another store is used as paths are executed concurrently.
+        const auto other_store = CreateDuckDBVectorStore(create_hashed_embedding_model(128), {.table_name = "other_table", .dimension = 128, .in_memory = true});
+        Document other_doc;
+        other_doc.set_text("ticket 0 is closed");
+        DocumentUtils::AddMissingPresetMetadataFields(other_doc);
+        other_store->AddDocument(other_doc);
+        const auto multi_path_retriever = CreateMultiPathRetriever(
+            create_keyword_ranking_model(),
+            retriever,
+            CreateVectorStoreRetriever(other_store)
+        );
+        ASSERT_EQ(CollectVector(multi_path_retriever->Retrieve(search_request))[0].text(), "ticket 123 reports error ERR-10123 in module 4");
+
+        // batch retrieval asks each path once, and re-ranks recalled documents for each query
+        BatchSearchRequest batch_request;
+        batch_request.add_queries("ERR-10123");
+        batch_request.add_queries("ticket 0");
+        batch_request.set_top_k(10);
+        const auto batch_result = multi_path_retriever->BatchRetrieve(batch_request);
+        ASSERT_EQ(batch_result.results_size(), 2);
+        ASSERT_EQ(batch_result.results(0).documents(0).text(), "ticket 123 reports error ERR-10123 in module 4");
+        ASSERT_LE(batch_result.results(1).documents_size(), 10);
+    }
+
+}
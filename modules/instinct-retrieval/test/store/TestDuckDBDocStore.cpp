@@ -227,4 +227,147 @@ namespace INSTINCT_RETRIEVAL_NS {
     }
 
 
+    TEST_F(DuckDBDocStoreTest, StreamingIngestion) {
+        std::vector<IngestionProgress> progresses;
+        DuckDBStoreOptions options {.table_name = "streaming_table", .in_memory = true};
+        options.ingestion.chunk_size = 7;
+        options.ingestion.on_progress = [&](const IngestionProgress& progress) {
+            progresses.push_back(progress);
+        };
+        const auto doc_store = CreateDuckDBDocStore(options);
+
+        constexpr int n = 50;
+        const auto doc_source = rpp::source::create<Document>([](const auto& observer) {
+            for (int i = 0; i < n; ++i) {
+                Document doc;
+                doc.set_text(fmt::format("streamed doc {}", i));
+                // a document lacking metadata fails alone, without affecting others in the same chunk
+                if (i != 10) {
+                    DocumentUtils::AddMissingPresetMetadataFields(doc);
+                }
+                observer.on_next(doc);
+            }
+            observer.on_completed();
+        });
+        UpdateResult update_result;
+        doc_store->AddDocuments(doc_source, update_result);
+
+        ASSERT_EQ(update_result.affected_rows(), n - 1);
+        ASSERT_EQ(update_result.failed_documents_size(), 1);
+        ASSERT_EQ(update_result.failed_documents(0).text(), "streamed doc 10");
+        ASSERT_EQ(doc_store->CountDocuments(), n - 1);
+
+        ASSERT_EQ(progresses.size(), 8);
+        ASSERT_EQ(progresses.back().chunk_count, 8);
+        ASSERT_EQ(progresses.back().row_count, n - 1);
+        ASSERT_EQ(progresses.back().failed_count, 1);
+        ASSERT_EQ(progresses.front().row_count, 7);
+
+        std::unordered_set<std::string> ids {update_result.returned_ids().begin(), update_result.returned_ids().end()};
+        for (const auto& id: ids) {
+            // random UUID of version 4
+            ASSERT_EQ(id.size(), 36);
+            ASSERT_EQ(id[14], '4');
+        }
+        ASSERT_EQ(CollectVector(doc_store->MultiGetDocuments({update_result.returned_ids(0)})).size(), 1);
+    }
+
+
+    TEST_F(DuckDBDocStoreTest, BulkMultiGetAndDelete) {
+        // ids are bound in chunks of 7
+        const auto doc_store = CreateDuckDBDocStore({.table_name = "bulk_table", .in_memory = true, .max_ids_per_statement = 7});
+        constexpr int n = 30;
+        std::vector<Document> docs;
+        for (int i = 0; i < n; ++i) {
+            Document doc;
+            doc.set_text(fmt::format("doc {}", i));
+            DocumentUtils::AddMissingPresetMetadataFields(doc);
+            docs.push_back(doc);
+        }
+        UpdateResult update_result;
+        doc_store->AddDocuments(docs, update_result);
+        ASSERT_EQ(update_result.affected_rows(), n);
+        const std::vector<std::string> ids {update_result.returned_ids().begin(), update_result.returned_ids().end()};
+
+        // unknown ids are ignored
+        std::vector<std::string> mget_ids = ids;
+        mget_ids.emplace_back("00000000-0000-4000-8000-000000000000");
+        const auto found = CollectVector(doc_store->MultiGetDocuments(mget_ids));
+        ASSERT_EQ(found.size(), n);
+        std::unordered_set<std::string> found_ids;
+        for (const auto& doc: found) {
+            found_ids.insert(doc.id());
+        }
+        ASSERT_EQ(found_ids, std::unordered_set<std::string>(ids.begin(), ids.end()));
+        ASSERT_EQ(CollectVector(doc_store->MultiGetDocuments({ids[3]})).front().text(), "doc 3");
+        ASSERT_TRUE(CollectVector(doc_store->MultiGetDocuments({})).empty());
+
+        // delete all but the last one
+        UpdateResult delete_result;
+        doc_store->DeleteDocuments({ids.begin(), ids.end() - 1}, delete_result);
+        ASSERT_EQ(delete_result.affected_rows(), n - 1);
+        ASSERT_EQ(doc_store->CountDocuments(), 1);
+        ASSERT_EQ(CollectVector(doc_store->MultiGetDocuments(ids)).size(), 1);
+    }
+
+    TEST_F(DuckDBDocStoreTest, ConvertAllFieldTypes) {
+        const auto schema_builder = MetadataSchemaBuilder::Create();
+        schema_builder->DefineString("name");
+        schema_builder->DefineInt32("age");
+        schema_builder->DefineInt64("population");
+        schema_builder->DefineFloat("weight");
+        schema_builder->DefineDouble("height");
+        schema_builder->DefineBool("endangered");
+        const auto schema = schema_builder->Build();
+        const auto doc_store = CreateDuckDBDocStore({.table_name = "typed_animal_table", .in_memory = true}, schema);
+
+        Document doc;
+        doc.set_text("Alpacas are domesticated camelids");
+        DocumentUtils::SetStringValueMetadataFiled(doc, "name", "Alpaca");
+        DocumentUtils::SetIntValueMetadataFiled(doc, "age", 12);
+        auto* population = doc.add_metadata();
+        population->set_name("population");
+        population->set_long_value(3000000000L);
+        auto* weight = doc.add_metadata();
+        weight->set_name("weight");
+        weight->set_float_value(64.5f);
+        auto* height = doc.add_metadata();
+        height->set_name("height");
+        height->set_double_value(0.91);
+        auto* endangered = doc.add_metadata();
+        endangered->set_name("endangered");
+        endangered->set_bool_value(false);
+        doc_store->AddDocument(doc);
+
+        // a row with null metadata
+        const auto base_store = std::dynamic_pointer_cast<BaseDuckDBStore>(doc_store);
+        const auto insert_result = base_store->GetConnection().Query("INSERT INTO typed_animal_table(id, text) VALUES ('5b8f0c3a-2f5e-4c9b-9a57-7f0e3d1c2b4a', 'unknown animal');");
+        ASSERT_TRUE(check_query_ok(insert_result));
+
+        FindRequest find_request;
+        find_request.add_sorters()->mutable_field()->set_field_name("text");
+        const auto docs = CollectVector(doc_store->FindDocuments(find_request));
+        ASSERT_EQ(docs.size(), 2);
+
+        const auto& found = docs[0];
+        ASSERT_EQ(found.id(), doc.id());
+        ASSERT_EQ(found.text(), doc.text());
+        ASSERT_EQ(found.metadata_size(), 6);
+        ASSERT_EQ(found.metadata(0).string_value(), "Alpaca");
+        ASSERT_EQ(found.metadata(1).int_value(), 12);
+        ASSERT_EQ(found.metadata(2).long_value(), 3000000000L);
+        ASSERT_FLOAT_EQ(found.metadata(3).float_value(), 64.5f);
+        ASSERT_DOUBLE_EQ(found.metadata(4).double_value(), 0.91);
+        ASSERT_TRUE(found.metadata(5).has_bool_value());
+        ASSERT_FALSE(found.metadata(5).bool_value());
+
+        const auto& unknown = docs[1];
+        ASSERT_EQ(unknown.id(), "5b8f0c3a-2f5e-4c9b-9a57-7f0e3d1c2b4a");
+        ASSERT_EQ(unknown.metadata_size(), 6);
+        for (const auto& field: unknown.metadata()) {
+            ASSERT_TRUE(field.is_null());
+        }
+    }
+
+
 }
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "RetrievalTestGlobals.hpp"
+#include "embedding_model/CachedEmbeddingModel.hpp"
+#include "store/duckdb/DuckDBEmbeddingCacheStore.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    class DuckDBEmbeddingCacheStoreTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+    };
+
+    TEST_F(DuckDBEmbeddingCacheStoreTest, MultiGetAndMultiPut) {
+        const auto db = std::make_shared<DuckDB>(nullptr);
+        const auto store = CreateDuckDBEmbeddingCacheStore(db);
+        ASSERT_TRUE(store->MultiGet({"k1"}).empty());
+        ASSERT_TRUE(store->MultiGet({}).empty());
+
+        store->MultiPut({{"k1", {1.0f, 2.0f}}, {"k2", {3.0f, 4.0f, 5.0f}}});
+        // existing entry is kept
+        store->MultiPut({{"k1", {0.0f, 0.0f}}});
+        const auto result = store->MultiGet({"k1", "k2", "k3"});
+        ASSERT_EQ(result.size(), 2);
+        ASSERT_EQ(result.at("k1"), (Embedding {1.0f, 2.0f}));
+        ASSERT_EQ(result.at("k2"), (Embedding {3.0f, 4.0f, 5.0f}));
+    }
+
+    TEST_F(DuckDBEmbeddingCacheStoreTest, MultiPutAcrossChunks) {
+        const auto db = std::make_shared<DuckDB>(nullptr);
+        const auto store = CreateDuckDBEmbeddingCacheStore(db);
+        // more entries than a single data chunk, with a duplicated key
+        std::vector<std::pair<std::string, Embedding>> entries;
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < 5000; ++i) {
+            entries.emplace_back(fmt::format("k{}", i), Embedding(i % 7 + 1, static_cast<float>(i)));
+            keys.push_back(entries.back().first);
+        }
+        entries.emplace_back("k0", Embedding {1.0f});
+        store->MultiPut(entries);
+        const auto result = store->MultiGet(keys);
+        ASSERT_EQ(result.size(), 5000);
+        for (size_t i = 0; i < 5000; ++i) {
+            ASSERT_EQ(result.at(keys[i]), entries[i].second);
+        }
+    }
+
+    TEST_F(DuckDBEmbeddingCacheStoreTest, SurviveRestart) {
+        const auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "cache.db";
+        const auto embeddings = INSTINCT_LLM_NS::create_hashed_embedding_model(64);
+        const std::vector<std::string> texts {"llama", "alpaca", "vicuna"};
+        std::vector<Embedding> expected;
+        {
+            const auto db = std::make_shared<DuckDB>(db_file_path);
+            const auto cached = CreateCachedEmbeddingModel(embeddings, {.model_name = "hashed"}, CreateDuckDBEmbeddingCacheStore(db));
+            expected = cached->EmbedDocuments(texts);
+            ASSERT_EQ(cached->GetStats().miss_count, 3);
+        }
+
+        const auto db = std::make_shared<DuckDB>(db_file_path);
+        const auto cached = CreateCachedEmbeddingModel(embeddings, {.model_name = "hashed"}, CreateDuckDBEmbeddingCacheStore(db));
+        ASSERT_EQ(cached->EmbedDocuments(texts), expected);
+        const auto stats = cached->GetStats();
+        ASSERT_EQ(stats.miss_count, 0);
+        ASSERT_EQ(stats.persistent_hit_count, 3);
+    }
+
+}
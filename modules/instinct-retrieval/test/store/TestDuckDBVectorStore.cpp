@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 #include <random>
 #include <ranges>
+#include <unordered_set>
 #include "RetrievalGlobals.hpp"
 #include "store/duckdb/DuckDBVectorStore.hpp"
 #include "tools/ChronoUtils.hpp"
@@ -44,20 +45,32 @@ namespace INSTINCT_RETRIEVAL_NS {
         auto predicate = mq.mutable_term();
         predicate->set_name("address");
         predicate->mutable_term()->set_string_value("shanghai");
-        auto sql = details::make_search_sql("tb1", s1, INSTINCT_LLM_NS::make_zero_vector(), mq);
+        SQLParameters parameters;
+        auto sql = details::make_search_sql("tb1", s1, 128, mq, parameters);
         std::cout << sql << std::endl;
-        ASSERT_EQ(sql, "SELECT id, text, name, address, age, array_cosine_similarity(vector, array_value(0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT)) AS similarity FROM tb1 WHERE address = 'shanghai' ORDER BY similarity DESC LIMIT 10;");
+        ASSERT_EQ(sql, "SELECT id, text, name, address, age, array_cosine_similarity(vector, ?::FLOAT[128]) AS similarity FROM tb1 WHERE address = ? ORDER BY similarity DESC LIMIT ?;");
+        ASSERT_EQ(parameters.size(), 2);
+        ASSERT_EQ(parameters[0].string_value(), "shanghai");
+        ASSERT_EQ(parameters[1].long_value(), 10);
 
-        sql = details::make_search_sql("tb1", s1, INSTINCT_LLM_NS::make_zero_vector(), SearchQuery {});
-        std::cout << sql << std::endl;
-        ASSERT_EQ(sql, "SELECT id, text, name, address, age, array_cosine_similarity(vector, array_value(0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT,0.000000::FLOAT)) AS similarity FROM tb1 ORDER BY similarity DESC LIMIT 10;");
+        // same shape of filter results in same sql
+        predicate->mutable_term()->set_string_value("beijing");
+        parameters.clear();
+        ASSERT_EQ(details::make_search_sql("tb1", s1, 128, mq, parameters, 5), sql);
+        ASSERT_EQ(parameters[0].string_value(), "beijing");
+        ASSERT_EQ(parameters[1].long_value(), 5);
 
+        parameters.clear();
+        sql = details::make_search_sql("tb1", s1, 128, SearchQuery {}, parameters);
+        std::cout << sql << std::endl;
+        ASSERT_EQ(sql, "SELECT id, text, name, address, age, array_cosine_similarity(vector, ?::FLOAT[128]) AS similarity FROM tb1 ORDER BY similarity DESC LIMIT ?;");
+        ASSERT_EQ(parameters.size(), 1);
     }
 
     TEST_F(DuckDBVectorStoreTest, make_delete_sql) {
-        auto sql = details::make_delete_sql("tb1", std::vector<std::string>{"1","2","3","4"});
+        auto sql = details::make_delete_sql("tb1");
         std::cout << sql << std::endl;
-        ASSERT_EQ(sql, "DELETE FROM tb1 WHERE id IN ('1','2','3','4');");
+        ASSERT_EQ(sql, "DELETE FROM tb1 WHERE id IN (SELECT UNNEST(?::UUID[]));");
     }
 
     TEST_F(DuckDBVectorStoreTest, TestSimpleRecall) {
@@ -102,6 +115,188 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     }
 
+    TEST_F(DuckDBVectorStoreTest, AppendEmbeddingsInChunks) {
+        constexpr size_t dim = 16;
+        // more rows than a single data chunk can hold
+        constexpr int n = 3000;
+        const auto db = std::make_shared<DuckDB>(nullptr);
+        const auto embeddings = INSTINCT_LLM_NS::create_hashed_embedding_model(dim);
+        const auto store = CreateDuckDBVectorStore(db, embeddings, {.table_name = "chunked_table", .dimension = dim}, s1);
+
+        std::vector<Document> docs;
+        for (int i = 0; i < n; ++i) {
+            Document document;
+            document.set_text(fmt::format("doc {}", i));
+            DocumentUtils::SetStringValueMetadataFiled(document, "name", fmt::format("name {}", i));
+            auto* address = document.add_metadata();
+            address->set_name("address");
+            if (i % 3 == 0) {
+                address->set_is_null(true);
+            } else {
+                address->set_string_value(fmt::format("address {}", i));
+            }
+            auto* age = document.add_metadata();
+            age->set_name("age");
+            // value of other type is cast to column type
+            if (i % 2 == 0) {
+                age->set_int_value(i);
+            } else {
+                age->set_long_value(i);
+            }
+            docs.push_back(document);
+        }
+        // a document without required metadata fails alone
+        Document bad_document;
+        bad_document.set_text("bad doc");
+        docs.push_back(bad_document);
+
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        ASSERT_EQ(update_result.affected_rows(), n);
+        ASSERT_EQ(update_result.failed_documents_size(), 1);
+        ASSERT_EQ(update_result.returned_ids_size(), n);
+
+        Connection connection(*db);
+        const auto result = connection.Query("SELECT id::VARCHAR, text, vector, name, address, age FROM chunked_table;");
+        ASSERT_FALSE(result->HasError());
+        ASSERT_EQ(result->RowCount(), n);
+        std::unordered_set<std::string> returned_ids {update_result.returned_ids().begin(), update_result.returned_ids().end()};
+        for (idx_t row = 0; row < result->RowCount(); ++row) {
+            ASSERT_TRUE(returned_ids.contains(result->GetValue(0, row).ToString()));
+            const auto text = result->GetValue(1, row).ToString();
+            const int i = std::stoi(text.substr(4));
+            const auto expected = embeddings->EmbedQuery(text);
+            const auto& components = ArrayValue::GetChildren(result->GetValue(2, row));
+            ASSERT_EQ(components.size(), dim);
+            for (size_t j = 0; j < dim; ++j) {
+                ASSERT_EQ(components[j].GetValue<float>(), expected[j]);
+            }
+            ASSERT_EQ(result->GetValue(3, row).ToString(), fmt::format("name {}", i));
+            if (i % 3 == 0) {
+                ASSERT_TRUE(result->GetValue(4, row).IsNull());
+            } else {
+                ASSERT_EQ(result->GetValue(4, row).ToString(), fmt::format("address {}", i));
+            }
+            ASSERT_EQ(result->GetValue(5, row).GetValue<int32_t>(), i);
+        }
+
+        // ids are found with the same UUID encoding
+        ASSERT_EQ(CollectVector(store->MultiGetDocuments({update_result.returned_ids(42)})).front().text(), docs[42].text());
+    }
+
+    /**
+     * Embedding model failing for any call that contains a poisoned text
+     */
+    class PoisonedEmbeddings final: public IEmbeddingModel {
+        HashedEmbeddings embeddings_;
+        std::string poison_;
+    public:
+        std::atomic<int> concurrent_calls = 0;
+        std::atomic<int> max_concurrent_calls = 0;
+
+        PoisonedEmbeddings(const size_t dim, std::string poison): embeddings_(dim), poison_(std::move(poison)) {}
+
+        std::vector<Embedding> EmbedDocuments(const std::vector<std::string>& texts) override {
+            const int calls = ++concurrent_calls;
+            int max_calls = max_concurrent_calls;
+            while (calls > max_calls && !max_concurrent_calls.compare_exchange_weak(max_calls, calls)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds {5});
+            --concurrent_calls;
+            if (std::ranges::find(texts, poison_) != texts.end()) {
+                throw InstinctException("poisoned");
+            }
+            return embeddings_.EmbedDocuments(texts);
+        }
+
+        Embedding EmbedQuery(const std::string& text) override {
+            return EmbedDocuments({text}).front();
+        }
+
+        size_t GetDimension() override {
+            return embeddings_.GetDimension();
+        }
+    };
+
+    TEST_F(DuckDBVectorStoreTest, PipelinedIngestion) {
+        constexpr size_t dim = 16;
+        constexpr int n = 50;
+        const auto embeddings = std::make_shared<PoisonedEmbeddings>(dim, "doc 20");
+        std::vector<IngestionProgress> progresses;
+        DuckDBStoreOptions options {.table_name = "pipelined_table", .dimension = dim, .in_memory = true};
+        options.ingestion.embedding_batch_size = 8;
+        options.ingestion.max_in_flight_embedding_batches = 3;
+        options.ingestion.on_batch_appended = [&](const IngestionProgress& progress) {
+            progresses.push_back(progress);
+        };
+        const auto store = CreateDuckDBVectorStore(embeddings, options);
+
+        std::vector<Document> docs;
+        for (int i = 0; i < n; ++i) {
+            Document document;
+            document.set_text(fmt::format("doc {}", i));
+            DocumentUtils::AddMissingPresetMetadataFields(document);
+            docs.push_back(document);
+        }
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+
+        // batch of docs 16 to 23 fails alone
+        ASSERT_EQ(update_result.affected_rows(), n - 8);
+        ASSERT_EQ(update_result.failed_documents_size(), 8);
+        ASSERT_EQ(update_result.failed_documents(0).text(), "doc 16");
+        ASSERT_EQ(store->CountDocuments(), n - 8);
+        ASSERT_GT(embeddings->max_concurrent_calls, 1);
+        ASSERT_LE(embeddings->max_concurrent_calls, 3);
+
+        // one callback for each batch
+        ASSERT_EQ(progresses.size(), 7);
+        ASSERT_EQ(progresses[1].row_count, 16);
+        ASSERT_EQ(progresses[2].row_count, 16);
+        ASSERT_EQ(progresses[2].failed_count, 8);
+        ASSERT_EQ(progresses.back().chunk_count, 7);
+        ASSERT_EQ(progresses.back().row_count, n - 8);
+
+        // ids are returned in order of input, and embeddings are matched with their documents
+        ASSERT_EQ(update_result.returned_ids(16), docs[24].id());
+        SearchRequest search_request;
+        search_request.set_query("doc 42");
+        search_request.set_top_k(1);
+        ASSERT_EQ(CollectVector(store->SearchDocuments(search_request)).front().text(), "doc 42");
+    }
+
+    TEST_F(DuckDBVectorStoreTest, FindDocumentsSkipsVectorColumn) {
+        const auto store = CreateDuckDBVectorStore(
+            INSTINCT_LLM_NS::create_hashed_embedding_model(16),
+            {.table_name = "find_table", .dimension = 16, .in_memory = true},
+            s1
+        );
+        std::vector<Document> docs;
+        for (int i = 0; i < 3; ++i) {
+            Document document;
+            document.set_text(fmt::format("doc {}", i));
+            DocumentUtils::SetStringValueMetadataFiled(document, "name", fmt::format("name {}", i));
+            DocumentUtils::SetStringValueMetadataFiled(document, "address", fmt::format("address {}", i));
+            DocumentUtils::SetIntValueMetadataFiled(document, "age", i);
+            docs.push_back(document);
+        }
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        ASSERT_EQ(update_result.affected_rows(), 3);
+
+        // `SELECT *` contains `vector` column between `text` and metadata columns
+        FindRequest find_request;
+        find_request.add_sorters()->mutable_field()->set_field_name("age");
+        const auto found = CollectVector(store->FindDocuments(find_request));
+        ASSERT_EQ(found.size(), 3);
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_EQ(found[i].id(), docs[i].id());
+            ASSERT_EQ(found[i].text(), docs[i].text());
+            ASSERT_EQ(DocumentUtils::GetStringValueMetadataField(found[i], "name"), fmt::format("name {}", i));
+            ASSERT_EQ(DocumentUtils::GetStringValueMetadataField(found[i], "address"), fmt::format("address {}", i));
+            ASSERT_EQ(DocumentUtils::GetIntValueMetadataField(found[i], "age"), i);
+        }
+    }
+
     TEST_F(DuckDBVectorStoreTest, SearchWithFilter) {
         size_t dim = 128;
         auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "test.db";
@@ -142,9 +337,363 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     }
 
+    TEST_F(DuckDBVectorStoreTest, SearchWithHNSWIndex) {
+        constexpr size_t dim = 128;
+        constexpr int n = 20000, k = 10;
+        auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "test.db";
+        LOG_INFO("db_file_path={}", db_file_path);
+        auto embeddings = INSTINCT_LLM_NS::create_pesudo_embedding_model(dim);
+        const auto db = std::make_shared<DuckDB>(db_file_path);
+        DuckDBStoreOptions options = { .table_name = "test_table_1", .db_file_path = db_file_path, .dimension = dim};
+        const auto exact_store = CreateDuckDBVectorStore(db, embeddings, options);
+        options.vector_index.enabled = true;
+        options.vector_index.ef_search = 128;
+        const auto indexed_store = CreateDuckDBVectorStore(db, embeddings, options);
+
+        std::vector<Document> docs;
+        for (const int i: std::views::iota (0,n)) {
+            Document document;
+            document.set_text(std::to_string(i));
+            auto* parent_id = document.mutable_metadata()->Add();
+            parent_id->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+            parent_id->set_string_value(std::to_string(i % 2));
+            DocumentUtils::AddMissingPresetMetadataFields(document);
+            docs.push_back(document);
+        }
+        UpdateResult update_result;
+        indexed_store->AddDocuments(docs, update_result);
+        ASSERT_EQ(update_result.affected_rows(), n);
+
+        // recall@k against exact path, with and without metadata filter
+        for (const bool with_filter: {false, true}) {
+            long exact_rt = 0, indexed_rt = 0;
+            size_t hits = 0, total = 0;
+            for (int i = 0; i < 50; ++i) {
+                SearchRequest search_request;
+                search_request.set_query(std::to_string(i * 397 % n));
+                search_request.set_top_k(k);
+                if (with_filter) {
+                    auto* term = search_request.mutable_metadata_filter()->mutable_term();
+                    term->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+                    term->mutable_term()->set_string_value("1");
+                }
+                auto t1 = ChronoUtils::GetCurrentTimeMillis();
+                const auto expected = CollectVector(exact_store->SearchDocuments(search_request));
+                exact_rt += ChronoUtils::GetCurrentTimeMillis() - t1;
+                t1 = ChronoUtils::GetCurrentTimeMillis();
+                const auto actual = CollectVector(indexed_store->SearchDocuments(search_request));
+                indexed_rt += ChronoUtils::GetCurrentTimeMillis() - t1;
+
+                ASSERT_EQ(actual.size(), k);
+                std::unordered_set<std::string> expected_ids;
+                for (const auto& doc: expected) {
+                    expected_ids.insert(doc.id());
+                }
+                for (const auto& doc: actual) {
+                    if (with_filter) {
+                        ASSERT_EQ(std::stoi(doc.text()) % 2, 1);
+                    }
+                    hits += expected_ids.contains(doc.id());
+                    total++;
+                }
+            }
+            const auto recall = static_cast<double>(hits) / total;
+            LOG_INFO("with_filter={}, recall@{}={}, exact_avg_rt={}ms, hnsw_avg_rt={}ms", with_filter, k, recall, exact_rt/50.0, indexed_rt/50.0);
+            ASSERT_GT(recall, 0.8);
+        }
+
+        // index should be restored from snapshot table
+        const auto reloaded_store = CreateDuckDBVectorStore(db, embeddings, options);
+        SearchRequest search_request;
+        search_request.set_query("42");
+        search_request.set_top_k(1);
+        ASSERT_EQ(CollectVector(reloaded_store->SearchDocuments(search_request))[0].text(), "42");
+
+        // deleted documents should never be recalled
+        UpdateResult delete_result;
+        const auto top_1 = CollectVector(indexed_store->SearchDocuments(search_request));
+        indexed_store->DeleteDocuments({top_1[0].id()}, delete_result);
+        for (const auto& doc: CollectVector(indexed_store->SearchDocuments(search_request))) {
+            ASSERT_NE(doc.id(), top_1[0].id());
+        }
+        // and the stale index in another store instance should be refreshed
+        for (const auto& doc: CollectVector(reloaded_store->SearchDocuments(search_request))) {
+            ASSERT_NE(doc.id(), top_1[0].id());
+        }
+    }
+
+    TEST_F(DuckDBVectorStoreTest, PersistHNSWIndexLazily) {
+        constexpr size_t dim = 32;
+        auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "test.db";
+        const auto embeddings = INSTINCT_LLM_NS::create_pesudo_embedding_model(dim);
+        const auto db = std::make_shared<DuckDB>(db_file_path);
+        DuckDBStoreOptions options = { .table_name = "test_table_1", .db_file_path = db_file_path, .dimension = dim};
+        options.vector_index.enabled = true;
+        options.vector_index.snapshot_interval = 100;
+        auto store = CreateDuckDBVectorStore(db, embeddings, options);
+        const auto read_snapshot_version = [&] {
+            Connection connection {*db};
+            const auto result = connection.Query("SELECT max(version) FROM test_table_1_hnsw;");
+            assert_query_ok(result);
+            return result->GetValue(0, 0).GetValue<int64_t>();
+        };
+        // empty graph is written when index is built
+        ASSERT_EQ(read_snapshot_version(), 1);
+
+        const auto add_documents = [&](const int offset, const int count) {
+            std::vector<Document> docs;
+            for (int i = offset; i < offset + count; ++i) {
+                Document document;
+                document.set_text(std::to_string(i));
+                DocumentUtils::AddMissingPresetMetadataFields(document);
+                docs.push_back(document);
+            }
+            UpdateResult update_result;
+            store->AddDocuments(docs, update_result);
+            ASSERT_EQ(update_result.affected_rows(), count);
+        };
+        for (int i = 0; i < 9; ++i) {
+            add_documents(i * 10, 10);
+        }
+        ASSERT_EQ(read_snapshot_version(), 1);
+        add_documents(90, 10);
+        ASSERT_EQ(read_snapshot_version(), 2);
+
+        // pending changes are written by `Persist`, and graph is restored from them
+        add_documents(100, 10);
+        ASSERT_EQ(read_snapshot_version(), 2);
+        store->Persist();
+        ASSERT_EQ(read_snapshot_version(), 3);
+        store.reset();
+        store = CreateDuckDBVectorStore(db, embeddings, options);
+        ASSERT_EQ(read_snapshot_version(), 3);
+        ASSERT_EQ(store->CountDocuments(), 110);
 
+        // pending changes are never written on destruction, so that stale snapshot is rebuilt on next load
+        add_documents(110, 10);
+        store.reset();
+        ASSERT_EQ(read_snapshot_version(), 3);
+        store = CreateDuckDBVectorStore(db, embeddings, options);
+        ASSERT_EQ(read_snapshot_version(), 4);
+        ASSERT_EQ(store->CountDocuments(), 120);
+    }
 
+    TEST_F(DuckDBVectorStoreTest, SearchWithQuantizedVectors) {
+        constexpr size_t dim = 128;
+        constexpr int n = 10000, k = 10;
+        const auto embeddings = INSTINCT_LLM_NS::create_hashed_embedding_model(dim);
+        for (const auto type: {kInt8Quantization, kProductQuantization}) {
+            auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "test.db";
+            const auto db = std::make_shared<DuckDB>(db_file_path);
+            DuckDBStoreOptions options = { .table_name = "test_table_1", .db_file_path = db_file_path, .dimension = dim};
+            const auto exact_store = CreateDuckDBVectorStore(db, embeddings, options);
+            options.vector_quantization.type = type;
+            const auto quantized_store = CreateDuckDBVectorStore(db, embeddings, options);
 
+            std::vector<Document> docs;
+            for (const int i: std::views::iota (0,n)) {
+                Document document;
+                document.set_text(std::to_string(i));
+                auto* parent_id = document.mutable_metadata()->Add();
+                parent_id->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+                parent_id->set_string_value(std::to_string(i % 2));
+                DocumentUtils::AddMissingPresetMetadataFields(document);
+                docs.push_back(document);
+            }
+            UpdateResult update_result;
+            quantized_store->AddDocuments(docs, update_result);
+            ASSERT_EQ(update_result.affected_rows(), n);
 
+            // recall@k against exact path, with and without metadata filter
+            for (const bool with_filter: {false, true}) {
+                size_t hits = 0, total = 0;
+                for (int i = 0; i < 50; ++i) {
+                    SearchRequest search_request;
+                    search_request.set_query("query " + std::to_string(i));
+                    search_request.set_top_k(k);
+                    if (with_filter) {
+                        auto* term = search_request.mutable_metadata_filter()->mutable_term();
+                        term->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+                        term->mutable_term()->set_string_value("1");
+                    }
+                    const auto expected = CollectVector(exact_store->SearchDocuments(search_request));
+                    const auto actual = CollectVector(quantized_store->SearchDocuments(search_request));
+                    ASSERT_EQ(actual.size(), k);
+                    std::unordered_set<std::string> expected_ids;
+                    for (const auto& doc: expected) {
+                        expected_ids.insert(doc.id());
+                    }
+                    for (const auto& doc: actual) {
+                        if (with_filter) {
+                            ASSERT_EQ(std::stoi(doc.text()) % 2, 1);
+                        }
+                        hits += expected_ids.contains(doc.id());
+                        total++;
+                    }
+                }
+                const auto recall = static_cast<double>(hits) / total;
+                LOG_INFO("type={}, with_filter={}, recall@{}={}", static_cast<int>(type), with_filter, k, recall);
+                ASSERT_GT(recall, 0.9);
+            }
+
+            // codes should be restored from snapshot table
+            const auto reloaded_store = CreateDuckDBVectorStore(db, embeddings, options);
+            SearchRequest search_request;
+            search_request.set_query("42");
+            search_request.set_top_k(1);
+            ASSERT_EQ(CollectVector(reloaded_store->SearchDocuments(search_request))[0].text(), "42");
+
+            // deleted documents should never be recalled, even by the other store instance
+            UpdateResult delete_result;
+            const auto top_1 = CollectVector(quantized_store->SearchDocuments(search_request));
+            quantized_store->DeleteDocuments({top_1[0].id()}, delete_result);
+            for (const auto& store: {quantized_store, reloaded_store}) {
+                for (const auto& doc: CollectVector(store->SearchDocuments(search_request))) {
+                    ASSERT_NE(doc.id(), top_1[0].id());
+                }
+            }
+        }
+    }
+
+    TEST_F(DuckDBVectorStoreTest, BatchSearch) {
+        constexpr size_t dim = 128;
+        constexpr int n = 2000, k = 10;
+        auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "test.db";
+        const auto embeddings = INSTINCT_LLM_NS::create_hashed_embedding_model(dim);
+        const auto store = CreateDuckDBVectorStore(embeddings, { .table_name = "test_table_1", .db_file_path = db_file_path, .dimension = dim});
+
+        std::vector<Document> docs;
+        for (const int i: std::views::iota (0,n)) {
+            Document document;
+            document.set_text(std::to_string(i));
+            auto* parent_id = document.mutable_metadata()->Add();
+            parent_id->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+            parent_id->set_string_value(std::to_string(i % 2));
+            DocumentUtils::AddMissingPresetMetadataFields(document);
+            docs.push_back(document);
+        }
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        ASSERT_EQ(update_result.affected_rows(), n);
+
+        // empty request
+        ASSERT_EQ(store->BatchSearchDocuments({}).results_size(), 0);
+
+        // result of each query should be identical to that of sequential search, with and without metadata filter
+        for (const bool with_filter: {false, true}) {
+            BatchSearchRequest batch_request;
+            batch_request.set_top_k(k);
+            for (int i = 0; i < 8; ++i) {
+                batch_request.add_queries("query " + std::to_string(i));
+            }
+            if (with_filter) {
+                auto* term = batch_request.mutable_metadata_filter()->mutable_term();
+                term->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+                term->mutable_term()->set_string_value("1");
+            }
+            const auto batch_result = store->BatchSearchDocuments(batch_request);
+            ASSERT_EQ(batch_result.results_size(), 8);
+            ASSERT_EQ(batch_result.fused_documents_size(), 0);
+            for (int i = 0; i < 8; ++i) {
+                const auto& query_result = batch_result.results(i);
+                ASSERT_EQ(query_result.query(), batch_request.queries(i));
+                SearchRequest search_request;
+                search_request.set_query(query_result.query());
+                search_request.set_top_k(k);
+                if (with_filter) {
+                    search_request.mutable_metadata_filter()->CopyFrom(batch_request.metadata_filter());
+                }
+                const auto expected = CollectVector(store->SearchDocuments(search_request));
+                ASSERT_EQ(query_result.documents_size(), expected.size());
+                for (int j = 0; j < query_result.documents_size(); ++j) {
+                    ASSERT_EQ(query_result.documents(j).id(), expected[j].id());
+                    ASSERT_EQ(query_result.documents(j).text(), expected[j].text());
+                    if (with_filter) {
+                        ASSERT_EQ(std::stoi(query_result.documents(j).text()) % 2, 1);
+                    }
+                }
+            }
+        }
+
+        // fused result is top-k of reciprocal rank fusion
+        BatchSearchRequest batch_request;
+        batch_request.set_top_k(k);
+        batch_request.set_fuse_results(true);
+        batch_request.add_queries("42");
+        batch_request.add_queries("42");
+        batch_request.add_queries("43");
+        const auto batch_result = store->BatchSearchDocuments(batch_request);
+        ASSERT_EQ(batch_result.fused_documents_size(), k);
+        ASSERT_EQ(batch_result.fused_documents(0).text(), "42");
+        std::vector<std::vector<Document>> ranked_lists;
+        for (const auto& query_result: batch_result.results()) {
+            ranked_lists.emplace_back(query_result.documents().begin(), query_result.documents().end());
+        }
+        const auto fused = details::reciprocal_rank_fusion(ranked_lists, k);
+        for (int i = 0; i < k; ++i) {
+            ASSERT_EQ(batch_result.fused_documents(i).id(), fused[i].id());
+        }
+    }
+
+    TEST_F(DuckDBVectorStoreTest, ConcurrentSearch) {
+        constexpr size_t dim = 64;
+        constexpr int n = 500, k = 5, thread_count = 16, query_count = 20;
+        auto db_file_path = INSTINCT_LLM_NS::ensure_random_temp_folder() / "test.db";
+        const auto embeddings = INSTINCT_LLM_NS::create_hashed_embedding_model(dim);
+        // fewer connections than threads, so that readers have to wait for each other
+        const auto store = CreateDuckDBVectorStore(embeddings, { .table_name = "test_table_1", .db_file_path = db_file_path, .dimension = dim, .connection_pool = {.initial_connection_count = 4}});
+
+        std::vector<Document> docs;
+        for (const int i: std::views::iota (0,n)) {
+            Document document;
+            document.set_text(std::to_string(i));
+            auto* parent_id = document.mutable_metadata()->Add();
+            parent_id->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+            parent_id->set_string_value(std::to_string(i % 2));
+            DocumentUtils::AddMissingPresetMetadataFields(document);
+            docs.push_back(document);
+        }
+        UpdateResult update_result;
+        store->AddDocuments(docs, update_result);
+        ASSERT_EQ(update_result.affected_rows(), n);
+
+        const auto make_request = [&](const int i) {
+            SearchRequest search_request;
+            search_request.set_query("query " + std::to_string(i));
+            search_request.set_top_k(k);
+            if (i % 2) {
+                auto* term = search_request.mutable_metadata_filter()->mutable_term();
+                term->set_name(METADATA_SCHEMA_PARENT_DOC_ID_KEY);
+                term->mutable_term()->set_string_value("1");
+            }
+            return search_request;
+        };
+        std::vector<std::vector<std::string>> expected(query_count);
+        for (int i = 0; i < query_count; ++i) {
+            for (const auto& doc: CollectVector(store->SearchDocuments(make_request(i)))) {
+                expected[i].push_back(doc.id());
+            }
+            ASSERT_EQ(expected[i].size(), k);
+        }
+
+        std::atomic<int> ok = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                for (int j = 0; j < query_count; ++j) {
+                    const int i = (t + j) % query_count;
+                    std::vector<std::string> ids;
+                    for (const auto& doc: CollectVector(store->SearchDocuments(make_request(i)))) {
+                        ids.push_back(doc.id());
+                    }
+                    ok += ids == expected[i] && store->CountDocuments() == n;
+                }
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        ASSERT_EQ(ok, thread_count * query_count);
+    }
 
 }
@@ -6,6 +6,7 @@
 #include "database/DBUtils.hpp"
 #include "database/duckdb/DuckDBConnectionPool.hpp"
 #include "database/duckdb/DuckDBDataTemplate.hpp"
+#include "RetrievalTestGlobals.hpp"
 #include "embedding_model/OpenAIEmbedding.hpp"
 #include "store/duckdb/DuckDBVectorStoreOperator.hpp"
 
@@ -48,4 +49,65 @@ namespace INSTINCT_RETRIEVAL_NS {
         const auto list2 = vdb_operator->ListInstances();
         ASSERT_EQ(list2.size(), 0);
     }
+
+    TEST_F(DuckDBVectorStoreOperatorTest, WarmLoad) {
+        const auto vdb_operator = std::make_shared<DuckDBVectorStoreOperator>(duck_db_, INSTINCT_LLM_NS::create_hashed_embedding_model(32), vector_store_metadata_data_mapper_, CreateVectorStorePresetMetadataSchema());
+        ASSERT_FALSE(vdb_operator->LoadInstance("vs-1"));
+
+        // instance created is cached
+        const auto obj1 = vdb_operator->CreateInstance("vs-1");
+        ASSERT_EQ(vdb_operator->LoadInstance("vs-1"), obj1);
+        ASSERT_EQ(vdb_operator->LoadInstance("vs-1"), obj1);
+
+        // reloaded after invalidation
+        vdb_operator->InvalidateInstance("vs-1");
+        const auto obj2 = vdb_operator->LoadInstance("vs-1");
+        ASSERT_TRUE(obj2);
+        ASSERT_NE(obj2, obj1);
+        ASSERT_EQ(vdb_operator->LoadInstance("vs-1"), obj2);
+
+        // re-created with another schema
+        ASSERT_TRUE(vdb_operator->RemoveInstance("vs-1"));
+        ASSERT_FALSE(vdb_operator->LoadInstance("vs-1"));
+        const auto schema = CreateVectorStorePresetMetadataSchema();
+        auto* field = schema->add_fields();
+        field->set_name("author");
+        field->set_type(VARCHAR);
+        const auto obj3 = vdb_operator->CreateInstance("vs-1", schema);
+        const auto obj4 = vdb_operator->LoadInstance("vs-1");
+        ASSERT_EQ(obj4, obj3);
+        ASSERT_EQ(obj4->GetMetadataSchema()->fields_size(), schema->fields_size());
+    }
+
+    TEST_F(DuckDBVectorStoreOperatorTest, ConcurrentLoad) {
+        const auto vdb_operator = std::make_shared<DuckDBVectorStoreOperator>(duck_db_, INSTINCT_LLM_NS::create_hashed_embedding_model(32), vector_store_metadata_data_mapper_, CreateVectorStorePresetMetadataSchema());
+        vdb_operator->CreateInstance("vs-1");
+        vdb_operator->InvalidateInstance("vs-1");
+
+        // instance is created only once for concurrent loads
+        constexpr int thread_count = 16;
+        std::vector<VectorStorePtr> loaded(thread_count);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < thread_count; ++i) {
+            threads.emplace_back([&, i] {
+                loaded[i] = vdb_operator->LoadInstance("vs-1");
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        ASSERT_TRUE(loaded[0]);
+        for (const auto& instance: loaded) {
+            ASSERT_EQ(instance, loaded[0]);
+        }
+    }
+
+    TEST_F(DuckDBVectorStoreOperatorTest, CacheDisabled) {
+        const auto vdb_operator = std::make_shared<DuckDBVectorStoreOperator>(duck_db_, INSTINCT_LLM_NS::create_hashed_embedding_model(32), vector_store_metadata_data_mapper_, CreateVectorStorePresetMetadataSchema(), DuckDBVectorStoreOperatorOptions {.instance_cache_size = 0});
+        const auto obj1 = vdb_operator->CreateInstance("vs-1");
+        const auto obj2 = vdb_operator->LoadInstance("vs-1");
+        ASSERT_TRUE(obj2);
+        ASSERT_NE(obj2, obj1);
+        ASSERT_NE(vdb_operator->LoadInstance("vs-1"), obj2);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <unordered_set>
+
+#include "store/HNSWIndex.hpp"
+#include "tools/ChronoUtils.hpp"
+#include "RetrievalTestGlobals.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    class HNSWIndexTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+
+        static std::vector<std::vector<float>> MakeVectors(const size_t n, const size_t dim, const unsigned seed = 42) {
+            std::mt19937 gen(seed);
+            std::normal_distribution<float> dis;
+            std::vector<std::vector<float>> vectors(n, std::vector<float>(dim));
+            for (auto& v: vectors) {
+                for (auto& f: v) {
+                    f = dis(gen);
+                }
+            }
+            return vectors;
+        }
+
+        static float CosineSimilarity(const std::vector<float>& a, const std::vector<float>& b) {
+            float dot = 0, na = 0, nb = 0;
+            for (size_t i = 0; i < a.size(); ++i) {
+                dot += a[i] * b[i];
+                na += a[i] * a[i];
+                nb += b[i] * b[i];
+            }
+            return dot / (std::sqrt(na) * std::sqrt(nb));
+        }
+
+        static std::vector<std::string> ExactTopK(const std::vector<std::vector<float>>& vectors, const std::vector<float>& query, const size_t k) {
+            std::vector<std::pair<float, size_t>> scores;
+            for (size_t i = 0; i < vectors.size(); ++i) {
+                scores.emplace_back(-CosineSimilarity(vectors[i], query), i);
+            }
+            std::partial_sort(scores.begin(), scores.begin() + k, scores.end());
+            std::vector<std::string> ids;
+            for (size_t i = 0; i < k; ++i) {
+                ids.push_back(std::to_string(scores[i].second));
+            }
+            return ids;
+        }
+    };
+
+    TEST_F(HNSWIndexTest, AddSearchAndRemove) {
+        const auto vectors = MakeVectors(1000, 64);
+        HNSWIndex index(64, {.enabled = true});
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            index.Add(std::to_string(i), vectors[i]);
+        }
+        ASSERT_EQ(index.Size(), 1000);
+
+        // a vector should be its own nearest neighbor
+        for (size_t i = 0; i < 100; ++i) {
+            const auto result = index.Search(vectors[i], 3);
+            ASSERT_EQ(result.size(), 3);
+            ASSERT_EQ(result[0].first, std::to_string(i));
+            ASSERT_NEAR(result[0].second, 1.0, 1e-4);
+            ASSERT_GE(result[0].second, result[1].second);
+            ASSERT_GE(result[1].second, result[2].second);
+        }
+
+        ASSERT_TRUE(index.Remove("0"));
+        ASSERT_FALSE(index.Remove("0"));
+        ASSERT_EQ(index.Size(), 999);
+        ASSERT_EQ(index.CountDeleted(), 1);
+        for (const auto& [id, _]: index.Search(vectors[0], 10)) {
+            ASSERT_NE(id, "0");
+        }
+
+        // replace vector of existing id
+        index.Add("1", vectors[2]);
+        ASSERT_EQ(index.Size(), 999);
+        ASSERT_EQ(index.Search(vectors[2], 2).size(), 2);
+
+        index.Compact();
+        ASSERT_EQ(index.Size(), 999);
+        ASSERT_EQ(index.CountDeleted(), 0);
+        ASSERT_EQ(index.Search(vectors[3], 1)[0].first, "3");
+    }
+
+    TEST_F(HNSWIndexTest, SerializeAndDeserialize) {
+        const auto vectors = MakeVectors(500, 32);
+        HNSWIndex index(32, {.enabled = true});
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            index.Add(std::to_string(i), vectors[i]);
+        }
+        index.Remove("7");
+
+        // graph only, with vectors loaded from elsewhere
+        const auto payload = index.Serialize();
+        const auto restored = HNSWIndex::Deserialize(payload, 32, index.GetOptions(), [&](const std::string& id, std::vector<float>& vector) {
+            vector = vectors[std::stoi(id)];
+            return true;
+        });
+        ASSERT_TRUE(restored);
+        ASSERT_EQ(restored->Size(), 499);
+        ASSERT_FALSE(restored->Contains("7"));
+        for (size_t i = 0; i < 50; ++i) {
+            ASSERT_EQ(restored->Search(vectors[i], 5), index.Search(vectors[i], 5));
+        }
+
+        // self-contained payload
+        const auto full = HNSWIndex::Deserialize(index.Serialize(true), 32, index.GetOptions());
+        ASSERT_TRUE(full);
+        ASSERT_EQ(full->Search(vectors[42], 5), index.Search(vectors[42], 5));
+
+        // stale payload is rejected
+        ASSERT_FALSE(HNSWIndex::Deserialize(payload, 32, index.GetOptions(), [](const auto&, auto&) { return false; }));
+        ASSERT_FALSE(HNSWIndex::Deserialize("garbage", 32, index.GetOptions()));
+
+        // payload of other dimension is rejected
+        ASSERT_FALSE(HNSWIndex::Deserialize(index.Serialize(true), 64, index.GetOptions()));
+
+        // node count that doesn't fit in payload is rejected before allocation. it follows magic, version, dimension and vector flag.
+        auto forged = index.Serialize(true);
+        constexpr size_t count_offset = sizeof(uint32_t) * 2 + sizeof(uint64_t) + sizeof(uint8_t);
+        constexpr uint32_t forged_count = std::numeric_limits<uint32_t>::max();
+        std::memcpy(forged.data() + count_offset, &forged_count, sizeof(uint32_t));
+        ASSERT_FALSE(HNSWIndex::Deserialize(forged, 32, index.GetOptions()));
+    }
+
+    TEST_F(HNSWIndexTest, RecallVersusLatency) {
+        constexpr size_t dim = 128, n = 20000, query_count = 100, k = 10;
+        const auto vectors = MakeVectors(n, dim);
+        const auto queries = MakeVectors(query_count, dim, 7);
+
+        HNSWIndex index(dim, {.enabled = true});
+        auto t1 = ChronoUtils::GetCurrentTimeMillis();
+        for (size_t i = 0; i < n; ++i) {
+            index.Add(std::to_string(i), vectors[i]);
+        }
+        LOG_INFO("HNSW build done: n={}, dim={}, rt={}ms", n, dim, ChronoUtils::GetCurrentTimeMillis() - t1);
+
+        std::vector<std::vector<std::string>> truth;
+        t1 = ChronoUtils::GetCurrentEpochMicroSeconds();
+        for (const auto& query: queries) {
+            truth.push_back(ExactTopK(vectors, query, k));
+        }
+        LOG_INFO("exact search: avg_latency={}us", (ChronoUtils::GetCurrentEpochMicroSeconds() - t1) / query_count);
+
+        double last_recall = 0;
+        for (const size_t ef: {16, 64, 256}) {
+            size_t hits = 0;
+            t1 = ChronoUtils::GetCurrentEpochMicroSeconds();
+            for (size_t q = 0; q < query_count; ++q) {
+                const auto result = index.Search(queries[q], k, ef);
+                std::unordered_set<std::string> expected {truth[q].begin(), truth[q].end()};
+                for (const auto& [id, _]: result) {
+                    hits += expected.contains(id);
+                }
+            }
+            const auto latency = (ChronoUtils::GetCurrentEpochMicroSeconds() - t1) / query_count;
+            const double recall = static_cast<double>(hits) / (query_count * k);
+            LOG_INFO("HNSW search: ef={}, recall@{}={}, avg_latency={}us", ef, k, recall, latency);
+            ASSERT_GE(recall, last_recall);
+            last_recall = recall;
+        }
+        // random gaussian vectors are among the hardest inputs for graph index
+        ASSERT_GT(last_recall, 0.8);
+    }
+
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "store/KeywordIndex.hpp"
+#include "RetrievalTestGlobals.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    class KeywordIndexTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+    };
+
+    TEST_F(KeywordIndexTest, Tokenize) {
+        ASSERT_EQ(details::tokenize_keywords("Error E1234: disk-full, retry!"), (std::vector<std::string> {"error", "e1234", "disk", "full", "retry"}));
+        ASSERT_EQ(details::tokenize_keywords("  "), std::vector<std::string> {});
+        // multibyte characters are kept in terms
+        ASSERT_EQ(details::tokenize_keywords("羊驼 llama"), (std::vector<std::string> {"羊驼", "llama"}));
+    }
+
+    TEST_F(KeywordIndexTest, SearchWithBM25) {
+        KeywordIndex index;
+        index.Add("1", "the quick brown fox jumps over the lazy dog");
+        index.Add("2", "the lazy dog sleeps");
+        index.Add("3", "error code E1234 is raised when disk is full");
+        index.Add("4", "the the the the the the fox");
+        ASSERT_EQ(index.Size(), 4);
+
+        // rare term dominates
+        auto result = index.Search("what is E1234", 10);
+        ASSERT_EQ(result.size(), 1);
+        ASSERT_EQ(result[0].first, "3");
+
+        // shorter document with same term frequency is ranked higher
+        result = index.Search("lazy dog", 10);
+        ASSERT_EQ(result.size(), 2);
+        ASSERT_EQ(result[0].first, "2");
+        ASSERT_EQ(result[1].first, "1");
+        ASSERT_GT(result[0].second, result[1].second);
+
+        // top-k is respected
+        ASSERT_EQ(index.Search("the fox dog", 2).size(), 2);
+        ASSERT_TRUE(index.Search("unknown", 10).empty());
+        ASSERT_TRUE(index.Search("fox", 0).empty());
+    }
+
+    TEST_F(KeywordIndexTest, RemoveAndReplace) {
+        KeywordIndex index;
+        index.Add("1", "alpaca wool");
+        index.Add("2", "llama wool");
+        ASSERT_TRUE(index.Remove("1"));
+        ASSERT_FALSE(index.Remove("1"));
+        ASSERT_FALSE(index.Contains("1"));
+        ASSERT_TRUE(index.Search("alpaca", 10).empty());
+        ASSERT_EQ(index.Search("wool", 10).size(), 1);
+
+        // replacing keeps size unchanged, and old text is no longer matched
+        index.Add("2", "vicuna");
+        ASSERT_EQ(index.Size(), 1);
+        ASSERT_TRUE(index.Search("llama", 10).empty());
+        ASSERT_EQ(index.Search("vicuna", 10)[0].first, "2");
+
+        // compaction keeps index consistent
+        for (int i = 0; i < 5000; ++i) {
+            index.Add(std::to_string(i), fmt::format("doc{} shared", i));
+        }
+        for (int i = 0; i < 4900; ++i) {
+            index.Remove(std::to_string(i));
+        }
+        ASSERT_EQ(index.Size(), 100);
+        ASSERT_EQ(index.Search("doc4950", 10)[0].first, "4950");
+        ASSERT_EQ(index.Search("shared", 1000).size(), 100);
+        ASSERT_TRUE(index.Search("doc10", 10).empty());
+    }
+
+}
@@ -105,5 +105,56 @@ namespace INSTINCT_RETRIEVAL_NS {
 
     }
 
+    TEST(TestSQLBuilder, BuildTermWithLongValue) {
+        SearchQuery search_query;
+        search_query.mutable_term()->set_name("bar");
+        search_query.mutable_term()->mutable_term()->set_long_value(9007199254740993);
+        ASSERT_EQ(
+            SQLBuilder::ToSelectString("foo", "*", search_query),
+            "SELECT * FROM foo WHERE bar = 9007199254740993;"
+        );
+    }
+
+    TEST(TestSQLBuilder, BuildParameterizedSelect) {
+        SearchQuery search_query;
+        auto* condition1 = search_query.mutable_bool_()->add_must();
+        condition1->mutable_terms()->set_name("bar");
+        condition1->mutable_terms()->add_terms()->set_string_value("cow's");
+        condition1->mutable_terms()->add_terms()->set_string_value("kar");
+        auto* condition2 = search_query.mutable_bool_()->add_must();
+        condition2->mutable_int_range()->set_name("score1");
+        condition2->mutable_int_range()->set_from(1);
+        condition2->mutable_int_range()->set_to(100);
+        auto* condition3 = search_query.mutable_bool_()->add_mustnot();
+        condition3->mutable_term()->set_name("score2");
+        condition3->mutable_term()->mutable_term()->set_is_null(true);
+
+        SQLParameters parameters;
+        const auto sql = SQLBuilder::ToParameterizedSelectString("foo", "*", search_query, parameters, std::vector<Sorter> {}, 20, 10);
+        ASSERT_EQ(sql, "SELECT * FROM foo WHERE (bar IN (?, ?) AND (score1 > ? AND score1 < ?)) AND NOT score2 = NULL LIMIT ? OFFSET ?;");
+        ASSERT_EQ(parameters.size(), 6);
+        ASSERT_EQ(parameters[0].string_value(), "cow's");
+        ASSERT_EQ(parameters[1].string_value(), "kar");
+        ASSERT_EQ(parameters[2].long_value(), 1);
+        ASSERT_EQ(parameters[3].long_value(), 100);
+        ASSERT_EQ(parameters[4].long_value(), 10);
+        ASSERT_EQ(parameters[5].long_value(), 20);
+
+        // literal SQL is unchanged
+        ASSERT_EQ(
+            SQLBuilder::ToSelectString("foo", "*", search_query, std::vector<Sorter> {}, 20, 10),
+            "SELECT * FROM foo WHERE (bar IN ('cow''s', 'kar') AND (score1 > 1 AND score1 < 100)) AND NOT score2 = NULL LIMIT 10 OFFSET 20;"
+        );
+    }
+
+    TEST(TestSQLBuilder, BuildParameterizedDelete) {
+        SearchQuery search_query;
+        search_query.mutable_term()->set_name("bar");
+        search_query.mutable_term()->mutable_term()->set_string_value("cow's");
+        SQLParameters parameters;
+        ASSERT_EQ(SQLBuilder::ToParameterizedDeleteString("foo", search_query, parameters, "id"), "DELETE FROM foo WHERE bar = ? RETURNING id;");
+        ASSERT_EQ(parameters.size(), 1);
+        ASSERT_EQ(parameters[0].string_value(), "cow's");
+    }
 
 }
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <unordered_set>
+
+#include "store/VectorQuantizer.hpp"
+#include "RetrievalTestGlobals.hpp"
+
+namespace INSTINCT_RETRIEVAL_NS {
+
+    class VectorQuantizerTest: public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+
+        /**
+         * Gaussian clusters, which resemble embeddings of related texts better than uniform noise
+         */
+        static std::vector<std::vector<float>> MakeVectors(const size_t n, const size_t dim, const unsigned seed = 42) {
+            std::mt19937 gen(seed);
+            std::normal_distribution<float> dis;
+            std::vector<std::vector<float>> centers(32, std::vector<float>(dim));
+            for (auto& c: centers) {
+                for (auto& f: c) {
+                    f = dis(gen);
+                }
+            }
+            std::vector<std::vector<float>> vectors(n, std::vector<float>(dim));
+            for (size_t i = 0; i < n; ++i) {
+                const auto& center = centers[i % centers.size()];
+                for (size_t j = 0; j < dim; ++j) {
+                    vectors[i][j] = center[j] + 0.5f * dis(gen);
+                }
+            }
+            return vectors;
+        }
+
+        static std::vector<float> Flatten(const std::vector<std::vector<float>>& vectors) {
+            std::vector<float> flat;
+            for (const auto& v: vectors) {
+                flat.insert(flat.end(), v.begin(), v.end());
+            }
+            return flat;
+        }
+
+        static float CosineSimilarity(const std::vector<float>& a, const std::vector<float>& b) {
+            float dot = 0, na = 0, nb = 0;
+            for (size_t i = 0; i < a.size(); ++i) {
+                dot += a[i] * b[i];
+                na += a[i] * a[i];
+                nb += b[i] * b[i];
+            }
+            return dot / (std::sqrt(na) * std::sqrt(nb));
+        }
+
+        static std::vector<std::string> ExactTopK(const std::vector<std::vector<float>>& vectors, const std::vector<float>& query, const size_t k) {
+            std::vector<std::pair<float, size_t>> scores;
+            for (size_t i = 0; i < vectors.size(); ++i) {
+                scores.emplace_back(-CosineSimilarity(vectors[i], query), i);
+            }
+            std::partial_sort(scores.begin(), scores.begin() + k, scores.end());
+            std::vector<std::string> ids;
+            for (size_t i = 0; i < k; ++i) {
+                ids.push_back(std::to_string(scores[i].second));
+            }
+            return ids;
+        }
+
+        /**
+         * Recall of exact top-k after re-scoring `k * rescore_factor` candidates with original vectors
+         */
+        static double MeasureRecall(const VectorQuantizer& quantizer, const std::vector<std::vector<float>>& vectors, const std::vector<std::vector<float>>& queries, const size_t k, const size_t rescore_factor) {
+            size_t hit = 0;
+            for (const auto& query: queries) {
+                const auto expected = ExactTopK(vectors, query, k);
+                std::vector<std::pair<float, std::string>> rescored;
+                for (const auto& [id, _]: quantizer.Search(query, k * rescore_factor)) {
+                    rescored.emplace_back(-CosineSimilarity(vectors[std::stoul(id)], query), id);
+                }
+                std::ranges::sort(rescored);
+                std::unordered_set<std::string> actual;
+                for (size_t i = 0; i < k && i < rescored.size(); ++i) {
+                    actual.insert(rescored[i].second);
+                }
+                for (const auto& id: expected) {
+                    hit += actual.contains(id);
+                }
+            }
+            return static_cast<double>(hit) / static_cast<double>(queries.size() * k);
+        }
+    };
+
+    TEST_F(VectorQuantizerTest, Int8Recall) {
+        const auto vectors = MakeVectors(5000, 64);
+        const auto queries = MakeVectors(50, 64, 7);
+        VectorQuantizer quantizer(64, {.type = kInt8Quantization});
+        ASSERT_EQ(quantizer.GetBytesPerVector(), 64 + sizeof(float));
+        quantizer.Train(Flatten(vectors));
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            quantizer.Add(std::to_string(i), vectors[i]);
+        }
+        ASSERT_EQ(quantizer.Size(), 5000);
+
+        // approximate similarity is close to exact one
+        const auto result = quantizer.Search(vectors[0], 1);
+        ASSERT_EQ(result[0].first, "0");
+        ASSERT_NEAR(result[0].second, 1.0, 1e-2);
+
+        const auto recall = MeasureRecall(quantizer, vectors, queries, 10, 1);
+        LOG_INFO("int8 recall@10 without re-scoring: {}", recall);
+        ASSERT_GE(recall, 0.9);
+        ASSERT_GE(MeasureRecall(quantizer, vectors, queries, 10, 4), 0.99);
+    }
+
+    TEST_F(VectorQuantizerTest, ProductQuantizationRecall) {
+        const auto vectors = MakeVectors(5000, 64);
+        const auto queries = MakeVectors(50, 64, 7);
+        VectorQuantizer quantizer(64, {.type = kProductQuantization, .pq_subspaces = 16});
+        ASSERT_EQ(quantizer.GetBytesPerVector(), 16 + sizeof(float));
+        quantizer.Train(Flatten(vectors));
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            quantizer.Add(std::to_string(i), vectors[i]);
+        }
+        const auto recall = MeasureRecall(quantizer, vectors, queries, 10, 10);
+        LOG_INFO("pq recall@10 with re-scoring: {}", recall);
+        ASSERT_GE(recall, 0.9);
+    }
+
+    TEST_F(VectorQuantizerTest, RemoveAndReplace) {
+        const auto vectors = MakeVectors(100, 16);
+        VectorQuantizer quantizer(16, {.type = kInt8Quantization});
+        ASSERT_FALSE(quantizer.IsTrained());
+        ASSERT_THROW(quantizer.Add("0", vectors[0]), InstinctException);
+        quantizer.Train(Flatten(vectors));
+        for (size_t i = 0; i < vectors.size(); ++i) {
+            quantizer.Add(std::to_string(i), vectors[i]);
+        }
+
+        ASSERT_TRUE(quantizer.Remove("0"));
+        ASSERT_FALSE(quantizer.Remove("0"));
+        ASSERT_EQ(quantizer.Size(), 99);
+        for (const auto& [id, _]: quantizer.Search(vectors[0], 100)) {
+            ASSERT_NE(id, "0");
+        }
+        // last vector is moved into freed slot, and it should still be found
+        ASSERT_EQ(quantizer.Search(vectors[99], 1)[0].first, "99");
+
+        // replacing keeps size unchanged
+        quantizer.Add("1", vectors[2]);
+        ASSERT_EQ(quantizer.Size(), 99);
+        const auto result = quantizer.Search(vectors[2], 2);
+        ASSERT_TRUE((result[0].first == "1" && result[1].first == "2") || (result[0].first == "2" && result[1].first == "1"));
+    }
+
+    TEST_F(VectorQuantizerTest, SerializeAndDeserialize) {
+        const auto vectors = MakeVectors(1000, 32);
+        for (const auto type: {kInt8Quantization, kProductQuantization}) {
+            const VectorQuantizationOptions options {.type = type, .pq_subspaces = 8};
+            VectorQuantizer quantizer(32, options);
+            quantizer.Train(Flatten(vectors));
+            for (size_t i = 0; i < vectors.size(); ++i) {
+                quantizer.Add(std::to_string(i), vectors[i]);
+            }
+            quantizer.Remove("10");
+
+            const auto payload = quantizer.Serialize();
+            const auto restored = VectorQuantizer::Deserialize(payload, options);
+            ASSERT_TRUE(restored);
+            ASSERT_TRUE(restored->IsTrained());
+            ASSERT_EQ(restored->Size(), 999);
+            ASSERT_FALSE(restored->Contains("10"));
+            for (size_t i = 0; i < 20; ++i) {
+                ASSERT_EQ(restored->Search(vectors[i], 5), quantizer.Search(vectors[i], 5));
+            }
+
+            // payload of other type is rejected
+            ASSERT_FALSE(VectorQuantizer::Deserialize(payload, {.type = type == kInt8Quantization ? kProductQuantization : kInt8Quantization, .pq_subspaces = 8}));
+            ASSERT_FALSE(VectorQuantizer::Deserialize(payload.substr(0, payload.size() / 2), options));
+        }
+    }
+
+    TEST_F(VectorQuantizerTest, RejectParametersOfWrongSizes) {
+        const auto vectors = MakeVectors(1000, 32);
+        const VectorQuantizationOptions options {.type = kInt8Quantization};
+        VectorQuantizer quantizer(32, options);
+        quantizer.Train(Flatten(vectors));
+        auto payload = quantizer.Serialize();
+        ASSERT_TRUE(VectorQuantizer::Deserialize(payload, options));
+
+        // drop last float of `mins`, which follows header of magic, version, type, dimension, code size and trained flag
+        constexpr size_t mins_offset = sizeof(uint32_t) * 3 + sizeof(uint64_t) * 2 + sizeof(uint8_t);
+        uint64_t mins_size;
+        std::memcpy(&mins_size, payload.data() + mins_offset, sizeof(uint64_t));
+        ASSERT_EQ(mins_size, 32);
+        --mins_size;
+        std::memcpy(payload.data() + mins_offset, &mins_size, sizeof(uint64_t));
+        payload.erase(mins_offset + sizeof(uint64_t) + mins_size * sizeof(float), sizeof(float));
+        ASSERT_FALSE(VectorQuantizer::Deserialize(payload, options));
+    }
+
+}
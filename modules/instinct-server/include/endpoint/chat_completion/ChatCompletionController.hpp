@@ -41,6 +41,14 @@ namespace INSTINCT_SERVER_NS {
             chunk.set_object("chat.completion.chunk");
             return chunk;
         }
+
+        /**
+         * Write a server-sent event. Return false if client is gone.
+         */
+        static bool write_sse_data(DataSink& sink, const std::string& data) {
+            const auto event = fmt::format("data: {}\n\n", data);
+            return sink.is_writable() && sink.write(event.data(), event.size());
+        }
     }
 
     using OpenAIChainPtr = MessageChainPtr<OpenAIChatCompletionRequest,OpenAIChatCompletionResponse>;
@@ -72,16 +80,78 @@ namespace INSTINCT_SERVER_NS {
                 long t1 = ChronoUtils::GetCurrentTimeMillis();
                 LOG_DEBUG("--> REQ /v1/chat/completions, req={}", req.body);
                 const auto openai_req = ProtobufUtils::Deserialize<OpenAIChatCompletionRequest>(req.body);
-                const auto openai_response = chain_->Invoke(openai_req);
                 if(openai_req.stream()) {
-                    auto chunk_response = details::conv_response_to_chunk(openai_response);
-                    resp.set_content(ProtobufUtils::Serialize(chunk_response), HTTP_CONTENT_TYPES.at(kJSON));
-                } else {
-                    resp.set_content(ProtobufUtils::Serialize(openai_response), HTTP_CONTENT_TYPES.at(kJSON));
+                    StreamCompletion_(openai_req, resp);
+                    LOG_DEBUG("<-- RESP /v1/chat/completions, streaming, rt={}", ChronoUtils::GetCurrentTimeMillis()-t1);
+                    return;
                 }
+                const auto openai_response = chain_->Invoke(openai_req);
+                resp.set_content(ProtobufUtils::Serialize(openai_response), HTTP_CONTENT_TYPES.at(kJSON));
                 LOG_DEBUG("<-- RESP /v1/chat/completions, res={}, rt={}", resp.body, ChronoUtils::GetCurrentTimeMillis()-t1);
             });
         }
+
+    private:
+        /**
+         * Emit chunks as soon as they are generated by chain. Chunks are written in httplib's worker thread, and `DataSink::write` blocks until data is sent, which in turn throttles upstream. Upstream subscription is disposed right after a write to disconnected client fails, so that upstream http stream is aborted as well.
+         */
+        void StreamCompletion_(const OpenAIChatCompletionRequest& openai_req, Response& resp) const {
+            resp.set_header("Cache-Control", "no-cache");
+            resp.set_chunked_content_provider(HTTP_CONTENT_TYPES.at(kEventStream), [chain = chain_, openai_req](size_t, DataSink& sink) {
+                const auto id = fmt::format("chatcmpl-{}", ChronoUtils::GetCurrentTimeMillis());
+                bool client_gone = false;
+                std::exception_ptr error;
+                OpenAIChatCompletionChunk last_chunk;
+                // disposed as soon as client is gone, rather than waiting for upstream to emit another chunk
+                const auto subscription = rpp::composite_disposable_wrapper::make();
+                try {
+                    chain->Stream(openai_req)
+                        .subscribe(
+                            subscription,
+                            [&](const OpenAIChatCompletionResponse& response) {
+                                if (client_gone) return;
+                                last_chunk = details::conv_response_to_chunk(response);
+                                last_chunk.set_id(id);
+                                if (!details::write_sse_data(sink, ProtobufUtils::Serialize(last_chunk))) {
+                                    client_gone = true;
+                                    subscription.dispose();
+                                }
+                            },
+                            [&](const std::exception_ptr& ep) {
+                                error = ep;
+                            }
+                        );
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                if (client_gone) {
+                    LOG_DEBUG("client is disconnected during streaming, id={}", id);
+                    return false;
+                }
+                if (error) {
+                    std::string message = "unknown exception occurred.";
+                    try {
+                        std::rethrow_exception(error);
+                    } catch (const std::exception& ex) {
+                        message = ex.what();
+                    } catch (...) {}
+                    LOG_ERROR("Failed streaming in ChatCompletionController. ex.what={}", message);
+                    details::write_sse_data(sink, HttpLibSession::CreateErrorObject(message, 500, "server_error").dump());
+                } else {
+                    // last chunk with empty delta and finish reason
+                    for (auto& choice: *last_chunk.mutable_choices()) {
+                        choice.mutable_delta()->Clear();
+                        choice.set_finish_reason("stop");
+                    }
+                    if (details::write_sse_data(sink, ProtobufUtils::Serialize(last_chunk))) {
+                        details::write_sse_data(sink, "[DONE]");
+                    }
+                }
+                sink.done();
+                return true;
+            });
+        }
     };
 
     static HttpLibControllerPtr CreateOpenAIChatCompletionController(
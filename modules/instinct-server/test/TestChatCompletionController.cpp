@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <mutex>
+
+#include "LLMTestGlobals.hpp"
+#include "endpoint/chat_completion/ChatCompletionController.hpp"
+#include "prompt/PlainPromptTemplate.hpp"
+#include "server/httplib/HttpLibServer.hpp"
+#include "tools/http/CURLHttpClient.hpp"
+
+namespace INSTINCT_SERVER_NS {
+    using namespace INSTINCT_LLM_NS;
+    using namespace INSTINCT_CORE_NS;
+
+    /**
+     * Chat model that emits given tokens one by one with fixed interval. If gate is closed, it holds rest of tokens after the first one until gate is opened.
+     */
+    class MockStreamingChatModel final: public BaseChatModel {
+        std::vector<std::string> tokens_;
+        std::chrono::milliseconds interval_;
+        std::mutex gate_mutex_;
+        std::condition_variable gate_cv_;
+        bool gate_open_ = true;
+
+    public:
+        std::atomic<int> emitted = 0;
+        std::atomic<bool> finished = false;
+
+        MockStreamingChatModel(std::vector<std::string> tokens, const std::chrono::milliseconds interval)
+            : tokens_(std::move(tokens)),
+              interval_(interval) {
+        }
+
+        void CloseGate() {
+            std::lock_guard lock {gate_mutex_};
+            gate_open_ = false;
+        }
+
+        void OpenGate() {
+            {
+                std::lock_guard lock {gate_mutex_};
+                gate_open_ = true;
+            }
+            gate_cv_.notify_all();
+        }
+
+        void Configure(const ModelOverrides &options) override {}
+
+        void BindTools(const FunctionToolkitPtr &toolkit) override {
+            throw InstinctException("Not implemented");
+        }
+
+    private:
+        BatchedLangaugeModelResult Generate(const std::vector<MessageList> &messages) override {
+            BatchedLangaugeModelResult batched_model_result;
+            for (int i = 0; i < messages.size(); ++i) {
+                auto* gen = batched_model_result.add_generations()->add_generations();
+                auto* msg = gen->mutable_message();
+                msg->set_content(StringUtils::JoinWith(tokens_, ""));
+                msg->set_role("assistant");
+                gen->set_text(msg->content());
+            }
+            return batched_model_result;
+        }
+
+        AsyncIterator<LangaugeModelResult> StreamGenerate(const MessageList &messages) override {
+            return rpp::source::create<LangaugeModelResult>([&](const auto& observer) {
+                for (const auto& token: tokens_) {
+                    if (emitted == 1) {
+                        // bounded wait so that a server buffering whole response fails assertions instead of hanging
+                        std::unique_lock lock {gate_mutex_};
+                        gate_cv_.wait_for(lock, std::chrono::seconds(10), [&] { return gate_open_; });
+                    }
+                    if (observer.is_disposed()) {
+                        finished = true;
+                        return;
+                    }
+                    std::this_thread::sleep_for(interval_);
+                    LangaugeModelResult result;
+                    auto* gen = result.add_generations();
+                    gen->set_text(token);
+                    gen->set_is_chunk(true);
+                    gen->mutable_message()->set_content(token);
+                    gen->mutable_message()->set_role("assistant");
+                    ++emitted;
+                    observer.on_next(result);
+                }
+                finished = true;
+                observer.on_completed();
+            });
+        }
+    };
+
+    class ChatCompletionControllerTest : public testing::Test {
+    protected:
+        void SetUp() override {
+            SetupLogging();
+        }
+
+        std::unique_ptr<HttpLibServer> server_;
+        std::thread server_thread_;
+        int port_ = 0;
+
+        void StartServer(const std::shared_ptr<MockStreamingChatModel>& model) {
+            const StepFunctionPtr prompt_template = CreatePlainPromptTemplate("{question}", {.input_keys = {"question"}});
+            server_ = std::make_unique<HttpLibServer>(ServerOptions {.host = "127.0.0.1"});
+            server_->Use(CreateOpenAIChatCompletionController(prompt_template | model->AsModelFunction()));
+            port_ = server_->Bind();
+            server_thread_ = std::thread([&] { server_->GetHttpLibServer().listen_after_bind(); });
+            server_->GetHttpLibServer().wait_until_ready();
+        }
+
+        void TearDown() override {
+            if (server_) {
+                server_->Shutdown();
+                server_thread_.join();
+            }
+        }
+
+        [[nodiscard]] HttpRequest CreateCompletionRequest(const bool stream) const {
+            auto request = HttpUtils::CreateRequest(fmt::format("POST http://127.0.0.1:{}/v1/chat/completions", port_));
+            request.headers[HTTP_HEADER_CONTENT_TYPE_NAME] = HTTP_CONTENT_TYPES.at(kJSON);
+            request.body = fmt::format(R"({{"model": "mock", "stream": {}, "messages": [{{"role": "user", "content": "hi"}}]}})", stream);
+            return request;
+        }
+    };
+
+    TEST_F(ChatCompletionControllerTest, StreamTokens) {
+        using namespace std::chrono_literals;
+        const std::vector<std::string> tokens {"Hello", ",", " how", " can", " I", " help", " you", " today", "?", "!"};
+        const auto model = std::make_shared<MockStreamingChatModel>(tokens, 10ms);
+        // model holds rest of tokens until first chunk reaches client
+        model->CloseGate();
+        StartServer(model);
+
+        CURLHttpClient client;
+        std::vector<std::string> events;
+        int emitted_at_first_chunk = -1;
+        client.StreamChunk(CreateCompletionRequest(true), {.line_breaker = "\n\n"})
+            .subscribe([&](const std::string& line) {
+                if (events.empty()) {
+                    emitted_at_first_chunk = model->emitted;
+                    model->OpenGate();
+                }
+                ASSERT_TRUE(line.starts_with("data: "));
+                events.push_back(line.substr(6));
+            });
+        LOG_INFO("emitted_at_first_chunk={}", emitted_at_first_chunk);
+
+        // first chunk is delivered while upstream is still generating
+        ASSERT_EQ(emitted_at_first_chunk, 1);
+        ASSERT_EQ(model->emitted, tokens.size());
+
+        // token chunks, a finishing chunk, and [DONE]
+        ASSERT_EQ(events.size(), tokens.size() + 2);
+        std::string id;
+        for (int i = 0; i < tokens.size(); ++i) {
+            const auto chunk = ProtobufUtils::Deserialize<OpenAIChatCompletionChunk>(events[i]);
+            ASSERT_EQ(chunk.object(), "chat.completion.chunk");
+            ASSERT_EQ(chunk.choices(0).delta().content(), tokens[i]);
+            if (i == 0) id = chunk.id();
+            ASSERT_EQ(chunk.id(), id);
+        }
+        const auto last_chunk = ProtobufUtils::Deserialize<OpenAIChatCompletionChunk>(events[tokens.size()]);
+        ASSERT_EQ(last_chunk.choices(0).finish_reason(), "stop");
+        ASSERT_TRUE(last_chunk.choices(0).delta().content().empty());
+        ASSERT_EQ(events.back(), "[DONE]");
+    }
+
+    TEST_F(ChatCompletionControllerTest, CancelOnClientDisconnect) {
+        using namespace std::chrono_literals;
+        const auto model = std::make_shared<MockStreamingChatModel>(std::vector<std::string>(50, "token"), 50ms);
+        StartServer(model);
+
+        CURLHttpClient client;
+        int received = 0;
+        // abort after first chunk
+        client.ExecuteWithCallback(CreateCompletionRequest(true), [&](const std::string&) {
+            ++received;
+            return false;
+        });
+        ASSERT_EQ(received, 1);
+
+        // bounded wait for upstream to stop
+        for (int i = 0; i < 100 && !model->finished; ++i) {
+            std::this_thread::sleep_for(100ms);
+        }
+        LOG_INFO("emitted={} of 50", model->emitted.load());
+        // upstream should be disposed before all tokens are generated
+        ASSERT_TRUE(model->finished);
+        ASSERT_LT(model->emitted, 50);
+    }
+
+    TEST_F(ChatCompletionControllerTest, NonStreaming) {
+        using namespace std::chrono_literals;
+        const auto model = std::make_shared<MockStreamingChatModel>(std::vector<std::string> {"a", "b", "c"}, 0ms);
+        StartServer(model);
+
+        CURLHttpClient client;
+        const auto resp = client.Execute(CreateCompletionRequest(false));
+        ASSERT_EQ(resp.status_code, 200);
+        const auto completion = ProtobufUtils::Deserialize<OpenAIChatCompletionResponse>(resp.body);
+        ASSERT_EQ(completion.choices(0).message().content(), "abc");
+        ASSERT_EQ(model->emitted, 0);
+    }
+
+}
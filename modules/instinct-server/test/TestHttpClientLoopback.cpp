@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <httplib.h>
+
+#include "CoreTestGlobals.hpp"
+#include "ServerGlobals.hpp"
+#include "tools/http/CURLHttpClient.hpp"
+#include "tools/http/CURLMultiHttpClient.hpp"
+
+namespace INSTINCT_SERVER_NS {
+    using namespace INSTINCT_CORE_NS;
+
+    /**
+     * Check http clients against a loopback server, including count of connections established. Throughput is measured by `BenchHttpClient.cpp` in retrieval benchmarks.
+     */
+    class HttpClientLoopbackTest : public testing::Test {
+    protected:
+        static constexpr int STREAM_LINES = 20;
+
+        httplib::Server server_;
+        std::thread server_thread_;
+        int port_ = 0;
+
+        void SetUp() override {
+            SetupLogging();
+            // keep connections alive during whole test
+            server_.set_keep_alive_max_count(100000);
+            server_.new_task_queue = [] { return new httplib::ThreadPool(64); };
+            server_.Get("/ping", [](const httplib::Request&, httplib::Response& resp) {
+                resp.set_content("pong", HTTP_CONTENT_TYPES.at(kPlainText));
+            });
+            server_.Get("/stream", [](const httplib::Request&, httplib::Response& resp) {
+                resp.set_chunked_content_provider(HTTP_CONTENT_TYPES.at(kEventStream), [](const size_t offset, httplib::DataSink& sink) {
+                    for (int i = 0; i < STREAM_LINES; ++i) {
+                        const auto line = fmt::format("data: {}\n\n", i);
+                        sink.write(line.data(), line.size());
+                    }
+                    sink.done();
+                    return true;
+                });
+            });
+            port_ = server_.bind_to_any_port("127.0.0.1");
+            server_thread_ = std::thread([&] { server_.listen_after_bind(); });
+            server_.wait_until_ready();
+        }
+
+        void TearDown() override {
+            server_.stop();
+            server_thread_.join();
+        }
+
+        [[nodiscard]] HttpRequest CreateRequest(const std::string& path) const {
+            return HttpUtils::CreateRequest(fmt::format("GET http://127.0.0.1:{}{}", port_, path));
+        }
+
+        /**
+         * Run requests with given client sequentially in a few threads
+         */
+        void RunSequentially(IHttpClient& client, const int thread_count = 4, const int request_per_thread = 250) const {
+            const auto request = CreateRequest("/ping");
+            std::vector<std::thread> threads;
+            std::atomic<int> ok = 0;
+            for (int i = 0; i < thread_count; ++i) {
+                threads.emplace_back([&] {
+                    for (int j = 0; j < request_per_thread; ++j) {
+                        ok += client.Execute(request).status_code == 200;
+                    }
+                });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+            ASSERT_EQ(ok, thread_count * request_per_thread);
+        }
+    };
+
+    TEST_F(HttpClientLoopbackTest, PooledHandles) {
+        // no handle is kept and no connection is shared, which equals to `curl_easy_init` per request
+        CURLHttpClient fresh_client {{.max_idle_handles_per_host = 0, .share_connections = false}};
+        RunSequentially(fresh_client);
+        const auto fresh_stats = fresh_client.GetStats();
+        ASSERT_EQ(fresh_stats.connection_count, fresh_stats.request_count);
+
+        CURLHttpClient pooled_client;
+        RunSequentially(pooled_client);
+        const auto pooled_stats = pooled_client.GetStats();
+        ASSERT_EQ(pooled_stats.request_count, 1000);
+        // at most one connection for each thread
+        ASSERT_LE(pooled_stats.connection_count, 4);
+    }
+
+    TEST_F(HttpClientLoopbackTest, MultiBatch) {
+        CURLMultiHttpClient client {{.max_host_connections = 16}};
+        ThreadPool unused_pool {1};
+        constexpr int n = 1000;
+        const std::vector calls(n, CreateRequest("/ping"));
+        auto futures = client.ExecuteBatch(calls, unused_pool);
+        for (auto& f: futures) {
+            const auto resp = f.get();
+            ASSERT_EQ(resp.status_code, 200);
+            ASSERT_EQ(resp.body, "pong");
+        }
+        const auto stats = client.GetStats();
+        ASSERT_EQ(stats.request_count, n);
+        ASSERT_LE(stats.connection_count, 16);
+
+        // blocking calls share the same event loop
+        RunSequentially(client);
+        ASSERT_LE(client.GetStats().connection_count, 16);
+    }
+
+    TEST_F(HttpClientLoopbackTest, MultiStreams) {
+        CURLMultiHttpClient client {{.max_host_connections = 16, .max_buffered_chunks = 4}};
+        constexpr int n = 32;
+        const auto request = CreateRequest("/stream");
+        std::vector<std::thread> threads;
+        std::atomic<int> lines = 0;
+        for (int i = 0; i < n; ++i) {
+            threads.emplace_back([&] {
+                client.StreamChunk(request, {.line_breaker = "\n\n"})
+                    .subscribe([&](const auto& chunk) {
+                        lines += chunk.starts_with("data: ");
+                    });
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        ASSERT_EQ(lines, n * STREAM_LINES);
+        ASSERT_LE(client.GetStats().connection_count, 16);
+
+        // stop after first chunk
+        int received = 0;
+        client.ExecuteWithCallback(request, [&](const std::string&) {
+            ++received;
+            return false;
+        });
+        ASSERT_EQ(received, 1);
+    }
+
+    TEST_F(HttpClientLoopbackTest, StreamOutlivesClient) {
+        AsyncIterator<std::string> stream = [&] {
+            CURLMultiHttpClient client;
+            return client.StreamChunk(CreateRequest("/stream"), {.line_breaker = "\n\n"});
+        }();
+        // observable doesn't refer to destroyed client, and subscription fails with an error
+        bool failed = false;
+        stream.subscribe([](const auto&) {}, [&](const std::exception_ptr&) { failed = true; });
+        ASSERT_TRUE(failed);
+    }
+
+}
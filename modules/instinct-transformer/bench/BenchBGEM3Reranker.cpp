@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <thread>
+
+#include "model_factory.hpp"
+
+namespace INSTINCT_TRANSFORMER_NS::bench {
+
+    static constexpr size_t RERANKER_BENCH_PAIR_COUNT = 64;
+
+    /**
+     * Model instances that share memory-mapped weights, and tokenized QA pairs scored by them. They are loaded once and shared by all benchmark runs.
+     */
+    struct RerankerFixture {
+        ModelFactory model_factory;
+        TokenizerPtr tokenizer;
+        std::vector<ModelPtr> models;
+        std::vector<std::vector<int>> pairs;
+
+        static RerankerFixture& GetInstance() {
+            static RerankerFixture fixture;
+            return fixture;
+        }
+
+        /**
+         * Get first `n` model instances, loading more of them if needed
+         */
+        std::vector<ModelPtr> GetModels(const size_t n) {
+            static std::mutex mutex;
+            std::lock_guard guard {mutex};
+            while (models.size() < n) {
+                auto [model, model_tokenizer] = model_factory.load(BGE_M3_RERANKER_BIN_PATH);
+                models.push_back(std::move(model));
+                if (!tokenizer) tokenizer = std::move(model_tokenizer);
+            }
+            return {models.begin(), models.begin() + static_cast<long>(n)};
+        }
+
+    private:
+        RerankerFixture() {
+            GetModels(1);
+            pairs.resize(RERANKER_BENCH_PAIR_COUNT);
+            for (size_t i = 0; i < RERANKER_BENCH_PAIR_COUNT; ++i) {
+                tokenizer->encode_qa("what is panda?", "The giant panda is a bear species endemic to China. #" + std::to_string(i), pairs[i]);
+            }
+        }
+    };
+
+    /**
+     * Pairs per second of scoring QA pairs with bge-reranker-v2-m3. Pairs are partitioned by threads, each of which owns a model instance, and then split into batches of `batch_size`. Token budget of a forward pass is large enough for the largest batch, so that every batch is evaluated in a single pass. Args: batch_size, threads.
+     */
+    static void BM_BGEM3Reranker_RankBatch(benchmark::State& state) {
+        const auto batch_size = static_cast<size_t>(state.range(0));
+        const auto thread_count = static_cast<size_t>(state.range(1));
+        auto& fixture = RerankerFixture::GetInstance();
+        const auto models = fixture.GetModels(thread_count);
+        const auto& pairs = fixture.pairs;
+        const GenerationConfig config {.num_threads = 1, .max_batch_tokens = 4096};
+        for (auto _: state) {
+            std::vector<std::vector<float>> results(thread_count);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t] {
+                    for (size_t i = t * batch_size; i < pairs.size(); i += thread_count * batch_size) {
+                        const std::vector batch(pairs.begin() + static_cast<long>(i), pairs.begin() + static_cast<long>(std::min(i + batch_size, pairs.size())));
+                        models[t]->qa_rank_batch(config, batch, results[t]);
+                    }
+                });
+            }
+            for (auto& thread: threads) {
+                thread.join();
+            }
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pairs.size()));
+    }
+
+    BENCHMARK(BM_BGEM3Reranker_RankBatch)
+        ->ArgNames({"batch_size", "threads"})
+        ->ArgsProduct({{1, 8, 32}, {1, 2, 4}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+}
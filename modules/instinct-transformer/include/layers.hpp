@@ -45,6 +45,14 @@ namespace INSTINCT_TRANSFORMER_NS::layers {
         ggml_cgraph *g_cgraph = nullptr;
         ggml_scratch g_scratch{};
 
+        // following tensors are only set when multiple sequences are packed into a single forward pass
+        // absolute position ids of each token: [qlen]
+        ggml_tensor *positions = nullptr;
+        // additive mask that prevents tokens from attending to other sequences: [qlen, qlen]
+        ggml_tensor *attention_mask = nullptr;
+        // index of first token of each sequence: [n_sequences]
+        ggml_tensor *sequence_starts = nullptr;
+
         ~ForwardContext() {
             ggml_free(g_ctx);
         }
@@ -163,7 +171,7 @@ namespace INSTINCT_TRANSFORMER_NS::layers {
 
         ggml_tensor *forward(ForwardContext *ctx, ggml_tensor *input, int n_past) override {
             int qlen = (int) input->ne[0];
-            ggml_tensor *idx = ggml_view_1d(ctx->g_ctx, indices, qlen,
+            ggml_tensor *idx = ctx->positions ? ctx->positions : ggml_view_1d(ctx->g_ctx, indices, qlen,
                                             (n_past + pad_index) * ggml_element_size(indices));
 
             ggml_tensor *output1 = ggml_get_rows(ctx->g_ctx, word_weight, input);
@@ -252,6 +260,10 @@ namespace INSTINCT_TRANSFORMER_NS::layers {
 
             attn_scores = apply_pos_embedding_kq(ctx, attn_scores, hidden_size, qlen, pos);
 
+            // mask is broadcast over heads
+            if (ctx->attention_mask)
+                attn_scores = ggml_add_inplace(ctx->g_ctx, attn_scores, ctx->attention_mask);
+
             // attn_masked = mask_past(attn_scores)
             struct ggml_tensor *attn_masked = causal_ ? ggml_diag_mask_inf_inplace(ctx->g_ctx, attn_scores, n_past)
                                                       : attn_scores;
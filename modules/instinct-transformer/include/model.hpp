@@ -11,7 +11,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <cstring>
+#include <algorithm>
 #include <map>
+#include <span>
 #include <unistd.h>
 
 #include "./config.hpp"
@@ -32,6 +34,8 @@ namespace INSTINCT_TRANSFORMER_NS::models {
 //    float presence_penalty;
 //    float tfs_z;
 //    std::string sampling;
+        // max count of tokens packed into a single forward pass in batched ranking. `max_length` of model config is used if it's not positive.
+        int max_batch_tokens = 512;
     };
 
     static ggml_tensor * ggml_init_tensor(ggml_tensor *tensor,
@@ -272,6 +276,18 @@ namespace INSTINCT_TRANSFORMER_NS::models {
         virtual ~BaseModel()=default;
         virtual void load(ModelLoader& loader) = 0;
         virtual float qa_rank(const GenerationConfig& generation_config, const std::vector<int> &input_ids) = 0;
+
+        /**
+         * Rank a batch of QA pairs. Scores are appended to `scores` in the same order of `batch_input_ids`.
+         * Default implementation calls `qa_rank` for each pair.
+         */
+        virtual void qa_rank_batch(const GenerationConfig& generation_config, const std::vector<std::vector<int>> &batch_input_ids, std::vector<float>& scores) {
+            scores.reserve(scores.size() + batch_input_ids.size());
+            for (const auto& input_ids: batch_input_ids) {
+                scores.push_back(qa_rank(generation_config, input_ids));
+            }
+        }
+
         virtual void text_embedding(const GenerationConfig& generation_config, const std::vector<int>& input_ids, std::vector<float>& output_embeding) = 0;
     protected:
         ModelType model_type_;
@@ -317,6 +333,32 @@ namespace INSTINCT_TRANSFORMER_NS::models {
             return *(float *)lm->data;
         }
 
+        /**
+         * Pairs are packed greedily into sequences of at most `max_batch_tokens` tokens, and each packed sequence is evaluated in a single forward pass with a block-diagonal attention mask.
+         */
+        void qa_rank_batch(const GenerationConfig &config, const std::vector<std::vector<int>> &batch_input_ids, std::vector<float> &scores) override {
+            const size_t max_tokens = config.max_batch_tokens > 0 ? config.max_batch_tokens : config_.max_length;
+            scores.reserve(scores.size() + batch_input_ids.size());
+            for (size_t begin = 0, end = 0; begin < batch_input_ids.size(); begin = end) {
+                // a pair longer than `max_tokens` still gets a pass of its own
+                size_t total = batch_input_ids[begin].size();
+                for (end = begin + 1; end < batch_input_ids.size() && total + batch_input_ids[end].size() <= max_tokens; ++end) {
+                    total += batch_input_ids[end].size();
+                }
+                if (end - begin == 1) {
+                    scores.push_back(qa_rank(config, batch_input_ids[begin]));
+                    continue;
+                }
+                const auto *lm = run_model_packed({batch_input_ids.data() + begin, end - begin}, config);
+                // "lm->type must be GGML_TYPE_F32"
+                GGML_ASSERT(lm->type == GGML_TYPE_F32);
+                // "output must be one scalar per sequence"
+                GGML_ASSERT((lm->ne[0] == 1) && (lm->ne[1] == (int64_t) (end - begin)) && ggml_is_contiguous(lm));
+                const auto *data = (float *) lm->data;
+                scores.insert(scores.end(), data, data + (end - begin));
+            }
+        }
+
         void text_embedding(const GenerationConfig &generation_config, const std::vector<int> &input_ids,
             std::vector<float> &output_embeding) override {
             throw std::runtime_error("not implemented");
@@ -324,19 +366,77 @@ namespace INSTINCT_TRANSFORMER_NS::models {
 
     protected:
 
+        /**
+         * Offset added to position ids of each token. e.g. Roberta models skip positions reserved for padding.
+         */
+        [[nodiscard]] virtual int get_position_offset() const {
+            return 0;
+        }
+
         virtual ggml_tensor *run_model(const std::vector<int> &input_ids,
                                        const GenerationConfig &gen_config,
                                        int past)
         {
             ForwardContext ctx;
+            init_forward_context(ctx);
+
+            ggml_tensor *input_ids_tensor = ggml_new_tensor_1d(ctx.g_ctx, GGML_TYPE_I32, input_ids.size());
+            std::memcpy(input_ids_tensor->data, input_ids.data(), ggml_nbytes(input_ids_tensor));
+
+            return compute_graph(ctx, input_ids_tensor, gen_config, past);
+        }
+
+        /**
+         * Concatenate multiple sequences and evaluate them together. Tokens can only attend to tokens of the same sequence, and position ids restart at each sequence.
+         * @return tensor of shape [1, n_sequences]
+         */
+        virtual ggml_tensor *run_model_packed(const std::span<const std::vector<int>> sequences,
+                                              const GenerationConfig &gen_config)
+        {
+            ForwardContext ctx;
+            init_forward_context(ctx);
+
+            size_t qlen = 0;
+            for (const auto& sequence: sequences) {
+                qlen += sequence.size();
+            }
+
+            // inputs are allocated before any scratch is set, so they live through the whole graph
+            ggml_tensor *input_ids_tensor = ggml_new_tensor_1d(ctx.g_ctx, GGML_TYPE_I32, (int64_t) qlen);
+            ctx.positions = ggml_new_tensor_1d(ctx.g_ctx, GGML_TYPE_I32, (int64_t) qlen);
+            ctx.sequence_starts = ggml_new_tensor_1d(ctx.g_ctx, GGML_TYPE_I32, (int64_t) sequences.size());
+            ctx.attention_mask = ggml_new_tensor_2d(ctx.g_ctx, GGML_TYPE_F32, (int64_t) qlen, (int64_t) qlen);
+
+            auto *ids = (int32_t *) input_ids_tensor->data;
+            auto *positions = (int32_t *) ctx.positions->data;
+            auto *starts = (int32_t *) ctx.sequence_starts->data;
+            auto *mask = (float *) ctx.attention_mask->data;
+            std::fill_n(mask, qlen * qlen, -INFINITY);
+
+            const int position_offset = get_position_offset();
+            size_t start = 0;
+            for (size_t i = 0; i < sequences.size(); ++i) {
+                const auto& sequence = sequences[i];
+                starts[i] = (int32_t) start;
+                for (size_t j = 0; j < sequence.size(); ++j) {
+                    ids[start + j] = sequence[j];
+                    positions[start + j] = (int32_t) j + position_offset;
+                    std::fill_n(mask + (start + j) * qlen + start, sequence.size(), 0.f);
+                }
+                start += sequence.size();
+            }
+
+            return compute_graph(ctx, input_ids_tensor, gen_config, 0);
+        }
+
+        void init_forward_context(ForwardContext& ctx) {
             ctx.g_ctx = ggml_init({.mem_size = mem_size_, .mem_buffer = mem_buffer_.get(), .no_alloc = false});
             ctx.g_scratch = {.offs = 0, .size = scratch_size_, .data = scratch_buffer_.get()};
-
-            int n_threads = input_ids.size() >= 32 && ggml_cpu_has_blas() && !ggml_cpu_has_gpublas() ? 1 : gen_config.num_threads;
             ctx.g_cgraph = ggml_new_graph_custom(ctx.g_ctx, graph_size, false);
+        }
 
-            ggml_tensor *input_ids_tensor = ggml_new_tensor_1d(ctx.g_ctx, GGML_TYPE_I32, input_ids.size());
-            std::memcpy(input_ids_tensor->data, input_ids.data(), ggml_nbytes(input_ids_tensor));
+        ggml_tensor *compute_graph(ForwardContext& ctx, ggml_tensor *input_ids_tensor, const GenerationConfig &gen_config, int past) {
+            int n_threads = input_ids_tensor->ne[0] >= 32 && ggml_cpu_has_blas() && !ggml_cpu_has_gpublas() ? 1 : gen_config.num_threads;
 
             ggml_tensor *r = get_transformer().forward(&ctx, input_ids_tensor, past);
 
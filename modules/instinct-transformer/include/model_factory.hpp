@@ -40,20 +40,19 @@ namespace INSTINCT_TRANSFORMER_NS {
         }
 
         /**
-         * Load model by weight file path. Same instance will be returned for single model path.
+         * Load model by weight file path. Weights are memory-mapped once for each model path, and every call returns a new model instance that shares these weights.
          * @param model_path
          * @return
          */
         std::pair<ModelPtr, TokenizerPtr> load(const std::string& model_path) {
+            // sequential access to model_loaders_. loaders are also guarded as their read cursors are shared by model instances of same path.
+            std::lock_guard loader_lock {mutex_};
             std::shared_ptr<ModelLoader> loader = nullptr;
-            { // sequential access to model_loaders_
-                std::lock_guard loader_lock {mutex_};
-                if(model_loaders_.contains(model_path)) {
-                    loader = model_loaders_.at(model_path);
-                } else {
-                    loader = std::make_shared<ModelLoader>(model_path);
-                    model_loaders_.emplace(model_path, loader);
-                }
+            if(model_loaders_.contains(model_path)) {
+                loader = model_loaders_.at(model_path);
+            } else {
+                loader = std::make_shared<ModelLoader>(model_path);
+                model_loaders_.emplace(model_path, loader);
             }
 
             // read headers
@@ -141,9 +141,11 @@ namespace INSTINCT_TRANSFORMER_NS::models::bge {
         ggml_tensor *forward(ForwardContext *ctx, ggml_tensor *hidden_states) override {
             int hidden_size = (int)hidden_states->ne[0];
 
-            // We "pool" the model by simply taking the hidden state corresponding to the first token.
-            ggml_tensor *first_token_tensor = ggml_view_2d(ctx->g_ctx, hidden_states, hidden_size, 1,
-                                                           hidden_size * ggml_element_size(hidden_states), 0);
+            // We "pool" the model by simply taking the hidden state corresponding to the first token of each sequence.
+            ggml_tensor *first_token_tensor = ctx->sequence_starts
+                                                  ? ggml_get_rows(ctx->g_ctx, hidden_states, ctx->sequence_starts)
+                                                  : ggml_view_2d(ctx->g_ctx, hidden_states, hidden_size, 1,
+                                                                 hidden_size * ggml_element_size(hidden_states), 0);
             ggml_tensor *output = dense.forward(ctx, first_token_tensor);
             output = inplace_act(ctx->g_ctx, activation, output);
             output = out_proj.forward(ctx, output);
@@ -225,6 +227,10 @@ namespace INSTINCT_TRANSFORMER_NS::models::bge {
             return transformer_;
         }
 
+        [[nodiscard]] int get_position_offset() const override {
+            return transformer_.word_embeddings.pad_index;
+        }
+
         void load(ModelLoader &loader) override {
             loader.read_tensor("embeddings.word_embeddings.weight",         transformer_.word_embeddings.word_weight);
             loader.read_tensor("embeddings.position_embeddings.weight",     transformer_.word_embeddings.position_weight);
@@ -45,5 +45,31 @@ namespace INSTINCT_TRANSFORMER_NS {
         ASSERT_GT(get_rank_score("hello", "welcome"), 0.7f);
         ASSERT_LT(get_rank_score("hello", "farewell"), 0.1);
     }
-}
 
+    TEST_F(BGEM3RankerTest, test_batch_ranker) {
+        const std::vector<std::pair<std::string, std::string>> pairs {
+            {"hello", "welcome"},
+            {"hello", "farewell"},
+            {"what is panda?", "The giant panda is a bear species endemic to China."},
+            {"what is panda?", "hi"},
+            {"how to cook rice", "Rinse the rice, add water and simmer for about twenty minutes until water is absorbed."}
+        };
+        std::vector<std::vector<int>> batch;
+        std::vector<float> expected;
+        for (const auto& [q, a]: pairs) {
+            tokenizer_->encode_qa(q, a, batch.emplace_back());
+            expected.push_back(get_rank_score(q, a));
+        }
+
+        // all pairs in one pass, and with a token budget that forces multiple passes
+        for (const int max_batch_tokens: {512, 24}) {
+            const GenerationConfig config {.num_threads = 1, .max_batch_tokens = max_batch_tokens};
+            std::vector<float> scores;
+            model_->qa_rank_batch(config, batch, scores);
+            ASSERT_EQ(scores.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_NEAR(scores[i], expected[i], 1e-3);
+            }
+        }
+    }
+}